@@ -2,15 +2,11 @@
 
 Actuator::Actuator(int actuatorPin) : pin(actuatorPin) {}
 
-void Actuator::setOnStateChangeCallback(std::function<void(bool)> callback) {
-    onStateChangeCallback = callback;
-}
-
 void Actuator::notifyStateChange(bool newState) {
     if (currentState != newState) {
         currentState = newState;
-        if (onStateChangeCallback) {
-            onStateChangeCallback(newState);
+        if (eventBus) {
+            eventBus->publish(EventBus::ACTUATOR_STATE, newState ? 1 : 0);
         }
     }
 }
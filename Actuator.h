@@ -2,7 +2,7 @@
 #define ACTUATOR_H
 
 #include <Arduino.h>
-#include <functional>
+#include "EventBus.h"
 
 /**
  * @brief Abstract base class for all actuators following the Interface Segregation Principle
@@ -15,7 +15,7 @@ protected:
     int pin;
     bool initialized = false;
     bool currentState = false;
-    std::function<void(bool)> onStateChangeCallback = nullptr;
+    EventBus* eventBus = nullptr;
 
 public:
     explicit Actuator(int actuatorPin);
@@ -27,7 +27,7 @@ public:
     virtual bool getState() const = 0;
 
     // Event-driven programming support
-    void setOnStateChangeCallback(std::function<void(bool)> callback);
+    void setEventBus(EventBus* bus) { eventBus = bus; }
     
     // State checking
     bool isInitialized() const { return initialized; }
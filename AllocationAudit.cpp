@@ -0,0 +1,231 @@
+#include "AllocationAudit.h"
+#include <stdlib.h>
+#include <new>
+
+#ifdef ARDUINO_ARCH_ESP32
+#include <esp_system.h>
+#endif
+
+namespace {
+
+bool bootComplete = false;
+uint32_t bootAllocations = 0;
+uint32_t postBootAllocations = 0;
+uint32_t postBootBytes = 0;
+uint32_t untrackedSites = 0; // Post-boot allocations from callers that did not fit the table
+AllocationAudit::Site sites[AllocationAudit::MAX_SITES];
+uint8_t siteCount = 0;
+#ifdef ARDUINO_ARCH_ESP32
+uint32_t freeHeapAtBoot = 0;
+#endif
+
+#ifdef ARDUINO_ARCH_ESP32
+portMUX_TYPE auditLock = portMUX_INITIALIZER_UNLOCKED;
+#define AUDIT_LOCK() portENTER_CRITICAL_SAFE(&auditLock)
+#define AUDIT_UNLOCK() portEXIT_CRITICAL_SAFE(&auditLock)
+#else
+#define AUDIT_LOCK() noInterrupts()
+#define AUDIT_UNLOCK() interrupts()
+#endif
+
+}
+
+void AllocationAudit::markBootComplete() {
+    AUDIT_LOCK();
+    bootComplete = true;
+    AUDIT_UNLOCK();
+#ifdef ARDUINO_ARCH_ESP32
+    freeHeapAtBoot = ESP.getFreeHeap();
+#endif
+}
+
+bool AllocationAudit::isBootComplete() {
+    return bootComplete;
+}
+
+void AllocationAudit::record(const void* caller, size_t size) {
+    // Runs inside operator new, so it must not allocate or print
+    AUDIT_LOCK();
+    if (!bootComplete) {
+        bootAllocations++;
+        AUDIT_UNLOCK();
+        return;
+    }
+
+    postBootAllocations++;
+    postBootBytes += size;
+
+    uint8_t i = 0;
+    while (i < siteCount && sites[i].caller != caller) {
+        i++;
+    }
+    if (i == siteCount) {
+        if (siteCount < MAX_SITES) {
+            sites[i].caller = caller;
+            sites[i].count = 0;
+            sites[i].bytes = 0;
+            sites[i].firstSeen = millis();
+            siteCount++;
+        } else {
+            untrackedSites++;
+            AUDIT_UNLOCK();
+            return;
+        }
+    }
+    sites[i].count++;
+    sites[i].bytes += size;
+    AUDIT_UNLOCK();
+}
+
+uint32_t AllocationAudit::getBootAllocations() {
+    return bootAllocations;
+}
+
+uint32_t AllocationAudit::getPostBootAllocations() {
+    return postBootAllocations;
+}
+
+uint32_t AllocationAudit::getPostBootBytes() {
+    return postBootBytes;
+}
+
+uint8_t AllocationAudit::getSiteCount() {
+    return siteCount;
+}
+
+bool AllocationAudit::getSite(uint8_t index, Site& site) {
+    AUDIT_LOCK();
+    bool valid = index < siteCount;
+    if (valid) {
+        site = sites[index];
+    }
+    AUDIT_UNLOCK();
+    return valid;
+}
+
+void AllocationAudit::print(Print& out) {
+#if TAVOLO_ALLOC_AUDIT
+    out.print("Allocations: ");
+    out.print(bootAllocations);
+    out.print(" during boot, ");
+    out.print(postBootAllocations);
+    out.print(" after boot (");
+    out.print(postBootBytes);
+    out.println(" bytes)");
+
+    Site site;
+    for (uint8_t i = 0; getSite(i, site); i++) {
+        out.print("  caller 0x");
+        out.print((unsigned long)(uintptr_t)site.caller, HEX);
+        out.print(": ");
+        out.print(site.count);
+        out.print(" x, ");
+        out.print(site.bytes);
+        out.print(" bytes, first at ");
+        out.print(site.firstSeen);
+        out.println(" ms");
+    }
+    if (untrackedSites > 0) {
+        out.print("  other callers: ");
+        out.println(untrackedSites);
+    }
+#else
+    out.println("Allocations: audit disabled (TAVOLO_ALLOC_AUDIT=0)");
+#endif
+
+#ifdef ARDUINO_ARCH_ESP32
+    out.print("Heap: ");
+    out.print(ESP.getFreeHeap());
+    out.print(" free (");
+    out.print(freeHeapAtBoot);
+    out.print(" after boot), ");
+    out.print(ESP.getMinFreeHeap());
+    out.print(" minimum, ");
+    out.print(ESP.getMaxAllocHeap());
+    out.println(" largest block");
+#endif
+}
+
+#if TAVOLO_ALLOC_AUDIT
+
+// Replacements for the global allocation functions. The caller address is the
+// code that asked for memory; __builtin_return_address(0) is taken here rather
+// than in a helper so it is not the helper's own frame.
+
+namespace {
+
+void* countedAllocation(size_t size, const void* caller) {
+    void* block = malloc(size ? size : 1);
+    if (block != nullptr) {
+        AllocationAudit::record(caller, size);
+    }
+    return block;
+}
+
+// Standard semantics: retry through the new_handler, then throw std::bad_alloc. Built
+// with -fno-exceptions there is nothing to throw, and abort() is what the toolchain's
+// own operator new does in that case.
+void* allocateOrThrow(size_t size, const void* caller) {
+    for (;;) {
+        void* block = countedAllocation(size, caller);
+        if (block != nullptr) return block;
+
+        std::new_handler handler = std::get_new_handler();
+        if (handler == nullptr) {
+#if defined(__cpp_exceptions) || defined(__EXCEPTIONS)
+            throw std::bad_alloc();
+#else
+            abort();
+#endif
+        }
+        handler();
+    }
+}
+
+void* allocateOrNull(size_t size, const void* caller) noexcept {
+#if defined(__cpp_exceptions) || defined(__EXCEPTIONS)
+    try {
+        return allocateOrThrow(size, caller);
+    } catch (...) {
+        return nullptr;
+    }
+#else
+    return countedAllocation(size, caller);
+#endif
+}
+
+}
+
+void* operator new(size_t size) {
+    return allocateOrThrow(size, __builtin_return_address(0));
+}
+
+void* operator new[](size_t size) {
+    return allocateOrThrow(size, __builtin_return_address(0));
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept {
+    return allocateOrNull(size, __builtin_return_address(0));
+}
+
+void* operator new[](size_t size, const std::nothrow_t&) noexcept {
+    return allocateOrNull(size, __builtin_return_address(0));
+}
+
+void operator delete(void* block) noexcept {
+    free(block);
+}
+
+void operator delete[](void* block) noexcept {
+    free(block);
+}
+
+void operator delete(void* block, size_t) noexcept {
+    free(block);
+}
+
+void operator delete[](void* block, size_t) noexcept {
+    free(block);
+}
+
+#endif
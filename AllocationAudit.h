@@ -0,0 +1,51 @@
+#ifndef ALLOCATION_AUDIT_H
+#define ALLOCATION_AUDIT_H
+
+#include <Arduino.h>
+
+// Build-time switch for the allocation audit; 0 leaves the toolchain's operator new in place
+#ifndef TAVOLO_ALLOC_AUDIT
+#define TAVOLO_ALLOC_AUDIT 1
+#endif
+
+/**
+ * @brief Counts heap allocations made after boot and remembers where they came from
+ *
+ * With TAVOLO_ALLOC_AUDIT the global operator new is replaced by a counting wrapper
+ * around malloc that fails like the standard one (new_handler, then std::bad_alloc,
+ * or abort() without exceptions). Once markBootComplete() is called every further allocation is
+ * counted and its caller address kept in a small table; STATUS and ALLOC print
+ * them, and xtensa-esp32-elf-addr2line turns the addresses into source lines.
+ *
+ * Only C++ allocations are seen (new, std::function storage, WiFiClient sockets).
+ * String and stdio use malloc directly; on ESP32 the heap's free, minimum and
+ * largest-block figures are printed alongside to show their effect.
+ */
+class AllocationAudit {
+public:
+    static const uint8_t MAX_SITES = 8;
+
+    struct Site {
+        const void* caller;
+        uint32_t count;
+        uint32_t bytes;
+        unsigned long firstSeen; // ms
+    };
+
+    // Everything allocated from here on is a steady-state allocation
+    static void markBootComplete();
+    static bool isBootComplete();
+
+    // Called by the operator new replacement
+    static void record(const void* caller, size_t size);
+
+    static uint32_t getBootAllocations();
+    static uint32_t getPostBootAllocations();
+    static uint32_t getPostBootBytes();
+    static uint8_t getSiteCount();
+    static bool getSite(uint8_t index, Site& site);
+
+    static void print(Print& out);
+};
+
+#endif // ALLOCATION_AUDIT_H
@@ -0,0 +1,91 @@
+#include "BinaryPayload.h"
+#include <string.h>
+
+void BinaryPayload::writeU32(uint8_t* out, uint32_t value) {
+    out[0] = value & 0xFF;
+    out[1] = (value >> 8) & 0xFF;
+    out[2] = (value >> 16) & 0xFF;
+    out[3] = (value >> 24) & 0xFF;
+}
+
+uint32_t BinaryPayload::readU32(const uint8_t* in) {
+    return (uint32_t)in[0] | ((uint32_t)in[1] << 8) |
+           ((uint32_t)in[2] << 16) | ((uint32_t)in[3] << 24);
+}
+
+void BinaryPayload::writeF32(uint8_t* out, float value) {
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    writeU32(out, bits);
+}
+
+float BinaryPayload::readF32(const uint8_t* in) {
+    uint32_t bits = readU32(in);
+    float value;
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+size_t BinaryPayload::writeHeader(uint8_t* out, MessageType type, uint32_t timestamp) {
+    out[0] = VERSION;
+    out[1] = type;
+    writeU32(out + HEADER_SIZE, timestamp);
+    return HEADER_SIZE + 4;
+}
+
+size_t BinaryPayload::encodeWeight(uint8_t* buffer, size_t capacity, uint32_t timestamp, float weight) {
+    if (capacity < WEIGHT_SIZE) return 0;
+
+    size_t length = writeHeader(buffer, WEIGHT, timestamp);
+    writeF32(buffer + length, weight);
+    return length + 4;
+}
+
+size_t BinaryPayload::encodeStatus(uint8_t* buffer, size_t capacity, uint32_t timestamp, const char* status) {
+    size_t statusLength = strlen(status);
+    if (statusLength > MAX_STATUS_LENGTH) statusLength = MAX_STATUS_LENGTH;
+    if (capacity < HEADER_SIZE + 5 + statusLength) return 0;
+
+    size_t length = writeHeader(buffer, STATUS, timestamp);
+    buffer[length++] = (uint8_t)statusLength;
+    memcpy(buffer + length, status, statusLength);
+    return length + statusLength;
+}
+
+size_t BinaryPayload::encodeHeartbeat(uint8_t* buffer, size_t capacity, uint32_t timestamp) {
+    if (capacity < HEARTBEAT_SIZE) return 0;
+
+    return writeHeader(buffer, HEARTBEAT, timestamp);
+}
+
+bool BinaryPayload::decode(const uint8_t* buffer, size_t length, Message& message) {
+    if (length < HEARTBEAT_SIZE || buffer[0] != VERSION) return false;
+
+    message.version = buffer[0];
+    message.type = (MessageType)buffer[1];
+    message.timestamp = readU32(buffer + HEADER_SIZE);
+    message.weight = 0.0f;
+    message.status[0] = '\0';
+
+    switch (message.type) {
+        case WEIGHT:
+            if (length != WEIGHT_SIZE) return false;
+            message.weight = readF32(buffer + HEADER_SIZE + 4);
+            return true;
+
+        case STATUS: {
+            if (length < HEADER_SIZE + 5) return false;
+            size_t statusLength = buffer[HEADER_SIZE + 4];
+            if (statusLength > MAX_STATUS_LENGTH || length != HEADER_SIZE + 5 + statusLength) return false;
+            memcpy(message.status, buffer + HEADER_SIZE + 5, statusLength);
+            message.status[statusLength] = '\0';
+            return true;
+        }
+
+        case HEARTBEAT:
+            return length == HEARTBEAT_SIZE;
+
+        default:
+            return false;
+    }
+}
@@ -0,0 +1,61 @@
+#ifndef BINARY_PAYLOAD_H
+#define BINARY_PAYLOAD_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief Compact fixed-layout binary encoding for edge telemetry
+ *
+ * Every message starts with a version byte and a type byte; all multi-byte
+ * fields are little-endian. The version byte is never '{' so the edge can tell
+ * binary and JSON payloads apart on the same topic. The device ID is carried
+ * by the topic and is not repeated in the payload.
+ *
+ *   WEIGHT    | ver | type | timestamp:u32 | weight:f32 |            10 bytes
+ *   STATUS    | ver | type | timestamp:u32 | len:u8 | status[len] | 7 + len bytes
+ *   HEARTBEAT | ver | type | timestamp:u32 |                         6 bytes
+ *
+ * The codec has no Arduino dependencies so the edge and host tools can link it as is.
+ */
+class BinaryPayload {
+public:
+    static const uint8_t VERSION = 1;
+
+    enum MessageType : uint8_t {
+        WEIGHT = 1,
+        STATUS = 2,
+        HEARTBEAT = 3
+    };
+
+    static const size_t HEADER_SIZE = 2;
+    static const size_t WEIGHT_SIZE = HEADER_SIZE + 8;
+    static const size_t HEARTBEAT_SIZE = HEADER_SIZE + 4;
+    static const size_t MAX_STATUS_LENGTH = 32;
+    static const size_t MAX_MESSAGE_SIZE = HEADER_SIZE + 5 + MAX_STATUS_LENGTH;
+
+    struct Message {
+        uint8_t version;
+        MessageType type;
+        uint32_t timestamp;
+        float weight;                        // WEIGHT only
+        char status[MAX_STATUS_LENGTH + 1];  // STATUS only, NUL-terminated
+    };
+
+    // Encoders return the number of bytes written, or 0 when the buffer is too small
+    static size_t encodeWeight(uint8_t* buffer, size_t capacity, uint32_t timestamp, float weight);
+    static size_t encodeStatus(uint8_t* buffer, size_t capacity, uint32_t timestamp, const char* status);
+    static size_t encodeHeartbeat(uint8_t* buffer, size_t capacity, uint32_t timestamp);
+
+    // Returns false for unknown versions, unknown types or truncated input
+    static bool decode(const uint8_t* buffer, size_t length, Message& message);
+
+private:
+    static size_t writeHeader(uint8_t* out, MessageType type, uint32_t timestamp);
+    static void writeU32(uint8_t* out, uint32_t value);
+    static uint32_t readU32(const uint8_t* in);
+    static void writeF32(uint8_t* out, float value);
+    static float readF32(const uint8_t* in);
+};
+
+#endif // BINARY_PAYLOAD_H
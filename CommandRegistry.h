@@ -0,0 +1,236 @@
+#ifndef COMMAND_REGISTRY_H
+#define COMMAND_REGISTRY_H
+
+#include <Arduino.h>
+#include <errno.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * @brief 32-bit FNV-1a hash of a command name
+ *
+ * constexpr so names given as literals can be hashed by the compiler; the
+ * runtime overload hashes the received name with the same algorithm.
+ */
+constexpr uint32_t commandHash(const char* name, uint32_t hash = 2166136261u) {
+    return *name ? commandHash(name + 1, (hash ^ (uint8_t)*name) * 16777619u) : hash;
+}
+
+/**
+ * @brief Decoded command argument
+ *
+ * TEXT arguments point into the caller's buffer and are only valid during the handler.
+ */
+struct CommandArg {
+    enum Type : uint8_t {
+        NONE,
+        FLOAT,
+        INT,
+        ENUM,  // Index into the choices given at registration
+        TEXT
+    };
+
+    Type type = NONE;
+    float floatValue = 0.0f;
+    long intValue = 0;
+    uint8_t enumValue = 0;
+    const char* text = "";
+};
+
+/**
+ * @brief Fixed-capacity command table with typed arguments and per-command timing
+ *
+ * Entries are kept sorted by name hash, so a lookup is a binary search plus one
+ * strcmp to rule out collisions. Handlers are plain function pointers taking the
+ * context object, which lets capture-less lambdas be registered without allocation.
+ * Adding a command is one add() call; dispatch() itself never changes.
+ */
+template<typename Context, uint8_t Capacity = 16>
+class CommandRegistry {
+public:
+    typedef void (*Handler)(Context& context, const CommandArg& arg);
+
+    enum class Result {
+        OK,
+        UNKNOWN_COMMAND,
+        BAD_ARGUMENT
+    };
+
+    struct Entry {
+        uint32_t hash;
+        const char* name;
+        CommandArg::Type argType;
+        const char* const* choices;
+        uint8_t choiceCount;
+        Handler handler;
+
+        // Statistics
+        uint32_t calls;
+        uint32_t errors;
+        uint32_t lastDispatchUs;
+        uint32_t maxDispatchUs;
+    };
+
+private:
+    Entry entries[Capacity];
+    uint8_t count = 0;
+    uint32_t unknownCount = 0;
+
+public:
+    bool add(const char* name, CommandArg::Type argType, Handler handler) {
+        return add(name, argType, nullptr, 0, handler);
+    }
+
+    bool add(const char* name, const char* const* choices, uint8_t choiceCount, Handler handler) {
+        return add(name, CommandArg::ENUM, choices, choiceCount, handler);
+    }
+
+    Result dispatch(Context& context, const char* name, const char* value, unsigned long& dispatchUs) {
+        dispatchUs = 0;
+
+        Entry* entry = find(name);
+        if (!entry) {
+            unknownCount++;
+            return Result::UNKNOWN_COMMAND;
+        }
+
+        CommandArg arg;
+        if (!decode(*entry, value ? value : "", arg)) {
+            entry->errors++;
+            return Result::BAD_ARGUMENT;
+        }
+
+        unsigned long start = micros();
+        entry->handler(context, arg);
+        dispatchUs = micros() - start;
+
+        entry->calls++;
+        entry->lastDispatchUs = dispatchUs;
+        if (dispatchUs > entry->maxDispatchUs) {
+            entry->maxDispatchUs = dispatchUs;
+        }
+        return Result::OK;
+    }
+
+    // Registered spelling of a command name (static storage), or nullptr when unknown
+    const char* lookup(const char* name) {
+        Entry* entry = find(name);
+        return entry ? entry->name : nullptr;
+    }
+
+    uint8_t size() const { return count; }
+    uint32_t getUnknownCount() const { return unknownCount; }
+
+    static const char* resultToString(Result result) {
+        switch (result) {
+            case Result::OK: return "OK";
+            case Result::UNKNOWN_COMMAND: return "UNKNOWN_COMMAND";
+            case Result::BAD_ARGUMENT: return "BAD_ARGUMENT";
+            default: return "UNKNOWN";
+        }
+    }
+
+    void printStats(Print& out) const {
+        out.println("=== EDGE COMMANDS ===");
+        for (uint8_t i = 0; i < count; i++) {
+            const Entry& entry = entries[i];
+            out.print(entry.name);
+            out.print(": calls=");
+            out.print(entry.calls);
+            out.print(" errors=");
+            out.print(entry.errors);
+            out.print(" last=");
+            out.print(entry.lastDispatchUs);
+            out.print("us max=");
+            out.print(entry.maxDispatchUs);
+            out.println("us");
+        }
+        out.print("Unknown commands: ");
+        out.println(unknownCount);
+        out.println("=====================");
+    }
+
+private:
+    bool add(const char* name, CommandArg::Type argType, const char* const* choices,
+             uint8_t choiceCount, Handler handler) {
+        uint32_t hash = commandHash(name);
+        if (count >= Capacity || !handler) return false;
+
+        // Keep the table sorted by hash; equal hashes are rejected so lookups stay unambiguous
+        uint8_t position = count;
+        while (position > 0 && entries[position - 1].hash > hash) {
+            position--;
+        }
+        if (position > 0 && entries[position - 1].hash == hash) return false;
+
+        for (uint8_t i = count; i > position; i--) {
+            entries[i] = entries[i - 1];
+        }
+
+        Entry& entry = entries[position];
+        entry = Entry();
+        entry.hash = hash;
+        entry.name = name;
+        entry.argType = argType;
+        entry.choices = choices;
+        entry.choiceCount = choiceCount;
+        entry.handler = handler;
+        count++;
+        return true;
+    }
+
+    Entry* find(const char* name) {
+        if (!name) return nullptr;
+        uint32_t hash = commandHash(name);
+
+        int low = 0;
+        int high = (int)count - 1;
+        while (low <= high) {
+            int middle = (low + high) / 2;
+            if (entries[middle].hash < hash) {
+                low = middle + 1;
+            } else if (entries[middle].hash > hash) {
+                high = middle - 1;
+            } else {
+                return strcmp(entries[middle].name, name) == 0 ? &entries[middle] : nullptr;
+            }
+        }
+        return nullptr;
+    }
+
+    static bool decode(const Entry& entry, const char* value, CommandArg& arg) {
+        arg.type = entry.argType;
+        arg.text = value;
+        char* end = nullptr;
+
+        switch (entry.argType) {
+            case CommandArg::NONE:
+            case CommandArg::TEXT:
+                return true;
+
+            // Out of range is an error, not a saturated value; inf and nan are never a setting
+            case CommandArg::FLOAT:
+                errno = 0;
+                arg.floatValue = strtof(value, &end);
+                return end != value && *end == '\0' && errno != ERANGE && isfinite(arg.floatValue);
+
+            case CommandArg::INT:
+                errno = 0;
+                arg.intValue = strtol(value, &end, 10);
+                return end != value && *end == '\0' && errno != ERANGE;
+
+            case CommandArg::ENUM:
+                for (uint8_t i = 0; i < entry.choiceCount; i++) {
+                    if (strcmp(entry.choices[i], value) == 0) {
+                        arg.enumValue = i;
+                        return true;
+                    }
+                }
+                return false;
+        }
+        return false;
+    }
+};
+
+#endif // COMMAND_REGISTRY_H
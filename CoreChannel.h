@@ -0,0 +1,103 @@
+#ifndef CORE_CHANNEL_H
+#define CORE_CHANNEL_H
+
+#include <Arduino.h>
+#include <atomic>
+#include "SampleRing.h"
+
+/**
+ * @brief Bounded lock-free queue between the two cores, with depth and drop metrics
+ *
+ * One producer task and one consumer task. A full queue drops the new message
+ * instead of blocking the producer, so a stalled consumer can never delay the
+ * sensing side.
+ */
+template <typename T, size_t Capacity>
+class CoreChannel {
+private:
+    SampleRing<T, Capacity> ring;
+    std::atomic<uint32_t> sentCount{0};
+    std::atomic<uint32_t> dropCount{0};
+    std::atomic<uint32_t> highWater{0};
+
+public:
+    // Producer side
+    bool send(const T& message) {
+        if (!ring.push(message)) {
+            dropCount.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        sentCount.fetch_add(1, std::memory_order_relaxed);
+
+        uint32_t depth = ring.size();
+        if (depth > highWater.load(std::memory_order_relaxed)) {
+            highWater.store(depth, std::memory_order_relaxed);
+        }
+        return true;
+    }
+
+    // Consumer side
+    bool receive(T& message) { return ring.pop(message); }
+
+    size_t depth() const { return ring.size(); }
+    static constexpr size_t capacity() { return Capacity; }
+    uint32_t getSentCount() const { return sentCount.load(std::memory_order_relaxed); }
+    uint32_t getDropCount() const { return dropCount.load(std::memory_order_relaxed); }
+    uint32_t getHighWater() const { return highWater.load(std::memory_order_relaxed); }
+
+    void printStats(Print& out, const char* name) const {
+        out.print(name);
+        out.print(": depth ");
+        out.print((unsigned long)depth());
+        out.print("/");
+        out.print((unsigned long)Capacity);
+        out.print(", high ");
+        out.print(getHighWater());
+        out.print(", sent ");
+        out.print(getSentCount());
+        out.print(", dropped ");
+        out.println(getDropCount());
+    }
+};
+
+/**
+ * @brief Single-writer sequence lock for publishing a small snapshot across cores
+ *
+ * The writer never waits. Readers retry while a write is in progress or when the
+ * sequence changed under them, so they always see a consistent copy.
+ */
+template <typename T>
+class SeqLock {
+private:
+    std::atomic<uint32_t> sequence{0};
+    T value;
+
+public:
+    SeqLock() : value() {}
+
+    void write(const T& newValue) {
+        uint32_t current = sequence.load(std::memory_order_relaxed);
+        sequence.store(current + 1, std::memory_order_relaxed); // Odd: write in progress
+        std::atomic_thread_fence(std::memory_order_release);
+        value = newValue;
+        std::atomic_thread_fence(std::memory_order_release);
+        sequence.store(current + 2, std::memory_order_release);
+    }
+
+    T read() const {
+        T copy;
+        uint32_t before;
+        uint32_t after;
+        do {
+            before = sequence.load(std::memory_order_acquire);
+            copy = value;
+            std::atomic_thread_fence(std::memory_order_acquire);
+            after = sequence.load(std::memory_order_relaxed);
+        } while ((before & 1) || before != after);
+        return copy;
+    }
+
+    uint32_t getVersion() const { return sequence.load(std::memory_order_acquire) / 2; }
+};
+
+#endif // CORE_CHANNEL_H
@@ -0,0 +1,203 @@
+#include "DeferredLog.h"
+#include <stdio.h>
+#include <string.h>
+#ifdef ARDUINO_ARCH_ESP32
+#include <esp_system.h>
+#endif
+
+namespace {
+
+struct Entry {
+    const DeferredLog::Site* site;
+    uint32_t timestamp;
+    uint8_t argCount;
+    DeferredLog::Arg args[DeferredLog::MAX_ARGS];
+};
+
+Entry entries[DeferredLog::CAPACITY];
+uint16_t head = 0; // Next slot to write
+uint16_t tail = 0; // Next slot to drain
+uint16_t count = 0;
+uint32_t writtenCount = 0;
+uint32_t droppedCount = 0;
+uint32_t reportedDrops = 0;
+
+// Line formatted by drain() but not yet written for lack of TX space
+char line[160];
+size_t lineLength = 0;
+size_t lineOffset = 0;
+
+#ifdef ARDUINO_ARCH_ESP32
+portMUX_TYPE logLock = portMUX_INITIALIZER_UNLOCKED;
+#define LOG_LOCK() portENTER_CRITICAL_SAFE(&logLock)
+#define LOG_UNLOCK() portEXIT_CRITICAL_SAFE(&logLock)
+#else
+#define LOG_LOCK() noInterrupts()
+#define LOG_UNLOCK() interrupts()
+#endif
+
+const char* levelTag(uint8_t level) {
+    switch (level) {
+        case TAVOLO_LOG_LEVEL_ERROR: return "E";
+        case TAVOLO_LOG_LEVEL_WARN: return "W";
+        case TAVOLO_LOG_LEVEL_INFO: return "I";
+        default: return "D";
+    }
+}
+
+// Expands the site's format with the stored arguments; each conversion is handed to
+// snprintf on its own with the length modifier dropped, since arguments are 32-bit
+size_t format(const Entry& entry, char* out, size_t size) {
+    int length = snprintf(out, size, "[%lu %s] ", (unsigned long)entry.timestamp, levelTag(entry.site->level));
+    size_t used = length > 0 ? (size_t)length : 0;
+    uint8_t argIndex = 0;
+
+    for (const char* p = entry.site->format; *p && used + 1 < size; p++) {
+        if (*p != '%') {
+            out[used++] = *p;
+            continue;
+        }
+        if (p[1] == '%') {
+            out[used++] = '%';
+            p++;
+            continue;
+        }
+
+        char spec[12];
+        size_t specLength = 0;
+        spec[specLength++] = '%';
+        p++;
+        while (*p && strchr("-+ #0123456789.", *p) && specLength < sizeof(spec) - 2) {
+            spec[specLength++] = *p++;
+        }
+        while (*p == 'l' || *p == 'h' || *p == 'z') {
+            p++;
+        }
+        if (!*p) break;
+        spec[specLength++] = *p;
+        spec[specLength] = '\0';
+
+        if (argIndex >= entry.argCount) {
+            length = snprintf(out + used, size - used, "?");
+        } else {
+            const DeferredLog::Arg& arg = entry.args[argIndex++];
+            switch (*p) {
+                case 'd':
+                case 'i':
+                    length = snprintf(out + used, size - used, spec, (int)arg.i);
+                    break;
+                case 'u':
+                case 'x':
+                case 'X':
+                case 'c':
+                    length = snprintf(out + used, size - used, spec, (unsigned)arg.u);
+                    break;
+                case 'f':
+                case 'g':
+                case 'e':
+                    length = snprintf(out + used, size - used, spec, (double)arg.f);
+                    break;
+                case 's':
+                    length = snprintf(out + used, size - used, spec, arg.s ? arg.s : "(null)");
+                    break;
+                default:
+                    length = 0;
+                    break;
+            }
+        }
+        if (length > 0) {
+            used += (size_t)length < size - used ? (size_t)length : size - used - 1;
+        }
+    }
+
+    if (used + 2 >= size) used = size - 3;
+    out[used++] = '\r';
+    out[used++] = '\n';
+    out[used] = '\0';
+    return used;
+}
+
+}
+
+void DeferredLog::push(const Site& site, const Arg* args, uint8_t argCount) {
+    uint32_t now = millis();
+    LOG_LOCK();
+    if (count == CAPACITY) {
+        droppedCount++;
+        LOG_UNLOCK();
+        return;
+    }
+    Entry& entry = entries[head];
+    entry.site = &site;
+    entry.timestamp = now;
+    entry.argCount = argCount;
+    for (uint8_t i = 0; i < argCount; i++) {
+        entry.args[i] = args[i];
+    }
+    head = (head + 1) % CAPACITY;
+    count++;
+    writtenCount++;
+    LOG_UNLOCK();
+}
+
+size_t DeferredLog::drain(HardwareSerial& out) {
+    size_t lines = 0;
+
+    for (;;) {
+        if (lineLength == 0) {
+            Entry entry;
+            bool haveEntry = false;
+            uint32_t drops;
+
+            LOG_LOCK();
+            drops = droppedCount;
+            if (drops == reportedDrops && count > 0) {
+                entry = entries[tail];
+                tail = (tail + 1) % CAPACITY;
+                count--;
+                haveEntry = true;
+            }
+            LOG_UNLOCK();
+
+            if (drops != reportedDrops) {
+                // Report losses before the next message so the gap shows where it happened
+                lineLength = snprintf(line, sizeof(line), "[log] %lu messages dropped\r\n",
+                                      (unsigned long)(drops - reportedDrops));
+                reportedDrops = drops;
+            } else if (haveEntry) {
+                lineLength = format(entry, line, sizeof(line));
+            } else {
+                return lines;
+            }
+        }
+
+        // Only what fits in the TX buffer; the rest waits for the next pass
+        int space = out.availableForWrite();
+        if (space <= 0) {
+            return lines;
+        }
+        size_t chunk = lineLength - lineOffset;
+        if (chunk > (size_t)space) chunk = space;
+        out.write((const uint8_t*)line + lineOffset, chunk);
+        lineOffset += chunk;
+
+        if (lineOffset < lineLength) {
+            return lines;
+        }
+        lineLength = 0;
+        lineOffset = 0;
+        lines++;
+    }
+}
+
+uint32_t DeferredLog::getWrittenCount() {
+    return writtenCount;
+}
+
+uint32_t DeferredLog::getDroppedCount() {
+    return droppedCount;
+}
+
+size_t DeferredLog::pending() {
+    return count;
+}
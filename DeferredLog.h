@@ -0,0 +1,100 @@
+#ifndef DEFERRED_LOG_H
+#define DEFERRED_LOG_H
+
+#include <Arduino.h>
+
+// Build-time filtering: messages above the level or outside the module mask compile to nothing
+#define TAVOLO_LOG_LEVEL_NONE 0
+#define TAVOLO_LOG_LEVEL_ERROR 1
+#define TAVOLO_LOG_LEVEL_WARN 2
+#define TAVOLO_LOG_LEVEL_INFO 3
+#define TAVOLO_LOG_LEVEL_DEBUG 4
+
+#ifndef TAVOLO_LOG_LEVEL
+#define TAVOLO_LOG_LEVEL TAVOLO_LOG_LEVEL_INFO
+#endif
+
+#ifndef TAVOLO_LOG_MODULES
+#define TAVOLO_LOG_MODULES 0xFF
+#endif
+
+enum LogModule : uint8_t {
+    LOG_SYSTEM = 0x01,
+    LOG_SENSOR = 0x02,
+    LOG_LED = 0x04,
+    LOG_DISPLAY = 0x08,
+    LOG_EDGE = 0x10,
+    LOG_POWER = 0x20,
+    LOG_DEVICE = 0x40
+};
+
+/**
+ * @brief Deferred logger: callers enqueue a format id and raw arguments, a
+ * background task formats and writes them
+ *
+ * A call site costs one static descriptor (its id) and a short copy into a
+ * ring shared by both cores; nothing is formatted and the UART is never touched
+ * on the caller's path. drain() only writes as many bytes as the serial TX
+ * buffer has room for, so the logger never blocks either. When the ring is
+ * full new messages are counted as dropped.
+ *
+ * Arguments are stored by value, so %s only accepts strings that outlive the
+ * call: literals and long-lived buffers, never locals.
+ */
+class DeferredLog {
+public:
+    struct Site {
+        uint8_t level;
+        uint8_t module;
+        const char* format;
+    };
+
+    union Arg {
+        int32_t i;
+        uint32_t u;
+        float f;
+        const char* s;
+    };
+
+    static const uint8_t MAX_ARGS = 4;
+    static const uint8_t CAPACITY = 64;
+
+    template<typename... Args>
+    static void write(const Site& site, Args... args) {
+        static_assert(sizeof...(Args) <= MAX_ARGS, "Too many log arguments");
+        Arg packed[sizeof...(Args) + 1] = { pack(args)... };
+        push(site, packed, sizeof...(Args));
+    }
+
+    // Writes queued lines while they fit in the TX buffer; returns the number written
+    static size_t drain(HardwareSerial& out);
+
+    static uint32_t getWrittenCount();
+    static uint32_t getDroppedCount();
+    static size_t pending();
+
+private:
+    static void push(const Site& site, const Arg* args, uint8_t count);
+
+    static Arg pack(int value) { Arg arg; arg.i = value; return arg; }
+    static Arg pack(unsigned int value) { Arg arg; arg.u = value; return arg; }
+    static Arg pack(long value) { Arg arg; arg.i = (int32_t)value; return arg; }
+    static Arg pack(unsigned long value) { Arg arg; arg.u = (uint32_t)value; return arg; }
+    static Arg pack(float value) { Arg arg; arg.f = value; return arg; }
+    static Arg pack(double value) { Arg arg; arg.f = (float)value; return arg; }
+    static Arg pack(const char* value) { Arg arg; arg.s = value; return arg; }
+};
+
+#define TAVOLO_LOG(level, module, format, ...) do { \
+    if ((level) <= TAVOLO_LOG_LEVEL && ((module) & TAVOLO_LOG_MODULES)) { \
+        static const DeferredLog::Site tavoloLogSite = { (level), (module), (format) }; \
+        DeferredLog::write(tavoloLogSite, ##__VA_ARGS__); \
+    } \
+} while (0)
+
+#define TAVOLO_LOG_ERROR(module, format, ...) TAVOLO_LOG(TAVOLO_LOG_LEVEL_ERROR, module, format, ##__VA_ARGS__)
+#define TAVOLO_LOG_WARN(module, format, ...) TAVOLO_LOG(TAVOLO_LOG_LEVEL_WARN, module, format, ##__VA_ARGS__)
+#define TAVOLO_LOG_INFO(module, format, ...) TAVOLO_LOG(TAVOLO_LOG_LEVEL_INFO, module, format, ##__VA_ARGS__)
+#define TAVOLO_LOG_DEBUG(module, format, ...) TAVOLO_LOG(TAVOLO_LOG_LEVEL_DEBUG, module, format, ##__VA_ARGS__)
+
+#endif // DEFERRED_LOG_H
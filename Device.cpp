@@ -21,8 +21,8 @@ void Device::loop() {
     // Base implementation - can be overridden
 }
 
-String Device::getStateString() const {
-    switch (currentState) {
+const char* Device::stateToString(DeviceState state) {
+    switch (state) {
         case DeviceState::INITIALIZING: return "INITIALIZING";
         case DeviceState::READY: return "READY";
         case DeviceState::ACTIVE: return "ACTIVE";
@@ -40,22 +40,15 @@ void Device::setState(DeviceState newState) {
     }
 }
 
-void Device::setOnStateChangeCallback(std::function<void(DeviceState, DeviceState)> callback) {
-    onStateChangeCallback = callback;
-}
-
 void Device::notifyStateChange(DeviceState oldState, DeviceState newState) {
-    Serial.print("Device state changed: ");
-    Serial.print(getStateString());
-    Serial.print(" -> ");
-    
-    // Temporarily change state to get new state string
-    DeviceState temp = currentState;
-    currentState = newState;
-    Serial.println(getStateString());
-    currentState = temp;
+    TAVOLO_LOG_INFO(LOG_DEVICE, "Device state changed: %s -> %s", stateToString(oldState), stateToString(newState));
     
-    if (onStateChangeCallback) {
-        onStateChangeCallback(oldState, newState);
+    if (eventBus) {
+        EventBus::Event event = {};
+        event.topic = EventBus::DEVICE_STATE;
+        event.code = (uint8_t)newState;
+        event.previous = (uint8_t)oldState;
+        event.timestamp = millis();
+        eventBus->publish(event);
     }
 }
@@ -3,7 +3,8 @@
 
 #include <Arduino.h>
 #include <WiFi.h>
-#include <functional>
+#include "DeferredLog.h"
+#include "EventBus.h"
 
 /**
  * @brief Base class for IoT devices following SOLID principles
@@ -27,7 +28,7 @@ protected:
     String deviceMacAddress;
     String deviceId;
     DeviceState currentState;
-    std::function<void(DeviceState, DeviceState)> onStateChangeCallback = nullptr;
+    EventBus* eventBus = nullptr;
 
 public:
     Device();
@@ -39,15 +40,16 @@ public:
 
     // State management
     DeviceState getState() const { return currentState; }
-    String getStateString() const;
+    const char* getStateString() const { return stateToString(currentState); }
+    static const char* stateToString(DeviceState state);
     void setState(DeviceState newState);
 
     // Device identification
-    String getDeviceMacAddress() const { return deviceMacAddress; }
-    String getDeviceId() const { return deviceId; }
+    const String& getDeviceMacAddress() const { return deviceMacAddress; }
+    const String& getDeviceId() const { return deviceId; }
 
     // Event-driven programming support
-    void setOnStateChangeCallback(std::function<void(DeviceState, DeviceState)> callback);
+    void setEventBus(EventBus* bus) { eventBus = bus; }
 
 protected:
     void notifyStateChange(DeviceState oldState, DeviceState newState);
@@ -1,7 +1,7 @@
 #include "DisplayManager.h"
 
 DisplayManager::DisplayManager(uint8_t address, uint8_t cols, uint8_t rows) 
-    : lcd(address, cols, rows) {}
+    : lcd(address, cols, rows), frameBuffer(cols, rows) {}
 
 void DisplayManager::begin() {
     Serial.println("Initializing Display Manager...");
@@ -9,12 +9,14 @@ void DisplayManager::begin() {
     lcd.init();
     lcd.backlight();
     lcd.clear();
+    frameBuffer.markCleared();
     
     Serial.println("Display Manager initialized successfully.");
 }
 
 void DisplayManager::update() {
     unsigned long currentTime = millis();
+    updateCount++;
     
     // Check for message timeout
     if (messageTimeout > 0 && currentTime >= messageTimeout) {
@@ -34,65 +36,74 @@ void DisplayManager::setMode(DisplayMode mode) {
     if (currentMode != mode) {
         currentMode = mode;
         needsUpdate = true;
-        
-        Serial.print("Display mode changed to: ");
-        switch (mode) {
-            case DisplayMode::BOOT:
-                Serial.println("BOOT");
-                break;
-            case DisplayMode::WEIGHT_DISPLAY:
-                Serial.println("WEIGHT_DISPLAY");
-                break;
-            case DisplayMode::STATUS_MESSAGE:
-                Serial.println("STATUS_MESSAGE");
-                break;
-            case DisplayMode::ERROR_MESSAGE:
-                Serial.println("ERROR_MESSAGE");
-                break;
+        if (mode == DisplayMode::WEIGHT_DISPLAY) {
+            weightScreenDirty = true; // Another screen may have overwritten it
         }
+        
+        TAVOLO_LOG_DEBUG(LOG_DISPLAY, "Display mode changed to: %s", modeToString(mode));
+    }
+}
+
+const char* DisplayManager::modeToString(DisplayMode mode) {
+    switch (mode) {
+        case DisplayMode::BOOT: return "BOOT";
+        case DisplayMode::WEIGHT_DISPLAY: return "WEIGHT_DISPLAY";
+        case DisplayMode::STATUS_MESSAGE: return "STATUS_MESSAGE";
+        case DisplayMode::ERROR_MESSAGE: return "ERROR_MESSAGE";
+        default: return "UNKNOWN";
     }
 }
 
-void DisplayManager::showWeightData(float weight, const String& status) {
-    formatWeightDisplay(weight, status);
+void DisplayManager::showWeightData(float weight, const char* status) {
+    // Only record the inputs; the screen is composed when the next refresh is due
+    if (weight != weightValue || strncmp(status, weightStatus, sizeof(weightStatus)) != 0) {
+        weightValue = weight;
+        strlcpy(weightStatus, status, sizeof(weightStatus));
+        weightScreenDirty = true;
+    }
     setMode(DisplayMode::WEIGHT_DISPLAY);
 }
 
-void DisplayManager::showStatusMessage(const String& message, unsigned long timeout) {
-    line1Content = centerText("STATUS", 20);
-    line2Content = centerText(message.substring(0, 20), 20);
-    line3Content = "";
-    line4Content = centerText("Press any key...", 20);
+void DisplayManager::showStatusMessage(const char* message, unsigned long timeout) {
+    setCenteredLine(0, "STATUS");
+    setCenteredLine(1, message);
+    setCenteredLine(2, "");
+    setCenteredLine(3, "Press any key...");
     
     setMode(DisplayMode::STATUS_MESSAGE);
     messageTimeout = millis() + timeout;
 }
 
-void DisplayManager::showErrorMessage(const String& error, unsigned long timeout) {
-    line1Content = centerText("ERROR", 20);
-    line2Content = centerText(error.substring(0, 20), 20);
-    line3Content = "";
-    line4Content = centerText("Check system...", 20);
+void DisplayManager::showErrorMessage(const char* error, unsigned long timeout) {
+    setCenteredLine(0, "ERROR");
+    setCenteredLine(1, error);
+    setCenteredLine(2, "");
+    setCenteredLine(3, "Check system...");
     
     setMode(DisplayMode::ERROR_MESSAGE);
     messageTimeout = millis() + timeout;
 }
 
-void DisplayManager::showBootScreen(const String& deviceId) {
-    line1Content = centerText("TAVOLO SYSTEM v1.0", 20);
-    line2Content = centerText("by Codares", 20);
-    line3Content = centerText(deviceId.substring(0, 20), 20);
-    line4Content = centerText("Initializing...", 20);
+void DisplayManager::showBootScreen(const char* deviceId) {
+    setCenteredLine(0, "TAVOLO SYSTEM v1.0");
+    setCenteredLine(1, "by Codares");
+    setCenteredLine(2, deviceId);
+    setCenteredLine(3, "Initializing...");
     
     setMode(DisplayMode::BOOT);
+    
+    // setup() runs before the first update(), and the Calibrating/Tare messages queued
+    // during it would replace this screen before it was ever drawn: send it now
+    frameBuffer.flush(lcd);
+    lastUpdate = millis();
+    needsUpdate = false;
 }
 
 void DisplayManager::clear() {
     lcd.clear();
-    line1Content = "";
-    line2Content = "";
-    line3Content = "";
-    line4Content = "";
+    frameBuffer.markCleared();
+    frameBuffer.fill(' ');
+    weightScreenDirty = true;
     needsUpdate = true;
 }
 
@@ -105,53 +116,48 @@ void DisplayManager::setBrightness(bool on) {
 }
 
 void DisplayManager::updateDisplay() {
-    lcd.setCursor(0, 0);
-    lcd.print(line1Content);
-    
-    lcd.setCursor(0, 1);
-    lcd.print(line2Content);
-    
-    lcd.setCursor(0, 2);
-    lcd.print(line3Content);
+    if (currentMode == DisplayMode::WEIGHT_DISPLAY && weightScreenDirty) {
+        composeWeightScreen();
+    }
     
-    lcd.setCursor(0, 3);
-    lcd.print(line4Content);
+    frameBuffer.flush(lcd); // Sends nothing when the glass already matches
 }
 
-void DisplayManager::formatWeightDisplay(float weight, const String& status) {
-    line1Content = centerText("TAVOLO WEIGHT", 20);
-    line2Content = centerText(formatWeight(weight), 20);
-    line3Content = centerText("Status: " + status, 20);
+void DisplayManager::composeWeightScreen() {
+    char text[LcdFrameBuffer::MAX_COLS + 1];
     
-    // Show connection status on line 4
-    line4Content = centerText("Connected to Edge", 20);
-}
-
-String DisplayManager::centerText(const String& text, int width) {
-    if (text.length() >= width) {
-        return text.substring(0, width);
-    }
+    setCenteredLine(0, "TAVOLO WEIGHT");
     
-    int padding = (width - text.length()) / 2;
-    String result = "";
+    formatWeight(text, sizeof(text), weightValue);
+    setCenteredLine(1, text);
     
-    for (int i = 0; i < padding; i++) {
-        result += " ";
-    }
+    snprintf(text, sizeof(text), "Status: %s", weightStatus);
+    setCenteredLine(2, text);
     
-    result += text;
+    // Show connection status on line 4
+    setCenteredLine(3, "Connected to Edge");
     
-    while (result.length() < width) {
-        result += " ";
-    }
+    weightScreenDirty = false;
+    composeCount++;
+}
+
+void DisplayManager::setCenteredLine(uint8_t row, const char* text) {
+    char line[LcdFrameBuffer::MAX_COLS + 1];
+    uint8_t width = frameBuffer.getCols();
+    size_t length = strnlen(text, width);
+    size_t padding = (width - length) / 2;
+    
+    memset(line, ' ', padding);
+    memcpy(line + padding, text, length);
+    line[padding + length] = '\0';
     
-    return result;
+    frameBuffer.setLine(row, line); // Pads the right side
 }
 
-String DisplayManager::formatWeight(float weight) {
+void DisplayManager::formatWeight(char* buffer, size_t size, float weight) {
     if (weight < 1000) {
-        return String(weight, 1) + " g";
+        snprintf(buffer, size, "%.1f g", weight);
     } else {
-        return String(weight / 1000.0, 2) + " kg";
+        snprintf(buffer, size, "%.2f kg", weight / 1000.0);
     }
 }
@@ -4,6 +4,8 @@
 #include <Arduino.h>
 #include <Wire.h>
 #include <LiquidCrystal_I2C.h>
+#include "LcdFrameBuffer.h"
+#include "DeferredLog.h"
 
 /**
  * @brief Display Manager for LCD screen following Single Responsibility Principle
@@ -22,16 +24,19 @@ public:
 
 private:
     LiquidCrystal_I2C lcd;
+    LcdFrameBuffer frameBuffer; // Only changed cells reach the I2C bus
     DisplayMode currentMode = DisplayMode::BOOT;
     unsigned long lastUpdate = 0;
     unsigned long messageTimeout = 0;
     bool needsUpdate = true;
     
-    // Display content
-    String line1Content = "";
-    String line2Content = "";
-    String line3Content = "";
-    String line4Content = "";
+    // Weight screen inputs; the screen is only recomposed when they change
+    static const uint8_t MAX_STATUS_LENGTH = 12;
+    float weightValue = 0.0f;
+    char weightStatus[MAX_STATUS_LENGTH] = "";
+    bool weightScreenDirty = true;
+    uint32_t updateCount = 0;
+    uint32_t composeCount = 0;
     
     // Constants
     static const unsigned long UPDATE_INTERVAL = 200; // 5 Hz refresh rate
@@ -46,22 +51,26 @@ public:
     // Display control
     void setMode(DisplayMode mode);
     DisplayMode getMode() const { return currentMode; }
+    static const char* modeToString(DisplayMode mode);
     
     // Content management
-    void showWeightData(float weight, const String& status);
-    void showStatusMessage(const String& message, unsigned long timeout = DEFAULT_MESSAGE_TIMEOUT);
-    void showErrorMessage(const String& error, unsigned long timeout = DEFAULT_MESSAGE_TIMEOUT);
-    void showBootScreen(const String& deviceId);
+    void showWeightData(float weight, const char* status);
+    void showStatusMessage(const char* message, unsigned long timeout = DEFAULT_MESSAGE_TIMEOUT);
+    void showErrorMessage(const char* error, unsigned long timeout = DEFAULT_MESSAGE_TIMEOUT);
+    void showBootScreen(const char* deviceId);
     
     // Utility methods
     void clear();
     void setBrightness(bool on);
+    const LcdFrameBuffer& getFrameBuffer() const { return frameBuffer; }
+    uint32_t getUpdateCount() const { return updateCount; }
+    uint32_t getComposeCount() const { return composeCount; }
     
 private:
     void updateDisplay();
-    void formatWeightDisplay(float weight, const String& status);
-    String centerText(const String& text, int width);
-    String formatWeight(float weight);
+    void composeWeightScreen();
+    void setCenteredLine(uint8_t row, const char* text);
+    static void formatWeight(char* buffer, size_t size, float weight);
 };
 
 #endif // DISPLAY_MANAGER_H
@@ -4,7 +4,7 @@
 EdgeCommunication* EdgeCommunication::instance = nullptr;
 
 EdgeCommunication::EdgeCommunication(const String& deviceId) 
-    : mqttClient(wifiClient), deviceId(deviceId) {
+    : mqttClient(transport), deviceId(deviceId) {
     instance = this;
     clientId = "tavolo_" + deviceId;
     setupTopics();
@@ -15,6 +15,9 @@ void EdgeCommunication::begin() {
     
     mqttClient.setServer(mqttServer.c_str(), mqttPort);
     mqttClient.setCallback(mqttCallback);
+    mqttClient.setBufferSize(MAX_BATCH_BYTES + 128); // Batch payload plus topic and MQTT header
+    mqttClient.setKeepAlive(KEEP_ALIVE_SECONDS);     // Must match the CONNECT we send ourselves
+    mqttClient.setSocketTimeout(1);                  // Bounds a partial packet read in loop()
     
     Serial.print("MQTT Server: ");
     Serial.print(mqttServer);
@@ -27,10 +30,25 @@ void EdgeCommunication::begin() {
 }
 
 void EdgeCommunication::update() {
+    unsigned long startMicros = micros();
     unsigned long currentTime = millis();
     
-    // Handle MQTT loop
-    if (mqttClient.connected()) {
+    if (offlineQueue) {
+        offlineQueue->update();
+    }
+    
+    if (connectPhase != ConnectPhase::ONLINE) {
+        stepConnection(currentTime);
+    } else if (!mqttClient.connected()) {
+        TAVOLO_LOG_WARN(LOG_EDGE, "MQTT connection lost");
+        spillBatchOffline();
+        setConnectionState(ConnectionState::DISCONNECTED);
+        transport.abort();
+        failedAttempts = 0;
+        enterPhase(ConnectPhase::BACKOFF, currentTime);
+        nextAttemptTime = currentTime; // First reconnect is immediate, then back off
+    } else {
+        // Handle MQTT loop
         mqttClient.loop();
         
         // Send heartbeat periodically
@@ -38,57 +56,227 @@ void EdgeCommunication::update() {
             sendHeartbeat();
             lastHeartbeat = currentTime;
         }
-    } else {
-        setConnectionState(ConnectionState::DISCONNECTED);
         
-        // Attempt reconnection
-        if (currentTime - lastConnectionAttempt >= RECONNECT_INTERVAL) {
-            Serial.println("Attempting to reconnect to MQTT...");
-            connect();
-            lastConnectionAttempt = currentTime;
+        // Flush a weight batch that has been open for too long
+        if (batchCount > 0 && currentTime - batchStartTime >= batchConfig.maxAgeMs) {
+            flushWeightBatch();
+        }
+        
+        // Forward stored backlog without starving live traffic; skipped when this
+        // pass already used half of its budget
+        if (offlineQueue && !offlineQueue->isEmpty() &&
+            currentTime - lastDrainTime >= DRAIN_INTERVAL &&
+            micros() - startMicros < updateBudgetUs / 2) {
+            drainOfflineQueue();
+            lastDrainTime = currentTime;
         }
     }
+    
+    unsigned long elapsed = micros() - startMicros;
+    if (elapsed > maxUpdateUs) {
+        maxUpdateUs = elapsed;
+    }
+    if (elapsed > updateBudgetUs) {
+        budgetOverruns++;
+    }
 }
 
 bool EdgeCommunication::connect() {
     if (WiFi.status() != WL_CONNECTED) {
-        Serial.println("WiFi not connected, cannot connect to MQTT");
+        TAVOLO_LOG_WARN(LOG_EDGE, "WiFi not connected, cannot connect to MQTT");
         setConnectionState(ConnectionState::ERROR);
         return false;
     }
     
-    setConnectionState(ConnectionState::CONNECTING);
-    Serial.print("Connecting to MQTT broker: ");
-    Serial.println(mqttServer);
+    // Start an attempt on the next update() regardless of the backoff timer
+    if (connectPhase == ConnectPhase::BACKOFF) {
+        nextAttemptTime = millis();
+    }
+    return true;
+}
+
+void EdgeCommunication::stepConnection(unsigned long currentTime) {
+    unsigned long elapsed = currentTime - phaseStartTime;
     
-    if (mqttClient.connect(clientId.c_str())) {
-        Serial.println("Connected to MQTT broker");
-        
-        // Subscribe to command topic
-        if (mqttClient.subscribe(commandTopic.c_str())) {
-            Serial.print("Subscribed to: ");
-            Serial.println(commandTopic);
+    switch (connectPhase) {
+        case ConnectPhase::BACKOFF:
+            if ((long)(currentTime - nextAttemptTime) < 0) {
+                break;
+            }
+            if (WiFi.status() != WL_CONNECTED) {
+                failConnection("WiFi not connected");
+                break;
+            }
+            setConnectionState(ConnectionState::CONNECTING);
+            TAVOLO_LOG_INFO(LOG_EDGE, "Connecting to MQTT broker: %s", mqttServer.c_str());
+            if (!transport.beginResolve(mqttServer.c_str())) {
+                failConnection("DNS lookup could not start");
+                break;
+            }
+            enterPhase(ConnectPhase::RESOLVING, currentTime);
+            break;
+            
+        case ConnectPhase::RESOLVING: {
+            MqttTransport::Progress progress = transport.pollResolve();
+            if (progress == MqttTransport::Progress::FAILED) {
+                failConnection("DNS lookup failed");
+            } else if (progress == MqttTransport::Progress::DONE) {
+                if (transport.beginConnect(mqttPort)) {
+                    enterPhase(ConnectPhase::TCP_CONNECTING, currentTime);
+                } else {
+                    failConnection("TCP connect could not start");
+                }
+            } else if (elapsed >= DNS_TIMEOUT) {
+                failConnection("DNS timeout");
+            }
+            break;
         }
-        
-        setConnectionState(ConnectionState::CONNECTED);
-        
-        // Send initial status
-        sendStatusUpdate("CONNECTED");
-        
-        return true;
-    } else {
-        Serial.print("Failed to connect to MQTT. State: ");
-        Serial.println(mqttClient.state());
-        setConnectionState(ConnectionState::ERROR);
-        return false;
+            
+        case ConnectPhase::TCP_CONNECTING: {
+            MqttTransport::Progress progress = transport.pollConnect();
+            if (progress == MqttTransport::Progress::FAILED) {
+                failConnection("TCP connect failed");
+            } else if (progress == MqttTransport::Progress::DONE) {
+                if (transport.sendConnect(clientId.c_str(), KEEP_ALIVE_SECONDS)) {
+                    enterPhase(ConnectPhase::AWAIT_CONNACK, currentTime);
+                } else {
+                    failConnection("CONNECT write failed");
+                }
+            } else if (elapsed >= TCP_TIMEOUT) {
+                failConnection("TCP connect timeout");
+            }
+            break;
+        }
+            
+        case ConnectPhase::AWAIT_CONNACK: {
+            MqttTransport::Progress progress = transport.pollConnAck();
+            if (progress == MqttTransport::Progress::FAILED) {
+                if (transport.getConnAckCode() != 0) {
+                    TAVOLO_LOG_WARN(LOG_EDGE, "Broker refused connection. Return code: %d",
+                                    (int)transport.getConnAckCode());
+                    failConnection("CONNACK refused");
+                } else {
+                    failConnection("Malformed CONNACK");
+                }
+            } else if (progress == MqttTransport::Progress::DONE) {
+                // Validated CONNACK is replayed, so PubSubClient's handshake returns at once
+                transport.expectConnectWrite();
+                if (!topicsValid) {
+                    failConnection("No valid command topic");
+                } else if (mqttClient.connect(clientId.c_str())) {
+                    TAVOLO_LOG_INFO(LOG_EDGE, "Connected to MQTT broker");
+                    mqttClient.subscribe(commandTopic);
+                    enterPhase(ConnectPhase::AWAIT_SUBACK, currentTime);
+                } else {
+                    TAVOLO_LOG_WARN(LOG_EDGE, "Broker refused connection. State: %d", mqttClient.state());
+                    failConnection("CONNACK refused");
+                }
+            } else if (!transport.connected()) {
+                failConnection("Connection closed before CONNACK");
+            } else if (elapsed >= CONNACK_TIMEOUT) {
+                failConnection("CONNACK timeout");
+            }
+            break;
+        }
+            
+        case ConnectPhase::AWAIT_SUBACK:
+            mqttClient.loop();
+            if (transport.hasSubAck()) {
+                if (transport.subAckGranted()) {
+                    TAVOLO_LOG_INFO(LOG_EDGE, "Subscribed to: %s", commandTopic);
+                    onConnectionEstablished();
+                } else {
+                    failConnection("Subscription rejected");
+                }
+            } else if (!mqttClient.connected()) {
+                failConnection("Connection closed before SUBACK");
+            } else if (elapsed >= SUBACK_TIMEOUT) {
+                failConnection("SUBACK timeout");
+            }
+            break;
+            
+        case ConnectPhase::ONLINE:
+            break;
+    }
+}
+
+void EdgeCommunication::enterPhase(ConnectPhase phase, unsigned long currentTime) {
+    connectPhase = phase;
+    phaseStartTime = currentTime;
+}
+
+void EdgeCommunication::failConnection(const char* reason) {
+    TAVOLO_LOG_WARN(LOG_EDGE, "MQTT connection attempt failed (%s): %s", phaseToString(connectPhase), reason);
+    
+    transport.abort();
+    
+    // Exponential backoff with equal jitter so a fleet does not reconnect in lockstep
+    uint8_t exponent = failedAttempts < 16 ? failedAttempts : 16;
+    unsigned long delayMs = backoffBase << exponent;
+    if (delayMs > backoffMax || delayMs < backoffBase) {
+        delayMs = backoffMax;
+    }
+    delayMs = delayMs / 2 + random(delayMs / 2 + 1);
+    if (failedAttempts < 255) {
+        failedAttempts++;
+    }
+    
+    unsigned long currentTime = millis();
+    enterPhase(ConnectPhase::BACKOFF, currentTime);
+    nextAttemptTime = currentTime + delayMs;
+    
+    TAVOLO_LOG_INFO(LOG_EDGE, "Next MQTT attempt in %lu ms", delayMs);
+    
+    setConnectionState(ConnectionState::ERROR);
+}
+
+void EdgeCommunication::onConnectionEstablished() {
+    failedAttempts = 0;
+    enterPhase(ConnectPhase::ONLINE, millis());
+    setConnectionState(ConnectionState::CONNECTED);
+    
+    // Send initial status
+    sendStatusUpdate("CONNECTED");
+}
+
+void EdgeCommunication::setReconnectBackoff(unsigned long baseMs, unsigned long maxMs) {
+    backoffBase = baseMs > 0 ? baseMs : 1;
+    backoffMax = maxMs > backoffBase ? maxMs : backoffBase;
+}
+
+const char* EdgeCommunication::phaseToString(ConnectPhase phase) const {
+    switch (phase) {
+        case ConnectPhase::BACKOFF: return "BACKOFF";
+        case ConnectPhase::RESOLVING: return "RESOLVING";
+        case ConnectPhase::TCP_CONNECTING: return "TCP_CONNECTING";
+        case ConnectPhase::AWAIT_CONNACK: return "AWAIT_CONNACK";
+        case ConnectPhase::AWAIT_SUBACK: return "AWAIT_SUBACK";
+        case ConnectPhase::ONLINE: return "ONLINE";
+        default: return "UNKNOWN";
+    }
+}
+
+const char* EdgeCommunication::connectionStateToString(ConnectionState state) {
+    switch (state) {
+        case ConnectionState::DISCONNECTED: return "DISCONNECTED";
+        case ConnectionState::CONNECTING: return "CONNECTING";
+        case ConnectionState::CONNECTED: return "CONNECTED";
+        case ConnectionState::ERROR: return "ERROR";
+        default: return "UNKNOWN";
     }
 }
 
 void EdgeCommunication::disconnect() {
+    flushWeightBatch(); // Published while still online, otherwise queued offline
     if (mqttClient.connected()) {
         sendStatusUpdate("DISCONNECTING");
         mqttClient.disconnect();
     }
+    transport.abort();
+    
+    // Reconnect through the normal backoff path
+    enterPhase(ConnectPhase::BACKOFF, millis());
+    nextAttemptTime = millis() + backoffBase;
     setConnectionState(ConnectionState::DISCONNECTED);
 }
 
@@ -97,56 +285,291 @@ bool EdgeCommunication::isConnected() {
 }
 
 bool EdgeCommunication::sendWeightData(const WeightData& data) {
+    bool connected = isConnected();
+    bool success = false;
+    
+    if (!connected) {
+        // Stored below
+    } else if (payloadFormat == PayloadFormat::BINARY) {
+        uint8_t buffer[BinaryPayload::WEIGHT_SIZE];
+        size_t length = BinaryPayload::encodeWeight(buffer, sizeof(buffer), data.timestamp, data.weight);
+        success = publish(weightTopic, buffer, length);
+    } else {
+        StaticJsonDocument<256> doc;
+        doc["deviceId"] = deviceId.c_str();
+        doc["weight"] = data.weight;
+        doc["timestamp"] = data.timestamp;
+        doc["type"] = "weight_data";
+        
+        success = publishJson(weightTopic, doc);
+    }
+    
+    if (!success) {
+        OfflineQueue::Record record = {};
+        record.kind = OfflineQueue::WEIGHT_SAMPLE;
+        record.timestamp = data.timestamp;
+        record.value = data.weight;
+        if (!storeOffline(record)) {
+            TAVOLO_LOG_WARN(LOG_EDGE, "Cannot send weight data: %s", connected ? "publish failed" : "not connected");
+        }
+    }
+    
+    return success;
+}
+
+bool EdgeCommunication::queueWeightData(const WeightData& data) {
+    if (!isfinite(data.weight)) {
+        TAVOLO_LOG_WARN(LOG_EDGE, "Weight sample at %lu is not finite, dropped", data.timestamp);
+        return false;
+    }
+    
+    if (!batchConfig.enabled || !isConnected()) {
+        return sendWeightData(data); // Goes to the offline queue when disconnected
+    }
+    
+    // Samples are encoded as [offsetMs,weight] relative to the batch base timestamp
+    unsigned long baseTimestamp = batchCount > 0 ? batchBaseTimestamp : data.timestamp;
+    char sample[32];
+    int sampleLength = snprintf(sample, sizeof(sample), "%s[%lu,%.2f]",
+                                batchCount > 0 ? "," : "",
+                                data.timestamp - baseTimestamp, data.weight);
+    if (sampleLength < 0 || sampleLength >= (int)sizeof(sample)) {
+        TAVOLO_LOG_WARN(LOG_EDGE, "Weight sample at %lu does not fit a batch entry, sent alone", data.timestamp);
+        return sendWeightData(data);
+    }
+    
+    // Leave room for the closing "]}" when checking the byte budget
+    if (batchCount > 0 && batchLength + sampleLength + 2 > batchConfig.maxBytes) {
+        flushWeightBatch();
+        return queueWeightData(data);
+    }
+    
+    if (batchCount == 0 && (!startBatch(data.timestamp) || batchLength + sampleLength + 2 > batchConfig.maxBytes)) {
+        TAVOLO_LOG_WARN(LOG_EDGE, "Batch header leaves no room for a sample, sent alone");
+        batchLength = 0;
+        return sendWeightData(data);
+    }
+    
+    memcpy(batchBuffer + batchLength, sample, sampleLength);
+    batchLength += sampleLength;
+    batchSamples[batchCount++] = data;
+    
+    if (batchCount >= batchConfig.maxSamples) {
+        return flushWeightBatch();
+    }
+    
+    return true;
+}
+
+bool EdgeCommunication::flushWeightBatch() {
+    if (batchCount == 0) {
+        return true;
+    }
+    
     if (!isConnected()) {
-        Serial.println("Cannot send weight data: not connected");
+        spillBatchOffline();
         return false;
     }
     
-    StaticJsonDocument<256> doc;
-    doc["deviceId"] = data.deviceId;
-    doc["weight"] = data.weight;
-    doc["timestamp"] = data.timestamp;
-    doc["type"] = "weight_data";
+    batchBuffer[batchLength] = ']';
+    batchBuffer[batchLength + 1] = '}';
+    batchBuffer[batchLength + 2] = '\0';
+    if (!publish(weightTopic, (const uint8_t*)batchBuffer, batchLength + 2)) {
+        spillBatchOffline();
+        return false;
+    }
     
-    String payload;
-    serializeJson(doc, payload);
+    batchCount = 0;
+    batchLength = 0;
+    return true;
+}
+
+void EdgeCommunication::spillBatchOffline() {
+    if (batchCount == 0) return;
     
-    bool success = mqttClient.publish(weightTopic.c_str(), payload.c_str());
+    uint16_t stored = 0;
+    uint16_t dropped = 0;
+    for (uint16_t i = 0; i < batchCount; i++) {
+        OfflineQueue::Record record = {};
+        record.kind = OfflineQueue::WEIGHT_SAMPLE;
+        record.timestamp = batchSamples[i].timestamp;
+        record.value = batchSamples[i].weight;
+        if (storeOffline(record)) {
+            stored++;
+        } else {
+            dropped++;
+        }
+    }
     
-    if (success) {
-        Serial.print("Weight data sent: ");
-        Serial.print(data.weight);
-        Serial.println("g");
+    if (dropped > 0) {
+        TAVOLO_LOG_WARN(LOG_EDGE, "Weight batch not sent: %u samples queued offline, %u dropped", stored, dropped);
     } else {
-        Serial.println("Failed to send weight data");
+        TAVOLO_LOG_INFO(LOG_EDGE, "Weight batch not sent: %u samples queued offline", stored);
+    }
+    batchCount = 0;
+    batchLength = 0;
+}
+
+bool EdgeCommunication::startBatch(unsigned long baseTimestamp) {
+    int headerLength = snprintf(batchBuffer, sizeof(batchBuffer),
+                                "{\"deviceId\":\"%s\",\"type\":\"weight_batch\",\"baseTimestamp\":%lu,\"samples\":[",
+                                deviceId.c_str(), baseTimestamp);
+    if (headerLength < 0 || headerLength >= (int)sizeof(batchBuffer)) {
+        return false; // snprintf reports the length it wanted, not what it wrote
+    }
+    batchBaseTimestamp = baseTimestamp;
+    batchStartTime = millis();
+    batchLength = headerLength;
+    return true;
+}
+
+bool EdgeCommunication::sendWeightEvent(const WeightEvent& event) {
+    bool connected = isConnected();
+    bool success = false;
+    
+    if (connected) {
+        StaticJsonDocument<256> doc;
+        doc["deviceId"] = deviceId.c_str();
+        doc["event"] = event.event;
+        doc["weight"] = event.weight;
+        doc["delta"] = event.delta;
+        doc["settleTime"] = event.settleTime;
+        doc["timestamp"] = event.timestamp;
+        doc["type"] = "weight_event";
+        
+        success = publishJson(weightTopic, doc);
+    }
+    
+    if (!success) {
+        OfflineQueue::Record record = {};
+        record.kind = OfflineQueue::LOAD_EVENT;
+        record.eventType = event.eventCode;
+        record.timestamp = event.timestamp;
+        record.value = event.weight;
+        record.delta = event.delta;
+        record.settleTime = event.settleTime;
+        if (!storeOffline(record)) {
+            TAVOLO_LOG_WARN(LOG_EDGE, "Cannot send weight event: %s", connected ? "publish failed" : "not connected");
+        }
     }
     
     return success;
 }
 
-bool EdgeCommunication::sendStatusUpdate(const String& status) {
+bool EdgeCommunication::sendWeightSummary(const WindowAggregator::Summary& summary) {
+    if (!isConnected()) {
+        return false; // The next window describes the table again once reconnected
+    }
+    
+    StaticJsonDocument<384> doc;
+    doc["deviceId"] = deviceId.c_str();
+    doc["type"] = "weight_summary";
+    doc["window"] = summary.hopMs == summary.windowMs ? "tumbling" : "sliding";
+    doc["windowMs"] = summary.windowMs;
+    doc["hopMs"] = summary.hopMs;
+    doc["count"] = summary.count;
+    doc["min"] = summary.min;
+    doc["max"] = summary.max;
+    doc["mean"] = summary.mean;
+    doc["variance"] = summary.variance;
+    doc["aboveThresholdMs"] = summary.aboveMs;
+    doc["timestamp"] = summary.timestamp;
+    
+    return publishJson(weightTopic, doc);
+}
+
+bool EdgeCommunication::sendStatusUpdate(const char* status) {
     if (!isConnected()) {
         return false;
     }
     
+    if (payloadFormat == PayloadFormat::BINARY) {
+        uint8_t buffer[BinaryPayload::MAX_MESSAGE_SIZE];
+        size_t length = BinaryPayload::encodeStatus(buffer, sizeof(buffer), millis(), status);
+        return publish(statusTopic, buffer, length);
+    }
+    
     StaticJsonDocument<256> doc;
-    doc["deviceId"] = deviceId;
+    doc["deviceId"] = deviceId.c_str();
     doc["status"] = status;
     doc["timestamp"] = millis();
     doc["type"] = "status_update";
+    doc["formats"] = "json,bin1"; // Advertised so the edge can request SET_FORMAT
+    
+    return publishJson(statusTopic, doc);
+}
+
+bool EdgeCommunication::sendFlightLog() {
+    if (!isConnected()) {
+        return false;
+    }
+    
+    // Records written while uploading (our own publishes) are left for the next upload
+    uint32_t sequence = FlightRecorder::getOldestSequence();
+    uint32_t end = FlightRecorder::getSequence();
+    FlightLog::Record records[FLIGHT_LOG_CHUNK_RECORDS];
+    uint8_t buffer[FlightLog::CHUNK_HEADER_SIZE + FLIGHT_LOG_CHUNK_RECORDS * FlightLog::RECORD_SIZE];
+    uint16_t chunks = 0;
     
-    String payload;
-    serializeJson(doc, payload);
+    while (sequence < end) {
+        size_t wanted = end - sequence < FLIGHT_LOG_CHUNK_RECORDS ? end - sequence : FLIGHT_LOG_CHUNK_RECORDS;
+        FlightLog::ChunkHeader header;
+        header.version = FlightLog::VERSION;
+        header.count = (uint8_t)FlightRecorder::read(sequence, records, wanted);
+        header.bootCount = FlightRecorder::getBootCount();
+        header.firstSequence = sequence;
+        if (header.count == 0) break;
+        
+        size_t length = FlightLog::encodeChunk(buffer, sizeof(buffer), header, records);
+        if (!publish(flightLogTopic, buffer, length)) {
+            return false;
+        }
+        sequence += header.count;
+        chunks++;
+    }
     
-    return mqttClient.publish(statusTopic.c_str(), payload.c_str());
+    TAVOLO_LOG_INFO(LOG_EDGE, "Flight log uploaded: %u chunks", chunks);
+    return true;
 }
 
-void EdgeCommunication::setOnCommandCallback(std::function<void(const EdgeCommand&)> callback) {
-    onCommandCallback = callback;
+bool EdgeCommunication::sendTraceChunk(const uint8_t* chunk, size_t length) {
+    if (!isConnected()) {
+        return false; // Debug traces are not worth offline storage
+    }
+    return publish(traceTopic, chunk, length);
+}
+
+#if TAVOLO_PROFILING
+bool EdgeCommunication::sendLatencyReport(const char* section, const LatencyHistogram& histogram) {
+    if (!isConnected()) {
+        return false; // Diagnostics are not worth offline storage
+    }
+    
+    // JSON in both payload formats; the edge tells them apart by the first byte
+    StaticJsonDocument<256> doc;
+    doc["deviceId"] = deviceId.c_str();
+    doc["type"] = "latency";
+    doc["section"] = section;
+    doc["count"] = histogram.getCount();
+    doc["meanUs"] = histogram.getMean();
+    doc["p50Us"] = histogram.percentile(50);
+    doc["p90Us"] = histogram.percentile(90);
+    doc["p99Us"] = histogram.percentile(99);
+    doc["maxUs"] = histogram.getMax();
+    doc["timestamp"] = millis();
+    
+    return publishJson(statusTopic, doc);
+}
+#endif
+
+void EdgeCommunication::setOnCommandCallback(CommandHandler handler, void* context) {
+    onCommandCallback = handler;
+    onCommandContext = context;
 }
 
-void EdgeCommunication::setOnConnectionStateCallback(std::function<void(ConnectionState)> callback) {
-    onConnectionStateCallback = callback;
+void EdgeCommunication::setOnConnectionStateCallback(ConnectionStateHandler handler, void* context) {
+    onConnectionStateCallback = handler;
+    onConnectionStateContext = context;
 }
 
 void EdgeCommunication::setMqttServer(const String& server, int port) {
@@ -155,88 +578,224 @@ void EdgeCommunication::setMqttServer(const String& server, int port) {
     mqttClient.setServer(server.c_str(), port);
 }
 
+bool EdgeCommunication::storeOffline(const OfflineQueue::Record& record) {
+    return offlineQueue && offlineQueue->push(record);
+}
+
+void EdgeCommunication::drainOfflineQueue() {
+    OfflineQueue::Record records[DRAIN_BURST];
+    size_t count = offlineQueue->peek(records, DRAIN_BURST);
+    if (count == 0) return;
+    
+    // Samples are [timestamp,weight]; events are [timestamp,weight,eventCode,delta,settleTime]
+    int length = snprintf(drainBuffer, sizeof(drainBuffer),
+                          "{\"deviceId\":\"%s\",\"type\":\"weight_backlog\",\"now\":%lu,\"records\":[",
+                          deviceId.c_str(), millis());
+    if (length < 0 || length >= (int)sizeof(drainBuffer)) {
+        return;
+    }
+    
+    size_t consumed = 0; // Leading records this message accounts for, sent or dropped
+    size_t appended = 0;
+    for (size_t i = 0; i < count; i++) {
+        const OfflineQueue::Record& record = records[i];
+        if (!OfflineQueue::isValid(record)) { // Torn or corrupted write
+            consumed = i + 1;
+            continue;
+        }
+        
+        // Two %.2f of FLT_MAX are 43 characters each: an event takes at most 115
+        char entry[128];
+        int entryLength;
+        if (record.kind == OfflineQueue::LOAD_EVENT) {
+            entryLength = snprintf(entry, sizeof(entry), "%s[%lu,%.2f,%u,%.2f,%lu]", appended == 0 ? "" : ",",
+                                   (unsigned long)record.timestamp, record.value, record.eventType,
+                                   record.delta, (unsigned long)record.settleTime);
+        } else {
+            entryLength = snprintf(entry, sizeof(entry), "%s[%lu,%.2f]", appended == 0 ? "" : ",",
+                                   (unsigned long)record.timestamp, record.value);
+        }
+        
+        // A record that does not fit an empty message never will: drop it rather than stall
+        bool fitsEntry = entryLength >= 0 && entryLength < (int)sizeof(entry);
+        if (!fitsEntry || (appended == 0 && length + entryLength + 2 >= (int)sizeof(drainBuffer))) {
+            TAVOLO_LOG_WARN(LOG_EDGE, "Offline record at %lu does not fit a backlog message, dropped",
+                            (unsigned long)record.timestamp);
+            consumed = i + 1;
+            continue;
+        }
+        if (length + entryLength + 2 >= (int)sizeof(drainBuffer)) {
+            break; // Send what fits, the rest goes out in the next message
+        }
+        memcpy(drainBuffer + length, entry, entryLength);
+        length += entryLength;
+        appended++;
+        consumed = i + 1;
+    }
+    
+    if (appended == 0) {
+        offlineQueue->pop(consumed); // Nothing sendable: discard what was skipped, publish nothing
+        return;
+    }
+    
+    drainBuffer[length++] = ']';
+    drainBuffer[length++] = '}';
+    drainBuffer[length] = '\0';
+    
+    // Records are only discarded once the broker accepted them
+    if (publish(weightTopic, (const uint8_t*)drainBuffer, length)) {
+        offlineQueue->pop(consumed);
+    }
+}
+
+void EdgeCommunication::setBatchConfig(const BatchConfig& config) {
+    flushWeightBatch();
+    
+    batchConfig = config;
+    if (batchConfig.maxBytes > MAX_BATCH_BYTES - 1) {
+        batchConfig.maxBytes = MAX_BATCH_BYTES - 1;
+    }
+    if (batchConfig.maxBytes < 128) {
+        batchConfig.maxBytes = 128; // Header plus at least one sample
+    }
+    if (batchConfig.maxSamples == 0) {
+        batchConfig.maxSamples = 1;
+    }
+    if (batchConfig.maxSamples > MAX_BATCH_SAMPLES) {
+        batchConfig.maxSamples = MAX_BATCH_SAMPLES;
+    }
+}
+
+void EdgeCommunication::setPayloadFormat(PayloadFormat format) {
+    if (payloadFormat != format) {
+        payloadFormat = format;
+        TAVOLO_LOG_INFO(LOG_EDGE, "Payload format changed to: %s", format == PayloadFormat::BINARY ? "BINARY" : "JSON");
+    }
+}
+
 void EdgeCommunication::setupTopics() {
-    String baseTopicName = deviceId;
-    baseTopicName.replace(":", "_"); // Replace colons with underscores for topic compatibility
+    char baseTopicName[MAX_TOPIC_LENGTH - TOPIC_FRAME_LENGTH];
+    bool nameFits = strlcpy(baseTopicName, deviceId.c_str(), sizeof(baseTopicName)) < sizeof(baseTopicName);
+    for (char* c = baseTopicName; *c; c++) {
+        if (*c == ':') *c = '_'; // Replace colons with underscores for topic compatibility
+    }
     
-    weightTopic = "tavolo/" + baseTopicName + "/weight";
-    commandTopic = "tavolo/" + baseTopicName + "/command";
-    statusTopic = "tavolo/" + baseTopicName + "/status";
+    // A cut device id or topic would address another device's topics
+    topicsValid = nameFits &&
+                  buildTopic(weightTopic, baseTopicName, "weight") &&
+                  buildTopic(commandTopic, baseTopicName, "command") &&
+                  buildTopic(statusTopic, baseTopicName, "status") &&
+                  buildTopic(flightLogTopic, baseTopicName, "flightlog") &&
+                  buildTopic(traceTopic, baseTopicName, "trace");
+    if (!topicsValid) {
+        TAVOLO_LOG_ERROR(LOG_EDGE, "Device id %s is too long for MQTT topics; publishing disabled",
+                         deviceId.c_str());
+    }
     
     Serial.println("MQTT Topics configured:");
-    Serial.println("Weight: " + weightTopic);
-    Serial.println("Command: " + commandTopic);
-    Serial.println("Status: " + statusTopic);
+    Serial.print("Weight: ");
+    Serial.println(weightTopic);
+    Serial.print("Command: ");
+    Serial.println(commandTopic);
+    Serial.print("Status: ");
+    Serial.println(statusTopic);
+    Serial.print("Flight log: ");
+    Serial.println(flightLogTopic);
+    Serial.print("Trace: ");
+    Serial.println(traceTopic);
+}
+
+bool EdgeCommunication::buildTopic(char* topic, const char* deviceName, const char* suffix) {
+    int length = snprintf(topic, MAX_TOPIC_LENGTH, "tavolo/%s/%s", deviceName, suffix);
+    return length >= 0 && length < MAX_TOPIC_LENGTH;
 }
 
 void EdgeCommunication::onMqttMessage(char* topic, byte* payload, unsigned int length) {
-    // Convert payload to string
-    String message;
-    for (unsigned int i = 0; i < length; i++) {
-        message += (char)payload[i];
-    }
-    
-    Serial.print("Received MQTT message on topic: ");
-    Serial.println(topic);
-    Serial.print("Message: ");
-    Serial.println(message);
+    unsigned long startMicros = micros();
     
-    // Parse JSON command
+    // Zero-copy parse: strings are unescaped in place inside PubSubClient's buffer
     StaticJsonDocument<256> doc;
-    DeserializationError error = deserializeJson(doc, message);
+    DeserializationError error = deserializeJson(doc, (char*)payload, length);
     
     if (error) {
-        Serial.print("Failed to parse JSON: ");
-        Serial.println(error.c_str());
+        TAVOLO_LOG_WARN(LOG_EDGE, "Failed to parse JSON command: %s", error.c_str());
         return;
     }
     
+    // Numeric values are accepted too and formatted for the command's own decoder
+    char numberText[24];
+    JsonVariant value = doc["value"];
+    const char* valueText = value.as<const char*>();
+    if (!valueText) {
+        valueText = "";
+        if (!value.isNull() && serializeJson(value, numberText, sizeof(numberText)) < sizeof(numberText)) {
+            valueText = numberText;
+        }
+    }
+    
     EdgeCommand command;
-    command.command = doc["command"].as<String>();
-    command.value = doc["value"].as<String>();
+    command.command = doc["command"] | "";
+    command.value = valueText;
     command.timestamp = doc["timestamp"] | millis();
+    command.parseMicros = micros() - startMicros;
     
     if (onCommandCallback) {
-        onCommandCallback(command);
+        onCommandCallback(onCommandContext, command);
     }
 }
 
 void EdgeCommunication::setConnectionState(ConnectionState newState) {
     if (currentState != newState) {
         currentState = newState;
+        FlightRecorder::record(FlightLog::CONNECTION_STATE, (uint8_t)newState);
         
-        Serial.print("Edge connection state changed to: ");
-        switch (newState) {
-            case ConnectionState::DISCONNECTED:
-                Serial.println("DISCONNECTED");
-                break;
-            case ConnectionState::CONNECTING:
-                Serial.println("CONNECTING");
-                break;
-            case ConnectionState::CONNECTED:
-                Serial.println("CONNECTED");
-                break;
-            case ConnectionState::ERROR:
-                Serial.println("ERROR");
-                break;
-        }
+        TAVOLO_LOG_INFO(LOG_EDGE, "Edge connection state changed to: %s", connectionStateToString(newState));
         
         if (onConnectionStateCallback) {
-            onConnectionStateCallback(newState);
+            onConnectionStateCallback(onConnectionStateContext, newState);
         }
     }
 }
 
 void EdgeCommunication::sendHeartbeat() {
+    if (payloadFormat == PayloadFormat::BINARY) {
+        uint8_t buffer[BinaryPayload::HEARTBEAT_SIZE];
+        size_t length = BinaryPayload::encodeHeartbeat(buffer, sizeof(buffer), millis());
+        publish(statusTopic, buffer, length);
+        return;
+    }
+    
     StaticJsonDocument<128> doc;
-    doc["deviceId"] = deviceId;
+    doc["deviceId"] = deviceId.c_str();
     doc["type"] = "heartbeat";
     doc["timestamp"] = millis();
     
-    String payload;
-    serializeJson(doc, payload);
-    
-    mqttClient.publish(statusTopic.c_str(), payload.c_str());
+    publishJson(statusTopic, doc);
+}
+
+bool EdgeCommunication::publish(const char* topic, const uint8_t* payload, size_t length) {
+    // PubSubClient copies into its preallocated packet buffer; nothing is allocated here
+    if (topicsValid && mqttClient.publish(topic, payload, length)) {
+        publishedCount++;
+        FlightRecorder::record(FlightLog::PUBLISH, 1, length > UINT16_MAX ? UINT16_MAX : length);
+        return true;
+    }
+    publishFailureCount++;
+    FlightRecorder::record(FlightLog::PUBLISH, 0, length > UINT16_MAX ? UINT16_MAX : length);
+    return false;
+}
+
+bool EdgeCommunication::publishJson(const char* topic, const JsonDocument& doc) {
+    // serializeJson() truncates silently, and truncated output would be invalid JSON
+    size_t needed = measureJson(doc);
+    if (needed == 0 || needed >= sizeof(messageBuffer)) {
+        TAVOLO_LOG_ERROR(LOG_EDGE, "JSON message for %s needs %u bytes, buffer holds %u",
+                         topic, (unsigned)needed, (unsigned)sizeof(messageBuffer) - 1);
+        publishFailureCount++;
+        return false;
+    }
+    size_t length = serializeJson(doc, messageBuffer, sizeof(messageBuffer));
+    return publish(topic, (const uint8_t*)messageBuffer, length);
 }
 
 // Static callback wrapper
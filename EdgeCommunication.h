@@ -5,7 +5,13 @@
 #include <WiFi.h>
 #include <ArduinoJson.h>
 #include <PubSubClient.h>
-#include <functional>
+#include "BinaryPayload.h"
+#include "OfflineQueue.h"
+#include "MqttTransport.h"
+#include "LatencyHistogram.h"
+#include "FlightRecorder.h"
+#include "DeferredLog.h"
+#include "WindowAggregator.h"
 
 /**
  * @brief Edge Communication Manager following Single Responsibility Principle
@@ -24,20 +30,58 @@ public:
         ERROR
     };
 
+    // Wire format for weight, status and heartbeat messages, negotiated per device
+    enum class PayloadFormat {
+        JSON,   // Human-readable, for debugging
+        BINARY  // BinaryPayload v1 fixed layout
+    };
+
+    // Phases of a non-blocking connection attempt
+    enum class ConnectPhase {
+        BACKOFF,         // Waiting for the next attempt
+        RESOLVING,       // Asynchronous DNS lookup
+        TCP_CONNECTING,  // Non-blocking socket connect
+        AWAIT_CONNACK,   // CONNECT sent, polling for CONNACK
+        AWAIT_SUBACK,    // SUBSCRIBE sent, polling for SUBACK
+        ONLINE
+    };
+
+    // Plain values only, so building one per sample never touches the heap
     struct WeightData {
         float weight;
         unsigned long timestamp;
-        String deviceId;
     };
 
+    struct WeightEvent {
+        const char* event;        // LOAD_PLACED, LOAD_REMOVED or LOAD_STABLE
+        uint8_t eventCode;        // Numeric form of event, used for offline storage
+        float weight;
+        float delta;
+        unsigned long settleTime; // ms
+        unsigned long timestamp;
+    };
+
+    // Weight samples are accumulated and published as one message when any limit is hit
+    struct BatchConfig {
+        bool enabled = false;
+        uint16_t maxSamples = 20;
+        unsigned long maxAgeMs = 2000;
+        uint16_t maxBytes = 512;
+    };
+
+    // Strings point into the MQTT receive buffer and are only valid during the callback
     struct EdgeCommand {
-        String command;
-        String value;
+        const char* command;
+        const char* value;
         unsigned long timestamp;
+        unsigned long parseMicros;
     };
 
+    typedef void (*CommandHandler)(void* context, const EdgeCommand& command);
+    typedef void (*ConnectionStateHandler)(void* context, ConnectionState state);
+
 private:
-    WiFiClient wifiClient;
+    MqttTransport transport;
     PubSubClient mqttClient;
     
     // Connection settings
@@ -46,21 +90,73 @@ private:
     String clientId;
     String deviceId;
     
-    // Topics
-    String weightTopic;
-    String commandTopic;
-    String statusTopic;
+    // Topics, built once in setupTopics(); never subscribed or published if one did not fit
+    static const uint8_t MAX_TOPIC_LENGTH = 64;
+    static const uint8_t TOPIC_FRAME_LENGTH = 17; // "tavolo/" plus the longest suffix, "/flightlog"
+    char weightTopic[MAX_TOPIC_LENGTH];
+    char commandTopic[MAX_TOPIC_LENGTH];
+    char statusTopic[MAX_TOPIC_LENGTH];
+    char flightLogTopic[MAX_TOPIC_LENGTH];
+    char traceTopic[MAX_TOPIC_LENGTH];
+    bool topicsValid = false;
+    
+    // Single-message payloads are serialized here instead of into a temporary String;
+    // the largest is a weight_summary with every number at full width, about 300 bytes
+    static const uint16_t MAX_MESSAGE_BYTES = 384;
+    static const uint8_t FLIGHT_LOG_CHUNK_RECORDS = 32; // 266-byte chunks
+    char messageBuffer[MAX_MESSAGE_BYTES];
+    uint32_t publishedCount = 0;
+    uint32_t publishFailureCount = 0;
     
     // State management
     ConnectionState currentState = ConnectionState::DISCONNECTED;
-    unsigned long lastConnectionAttempt = 0;
+    PayloadFormat payloadFormat = PayloadFormat::JSON;
     unsigned long lastHeartbeat = 0;
-    const unsigned long RECONNECT_INTERVAL = 5000;
+    
+    // Connection state machine; every phase is polled and bounded by its own timeout
+    ConnectPhase connectPhase = ConnectPhase::BACKOFF;
+    unsigned long phaseStartTime = 0;
+    unsigned long nextAttemptTime = 0;
+    uint8_t failedAttempts = 0;
+    const unsigned long DNS_TIMEOUT = 5000;
+    const unsigned long TCP_TIMEOUT = 5000;
+    const unsigned long CONNACK_TIMEOUT = 5000;
+    const unsigned long SUBACK_TIMEOUT = 5000;
+    const uint16_t KEEP_ALIVE_SECONDS = 15;
+    unsigned long backoffBase = 1000;   // ms, doubled per failed attempt
+    unsigned long backoffMax = 60000;   // ms
+    
+    // update() time budget accounting
+    unsigned long updateBudgetUs = 20000;
+    unsigned long maxUpdateUs = 0;
+    uint32_t budgetOverruns = 0;
     const unsigned long HEARTBEAT_INTERVAL = 30000;
     
-    // Callbacks for event-driven architecture
-    std::function<void(const EdgeCommand&)> onCommandCallback = nullptr;
-    std::function<void(ConnectionState)> onConnectionStateCallback = nullptr;
+    // Weight batching: payload text is built incrementally so the byte budget is exact.
+    // The samples are also kept as they came, so an unsent batch spills without reparsing
+    static const uint16_t MAX_BATCH_BYTES = 1024;
+    static const uint8_t MAX_BATCH_SAMPLES = 112; // The text budget holds about 106: 9 bytes a sample
+    BatchConfig batchConfig;
+    char batchBuffer[MAX_BATCH_BYTES];
+    WeightData batchSamples[MAX_BATCH_SAMPLES];
+    uint16_t batchLength = 0;
+    uint16_t batchCount = 0;
+    unsigned long batchBaseTimestamp = 0;
+    unsigned long batchStartTime = 0;
+    
+    // Store-and-forward: unsent telemetry is persisted and drained at a bounded rate
+    OfflineQueue* offlineQueue = nullptr;
+    static const unsigned long DRAIN_INTERVAL = 250; // At most 4 backlog messages per second
+    static const uint8_t DRAIN_BURST = 16;           // Records per backlog message
+    static const uint16_t MAX_DRAIN_BYTES = 768;
+    char drainBuffer[MAX_DRAIN_BYTES];
+    unsigned long lastDrainTime = 0;
+    
+    // Callbacks run on the network core; the owner forwards them to the sensing core
+    CommandHandler onCommandCallback = nullptr;
+    void* onCommandContext = nullptr;
+    ConnectionStateHandler onConnectionStateCallback = nullptr;
+    void* onConnectionStateContext = nullptr;
 
 public:
     EdgeCommunication(const String& deviceId);
@@ -73,23 +169,60 @@ public:
     void disconnect();
     bool isConnected();
     ConnectionState getConnectionState() const { return currentState; }
+    ConnectPhase getConnectPhase() const { return connectPhase; }
+    void setReconnectBackoff(unsigned long baseMs, unsigned long maxMs);
+    const char* phaseToString(ConnectPhase phase) const;
+    static const char* connectionStateToString(ConnectionState state);
+    
+    // Timing of update() against its budget
+    void setUpdateBudget(unsigned long budgetUs) { updateBudgetUs = budgetUs; }
+    unsigned long getMaxUpdateTime() const { return maxUpdateUs; }
+    uint32_t getBudgetOverruns() const { return budgetOverruns; }
     
     // Data transmission
     bool sendWeightData(const WeightData& data);
-    bool sendStatusUpdate(const String& status);
+    bool sendWeightEvent(const WeightEvent& event);
+    bool sendWeightSummary(const WindowAggregator::Summary& summary);
+    bool queueWeightData(const WeightData& data);
+    bool flushWeightBatch();
+    uint16_t getBatchedSampleCount() const { return batchCount; }
+    bool sendStatusUpdate(const char* status);
+    bool sendFlightLog(); // Every retained flight recorder record, in FlightLog chunks
+    bool sendTraceChunk(const uint8_t* chunk, size_t length); // One TraceCodec chunk, as is
+#if TAVOLO_PROFILING
+    bool sendLatencyReport(const char* section, const LatencyHistogram& histogram);
+#endif
+    uint32_t getPublishedCount() const { return publishedCount; }
+    uint32_t getPublishFailureCount() const { return publishFailureCount; }
     
     // Event callbacks
-    void setOnCommandCallback(std::function<void(const EdgeCommand&)> callback);
-    void setOnConnectionStateCallback(std::function<void(ConnectionState)> callback);
+    void setOnCommandCallback(CommandHandler handler, void* context);
+    void setOnConnectionStateCallback(ConnectionStateHandler handler, void* context);
     
     // Configuration
     void setMqttServer(const String& server, int port = 1883);
+    void setBatchConfig(const BatchConfig& config);
+    void setPayloadFormat(PayloadFormat format);
+    void setOfflineQueue(OfflineQueue* queue) { offlineQueue = queue; }
+    PayloadFormat getPayloadFormat() const { return payloadFormat; }
+    const BatchConfig& getBatchConfig() const { return batchConfig; }
 
 private:
     void setupTopics();
+    static bool buildTopic(char* topic, const char* deviceName, const char* suffix);
+    void stepConnection(unsigned long currentTime);
+    void enterPhase(ConnectPhase phase, unsigned long currentTime);
+    void failConnection(const char* reason);
+    void onConnectionEstablished();
     void onMqttMessage(char* topic, byte* payload, unsigned int length);
     void setConnectionState(ConnectionState newState);
     void sendHeartbeat();
+    bool publish(const char* topic, const uint8_t* payload, size_t length);
+    bool publishJson(const char* topic, const JsonDocument& doc);
+    bool startBatch(unsigned long baseTimestamp);
+    void spillBatchOffline();
+    bool storeOffline(const OfflineQueue::Record& record);
+    void drainOfflineQueue();
     
     // Static wrapper for MQTT callback
     static void mqttCallback(char* topic, byte* payload, unsigned int length);
@@ -0,0 +1,148 @@
+#include "EventBus.h"
+
+void EventBus::attach(Scheduler& target) {
+    scheduler = &target;
+    dispatchTask = target.addEvent("events", [this]() {
+        dispatch();
+    });
+    if (!queue.isEmpty()) {
+        target.signal(dispatchTask); // Published before attach()
+    }
+}
+
+EventBus::SubscriberId EventBus::subscribe(const char* name, Topic topic, Handler handler, void* context,
+                                           uint8_t decimation, unsigned long minIntervalMs) {
+    if (subscriberCount >= MAX_SUBSCRIBERS || topic >= TOPIC_COUNT || handler == nullptr) {
+        return INVALID_SUBSCRIBER;
+    }
+
+    Subscriber& subscriber = subscribers[subscriberCount];
+    subscriber.name = name;
+    subscriber.topic = topic;
+    subscriber.handler = handler;
+    subscriber.context = context;
+    subscriber.deliveredCount = 0;
+    subscriber.skippedCount = 0;
+    topicSubscribers[topic]++;
+
+    SubscriberId id = subscriberCount++;
+    setRate(id, decimation, minIntervalMs);
+    return id;
+}
+
+void EventBus::setRate(SubscriberId id, uint8_t decimation, unsigned long minIntervalMs) {
+    if (id < 0 || id >= subscriberCount) return;
+
+    Subscriber& subscriber = subscribers[id];
+    subscriber.decimation = decimation > 0 ? decimation : 1;
+    subscriber.countdown = 0; // Next event is delivered
+    subscriber.minInterval = minIntervalMs;
+    subscriber.delivered = false;
+}
+
+bool EventBus::publish(const Event& event) {
+    if (!hasSubscribers(event.topic)) return false;
+
+    if (!queue.push(event)) {
+        droppedCount++;
+        return false;
+    }
+    publishedCount++;
+
+    uint32_t depth = queue.size();
+    if (depth > highWater) {
+        highWater = depth;
+    }
+    if (scheduler != nullptr) {
+        scheduler->signal(dispatchTask);
+    }
+    return true;
+}
+
+bool EventBus::publish(Topic topic, uint8_t code, float value) {
+    Event event = {};
+    event.topic = topic;
+    event.code = code;
+    event.value = value;
+    event.timestamp = millis();
+    return publish(event);
+}
+
+size_t EventBus::dispatch() {
+    // A handler calling dispatch() again would deliver out of order; its events wait in the queue
+    if (dispatching) return 0;
+    dispatching = true;
+
+    size_t count = 0;
+    Event event;
+    while (queue.pop(event)) {
+        deliver(event);
+        count++;
+    }
+
+    dispatching = false;
+    return count;
+}
+
+void EventBus::deliver(const Event& event) {
+    for (uint8_t i = 0; i < subscriberCount; i++) {
+        Subscriber& subscriber = subscribers[i];
+        if (subscriber.topic != event.topic) continue;
+
+        if (subscriber.countdown > 0) {
+            subscriber.countdown--;
+            subscriber.skippedCount++;
+            continue;
+        }
+        if (subscriber.minInterval > 0 && subscriber.delivered &&
+            event.timestamp - subscriber.lastDelivery < subscriber.minInterval) {
+            subscriber.skippedCount++;
+            continue;
+        }
+
+        subscriber.countdown = subscriber.decimation - 1;
+        subscriber.lastDelivery = event.timestamp;
+        subscriber.delivered = true;
+        subscriber.deliveredCount++;
+        subscriber.handler(subscriber.context, event);
+    }
+}
+
+void EventBus::printStats(Print& out) const {
+    out.print("Event bus: depth ");
+    out.print((unsigned long)queue.size());
+    out.print("/");
+    out.print((unsigned long)QUEUE_CAPACITY);
+    out.print(", high ");
+    out.print(highWater);
+    out.print(", published ");
+    out.print(publishedCount);
+    out.print(", dropped ");
+    out.println(droppedCount);
+
+    for (uint8_t i = 0; i < subscriberCount; i++) {
+        const Subscriber& subscriber = subscribers[i];
+        out.print("  ");
+        out.print(subscriber.name);
+        out.print(" <- ");
+        out.print(topicToString(subscriber.topic));
+        out.print(": delivered ");
+        out.print(subscriber.deliveredCount);
+        out.print(", skipped ");
+        out.println(subscriber.skippedCount);
+    }
+}
+
+const char* EventBus::topicToString(Topic topic) {
+    switch (topic) {
+        case WEIGHT_SAMPLE: return "WEIGHT_SAMPLE";
+        case LOAD_EVENT: return "LOAD_EVENT";
+        case SYSTEM_STATE: return "SYSTEM_STATE";
+        case DEVICE_STATE: return "DEVICE_STATE";
+        case ACTUATOR_STATE: return "ACTUATOR_STATE";
+        case CONNECTION_STATE: return "CONNECTION_STATE";
+        case COMMAND: return "COMMAND";
+        case THRESHOLD: return "THRESHOLD";
+        default: return "UNKNOWN";
+    }
+}
@@ -0,0 +1,102 @@
+#ifndef EVENT_BUS_H
+#define EVENT_BUS_H
+
+#include <Arduino.h>
+#include "SampleRing.h"
+#include "Scheduler.h"
+
+/**
+ * @brief Statically allocated publish/subscribe bus for the sensing core
+ *
+ * Sources publish small fixed-size events into a queue; dispatch() delivers them
+ * in order to every subscriber of the topic. Handlers are plain function pointers
+ * with a context pointer, so subscribing never allocates. Each subscriber may ask
+ * for every Nth event and/or a minimum interval between deliveries, which lets
+ * several consumers take different rates from the same sample stream.
+ *
+ * Dispatch is never re-entrant: an event published from a handler is queued and
+ * delivered after the current one. publish() and dispatch() must run on the same
+ * core; data from the other core arrives through a CoreChannel first.
+ */
+class EventBus {
+public:
+    enum Topic : uint8_t {
+        WEIGHT_SAMPLE,    // value = weight (g)
+        LOAD_EVENT,       // code = sensor event type, value, delta, duration = settle time
+        SYSTEM_STATE,     // code = new state, previous = old state
+        DEVICE_STATE,     // code = new state, previous = old state
+        ACTUATOR_STATE,   // code = 1 on / 0 off
+        CONNECTION_STATE, // code = EdgeCommunication::ConnectionState
+        COMMAND,          // name = command, code = dispatch result
+        THRESHOLD,        // code = 1 exceeded / 0 cleared, value = weight
+        TOPIC_COUNT
+    };
+
+    struct Event {
+        Topic topic;
+        uint8_t code;
+        uint8_t previous;
+        float value;
+        float delta;
+        unsigned long duration;
+        unsigned long timestamp;
+        const char* name; // Static storage only; delivered after the publisher returned
+    };
+
+    typedef void (*Handler)(void* context, const Event& event);
+    typedef int8_t SubscriberId;
+    static const SubscriberId INVALID_SUBSCRIBER = -1;
+    static const uint8_t MAX_SUBSCRIBERS = 12;
+    static const size_t QUEUE_CAPACITY = 32;
+
+private:
+    struct Subscriber {
+        const char* name;
+        Topic topic;
+        Handler handler;
+        void* context;
+        uint8_t decimation;       // Deliver every Nth event, 1 = all
+        uint8_t countdown;
+        unsigned long minInterval; // ms between deliveries, 0 = unlimited
+        unsigned long lastDelivery;
+        bool delivered;            // lastDelivery is valid
+        uint32_t deliveredCount;
+        uint32_t skippedCount;
+    };
+
+    Subscriber subscribers[MAX_SUBSCRIBERS];
+    uint8_t subscriberCount = 0;
+    uint8_t topicSubscribers[TOPIC_COUNT] = {};
+    SampleRing<Event, QUEUE_CAPACITY> queue;
+    Scheduler* scheduler = nullptr;
+    Scheduler::TaskId dispatchTask = Scheduler::INVALID_TASK;
+    bool dispatching = false;
+    uint32_t publishedCount = 0;
+    uint32_t droppedCount = 0;
+    uint32_t highWater = 0;
+
+public:
+    // Registers an event task on the scheduler that runs dispatch() after each publish
+    void attach(Scheduler& scheduler);
+
+    SubscriberId subscribe(const char* name, Topic topic, Handler handler, void* context = nullptr,
+                           uint8_t decimation = 1, unsigned long minIntervalMs = 0);
+    void setRate(SubscriberId id, uint8_t decimation, unsigned long minIntervalMs);
+
+    // Events for topics nobody listens to are discarded without being queued
+    bool publish(const Event& event);
+    bool publish(Topic topic, uint8_t code = 0, float value = 0.0f);
+    bool hasSubscribers(Topic topic) const { return topic < TOPIC_COUNT && topicSubscribers[topic] > 0; }
+
+    size_t dispatch();
+
+    uint32_t getPublishedCount() const { return publishedCount; }
+    uint32_t getDroppedCount() const { return droppedCount; }
+    void printStats(Print& out) const;
+    static const char* topicToString(Topic topic);
+
+private:
+    void deliver(const Event& event);
+};
+
+#endif // EVENT_BUS_H
@@ -0,0 +1,93 @@
+#include "FileLogStorage.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <dirent.h>
+#include <sys/stat.h>
+
+#ifdef ARDUINO_ARCH_ESP32
+#include <LittleFS.h>
+#endif
+
+FileLogStorage::FileLogStorage(const char* path) {
+    strncpy(basePath, path, sizeof(basePath) - 1);
+    basePath[sizeof(basePath) - 1] = '\0';
+}
+
+bool FileLogStorage::begin() {
+#ifdef ARDUINO_ARCH_ESP32
+    if (!LittleFS.begin(true)) { // Format on first use
+        return false;
+    }
+#endif
+    struct stat info;
+    if (stat(basePath, &info) != 0 && mkdir(basePath, 0755) != 0) {
+        return false;
+    }
+    return true;
+}
+
+bool FileLogStorage::append(uint32_t segment, const uint8_t* data, size_t length) {
+    char path[48];
+    segmentPath(segment, path, sizeof(path));
+
+    FILE* file = fopen(path, "ab");
+    if (!file) return false;
+
+    size_t written = fwrite(data, 1, length, file);
+    fclose(file);
+    return written == length;
+}
+
+size_t FileLogStorage::read(uint32_t segment, size_t offset, uint8_t* data, size_t length) {
+    char path[48];
+    segmentPath(segment, path, sizeof(path));
+
+    FILE* file = fopen(path, "rb");
+    if (!file) return 0;
+
+    size_t bytesRead = 0;
+    if (fseek(file, offset, SEEK_SET) == 0) {
+        bytesRead = fread(data, 1, length, file);
+    }
+    fclose(file);
+    return bytesRead;
+}
+
+size_t FileLogStorage::segmentSize(uint32_t segment) {
+    char path[48];
+    segmentPath(segment, path, sizeof(path));
+
+    struct stat info;
+    if (stat(path, &info) != 0) return 0;
+    return info.st_size;
+}
+
+bool FileLogStorage::removeSegment(uint32_t segment) {
+    char path[48];
+    segmentPath(segment, path, sizeof(path));
+    return remove(path) == 0;
+}
+
+bool FileLogStorage::findSegments(uint32_t& first, uint32_t& last) {
+    DIR* dir = opendir(basePath);
+    if (!dir) return false;
+
+    bool found = false;
+    struct dirent* entry;
+    while ((entry = readdir(dir)) != nullptr) {
+        char* end;
+        unsigned long id = strtoul(entry->d_name, &end, 10);
+        if (end == entry->d_name || strcmp(end, ".seg") != 0) continue;
+
+        if (!found || id < first) first = id;
+        if (!found || id > last) last = id;
+        found = true;
+    }
+    closedir(dir);
+    return found;
+}
+
+void FileLogStorage::segmentPath(uint32_t segment, char* path, size_t size) const {
+    snprintf(path, size, "%s/%08lu.seg", basePath, (unsigned long)segment);
+}
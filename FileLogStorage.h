@@ -0,0 +1,36 @@
+#ifndef FILE_LOG_STORAGE_H
+#define FILE_LOG_STORAGE_H
+
+#include "LogStorage.h"
+
+// Segment directory; host builds point it at a scratch directory
+#ifndef TAVOLO_OFFLINE_QUEUE_PATH
+#define TAVOLO_OFFLINE_QUEUE_PATH "/littlefs/queue"
+#endif
+
+/**
+ * @brief LogStorage backed by one file per segment
+ *
+ * Uses plain stdio/dirent calls, so the same code runs on the ESP32 VFS (LittleFS
+ * mounted at /littlefs) and against an ordinary directory on a Linux host.
+ */
+class FileLogStorage : public LogStorage {
+private:
+    char basePath[32];
+
+public:
+    explicit FileLogStorage(const char* basePath = TAVOLO_OFFLINE_QUEUE_PATH);
+
+    bool begin() override;
+
+    bool append(uint32_t segment, const uint8_t* data, size_t length) override;
+    size_t read(uint32_t segment, size_t offset, uint8_t* data, size_t length) override;
+    size_t segmentSize(uint32_t segment) override;
+    bool removeSegment(uint32_t segment) override;
+    bool findSegments(uint32_t& first, uint32_t& last) override;
+
+private:
+    void segmentPath(uint32_t segment, char* path, size_t size) const;
+};
+
+#endif // FILE_LOG_STORAGE_H
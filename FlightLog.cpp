@@ -0,0 +1,88 @@
+#include "FlightLog.h"
+#include <stdio.h>
+
+void FlightLog::writeU16(uint8_t* out, uint16_t value) {
+    out[0] = value & 0xFF;
+    out[1] = (value >> 8) & 0xFF;
+}
+
+uint16_t FlightLog::readU16(const uint8_t* in) {
+    return (uint16_t)(in[0] | (in[1] << 8));
+}
+
+void FlightLog::writeU32(uint8_t* out, uint32_t value) {
+    out[0] = value & 0xFF;
+    out[1] = (value >> 8) & 0xFF;
+    out[2] = (value >> 16) & 0xFF;
+    out[3] = (value >> 24) & 0xFF;
+}
+
+uint32_t FlightLog::readU32(const uint8_t* in) {
+    return (uint32_t)in[0] | ((uint32_t)in[1] << 8) |
+           ((uint32_t)in[2] << 16) | ((uint32_t)in[3] << 24);
+}
+
+size_t FlightLog::encodeChunk(uint8_t* buffer, size_t capacity, const ChunkHeader& header,
+                              const Record* records) {
+    size_t length = CHUNK_HEADER_SIZE + (size_t)header.count * RECORD_SIZE;
+    if (capacity < length) return 0;
+
+    buffer[0] = 'F';
+    buffer[1] = 'L';
+    buffer[2] = VERSION;
+    buffer[3] = header.count;
+    writeU16(buffer + 4, header.bootCount);
+    writeU32(buffer + 6, header.firstSequence);
+
+    uint8_t* out = buffer + CHUNK_HEADER_SIZE;
+    for (uint8_t i = 0; i < header.count; i++) {
+        writeU32(out, records[i].timestamp);
+        out[4] = records[i].type;
+        out[5] = records[i].a;
+        writeU16(out + 6, records[i].b);
+        out += RECORD_SIZE;
+    }
+    return length;
+}
+
+bool FlightLog::decodeChunk(const uint8_t* buffer, size_t length, ChunkHeader& header,
+                            Record* records, size_t maxRecords) {
+    if (length < CHUNK_HEADER_SIZE || buffer[0] != 'F' || buffer[1] != 'L') return false;
+
+    header.version = buffer[2];
+    header.count = buffer[3];
+    header.bootCount = readU16(buffer + 4);
+    header.firstSequence = readU32(buffer + 6);
+    if (header.version != VERSION) return false;
+    if (header.count > maxRecords || length < CHUNK_HEADER_SIZE + (size_t)header.count * RECORD_SIZE) {
+        return false;
+    }
+
+    const uint8_t* in = buffer + CHUNK_HEADER_SIZE;
+    for (uint8_t i = 0; i < header.count; i++) {
+        records[i].timestamp = readU32(in);
+        records[i].type = in[4];
+        records[i].a = in[5];
+        records[i].b = readU16(in + 6);
+        in += RECORD_SIZE;
+    }
+    return true;
+}
+
+const char* FlightLog::typeToString(uint8_t type) {
+    switch (type) {
+        case BOOT: return "BOOT";
+        case STATE_CHANGE: return "STATE_CHANGE";
+        case CONNECTION_STATE: return "CONNECTION_STATE";
+        case PUBLISH: return "PUBLISH";
+        case COMMAND: return "COMMAND";
+        case SAMPLE_OVERRUN: return "SAMPLE_OVERRUN";
+        case SAMPLE_MISSED: return "SAMPLE_MISSED";
+        default: return "UNKNOWN";
+    }
+}
+
+int FlightLog::describe(const Record& record, char* out, size_t size) {
+    return snprintf(out, size, "%lu %s a=%u b=%u", (unsigned long)record.timestamp,
+                    typeToString(record.type), (unsigned)record.a, (unsigned)record.b);
+}
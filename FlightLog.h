@@ -0,0 +1,71 @@
+#ifndef FLIGHT_LOG_H
+#define FLIGHT_LOG_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief Record layout and upload framing of the flight recorder
+ *
+ * Records are fixed 8-byte entries; chunks carry a run of consecutive records.
+ * All multi-byte fields are little-endian.
+ *
+ *   RECORD | timestamp:u32 | type:u8 | a:u8 | b:u16 |                        8 bytes
+ *   CHUNK  | 'F' | 'L' | ver | count:u8 | boot:u16 | firstSequence:u32 | records |
+ *
+ * Sequences count every record written since the ring was last cleared, so gaps
+ * between chunks show what was overwritten. Like BinaryPayload, the codec has no
+ * Arduino dependencies so the edge and host tools can link it as is.
+ */
+class FlightLog {
+public:
+    static const uint8_t VERSION = 1;
+
+    enum RecordType : uint8_t {
+        BOOT = 1,              // a = reset reason (esp_reset_reason_t)
+        STATE_CHANGE = 2,      // a = previous SystemState, b = new SystemState
+        CONNECTION_STATE = 3,  // a = ConnectionState
+        PUBLISH = 4,           // a = 1 published / 0 failed, b = payload bytes
+        COMMAND = 5,           // a = dispatch result, b = low 16 bits of the command hash
+        SAMPLE_OVERRUN = 6,    // b = overrun total, saturated
+        SAMPLE_MISSED = 7      // b = missed conversion total, saturated
+    };
+
+    struct Record {
+        uint32_t timestamp; // millis()
+        uint8_t type;
+        uint8_t a;
+        uint16_t b;
+    };
+
+    struct ChunkHeader {
+        uint8_t version;
+        uint8_t count;
+        uint16_t bootCount;
+        uint32_t firstSequence;
+    };
+
+    static const size_t RECORD_SIZE = 8;
+    static const size_t CHUNK_HEADER_SIZE = 10;
+
+    // Returns the number of bytes written, or 0 when the buffer is too small
+    static size_t encodeChunk(uint8_t* buffer, size_t capacity, const ChunkHeader& header,
+                              const Record* records);
+
+    // Returns false for a bad magic, unknown version or truncated input
+    static bool decodeChunk(const uint8_t* buffer, size_t length, ChunkHeader& header,
+                            Record* records, size_t maxRecords);
+
+    static const char* typeToString(uint8_t type);
+
+    // One human-readable line, e.g. "12345 STATE_CHANGE a=2 b=3"; same contract as snprintf
+    static int describe(const Record& record, char* out, size_t size);
+
+private:
+    static void writeU16(uint8_t* out, uint16_t value);
+    static uint16_t readU16(const uint8_t* in);
+    static void writeU32(uint8_t* out, uint32_t value);
+    static uint32_t readU32(const uint8_t* in);
+};
+
+#endif // FLIGHT_LOG_H
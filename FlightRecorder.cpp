@@ -0,0 +1,129 @@
+#include "FlightRecorder.h"
+
+#ifdef ARDUINO_ARCH_ESP32
+#include <esp_system.h>
+#else
+#define RTC_NOINIT_ATTR
+#endif
+
+namespace {
+
+const uint32_t RECORDER_MAGIC = 0x464C5231; // "FLR1"
+
+struct RecorderState {
+    uint32_t magic;
+    uint32_t sequence;
+    uint16_t bootCount;
+    uint16_t reserved;
+    FlightLog::Record records[FlightRecorder::CAPACITY];
+};
+
+RTC_NOINIT_ATTR RecorderState state;
+
+#ifdef ARDUINO_ARCH_ESP32
+portMUX_TYPE recorderLock = portMUX_INITIALIZER_UNLOCKED;
+#define RECORDER_LOCK() portENTER_CRITICAL_SAFE(&recorderLock)
+#define RECORDER_UNLOCK() portEXIT_CRITICAL_SAFE(&recorderLock)
+#else
+#define RECORDER_LOCK() noInterrupts()
+#define RECORDER_UNLOCK() interrupts()
+#endif
+
+}
+
+void FlightRecorder::begin() {
+    uint8_t resetReason = 0;
+    bool coldBoot = true;
+#ifdef ARDUINO_ARCH_ESP32
+    esp_reset_reason_t reason = esp_reset_reason();
+    resetReason = (uint8_t)reason;
+    coldBoot = reason == ESP_RST_POWERON || reason == ESP_RST_BROWNOUT || reason == ESP_RST_UNKNOWN;
+#else
+    coldBoot = false; // Host: the process start is the power-on, so a later begin() is a reset
+#endif
+
+    // RTC memory holds garbage after power-on; anything else keeps the previous boot's records
+    if (coldBoot || state.magic != RECORDER_MAGIC) {
+        clear();
+        state.bootCount = 0;
+    }
+    state.bootCount++;
+
+    record(FlightLog::BOOT, resetReason, state.bootCount);
+
+    Serial.print("Flight recorder: boot ");
+    Serial.print(state.bootCount);
+    Serial.print(", ");
+    Serial.print(state.sequence - getOldestSequence());
+    Serial.println(" records retained");
+}
+
+void FlightRecorder::record(uint8_t type, uint8_t a, uint16_t b) {
+    if (state.magic != RECORDER_MAGIC) return; // Not validated yet
+
+    uint32_t now = millis();
+    RECORDER_LOCK();
+    FlightLog::Record& slot = state.records[state.sequence & (CAPACITY - 1)];
+    slot.timestamp = now;
+    slot.type = type;
+    slot.a = a;
+    slot.b = b;
+    state.sequence++;
+    RECORDER_UNLOCK();
+}
+
+void FlightRecorder::clear() {
+    RECORDER_LOCK();
+    state.magic = RECORDER_MAGIC;
+    state.sequence = 0;
+    RECORDER_UNLOCK();
+}
+
+uint32_t FlightRecorder::getSequence() {
+    return state.sequence;
+}
+
+uint32_t FlightRecorder::getOldestSequence() {
+    uint32_t sequence = state.sequence;
+    return sequence > CAPACITY ? sequence - CAPACITY : 0;
+}
+
+uint16_t FlightRecorder::getBootCount() {
+    return state.bootCount;
+}
+
+size_t FlightRecorder::read(uint32_t& sequence, FlightLog::Record* out, size_t maxRecords) {
+    RECORDER_LOCK();
+    uint32_t oldest = getOldestSequence();
+    if (sequence < oldest) {
+        sequence = oldest;
+    }
+
+    size_t count = 0;
+    while (count < maxRecords && sequence + count < state.sequence) {
+        out[count] = state.records[(sequence + count) & (CAPACITY - 1)];
+        count++;
+    }
+    RECORDER_UNLOCK();
+    return count;
+}
+
+void FlightRecorder::print(Print& out, uint16_t last) {
+    uint32_t end = getSequence();
+    uint32_t sequence = end > last ? end - last : 0;
+
+    out.print("=== FLIGHT RECORDER (boot ");
+    out.print(getBootCount());
+    out.println(") ===");
+
+    FlightLog::Record record;
+    char line[48];
+    while (sequence < end && read(sequence, &record, 1) == 1) {
+        FlightLog::describe(record, line, sizeof(line));
+        out.print(sequence);
+        out.print(": ");
+        out.println(line);
+        sequence++;
+    }
+    out.println("===========================");
+}
@@ -0,0 +1,37 @@
+#ifndef FLIGHT_RECORDER_H
+#define FLIGHT_RECORDER_H
+
+#include <Arduino.h>
+#include "FlightLog.h"
+
+/**
+ * @brief Binary event ring that survives watchdog and software resets
+ *
+ * The ring lives in RTC no-init memory, which the bootloader leaves untouched on
+ * anything but a power-on or brownout reset. A record is one 8-byte store under a
+ * spinlock shared by both cores, so it is cheap enough for the hot paths. After a
+ * crash the previous boot's records are still there and can be uploaded through
+ * EdgeCommunication::sendFlightLog() or printed on the serial console.
+ */
+class FlightRecorder {
+public:
+    static const uint16_t CAPACITY = 256; // Power of two; 2 KB of RTC memory
+
+    // Validates the retained ring (clearing it after a cold boot) and records BOOT
+    static void begin();
+    static void record(uint8_t type, uint8_t a = 0, uint16_t b = 0);
+    static void clear();
+
+    // Sequence of the next record; the ring holds [getOldestSequence(), getSequence())
+    static uint32_t getSequence();
+    static uint32_t getOldestSequence();
+    static uint16_t getBootCount();
+
+    // Copies up to maxRecords starting at sequence, which is moved forward past
+    // records that were already overwritten; returns the number copied
+    static size_t read(uint32_t& sequence, FlightLog::Record* out, size_t maxRecords);
+
+    static void print(Print& out, uint16_t last);
+};
+
+#endif // FLIGHT_RECORDER_H
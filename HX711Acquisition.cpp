@@ -0,0 +1,166 @@
+#include "HX711Acquisition.h"
+
+#ifdef ARDUINO_ARCH_ESP32
+#include "soc/soc.h"
+#include "soc/gpio_reg.h"
+#endif
+
+// Static instance for ISR
+HX711Acquisition* HX711Acquisition::instance = nullptr;
+
+HX711Acquisition::HX711Acquisition(int dataPin, int clockPin)
+    : channelCount(1), clockPin(clockPin) {
+    dataPins[0] = dataPin;
+}
+
+HX711Acquisition::HX711Acquisition(const uint8_t* dataPins, uint8_t channelCount, int clockPin)
+    : channelCount(channelCount), clockPin(clockPin) {
+    if (this->channelCount == 0) this->channelCount = 1;
+    if (this->channelCount > MAX_CHANNELS) this->channelCount = MAX_CHANNELS;
+    for (uint8_t i = 0; i < this->channelCount; i++) {
+        this->dataPins[i] = dataPins[i];
+    }
+}
+
+void HX711Acquisition::begin(uint8_t gain, uint16_t samplesPerSecond) {
+    dataMask = 0;
+    for (uint8_t i = 0; i < channelCount; i++) {
+        pinMode(dataPins[i], INPUT);
+        dataMask |= 1ULL << dataPins[i];
+    }
+    pinMode(clockPin, OUTPUT);
+    digitalWrite(clockPin, LOW);
+
+    switch (gain) {
+        case 64: gainPulses = 3; break;  // Channel A, gain 64
+        case 32: gainPulses = 2; break;  // Channel B, gain 32
+        default: gainPulses = 1; break;  // Channel A, gain 128
+    }
+
+    setSampleRate(samplesPerSecond);
+    instance = this;
+}
+
+void HX711Acquisition::start() {
+    if (running) return;
+
+    hasLastSample = false;
+    ring.clear();
+    running = true;
+
+    // A conversion that finished before the ISR was attached produces no further
+    // edge until it is clocked out, so drain it by hand first
+    noInterrupts();
+    acquire();
+    interrupts();
+
+    // Whichever DOUT goes low last completes the set
+    for (uint8_t i = 0; i < channelCount; i++) {
+        attachInterrupt(digitalPinToInterrupt(dataPins[i]), onDataReady, FALLING);
+    }
+}
+
+void HX711Acquisition::stop() {
+    if (!running) return;
+
+    for (uint8_t i = 0; i < channelCount; i++) {
+        detachInterrupt(digitalPinToInterrupt(dataPins[i]));
+    }
+    running = false;
+}
+
+void HX711Acquisition::service() {
+    if (!running || !allReady()) return;
+
+    // Every DOUT is low but the ISR has not fired for several periods: the edge was lost
+    uint32_t silence = micros() - lastSampleMicros;
+    if (!hasLastSample || silence > nominalPeriodUs * 4) {
+        noInterrupts();
+        acquire();
+        interrupts();
+    }
+}
+
+void HX711Acquisition::setSampleRate(uint16_t samplesPerSecond) {
+    if (samplesPerSecond == 0) samplesPerSecond = 10;
+    nominalPeriodUs = 1000000UL / samplesPerSecond;
+    hasLastSample = false; // Do not count the rate switch as missed conversions
+}
+
+void HX711Acquisition::resetStatistics() {
+    producedCount = 0;
+    overrunCount = 0;
+    missedCount = 0;
+}
+
+uint64_t IRAM_ATTR HX711Acquisition::readInputs() const {
+#ifdef ARDUINO_ARCH_ESP32
+    // GPIO0-31 in one register, GPIO32-39 in the next; skip the second read when unused
+    uint64_t inputs = REG_READ(GPIO_IN_REG);
+    if (dataMask >> 32) {
+        inputs |= (uint64_t)REG_READ(GPIO_IN1_REG) << 32;
+    }
+    return inputs;
+#else
+    uint64_t inputs = 0;
+    for (uint8_t i = 0; i < channelCount; i++) {
+        if (digitalRead(dataPins[i])) {
+            inputs |= 1ULL << dataPins[i];
+        }
+    }
+    return inputs;
+#endif
+}
+
+void IRAM_ATTR HX711Acquisition::acquire() {
+    // DOUT toggles while bits are shifted out and re-arms the edge interrupt;
+    // only every DOUT low means a full set of conversions is actually waiting
+    if (!running || !allReady()) return;
+
+    uint32_t now = micros();
+    uint32_t raw[MAX_CHANNELS] = {};
+
+    for (uint8_t i = 0; i < 24; i++) {
+        digitalWrite(clockPin, HIGH);
+        delayMicroseconds(1);
+        uint64_t inputs = readInputs();
+        for (uint8_t c = 0; c < channelCount; c++) {
+            raw[c] = (raw[c] << 1) | (uint32_t)((inputs >> dataPins[c]) & 1);
+        }
+        digitalWrite(clockPin, LOW);
+        delayMicroseconds(1);
+    }
+
+    for (uint8_t i = 0; i < gainPulses; i++) {
+        digitalWrite(clockPin, HIGH);
+        delayMicroseconds(1);
+        digitalWrite(clockPin, LOW);
+        delayMicroseconds(1);
+    }
+
+    // A gap of more than 1.5 periods means conversions finished without being read
+    if (hasLastSample) {
+        uint32_t gap = now - lastSampleMicros;
+        if (gap > nominalPeriodUs + nominalPeriodUs / 2) {
+            missedCount = missedCount + (gap + nominalPeriodUs / 2) / nominalPeriodUs - 1;
+        }
+    }
+    lastSampleMicros = now;
+    hasLastSample = true;
+    producedCount = producedCount + 1;
+
+    RawSample sample = {};
+    sample.timestamp = now;
+    for (uint8_t c = 0; c < channelCount; c++) {
+        sample.values[c] = (raw[c] & 0x800000UL) ? (int32_t)(raw[c] | 0xFF000000UL) : (int32_t)raw[c];
+    }
+    if (!ring.push(sample)) {
+        overrunCount = overrunCount + 1;
+    }
+}
+
+void IRAM_ATTR HX711Acquisition::onDataReady() {
+    if (instance) {
+        instance->acquire();
+    }
+}
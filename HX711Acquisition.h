@@ -0,0 +1,82 @@
+#ifndef HX711_ACQUISITION_H
+#define HX711_ACQUISITION_H
+
+#include <Arduino.h>
+#include "SampleRing.h"
+
+/**
+ * @brief Interrupt-driven HX711 conversion producer
+ *
+ * The falling edge of DOUT/DRDY signals a finished conversion. The ISR clocks the
+ * raw 24-bit value out, timestamps it and pushes it into a lock-free ring that the
+ * main loop drains without ever waiting on the converter.
+ *
+ * Several HX711 boards (one per load cell) may share the SCK line, each with its own
+ * DOUT. A conversion set is clocked out once every DOUT is low; each bit is taken from
+ * a single GPIO input register read, so all channels are sampled on the same edge.
+ */
+class HX711Acquisition {
+public:
+    static const uint8_t MAX_CHANNELS = 4;
+
+    struct RawSample {
+        int32_t values[MAX_CHANNELS]; // Sign-extended 24-bit conversion result per channel
+        uint32_t timestamp;           // micros() at data-ready
+    };
+
+    static const size_t RING_SIZE = 32; // 400 ms of headroom at 80 SPS
+
+private:
+    uint8_t dataPins[MAX_CHANNELS];
+    uint8_t channelCount;
+    uint64_t dataMask = 0; // One bit per DOUT pin in the combined input registers
+    int clockPin;
+    uint8_t gainPulses = 1; // Extra SCK pulses selecting gain/channel for the next conversion
+    uint32_t nominalPeriodUs = 100000; // 10 SPS default (RATE pin low)
+    bool running = false;
+
+    SampleRing<RawSample, RING_SIZE> ring;
+
+    // Producer statistics, written only from the ISR
+    volatile uint32_t producedCount = 0;
+    volatile uint32_t overrunCount = 0;  // Conversions lost because the ring was full
+    volatile uint32_t missedCount = 0;   // Conversions never clocked out (timestamp gaps)
+    volatile uint32_t lastSampleMicros = 0;
+    volatile bool hasLastSample = false;
+
+    static HX711Acquisition* instance;
+
+public:
+    HX711Acquisition(int dataPin, int clockPin);
+    HX711Acquisition(const uint8_t* dataPins, uint8_t channelCount, int clockPin);
+
+    void begin(uint8_t gain = 128, uint16_t samplesPerSecond = 10);
+    void start();
+    void stop();
+    bool isRunning() const { return running; }
+    uint8_t getChannelCount() const { return channelCount; }
+
+    // Consumer side
+    bool pop(RawSample& sample) { return ring.pop(sample); }
+    size_t pending() const { return ring.size(); }
+    void flush() { ring.clear(); }
+    void service(); // Recovers from a lost DRDY edge; call from the main loop
+
+    // Configuration
+    void setSampleRate(uint16_t samplesPerSecond);
+    uint16_t getSampleRate() const { return 1000000UL / nominalPeriodUs; }
+
+    // Statistics
+    uint32_t getProducedCount() const { return producedCount; }
+    uint32_t getOverrunCount() const { return overrunCount; }
+    uint32_t getMissedCount() const { return missedCount; }
+    void resetStatistics();
+
+private:
+    uint64_t readInputs() const;
+    bool allReady() const { return (readInputs() & dataMask) == 0; }
+    void acquire();
+    static void onDataReady();
+};
+
+#endif // HX711_ACQUISITION_H
@@ -0,0 +1,59 @@
+#ifndef IN_PLACE_H
+#define IN_PLACE_H
+
+#include <Arduino.h>
+#include <new>
+#include <utility>
+
+// Build-time switch: 1 keeps components in static storage, 0 allocates them with new
+#ifndef TAVOLO_STATIC_COMPONENTS
+#define TAVOLO_STATIC_COMPONENTS 1
+#endif
+
+/**
+ * @brief Storage for one object whose construction is deferred until boot
+ *
+ * Components need constructor arguments (pins, addresses) and must not be built
+ * before setup(), so they cannot simply be globals. InPlace reserves the bytes
+ * inside its owner (static or member storage) and constructs into them with
+ * placement new, which keeps the object off the heap.
+ */
+template <typename T>
+class InPlace {
+private:
+#if TAVOLO_STATIC_COMPONENTS
+    alignas(T) uint8_t storage[sizeof(T)];
+#endif
+    T* object = nullptr;
+
+public:
+    InPlace() = default;
+    InPlace(const InPlace&) = delete;
+    InPlace& operator=(const InPlace&) = delete;
+    ~InPlace() { destroy(); }
+
+    template <typename... Args>
+    T* construct(Args&&... args) {
+        destroy();
+#if TAVOLO_STATIC_COMPONENTS
+        object = new (storage) T(std::forward<Args>(args)...);
+#else
+        object = new T(std::forward<Args>(args)...);
+#endif
+        return object;
+    }
+
+    void destroy() {
+        if (object == nullptr) return;
+#if TAVOLO_STATIC_COMPONENTS
+        object->~T();
+#else
+        delete object;
+#endif
+        object = nullptr;
+    }
+
+    T* get() const { return object; }
+};
+
+#endif // IN_PLACE_H
@@ -0,0 +1,147 @@
+#ifndef LATENCY_HISTOGRAM_H
+#define LATENCY_HISTOGRAM_H
+
+#include <Arduino.h>
+
+// Build-time switch for loop latency instrumentation; 0 removes probes, histograms and reports
+#ifndef TAVOLO_PROFILING
+#define TAVOLO_PROFILING 1
+#endif
+
+/**
+ * @brief Fixed-bucket log2 histogram of section durations in microseconds
+ *
+ * Bucket 0 counts durations below 2 us, bucket i counts [2^i, 2^(i+1)) us and the
+ * last bucket everything from 2^(BUCKET_COUNT-1) us (about 33 ms) up. Recording is a
+ * count-leading-zeros and a few increments, so every task run can be measured.
+ */
+class LatencyHistogram {
+public:
+    static const uint8_t BUCKET_COUNT = 16;
+
+private:
+    uint32_t buckets[BUCKET_COUNT] = {};
+    uint32_t count = 0;
+    uint32_t maxUs = 0;
+    uint64_t totalUs = 0;
+
+public:
+    void record(uint32_t us) {
+        uint8_t bucket = us < 2 ? 0 : 31 - __builtin_clz(us);
+        if (bucket >= BUCKET_COUNT) bucket = BUCKET_COUNT - 1;
+        buckets[bucket]++;
+        count++;
+        totalUs += us;
+        if (us > maxUs) maxUs = us;
+    }
+
+    void reset() {
+        for (uint8_t i = 0; i < BUCKET_COUNT; i++) {
+            buckets[i] = 0;
+        }
+        count = 0;
+        maxUs = 0;
+        totalUs = 0;
+    }
+
+    uint32_t getCount() const { return count; }
+    uint32_t getMax() const { return maxUs; }
+    uint32_t getMean() const { return count > 0 ? (uint32_t)(totalUs / count) : 0; }
+    uint32_t getBucket(uint8_t bucket) const { return bucket < BUCKET_COUNT ? buckets[bucket] : 0; }
+
+    // Upper bound of the bucket holding the given percentile, capped at the observed maximum
+    uint32_t percentile(uint8_t percent) const {
+        if (count == 0) return 0;
+
+        uint32_t rank = (uint32_t)(((uint64_t)count * percent + 99) / 100);
+        uint32_t seen = 0;
+        for (uint8_t i = 0; i + 1 < BUCKET_COUNT; i++) {
+            seen += buckets[i];
+            if (seen >= rank) {
+                uint32_t upperBound = 2UL << i;
+                return upperBound < maxUs ? upperBound : maxUs;
+            }
+        }
+        return maxUs;
+    }
+
+    void print(Print& out, const char* name) const {
+        out.print(name);
+        out.print(": n=");
+        out.print(count);
+        out.print(" mean=");
+        out.print(getMean());
+        out.print("us p50<=");
+        out.print(percentile(50));
+        out.print("us p99<=");
+        out.print(percentile(99));
+        out.print("us max=");
+        out.print(maxUs);
+        out.println("us");
+
+        // Non-empty buckets only, as "<upper bound>:<count>"
+        out.print("  ");
+        for (uint8_t i = 0; i < BUCKET_COUNT; i++) {
+            if (buckets[i] == 0) continue;
+            if (i + 1 < BUCKET_COUNT) {
+                out.print("<");
+                out.print(2UL << i);
+            } else {
+                out.print(">=");
+                out.print(1UL << i);
+            }
+            out.print(":");
+            out.print(buckets[i]);
+            out.print(" ");
+        }
+        out.println();
+    }
+};
+
+/**
+ * @brief Scope timer feeding a LatencyHistogram from the CPU cycle counter
+ *
+ * Cycles are converted with the clock rate set by the active power profile. With
+ * automatic light sleep the clock may drop below that rate, so ECO readings can
+ * under-read. Off target the probe falls back to micros().
+ */
+class LatencyProbe {
+private:
+    LatencyHistogram& histogram;
+    uint32_t start;
+
+    static uint32_t& cyclesPerMicro() {
+#ifdef ARDUINO_ARCH_ESP32
+        static uint32_t value = 240;
+#else
+        static uint32_t value = 1;
+#endif
+        return value;
+    }
+
+public:
+    explicit LatencyProbe(LatencyHistogram& histogram) : histogram(histogram), start(now()) {}
+    ~LatencyProbe() { histogram.record((now() - start) / cyclesPerMicro()); }
+
+    static uint32_t now() {
+#ifdef ARDUINO_ARCH_ESP32
+        return ESP.getCycleCount();
+#else
+        return micros();
+#endif
+    }
+
+    static void setCpuFrequency(uint32_t mhz) {
+#ifdef ARDUINO_ARCH_ESP32
+        if (mhz > 0) cyclesPerMicro() = mhz;
+#endif
+    }
+};
+
+#if TAVOLO_PROFILING
+#define TAVOLO_PROFILE_SCOPE(histogram) LatencyProbe latencyProbe(histogram)
+#else
+#define TAVOLO_PROFILE_SCOPE(histogram)
+#endif
+
+#endif // LATENCY_HISTOGRAM_H
@@ -0,0 +1,94 @@
+#include "LcdFrameBuffer.h"
+
+LcdFrameBuffer::LcdFrameBuffer(uint8_t cols, uint8_t rows)
+    : cols(cols < MAX_COLS ? cols : MAX_COLS), rows(rows < MAX_ROWS ? rows : MAX_ROWS) {
+    fill(' ');
+    memset(glass, ' ', sizeof(glass));
+}
+
+void LcdFrameBuffer::setLine(uint8_t row, const char* text) {
+    if (row >= rows) return;
+
+    uint8_t col = 0;
+    if (text) {
+        while (col < cols && text[col] != '\0') {
+            frame[row][col] = text[col];
+            col++;
+        }
+    }
+    while (col < cols) {
+        frame[row][col++] = ' ';
+    }
+}
+
+void LcdFrameBuffer::fill(char c) {
+    memset(frame, c, sizeof(frame));
+}
+
+void LcdFrameBuffer::markCleared() {
+    memset(glass, ' ', sizeof(glass));
+    glassKnown = true;
+}
+
+void LcdFrameBuffer::invalidate() {
+    glassKnown = false;
+}
+
+bool LcdFrameBuffer::isDirty() const {
+    if (!glassKnown) return true;
+    for (uint8_t row = 0; row < rows; row++) {
+        if (memcmp(frame[row], glass[row], cols) != 0) return true;
+    }
+    return false;
+}
+
+size_t LcdFrameBuffer::flush(LiquidCrystal_I2C& lcd) {
+    size_t sent = 0;
+
+    for (uint8_t row = 0; row < rows; row++) {
+        // The cursor does not wrap to the next visual row, so every row starts with a setCursor
+        int cursorCol = -1;
+        uint8_t col = 0;
+
+        while (col < cols) {
+            if (glassKnown && frame[row][col] == glass[row][col]) {
+                col++;
+                continue;
+            }
+
+            // Extend the run while the next change is at most one unchanged cell away
+            uint8_t start = col;
+            uint8_t last = col;
+            for (uint8_t next = col + 1; next < cols && next <= last + 2; next++) {
+                if (!glassKnown || frame[row][next] != glass[row][next]) {
+                    last = next;
+                }
+            }
+
+            if (cursorCol != start) {
+                lcd.setCursor(start, row);
+                sent++;
+            }
+            for (uint8_t i = start; i <= last; i++) {
+                lcd.write((uint8_t)frame[row][i]);
+                glass[row][i] = frame[row][i];
+            }
+            sent += last - start + 1;
+
+            cursorCol = last + 1;
+            col = last + 1;
+        }
+    }
+
+    glassKnown = true;
+    flushCount++;
+    bytesSent += sent;
+    bytesSaved += fullRefreshBytes() - sent;
+    return sent;
+}
+
+void LcdFrameBuffer::resetStatistics() {
+    flushCount = 0;
+    bytesSent = 0;
+    bytesSaved = 0;
+}
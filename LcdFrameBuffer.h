@@ -0,0 +1,66 @@
+#ifndef LCD_FRAME_BUFFER_H
+#define LCD_FRAME_BUFFER_H
+
+#include <Arduino.h>
+#include <LiquidCrystal_I2C.h>
+
+/**
+ * @brief Shadow framebuffer for a character LCD
+ *
+ * Keeps the wanted screen and a copy of what is physically on the glass, and on
+ * flush() sends only the cells that differ. Changed cells on a row are grouped into
+ * runs; a single unchanged cell between two changes is rewritten rather than paying
+ * for another setCursor, and no setCursor is sent where the controller's cursor
+ * already points after the previous run.
+ */
+class LcdFrameBuffer {
+public:
+    static const uint8_t MAX_COLS = 20;
+    static const uint8_t MAX_ROWS = 4;
+
+    // LiquidCrystal_I2C sends each LCD byte as two nibbles of three expander writes
+    static const uint8_t I2C_TRANSACTIONS_PER_BYTE = 6;
+
+private:
+    uint8_t cols;
+    uint8_t rows;
+    char frame[MAX_ROWS][MAX_COLS];  // Wanted content
+    char glass[MAX_ROWS][MAX_COLS];  // Content last sent to the display
+    bool glassKnown = false;         // False until the display has been cleared once
+
+    // Statistics, counted in LCD bytes (commands and characters)
+    uint32_t flushCount = 0;
+    uint32_t bytesSent = 0;
+    uint32_t bytesSaved = 0;
+
+public:
+    LcdFrameBuffer(uint8_t cols = MAX_COLS, uint8_t rows = MAX_ROWS);
+
+    // Composition; text is clipped to the row and padded with spaces
+    void setLine(uint8_t row, const char* text);
+    void fill(char c = ' ');
+
+    // Glass tracking
+    void markCleared();  // Call after lcd.clear(): the glass is all spaces
+    void invalidate();   // Glass unknown, the next flush rewrites every cell
+    bool isDirty() const;
+
+    // Sends the difference and returns the number of LCD bytes written
+    size_t flush(LiquidCrystal_I2C& lcd);
+
+    char frameAt(uint8_t col, uint8_t row) const { return frame[row][col]; }
+    char glassAt(uint8_t col, uint8_t row) const { return glass[row][col]; }
+    uint8_t getCols() const { return cols; }
+    uint8_t getRows() const { return rows; }
+
+    uint32_t getFlushCount() const { return flushCount; }
+    uint32_t getBytesSent() const { return bytesSent; }
+    uint32_t getBytesSaved() const { return bytesSaved; }
+    uint32_t getTransactionsSaved() const { return bytesSaved * I2C_TRANSACTIONS_PER_BYTE; }
+    void resetStatistics();
+
+private:
+    size_t fullRefreshBytes() const { return (size_t)rows * (cols + 1); }
+};
+
+#endif // LCD_FRAME_BUFFER_H
@@ -25,6 +25,17 @@ void LedActuator::setState(bool state) {
     notifyStateChange(state);
 }
 
+const char* LedActuator::patternToString(BlinkPattern pattern) {
+    switch (pattern) {
+        case BlinkPattern::OFF: return "OFF";
+        case BlinkPattern::ON: return "ON";
+        case BlinkPattern::SLOW_BLINK: return "SLOW_BLINK";
+        case BlinkPattern::FAST_BLINK: return "FAST_BLINK";
+        case BlinkPattern::PULSE: return "PULSE";
+        default: return "UNKNOWN";
+    }
+}
+
 bool LedActuator::getState() const {
     return currentPattern != BlinkPattern::OFF;
 }
@@ -34,24 +45,18 @@ void LedActuator::setPattern(BlinkPattern pattern) {
         currentPattern = pattern;
         lastToggleTime = millis();
         
-        Serial.print("LED pattern changed to: ");
+        TAVOLO_LOG_DEBUG(LOG_LED, "LED pattern changed to: %s", patternToString(pattern));
         switch (pattern) {
             case BlinkPattern::OFF:
-                Serial.println("OFF");
                 writeLed(false);
                 break;
             case BlinkPattern::ON:
-                Serial.println("ON");
                 writeLed(true);
                 break;
             case BlinkPattern::SLOW_BLINK:
-                Serial.println("SLOW_BLINK");
-                break;
             case BlinkPattern::FAST_BLINK:
-                Serial.println("FAST_BLINK");
                 break;
             case BlinkPattern::PULSE:
-                Serial.println("PULSE");
                 brightness = 0;
                 fadeDirection = true;
                 break;
@@ -2,6 +2,7 @@
 #define LED_ACTUATOR_H
 
 #include "Actuator.h"
+#include "DeferredLog.h"
 
 /**
  * @brief LED Actuator implementation following Single Responsibility Principle
@@ -43,6 +44,7 @@ public:
     // LED-specific methods
     void setPattern(BlinkPattern pattern);
     BlinkPattern getPattern() const { return currentPattern; }
+    static const char* patternToString(BlinkPattern pattern);
     void setBrightness(int brightness); // 0-255
     int getBrightness() const { return brightness; }
     
@@ -0,0 +1,30 @@
+#ifndef LOG_STORAGE_H
+#define LOG_STORAGE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief Abstract append-only segment storage following the Dependency Inversion Principle
+ *
+ * OfflineQueue only talks to this interface, so the backing medium (LittleFS file,
+ * raw flash partition, plain file on a Linux host) can be swapped freely.
+ * Segments are identified by increasing numbers and are only ever appended to or
+ * removed as a whole, never rewritten in place.
+ */
+class LogStorage {
+public:
+    virtual ~LogStorage() = default;
+
+    virtual bool begin() = 0;
+
+    virtual bool append(uint32_t segment, const uint8_t* data, size_t length) = 0;
+    virtual size_t read(uint32_t segment, size_t offset, uint8_t* data, size_t length) = 0;
+    virtual size_t segmentSize(uint32_t segment) = 0;
+    virtual bool removeSegment(uint32_t segment) = 0;
+
+    // Reports the oldest and newest existing segment; returns false when there are none
+    virtual bool findSegments(uint32_t& first, uint32_t& last) = 0;
+};
+
+#endif // LOG_STORAGE_H
@@ -0,0 +1,282 @@
+#include "MqttTransport.h"
+
+#ifdef ARDUINO_ARCH_ESP32
+#include <lwip/sockets.h>
+#else
+#include <arpa/inet.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <sys/select.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+#ifdef ARDUINO_ARCH_ESP32
+MqttTransport* MqttTransport::resolver = nullptr;
+#endif
+
+bool MqttTransport::beginResolve(const char* host) {
+    uint32_t generation = dnsGeneration.fetch_add(1) + 1;
+
+#ifdef ARDUINO_ARCH_ESP32
+    resolver = this;
+    ip_addr_t address;
+    err_t result = dns_gethostbyname(host, &address, onDnsFound, (void*)(uintptr_t)generation);
+
+    if (result == ERR_OK) {
+        // Cached entry or numeric address, resolved synchronously
+        completeResolve(generation, ip_2_ip4(&address)->addr, true);
+        return true;
+    }
+    return result == ERR_INPROGRESS;
+#else
+    // Numeric addresses skip the resolver, which allocates even for them
+    struct in_addr numeric;
+    if (inet_pton(AF_INET, host, &numeric) == 1) {
+        completeResolve(generation, numeric.s_addr, true);
+        return true;
+    }
+
+    struct addrinfo hints;
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_INET;
+    hints.ai_socktype = SOCK_STREAM;
+
+    struct addrinfo* result = nullptr;
+    if (getaddrinfo(host, nullptr, &hints, &result) != 0 || !result) {
+        return false;
+    }
+    completeResolve(generation, ((struct sockaddr_in*)result->ai_addr)->sin_addr.s_addr, true);
+    freeaddrinfo(result);
+    return true;
+#endif
+}
+
+MqttTransport::Progress MqttTransport::pollResolve() {
+    if (dnsCompletedGeneration.load(std::memory_order_acquire) != dnsGeneration.load()) {
+        return Progress::PENDING;
+    }
+    return dnsFailed ? Progress::FAILED : Progress::DONE;
+}
+
+void MqttTransport::completeResolve(uint32_t generation, uint32_t address, bool found) {
+    if (generation != dnsGeneration.load()) return; // Aborted, or superseded by a newer attempt
+
+    resolvedAddress = address;
+    dnsFailed = !found;
+    dnsCompletedGeneration.store(generation, std::memory_order_release);
+}
+
+bool MqttTransport::beginConnect(uint16_t port) {
+    abort();
+
+    pendingSocket = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+    if (pendingSocket < 0) return false;
+
+    fcntl(pendingSocket, F_SETFL, fcntl(pendingSocket, F_GETFL, 0) | O_NONBLOCK);
+
+    struct sockaddr_in address;
+    memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_port = htons(port);
+    address.sin_addr.s_addr = resolvedAddress;
+
+    int result = ::connect(pendingSocket, (struct sockaddr*)&address, sizeof(address));
+    if (result < 0 && errno != EINPROGRESS) {
+        close(pendingSocket);
+        pendingSocket = -1;
+        return false;
+    }
+    return true;
+}
+
+MqttTransport::Progress MqttTransport::pollConnect() {
+    if (pendingSocket < 0) return Progress::FAILED;
+
+    fd_set writeSet;
+    FD_ZERO(&writeSet);
+    FD_SET(pendingSocket, &writeSet);
+    struct timeval noWait = { 0, 0 };
+
+    int ready = select(pendingSocket + 1, nullptr, &writeSet, nullptr, &noWait);
+    if (ready == 0) return Progress::PENDING;
+
+    int socketError = 0;
+    socklen_t length = sizeof(socketError);
+    if (ready < 0 || getsockopt(pendingSocket, SOL_SOCKET, SO_ERROR, &socketError, &length) < 0 ||
+        socketError != 0) {
+        close(pendingSocket);
+        pendingSocket = -1;
+        return Progress::FAILED;
+    }
+
+    // Hand the established socket to WiFiClient for the rest of the session
+    client = WiFiClient(pendingSocket);
+    pendingSocket = -1;
+    resetFraming();
+    return Progress::DONE;
+}
+
+bool MqttTransport::sendConnect(const char* clientId, uint16_t keepAliveSeconds) {
+    // MQTT 3.1.1 CONNECT with clean session, byte-identical to what PubSubClient sends
+    size_t idLength = strlen(clientId);
+    if (idLength > 100) return false;
+
+    uint8_t packet[2 + 10 + 2 + 100];
+    size_t length = 0;
+    packet[length++] = 0x10;
+    packet[length++] = 10 + 2 + idLength;
+
+    const uint8_t variableHeader[] = { 0x00, 0x04, 'M', 'Q', 'T', 'T', 0x04, 0x02 };
+    memcpy(packet + length, variableHeader, sizeof(variableHeader));
+    length += sizeof(variableHeader);
+    packet[length++] = keepAliveSeconds >> 8;
+    packet[length++] = keepAliveSeconds & 0xFF;
+
+    packet[length++] = idLength >> 8;
+    packet[length++] = idLength & 0xFF;
+    memcpy(packet + length, clientId, idLength);
+    length += idLength;
+
+    return client.write(packet, length) == length;
+}
+
+MqttTransport::Progress MqttTransport::pollConnAck() {
+    // Fixed header 0x20 0x02, acknowledge flags (only session-present may be set), return code
+    while (connAckLength < sizeof(connAck)) {
+        if (client.available() <= 0) return Progress::PENDING;
+        int byte = client.read();
+        if (byte < 0) return Progress::PENDING;
+        connAck[connAckLength++] = byte;
+
+        bool valid = true;
+        switch (connAckLength) {
+            case 1: valid = byte == 0x20; break;
+            case 2: valid = byte == 0x02; break;
+            case 3: valid = (byte & 0xFE) == 0; break;
+            case 4: valid = byte == 0x00; break;
+        }
+        if (!valid) return Progress::FAILED;
+    }
+    connAckValid = true;
+    return Progress::DONE;
+}
+
+void MqttTransport::abort() {
+    dnsGeneration.fetch_add(1); // A lookup still in flight no longer belongs to any attempt
+    if (pendingSocket >= 0) {
+        close(pendingSocket);
+        pendingSocket = -1;
+    }
+    client.stop();
+    swallowNextWrite = false;
+    resetFraming();
+}
+
+int MqttTransport::connect(IPAddress ip, uint16_t port) {
+    resetFraming();
+    return client.connect(ip, port);
+}
+
+int MqttTransport::connect(const char* host, uint16_t port) {
+    resetFraming();
+    return client.connect(host, port);
+}
+
+size_t MqttTransport::write(uint8_t byte) {
+    return client.write(byte);
+}
+
+size_t MqttTransport::write(const uint8_t* buffer, size_t size) {
+    if (swallowNextWrite) {
+        // PubSubClient's own CONNECT; ours is already on the wire and acknowledged
+        swallowNextWrite = false;
+        return size;
+    }
+    return client.write(buffer, size);
+}
+
+int MqttTransport::read() {
+    if (pendingReplay() > 0) {
+        uint8_t byte = connAck[connAckReplayed++];
+        observe(byte);
+        return byte;
+    }
+    int byte = client.read();
+    if (byte >= 0) {
+        observe(byte);
+    }
+    return byte;
+}
+
+int MqttTransport::read(uint8_t* buffer, size_t size) {
+    size_t replayed = 0;
+    while (replayed < size && pendingReplay() > 0) {
+        buffer[replayed++] = connAck[connAckReplayed++];
+    }
+    int count = client.read(buffer + replayed, size - replayed);
+    if (count < 0) {
+        count = 0;
+        if (replayed == 0) return -1;
+    }
+    count += replayed;
+    for (int i = 0; i < count; i++) {
+        observe(buffer[i]);
+    }
+    return count;
+}
+
+void MqttTransport::stop() {
+    client.stop();
+    resetFraming();
+}
+
+void MqttTransport::resetFraming() {
+    frameState = FrameState::HEADER;
+    connAckLength = 0;
+    connAckReplayed = 0;
+    connAckValid = false;
+    subAckReceived = false;
+    subAckCode = 0;
+}
+
+void MqttTransport::observe(uint8_t byte) {
+    switch (frameState) {
+        case FrameState::HEADER:
+            packetType = byte >> 4;
+            remainingLength = 0;
+            lengthMultiplier = 1;
+            frameState = FrameState::LENGTH;
+            break;
+
+        case FrameState::LENGTH:
+            remainingLength += (byte & 0x7F) * lengthMultiplier;
+            lengthMultiplier *= 128;
+            if ((byte & 0x80) == 0) {
+                bodyIndex = 0;
+                frameState = remainingLength > 0 ? FrameState::BODY : FrameState::HEADER;
+            }
+            break;
+
+        case FrameState::BODY:
+            // SUBACK body: packet id (2 bytes) followed by the granted QoS or 0x80
+            if (packetType == 9 && bodyIndex == 2) {
+                subAckReceived = true;
+                subAckCode = byte;
+            }
+            if (++bodyIndex >= remainingLength) {
+                frameState = FrameState::HEADER;
+            }
+            break;
+    }
+}
+
+#ifdef ARDUINO_ARCH_ESP32
+void MqttTransport::onDnsFound(const char* name, const ip_addr_t* address, void* arg) {
+    if (resolver == nullptr) return;
+    uint32_t generation = (uint32_t)(uintptr_t)arg;
+    resolver->completeResolve(generation, address ? ip_2_ip4(address)->addr : 0, address != nullptr);
+}
+#endif
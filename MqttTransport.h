@@ -0,0 +1,106 @@
+#ifndef MQTT_TRANSPORT_H
+#define MQTT_TRANSPORT_H
+
+#include <Arduino.h>
+#include <WiFi.h>
+#include <atomic>
+
+#ifdef ARDUINO_ARCH_ESP32
+#include <lwip/dns.h>
+#endif
+
+/**
+ * @brief Non-blocking network transport for PubSubClient
+ *
+ * Wraps a WiFiClient and adds what PubSubClient cannot do without blocking:
+ * asynchronous DNS, a non-blocking TCP connect and a pre-sent MQTT CONNECT whose
+ * CONNACK can be polled. Every byte PubSubClient reads passes through here, so
+ * control packets such as SUBACK are observed on the way.
+ *
+ * Off target the same BSD socket calls run on the host stack and name resolution
+ * goes through getaddrinfo() (numeric addresses are parsed directly), which answers
+ * before beginResolve() returns.
+ */
+class MqttTransport : public Client {
+public:
+    enum class Progress {
+        PENDING,
+        DONE,
+        FAILED
+    };
+
+private:
+    WiFiClient client;
+    int pendingSocket = -1;
+
+    // Asynchronous DNS result, written from the lwIP thread. Every attempt gets a new
+    // generation; a late callback from an aborted attempt carries an older one and is ignored
+    std::atomic<uint32_t> dnsGeneration{0};
+    std::atomic<uint32_t> dnsCompletedGeneration{0};
+    volatile bool dnsFailed = false;
+    volatile uint32_t resolvedAddress = 0;
+#ifdef ARDUINO_ARCH_ESP32
+    static MqttTransport* resolver; // The lwIP callback argument is the generation, not the transport
+#endif
+
+    // CONNECT handshake: our pre-sent packet replaces the one PubSubClient writes, and the
+    // CONNACK we validated is replayed to it byte for byte
+    bool swallowNextWrite = false;
+    uint8_t connAck[4];
+    uint8_t connAckLength = 0;
+    uint8_t connAckReplayed = 0;
+    bool connAckValid = false;
+
+    // Inbound MQTT packet framing, used to spot SUBACK
+    enum class FrameState { HEADER, LENGTH, BODY };
+    FrameState frameState = FrameState::HEADER;
+    uint8_t packetType = 0;
+    uint32_t remainingLength = 0;
+    uint32_t lengthMultiplier = 1;
+    uint32_t bodyIndex = 0;
+    bool subAckReceived = false;
+    uint8_t subAckCode = 0;
+
+public:
+    MqttTransport() = default;
+
+    // Connection phases, each polled once per EdgeCommunication::update()
+    bool beginResolve(const char* host);
+    Progress pollResolve();
+    bool beginConnect(uint16_t port);
+    Progress pollConnect();
+    bool sendConnect(const char* clientId, uint16_t keepAliveSeconds);
+    Progress pollConnAck();
+    uint8_t getConnAckCode() const { return connAckLength == sizeof(connAck) ? connAck[3] : 0; }
+    void expectConnectWrite() { swallowNextWrite = true; }
+    bool hasSubAck() const { return subAckReceived; }
+    bool subAckGranted() const { return subAckReceived && subAckCode < 0x80; }
+    void abort();
+
+    // Client interface
+    int connect(IPAddress ip, uint16_t port) override;
+    int connect(const char* host, uint16_t port) override;
+    int connect(IPAddress ip, uint16_t port, int32_t timeout) { return connect(ip, port); }
+    int connect(const char* host, uint16_t port, int32_t timeout) { return connect(host, port); }
+    size_t write(uint8_t byte) override;
+    size_t write(const uint8_t* buffer, size_t size) override;
+    int available() override { return pendingReplay() + client.available(); }
+    int read() override;
+    int read(uint8_t* buffer, size_t size) override;
+    int peek() override { return pendingReplay() > 0 ? connAck[connAckReplayed] : client.peek(); }
+    void flush() override { client.flush(); }
+    void stop() override;
+    uint8_t connected() override { return client.connected(); }
+    operator bool() override { return client.connected(); }
+
+private:
+    void resetFraming();
+    int pendingReplay() const { return connAckValid ? connAckLength - connAckReplayed : 0; }
+    void observe(uint8_t byte);
+    void completeResolve(uint32_t generation, uint32_t address, bool found);
+#ifdef ARDUINO_ARCH_ESP32
+    static void onDnsFound(const char* name, const ip_addr_t* address, void* arg);
+#endif
+};
+
+#endif // MQTT_TRANSPORT_H
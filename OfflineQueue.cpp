@@ -0,0 +1,231 @@
+#include "OfflineQueue.h"
+
+static_assert(sizeof(OfflineQueue::Record) == 20, "OfflineQueue::Record layout must stay 20 bytes");
+
+OfflineQueue::OfflineQueue(LogStorage& storage) : storage(storage) {}
+
+bool OfflineQueue::begin() {
+    Serial.println("Initializing Offline Queue...");
+
+    if (!storage.begin()) {
+        Serial.println("Error: Offline queue storage unavailable");
+        return false;
+    }
+
+    // Rebuild bookkeeping from whatever survived the last reboot
+    uint32_t first;
+    uint32_t last;
+    storedRecords = 0;
+    if (storage.findSegments(first, last)) {
+        hasSegments = true;
+        headSegment = first;
+        tailSegment = last;
+        headIndex = 0;
+
+        for (uint32_t segment = first; segment <= last; segment++) {
+            storedRecords += segmentRecords(segment);
+        }
+        headRecords = segmentRecords(headSegment);
+        tailRecords = segmentRecords(tailSegment);
+
+        // A torn final write would misalign later appends; continue in a fresh segment
+        if (storage.segmentSize(tailSegment) % sizeof(Record) != 0) {
+            tailRecords = config.recordsPerSegment;
+        }
+    }
+
+    ready = true;
+
+    Serial.print("Offline Queue initialized, pending records: ");
+    Serial.println(storedRecords);
+    return true;
+}
+
+void OfflineQueue::update() {
+    if (buffered > 0 && millis() - firstBufferedTime >= FLUSH_INTERVAL) {
+        flush();
+    }
+}
+
+void OfflineQueue::setConfig(const Config& newConfig) {
+    config = newConfig;
+    if (config.recordsPerSegment == 0) config.recordsPerSegment = 1;
+    if (config.maxSegments < 2) config.maxSegments = 2;
+}
+
+bool OfflineQueue::push(const Record& record) {
+    if (!ready) {
+        droppedCount++;
+        return false;
+    }
+
+    if (buffered == 0) {
+        firstBufferedTime = millis();
+    }
+
+    Record& slot = writeBuffer[buffered++];
+    slot = record;
+    slot.checksum = computeChecksum(slot);
+
+    if (buffered == WRITE_BATCH) {
+        return flush();
+    }
+    return true;
+}
+
+bool OfflineQueue::flush() {
+    if (buffered == 0) return true;
+
+    bool success = writeRecords(writeBuffer, buffered);
+    buffered = 0;
+    return success;
+}
+
+size_t OfflineQueue::peek(Record* records, size_t maxRecords) {
+    flush();
+
+    size_t count = 0;
+    uint32_t segment = headSegment;
+    uint32_t index = headIndex;
+    uint32_t available = headRecords;
+
+    while (count < maxRecords && count < storedRecords) {
+        if (index >= available) {
+            if (segment == tailSegment) break;
+            segment++;
+            index = 0;
+            available = (segment == tailSegment) ? tailRecords : segmentRecords(segment);
+            continue;
+        }
+
+        size_t chunk = available - index;
+        if (chunk > maxRecords - count) chunk = maxRecords - count;
+
+        size_t bytes = storage.read(segment, index * sizeof(Record),
+                                    (uint8_t*)&records[count], chunk * sizeof(Record));
+        size_t readRecords = bytes / sizeof(Record);
+        if (readRecords == 0) break;
+
+        count += readRecords;
+        index += readRecords;
+    }
+
+    return count;
+}
+
+void OfflineQueue::pop(size_t count) {
+    while (count > 0 && storedRecords > 0) {
+        uint32_t inHead = headRecords - headIndex;
+        uint32_t step = count < inHead ? count : inHead;
+
+        headIndex += step;
+        storedRecords -= step;
+        forwardedCount += step;
+        count -= step;
+
+        if (headIndex >= headRecords) {
+            advanceHead();
+        }
+    }
+}
+
+bool OfflineQueue::isValid(const Record& record) {
+    return record.checksum == computeChecksum(record);
+}
+
+bool OfflineQueue::writeRecords(const Record* records, uint8_t count) {
+    uint8_t written = 0;
+
+    while (written < count) {
+        if (!hasSegments || tailRecords >= config.recordsPerSegment) {
+            if (!openNewSegment()) {
+                droppedCount += count - written;
+                return false;
+            }
+        }
+
+        uint8_t chunk = count - written;
+        if (chunk > config.recordsPerSegment - tailRecords) {
+            chunk = config.recordsPerSegment - tailRecords;
+        }
+
+        if (!storage.append(tailSegment, (const uint8_t*)&records[written], chunk * sizeof(Record))) {
+            writeErrorCount++;
+            droppedCount += count - written;
+            return false;
+        }
+
+        tailRecords += chunk;
+        storedRecords += chunk;
+        if (headSegment == tailSegment) {
+            headRecords = tailRecords;
+        }
+        written += chunk;
+    }
+
+    return true;
+}
+
+bool OfflineQueue::openNewSegment() {
+    if (!hasSegments) {
+        hasSegments = true;
+        headSegment = tailSegment = tailSegment + 1;
+        headRecords = headIndex = tailRecords = 0;
+        return true;
+    }
+
+    if (tailSegment - headSegment + 1 >= config.maxSegments) {
+        if (config.policy == EvictionPolicy::DROP_NEWEST) {
+            return false;
+        }
+        evictOldestSegment();
+    }
+
+    tailSegment++;
+    tailRecords = 0;
+    return true;
+}
+
+void OfflineQueue::evictOldestSegment() {
+    uint32_t remaining = headRecords - headIndex;
+    droppedCount += remaining;
+    storedRecords -= remaining;
+
+    storage.removeSegment(headSegment);
+    headSegment++;
+    headIndex = 0;
+    headRecords = (headSegment == tailSegment) ? tailRecords : segmentRecords(headSegment);
+}
+
+void OfflineQueue::advanceHead() {
+    storage.removeSegment(headSegment);
+
+    if (headSegment == tailSegment) {
+        // Everything forwarded; the next write starts a new segment
+        hasSegments = false;
+        headRecords = headIndex = tailRecords = 0;
+        return;
+    }
+
+    headSegment++;
+    headIndex = 0;
+    headRecords = (headSegment == tailSegment) ? tailRecords : segmentRecords(headSegment);
+}
+
+uint32_t OfflineQueue::segmentRecords(uint32_t segment) {
+    return storage.segmentSize(segment) / sizeof(Record);
+}
+
+uint16_t OfflineQueue::computeChecksum(const Record& record) {
+    // Fletcher-16 over every byte except the checksum field itself
+    const uint8_t* bytes = (const uint8_t*)&record;
+    uint16_t sum1 = 0;
+    uint16_t sum2 = 0;
+
+    for (size_t i = 0; i < sizeof(Record); i++) {
+        if (i == offsetof(Record, checksum) || i == offsetof(Record, checksum) + 1) continue;
+        sum1 = (sum1 + bytes[i]) % 255;
+        sum2 = (sum2 + sum1) % 255;
+    }
+    return (sum2 << 8) | sum1;
+}
@@ -0,0 +1,104 @@
+#ifndef OFFLINE_QUEUE_H
+#define OFFLINE_QUEUE_H
+
+#include <Arduino.h>
+#include "LogStorage.h"
+
+/**
+ * @brief Persistent store-and-forward queue for telemetry that could not be sent
+ *
+ * Records are appended to fixed-size segments in a LogStorage backend. Writes are
+ * batched in RAM to limit flash wear, segments are never rewritten, and a fully
+ * forwarded segment is deleted as a whole. When the configured segment budget is
+ * exhausted the eviction policy decides whether the oldest data or the newest record
+ * is dropped. Delivery is at-least-once: a partially forwarded segment is resent
+ * after a reboot.
+ */
+class OfflineQueue {
+public:
+    enum RecordKind : uint8_t {
+        WEIGHT_SAMPLE = 1,
+        LOAD_EVENT = 2
+    };
+
+    enum class EvictionPolicy {
+        DROP_OLDEST, // Keep the most recent history
+        DROP_NEWEST  // Keep the oldest history, refuse new records
+    };
+
+    // Stored verbatim, 20 bytes per record
+    struct Record {
+        uint8_t kind;
+        uint8_t eventType;      // LOAD_EVENT only
+        uint16_t checksum;
+        uint32_t timestamp;
+        float value;
+        float delta;            // LOAD_EVENT only
+        uint32_t settleTime;    // LOAD_EVENT only
+    };
+
+    struct Config {
+        uint16_t recordsPerSegment = 128;
+        uint8_t maxSegments = 16; // 16 x 128 x 20 B = 40 KB of flash
+        EvictionPolicy policy = EvictionPolicy::DROP_OLDEST;
+    };
+
+private:
+    LogStorage& storage;
+    Config config;
+    bool ready = false;
+
+    // RAM write buffer, flushed when full or after FLUSH_INTERVAL
+    static const uint8_t WRITE_BATCH = 8;
+    static const unsigned long FLUSH_INTERVAL = 5000;
+    Record writeBuffer[WRITE_BATCH];
+    uint8_t buffered = 0;
+    unsigned long firstBufferedTime = 0;
+
+    // Segment bookkeeping
+    bool hasSegments = false;
+    uint32_t headSegment = 0;  // Oldest segment, read side
+    uint32_t tailSegment = 0;  // Newest segment, write side
+    uint32_t headRecords = 0;  // Records stored in the head segment
+    uint32_t headIndex = 0;    // Records already forwarded from the head segment
+    uint32_t tailRecords = 0;  // Records stored in the tail segment
+    uint32_t storedRecords = 0;
+
+    // Statistics
+    uint32_t droppedCount = 0;
+    uint32_t forwardedCount = 0;
+    uint32_t writeErrorCount = 0;
+
+public:
+    explicit OfflineQueue(LogStorage& storage);
+
+    bool begin();
+    void update();
+    void setConfig(const Config& newConfig);
+
+    // Producer side
+    bool push(const Record& record);
+    bool flush();
+
+    // Drain side: peek() returns the oldest records, pop() discards them once forwarded
+    size_t peek(Record* records, size_t maxRecords);
+    void pop(size_t count);
+    static bool isValid(const Record& record);
+
+    uint32_t size() const { return storedRecords + buffered; }
+    bool isEmpty() const { return size() == 0; }
+    bool isReady() const { return ready; }
+    uint32_t getDroppedCount() const { return droppedCount; }
+    uint32_t getForwardedCount() const { return forwardedCount; }
+    uint32_t getWriteErrorCount() const { return writeErrorCount; }
+
+private:
+    bool writeRecords(const Record* records, uint8_t count);
+    bool openNewSegment();
+    void evictOldestSegment();
+    void advanceHead();
+    uint32_t segmentRecords(uint32_t segment);
+    static uint16_t computeChecksum(const Record& record);
+};
+
+#endif // OFFLINE_QUEUE_H
@@ -0,0 +1,151 @@
+#include "PowerManager.h"
+#include <WiFi.h>
+#include "LatencyHistogram.h"
+#include "DeferredLog.h"
+
+// Indexed by Profile. WiFi needs at least 80 MHz.
+static const PowerManager::ProfileSettings PROFILE_SETTINGS[PowerManager::PROFILE_COUNT] = {
+    { 240, false, false, 0 },    // PERFORMANCE
+    { 160, true,  false, 0 },    // BALANCED
+    { 80,  true,  true,  1000 }  // ECO
+};
+
+PowerManager::PowerManager(WeightSensor& weightSensor) : weightSensor(weightSensor) {}
+
+void PowerManager::begin() {
+#if defined(ARDUINO_ARCH_ESP32) && CONFIG_PM_ENABLE
+    // Without the lock a conversion finishing during light sleep would go unserviced
+    lightSleepAvailable = esp_pm_lock_create(ESP_PM_NO_LIGHT_SLEEP, 0, "hx711", &converterLock) == ESP_OK;
+#endif
+    weightSensor.setPowerHandler(onSensorPower, this);
+    blockLightSleep(!weightSensor.isPoweredDown());
+    Serial.print("Power management: automatic light sleep ");
+    Serial.println(lightSleepAvailable ? "available" : "not available in this build");
+    apply(currentProfile);
+}
+
+void PowerManager::update() {
+    // Attribute every completed sensor wake to the profile that caused it
+    uint32_t wakes = weightSensor.getWakeCount();
+    if (wakes != seenSensorWakes) {
+        seenSensorWakes = wakes;
+        ProfileStats& profileStats = stats[(uint8_t)currentProfile];
+        uint32_t latency = weightSensor.getLastWakeLatency();
+        profileStats.sensorWakes++;
+        profileStats.lastWakeLatencyUs = latency;
+        if (latency > profileStats.maxWakeLatencyUs) {
+            profileStats.maxWakeLatencyUs = latency;
+        }
+    }
+}
+
+void PowerManager::apply(Profile profile) {
+    if (applied && profile == currentProfile) return;
+
+    if (applied) {
+        accountActiveTime();
+    }
+
+    const ProfileSettings& settings = settingsFor(profile);
+    configureClock(settings);
+#if TAVOLO_PROFILING
+    LatencyProbe::setCpuFrequency(settings.cpuMhz);
+#endif
+#ifdef ARDUINO_ARCH_ESP32
+    WiFi.setSleep(settings.modemSleep);
+#endif
+    weightSensor.setDutyCycle(settings.sensorSleepMs);
+
+    currentProfile = profile;
+    applied = true;
+    profileSince = millis();
+    stats[(uint8_t)profile].activations++;
+
+    TAVOLO_LOG_INFO(LOG_POWER, "Power profile: %s (%u MHz)", profileToString(profile), settings.cpuMhz);
+}
+
+void PowerManager::configureClock(const ProfileSettings& settings) {
+#ifdef ARDUINO_ARCH_ESP32
+#if CONFIG_PM_ENABLE
+    // Let the power management driver scale the clock and enter light sleep when idle
+#if ESP_IDF_VERSION_MAJOR >= 5
+    esp_pm_config_t config = {};
+#else
+    esp_pm_config_esp32_t config = {};
+#endif
+    config.max_freq_mhz = settings.cpuMhz;
+    config.min_freq_mhz = settings.lightSleep ? 40 : settings.cpuMhz;
+    config.light_sleep_enable = settings.lightSleep && lightSleepAvailable;
+    if (esp_pm_configure(&config) == ESP_OK) return;
+#endif
+    setCpuFrequencyMhz(settings.cpuMhz);
+#endif
+}
+
+// GPIO wakeup would need a level-triggered DRDY interrupt, which with several cells
+// sharing SCK fires repeatedly until the slowest one is ready. The lock is simpler:
+// light sleep only happens between duty-cycle wakes, when the converter is off.
+void PowerManager::blockLightSleep(bool block) {
+    if (block == lightSleepBlocked) return;
+    lightSleepBlocked = block;
+#if defined(ARDUINO_ARCH_ESP32) && CONFIG_PM_ENABLE
+    if (converterLock != nullptr) {
+        if (block) {
+            esp_pm_lock_acquire(converterLock);
+        } else {
+            esp_pm_lock_release(converterLock);
+        }
+    }
+#endif
+}
+
+void PowerManager::onSensorPower(void* context, bool poweredDown) {
+    static_cast<PowerManager*>(context)->blockLightSleep(!poweredDown);
+}
+
+void PowerManager::accountActiveTime() {
+    stats[(uint8_t)currentProfile].activeMs += millis() - profileSince;
+    profileSince = millis();
+}
+
+const PowerManager::ProfileSettings& PowerManager::settingsFor(Profile profile) {
+    return PROFILE_SETTINGS[(uint8_t)profile];
+}
+
+const char* PowerManager::profileToString(Profile profile) {
+    switch (profile) {
+        case Profile::PERFORMANCE: return "PERFORMANCE";
+        case Profile::BALANCED: return "BALANCED";
+        case Profile::ECO: return "ECO";
+        default: return "UNKNOWN";
+    }
+}
+
+void PowerManager::printStats(Print& out) {
+    accountActiveTime();
+
+    out.println("=== POWER PROFILES ===");
+    out.print("Current: ");
+    out.println(profileToString(currentProfile));
+    out.print("Light sleep: ");
+    out.println(!lightSleepAvailable ? "unavailable" : lightSleepBlocked ? "held off, HX711 powered" : "allowed");
+    for (uint8_t i = 0; i < PROFILE_COUNT; i++) {
+        const ProfileSettings& settings = PROFILE_SETTINGS[i];
+        const ProfileStats& profileStats = stats[i];
+        out.print(profileToString((Profile)i));
+        out.print(": ");
+        out.print(settings.cpuMhz);
+        out.print("MHz sensorSleep=");
+        out.print(settings.sensorSleepMs);
+        out.print("ms active=");
+        out.print(profileStats.activeMs / 1000);
+        out.print("s wakes=");
+        out.print(profileStats.sensorWakes);
+        out.print(" wakeLatency last/max=");
+        out.print(profileStats.lastWakeLatencyUs);
+        out.print("/");
+        out.print(profileStats.maxWakeLatencyUs);
+        out.println("us");
+    }
+    out.println("======================");
+}
@@ -0,0 +1,80 @@
+#ifndef POWER_MANAGER_H
+#define POWER_MANAGER_H
+
+#include <Arduino.h>
+#include "WeightSensor.h"
+
+#ifdef ARDUINO_ARCH_ESP32
+#include <esp_pm.h>
+#endif
+
+/**
+ * @brief Applies power profiles chosen by the system state machine
+ *
+ * A profile sets the CPU clock, WiFi modem sleep, automatic light sleep (only when
+ * the core is built with power management) and HX711 duty cycling. Light sleep is
+ * held off whenever the HX711 is powered: its DRDY falling edge is an edge interrupt,
+ * which cannot wake the chip. For each profile
+ * the wake-to-first-valid-sample latency of the sensor is recorded, so the energy
+ * saved can be weighed against how late a new load is noticed.
+ */
+class PowerManager {
+public:
+    enum class Profile : uint8_t {
+        PERFORMANCE,  // Full clock, sensor always on
+        BALANCED,     // Reduced clock and modem sleep, sensor always on
+        ECO           // Minimum clock, light sleep, sensor duty cycled
+    };
+
+    static const uint8_t PROFILE_COUNT = 3;
+
+    struct ProfileSettings {
+        uint16_t cpuMhz;
+        bool modemSleep;
+        bool lightSleep;
+        unsigned long sensorSleepMs; // HX711 powered down between checks; 0 keeps it on
+    };
+
+    struct ProfileStats {
+        uint32_t activations = 0;
+        uint32_t sensorWakes = 0;
+        uint32_t lastWakeLatencyUs = 0;
+        uint32_t maxWakeLatencyUs = 0;
+        unsigned long activeMs = 0;
+    };
+
+private:
+    WeightSensor& weightSensor;
+    Profile currentProfile = Profile::PERFORMANCE;
+    bool applied = false;
+    unsigned long profileSince = 0;
+    uint32_t seenSensorWakes = 0;
+    bool lightSleepAvailable = false;
+    bool lightSleepBlocked = false;
+#if defined(ARDUINO_ARCH_ESP32) && CONFIG_PM_ENABLE
+    esp_pm_lock_handle_t converterLock = nullptr; // ESP_PM_NO_LIGHT_SLEEP
+#endif
+    ProfileStats stats[PROFILE_COUNT];
+
+public:
+    explicit PowerManager(WeightSensor& weightSensor);
+
+    void begin();
+    void update();
+
+    void apply(Profile profile);
+    Profile getProfile() const { return currentProfile; }
+    static const ProfileSettings& settingsFor(Profile profile);
+    static const char* profileToString(Profile profile);
+    const ProfileStats& getStats(Profile profile) const { return stats[(uint8_t)profile]; }
+    bool isLightSleepBlocked() const { return lightSleepBlocked; } // The HX711 is powered
+    void printStats(Print& out);
+
+private:
+    void configureClock(const ProfileSettings& settings);
+    void accountActiveTime();
+    void blockLightSleep(bool block);
+    static void onSensorPower(void* context, bool poweredDown);
+};
+
+#endif // POWER_MANAGER_H
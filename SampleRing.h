@@ -0,0 +1,61 @@
+#ifndef SAMPLE_RING_H
+#define SAMPLE_RING_H
+
+#include <Arduino.h>
+#include <atomic>
+
+/**
+ * @brief Fixed-size single-producer/single-consumer ring buffer
+ *
+ * Lock-free: the producer only advances head and the consumer only advances tail,
+ * so push() may run inside an ISR while pop() runs in the main loop.
+ * Capacity must be a power of two; head and tail are free-running counters,
+ * so all Capacity slots are usable.
+ */
+template <typename T, size_t Capacity>
+class SampleRing {
+    static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0,
+                  "SampleRing capacity must be a power of two");
+
+private:
+    T buffer[Capacity];
+    std::atomic<uint32_t> head{0}; // Next slot to write (producer)
+    std::atomic<uint32_t> tail{0}; // Next slot to read (consumer)
+
+public:
+    // Producer side - returns false when the ring is full
+    bool push(const T& item) {
+        uint32_t currentHead = head.load(std::memory_order_relaxed);
+        if (currentHead - tail.load(std::memory_order_acquire) >= Capacity) {
+            return false;
+        }
+        buffer[currentHead & (Capacity - 1)] = item;
+        head.store(currentHead + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer side - returns false when the ring is empty
+    bool pop(T& item) {
+        uint32_t currentTail = tail.load(std::memory_order_relaxed);
+        if (currentTail == head.load(std::memory_order_acquire)) {
+            return false;
+        }
+        item = buffer[currentTail & (Capacity - 1)];
+        tail.store(currentTail + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer side - discards everything currently queued
+    void clear() {
+        tail.store(head.load(std::memory_order_acquire), std::memory_order_release);
+    }
+
+    size_t size() const {
+        return head.load(std::memory_order_acquire) - tail.load(std::memory_order_acquire);
+    }
+
+    bool isEmpty() const { return size() == 0; }
+    static constexpr size_t capacity() { return Capacity; }
+};
+
+#endif // SAMPLE_RING_H
@@ -0,0 +1,305 @@
+#include "Scheduler.h"
+
+#ifdef ARDUINO_ARCH_ESP32
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <esp_timer.h>
+
+static void onSleepTimer(void* arg) {
+    xTaskNotifyGive((TaskHandle_t)arg);
+}
+
+void SystemClock::sleep(uint32_t durationUs) {
+    if (!waitingTask) {
+        waitingTask = xTaskGetCurrentTaskHandle();
+        esp_timer_create_args_t args = {};
+        args.callback = onSleepTimer;
+        args.arg = waitingTask;
+        args.name = "scheduler";
+        esp_timer_create(&args, (esp_timer_handle_t*)&timer);
+    }
+
+    esp_timer_start_once((esp_timer_handle_t)timer, durationUs);
+    ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(durationUs / 1000 + 10));
+    esp_timer_stop((esp_timer_handle_t)timer); // No-op unless woken early
+}
+
+void SystemClock::wake() {
+    if (!waitingTask) return;
+
+    if (xPortInIsrContext()) {
+        BaseType_t higherPriorityWoken = pdFALSE;
+        vTaskNotifyGiveFromISR((TaskHandle_t)waitingTask, &higherPriorityWoken);
+        if (higherPriorityWoken) {
+            portYIELD_FROM_ISR();
+        }
+    } else {
+        xTaskNotifyGive((TaskHandle_t)waitingTask);
+    }
+}
+#else
+void SystemClock::sleep(uint32_t durationUs) {
+    delayMicroseconds(durationUs);
+}
+
+void SystemClock::wake() {}
+#endif
+
+Scheduler::Scheduler() : Scheduler(systemClock) {}
+
+Scheduler::Scheduler(SchedulerClock& clock) : clock(clock), signaled(0), wakeRequested(false) {}
+
+Scheduler::TaskId Scheduler::addPeriodic(const char* name, unsigned long periodMs,
+                                         std::function<void()> callback, unsigned long firstDelayMs) {
+    TaskId id = allocate(name, callback);
+    if (id != INVALID_TASK) {
+        tasks[id].periodUs = periodMs * 1000;
+        schedule(id, firstDelayMs);
+    }
+    return id;
+}
+
+Scheduler::TaskId Scheduler::addOneShot(const char* name, unsigned long delayMs, std::function<void()> callback) {
+    TaskId id = allocate(name, callback);
+    if (id != INVALID_TASK) {
+        schedule(id, delayMs);
+    }
+    return id;
+}
+
+Scheduler::TaskId Scheduler::addEvent(const char* name, std::function<void()> callback) {
+    TaskId id = allocate(name, callback);
+    if (id != INVALID_TASK) {
+        tasks[id].eventDriven = true;
+    }
+    return id;
+}
+
+Scheduler::TaskId Scheduler::allocate(const char* name, std::function<void()> callback) {
+    for (uint8_t i = 0; i < MAX_TASKS; i++) {
+        if (!tasks[i].used) {
+            tasks[i] = Task();
+            tasks[i].used = true;
+            tasks[i].name = name;
+            tasks[i].callback = callback;
+            return i;
+        }
+    }
+    Serial.print("Scheduler full, cannot add task: ");
+    Serial.println(name);
+    return INVALID_TASK;
+}
+
+void Scheduler::remove(TaskId id) {
+    if (id < 0 || id >= MAX_TASKS || !tasks[id].used) return;
+    cancel(id);
+    signaled.fetch_and(~(1u << id));
+    tasks[id] = Task();
+}
+
+void Scheduler::schedule(TaskId id, unsigned long delayMs) {
+    scheduleMicros(id, delayMs * 1000);
+}
+
+void Scheduler::scheduleMicros(TaskId id, uint32_t delayUs) {
+    if (id < 0 || id >= MAX_TASKS || !tasks[id].used) return;
+    heapRemove(id);
+    tasks[id].deadline = clock.now() + delayUs;
+    heapPush(id);
+}
+
+void Scheduler::cancel(TaskId id) {
+    if (id < 0 || id >= MAX_TASKS) return;
+    heapRemove(id);
+}
+
+void Scheduler::setPeriod(TaskId id, unsigned long periodMs) {
+    if (id < 0 || id >= MAX_TASKS || !tasks[id].used) return;
+    tasks[id].periodUs = periodMs * 1000;
+}
+
+bool Scheduler::isScheduled(TaskId id) const {
+    return id >= 0 && id < MAX_TASKS && tasks[id].heapIndex >= 0;
+}
+
+void Scheduler::signal(TaskId id) {
+    if (id < 0 || id >= MAX_TASKS) return;
+    signaled.fetch_or(1u << id);
+    clock.wake();
+}
+
+void Scheduler::wake() {
+    wakeRequested.store(true);
+    clock.wake();
+}
+
+void Scheduler::runDue() {
+    // Event tasks first: they exist because something is waiting on them
+    uint32_t pending = signaled.exchange(0);
+    for (uint8_t id = 0; pending != 0; id++, pending >>= 1) {
+        if ((pending & 1) && tasks[id].used) {
+            run(tasks[id], 0, false);
+        }
+    }
+
+    while (heapSize > 0) {
+        uint32_t now = clock.now();
+        Task& task = tasks[heap[0]];
+        if (before(now, task.deadline)) break;
+
+        uint32_t deadline = task.deadline;
+        heapRemove(heap[0]);
+
+        // Re-arm before running so the callback may cancel or reschedule itself
+        if (task.periodUs > 0) {
+            task.deadline = deadline + task.periodUs;
+            if (!before(now, task.deadline)) {
+                task.deadline = now + task.periodUs; // Fell behind: skip missed runs
+            }
+            heapPush(&task - tasks);
+        }
+
+        run(task, deadline, true);
+    }
+}
+
+void Scheduler::run(Task& task, uint32_t deadline, bool timed) {
+    if (timed) {
+        uint32_t latency = clock.now() - deadline;
+        stats.lastLatencyUs = latency;
+        stats.totalLatencyUs += latency;
+        stats.timedRuns++;
+        if (latency > stats.maxLatencyUs) stats.maxLatencyUs = latency;
+        if (latency > task.maxLatencyUs) task.maxLatencyUs = latency;
+    }
+
+    task.runs++;
+    stats.tasksRun++;
+    if (task.callback) {
+        task.callback();
+    }
+}
+
+uint32_t Scheduler::timeUntilNext() {
+    if (signaled.load() != 0) return 0;
+    if (heapSize == 0) return MAX_SLEEP_US;
+
+    int32_t remaining = (int32_t)(tasks[heap[0]].deadline - clock.now());
+    if (remaining <= 0) return 0;
+    return (uint32_t)remaining < MAX_SLEEP_US ? remaining : MAX_SLEEP_US;
+}
+
+void Scheduler::waitForNext() {
+    uint32_t duration = timeUntilNext();
+    if (duration == 0 || wakeRequested.exchange(false)) return;
+
+    uint32_t start = clock.now();
+    clock.sleep(duration);
+    uint32_t slept = clock.now() - start;
+
+    stats.wakeups++;
+    stats.sleptUs += slept;
+    if (slept < duration && (signaled.load() != 0 || wakeRequested.load())) {
+        stats.earlyWakeups++;
+    }
+    wakeRequested.store(false);
+}
+
+void Scheduler::resetStatistics() {
+    stats = Statistics();
+    for (uint8_t i = 0; i < MAX_TASKS; i++) {
+        tasks[i].runs = 0;
+        tasks[i].maxLatencyUs = 0;
+    }
+}
+
+void Scheduler::printStatistics(Print& out) const {
+    out.println("=== SCHEDULER ===");
+    for (uint8_t i = 0; i < MAX_TASKS; i++) {
+        const Task& task = tasks[i];
+        if (!task.used) continue;
+        out.print(task.name);
+        out.print(": ");
+        if (task.periodUs > 0) {
+            out.print(task.periodUs / 1000);
+            out.print("ms");
+        } else {
+            out.print(task.eventDriven ? "event" : "one-shot");
+        }
+        out.print(" runs=");
+        out.print(task.runs);
+        out.print(" maxLatency=");
+        out.print(task.maxLatencyUs);
+        out.println("us");
+    }
+    out.print("Wakeups: ");
+    out.print(stats.wakeups);
+    out.print(" (early ");
+    out.print(stats.earlyWakeups);
+    out.print("), slept ");
+    out.print((unsigned long)(stats.sleptUs / 1000));
+    out.println("ms");
+    out.print("Latency last/avg/max: ");
+    out.print(stats.lastLatencyUs);
+    out.print("/");
+    out.print(stats.timedRuns > 0 ? (unsigned long)(stats.totalLatencyUs / stats.timedRuns) : 0UL);
+    out.print("/");
+    out.print(stats.maxLatencyUs);
+    out.println("us");
+    out.println("=================");
+}
+
+void Scheduler::heapPush(uint8_t id) {
+    uint8_t index = heapSize++;
+    heap[index] = id;
+    tasks[id].heapIndex = index;
+    siftUp(index);
+}
+
+void Scheduler::heapRemove(uint8_t id) {
+    int8_t index = tasks[id].heapIndex;
+    if (index < 0) return;
+
+    tasks[id].heapIndex = -1;
+    heapSize--;
+    if (index == heapSize) return;
+
+    heap[index] = heap[heapSize];
+    tasks[heap[index]].heapIndex = index;
+    siftUp(index);
+    siftDown(tasks[heap[index]].heapIndex);
+}
+
+void Scheduler::siftUp(uint8_t index) {
+    while (index > 0) {
+        uint8_t parent = (index - 1) / 2;
+        if (!before(tasks[heap[index]].deadline, tasks[heap[parent]].deadline)) break;
+        swapNodes(index, parent);
+        index = parent;
+    }
+}
+
+void Scheduler::siftDown(uint8_t index) {
+    while (true) {
+        uint8_t smallest = index;
+        uint8_t left = 2 * index + 1;
+        uint8_t right = left + 1;
+        if (left < heapSize && before(tasks[heap[left]].deadline, tasks[heap[smallest]].deadline)) {
+            smallest = left;
+        }
+        if (right < heapSize && before(tasks[heap[right]].deadline, tasks[heap[smallest]].deadline)) {
+            smallest = right;
+        }
+        if (smallest == index) break;
+        swapNodes(index, smallest);
+        index = smallest;
+    }
+}
+
+void Scheduler::swapNodes(uint8_t a, uint8_t b) {
+    uint8_t id = heap[a];
+    heap[a] = heap[b];
+    heap[b] = id;
+    tasks[heap[a]].heapIndex = a;
+    tasks[heap[b]].heapIndex = b;
+}
@@ -0,0 +1,131 @@
+#ifndef SCHEDULER_H
+#define SCHEDULER_H
+
+#include <Arduino.h>
+#include <atomic>
+#include <functional>
+
+/**
+ * @brief Time source and sleep primitive used by the Scheduler
+ *
+ * Abstracted so the scheduler can run against a virtual clock on a host. sleep()
+ * may return early when wake() is called, from a task or an ISR.
+ */
+class SchedulerClock {
+public:
+    virtual ~SchedulerClock() = default;
+    virtual uint32_t now() = 0;                 // Microseconds, free-running
+    virtual void sleep(uint32_t durationUs) = 0;
+    virtual void wake() {}
+};
+
+/**
+ * @brief Clock backed by micros(); on ESP32 the loop task blocks on a task
+ * notification armed by a one-shot esp_timer, so it sleeps exactly until the
+ * deadline instead of to the next RTOS tick. Elsewhere sleep() is
+ * delayMicroseconds(), so a host Arduino shim with a virtual clock skips
+ * straight to the next deadline.
+ */
+class SystemClock : public SchedulerClock {
+private:
+    void* waitingTask = nullptr;
+    void* timer = nullptr;
+
+public:
+    uint32_t now() override { return micros(); }
+    void sleep(uint32_t durationUs) override;
+    void wake() override;
+};
+
+/**
+ * @brief Tickless deadline scheduler
+ *
+ * Tasks are periodic, one-shot or event-driven. Pending deadlines live in a binary
+ * min-heap, so finding the next one is O(1) and rescheduling O(log n). runDue()
+ * executes signaled and expired tasks; waitForNext() sleeps until the earliest
+ * deadline or until signal()/wake() is called. A periodic task that falls more than
+ * a period behind skips the missed runs instead of bursting.
+ */
+class Scheduler {
+public:
+    typedef int8_t TaskId;
+    static const TaskId INVALID_TASK = -1;
+    static const uint8_t MAX_TASKS = 16;
+    static const uint32_t MAX_SLEEP_US = 1000000; // Upper bound when nothing is scheduled
+
+    struct Statistics {
+        uint32_t wakeups = 0;        // Returns from waitForNext()
+        uint32_t earlyWakeups = 0;   // Woken by signal()/wake() before the deadline
+        uint32_t tasksRun = 0;
+        uint32_t lastLatencyUs = 0;  // Task start minus its deadline
+        uint32_t maxLatencyUs = 0;
+        uint64_t totalLatencyUs = 0;
+        uint32_t timedRuns = 0;      // Runs that had a deadline (latency samples)
+        uint64_t sleptUs = 0;
+    };
+
+private:
+    struct Task {
+        std::function<void()> callback;
+        const char* name = nullptr;
+        uint32_t deadline = 0;
+        uint32_t periodUs = 0;  // 0 = one-shot or event task
+        int8_t heapIndex = -1;  // Position in the heap, -1 when not scheduled
+        bool used = false;
+        bool eventDriven = false;
+        uint32_t runs = 0;
+        uint32_t maxLatencyUs = 0;
+    };
+
+    SystemClock systemClock;  // Per instance: it remembers the task that sleeps on it
+    SchedulerClock& clock;
+    Task tasks[MAX_TASKS];
+    uint8_t heap[MAX_TASKS];
+    uint8_t heapSize = 0;
+    std::atomic<uint32_t> signaled;
+    std::atomic<bool> wakeRequested;
+    Statistics stats;
+
+public:
+    Scheduler();
+    explicit Scheduler(SchedulerClock& clock);
+
+    // Registration; intervals in milliseconds like the rest of the system
+    TaskId addPeriodic(const char* name, unsigned long periodMs, std::function<void()> callback,
+                       unsigned long firstDelayMs = 0);
+    TaskId addOneShot(const char* name, unsigned long delayMs, std::function<void()> callback);
+    TaskId addEvent(const char* name, std::function<void()> callback);
+    void remove(TaskId id);
+
+    // Deadline control
+    void schedule(TaskId id, unsigned long delayMs);   // (Re)arm, also for periodic tasks
+    void scheduleMicros(TaskId id, uint32_t delayUs);
+    void cancel(TaskId id);                            // Disarm but keep registered
+    void setPeriod(TaskId id, unsigned long periodMs);
+    bool isScheduled(TaskId id) const;
+
+    // External wakeups, safe from ISRs and other tasks
+    void signal(TaskId id);
+    void wake();
+
+    // Main loop
+    void runDue();
+    void waitForNext();
+    uint32_t timeUntilNext();
+
+    const Statistics& getStatistics() const { return stats; }
+    void resetStatistics();
+    void printStatistics(Print& out) const;
+
+private:
+    TaskId allocate(const char* name, std::function<void()> callback);
+    void run(Task& task, uint32_t deadline, bool timed);
+    static bool before(uint32_t a, uint32_t b) { return (int32_t)(a - b) < 0; }
+    void heapPush(uint8_t id);
+    void heapRemove(uint8_t id);
+    void siftUp(uint8_t index);
+    void siftDown(uint8_t index);
+    void swapNodes(uint8_t a, uint8_t b);
+};
+
+#endif // SCHEDULER_H
@@ -2,12 +2,21 @@
 
 Sensor::Sensor(int sensorPin) : pin(sensorPin) {}
 
-void Sensor::setOnDataCallback(std::function<void(float)> callback) {
-    onDataCallback = callback;
+void Sensor::notifyDataReady(float data) {
+    if (eventBus) {
+        eventBus->publish(dataTopic, 0, data);
+    }
 }
 
-void Sensor::notifyDataReady(float data) {
-    if (onDataCallback) {
-        onDataCallback(data);
+void Sensor::notifyEvent(const SensorEvent& event) {
+    if (eventBus) {
+        EventBus::Event busEvent = {};
+        busEvent.topic = eventTopic;
+        busEvent.code = event.type;
+        busEvent.value = event.value;
+        busEvent.delta = event.delta;
+        busEvent.duration = event.settleTime;
+        busEvent.timestamp = event.timestamp;
+        eventBus->publish(busEvent);
     }
 }
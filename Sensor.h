@@ -2,7 +2,7 @@
 #define SENSOR_H
 
 #include <Arduino.h>
-#include <functional>
+#include "EventBus.h"
 
 /**
  * @brief Abstract base class for all sensors following the Interface Segregation Principle
@@ -11,10 +11,22 @@
  * It follows the Single Responsibility Principle by focusing only on sensor operations.
  */
 class Sensor {
+public:
+    // Discrete event derived from the sample stream; type codes are defined by each sensor
+    struct SensorEvent {
+        uint8_t type;
+        float value;              // Reading at the time of the event
+        float delta;              // Change that produced the event
+        unsigned long settleTime; // ms from first disturbance to settled reading
+        unsigned long timestamp;
+    };
+
 protected:
     int pin;
     bool initialized = false;
-    std::function<void(float)> onDataCallback = nullptr;
+    EventBus* eventBus = nullptr;
+    EventBus::Topic dataTopic = EventBus::WEIGHT_SAMPLE;
+    EventBus::Topic eventTopic = EventBus::LOAD_EVENT;
 
 public:
     explicit Sensor(int sensorPin);
@@ -26,13 +38,14 @@ public:
     virtual bool isReady() const = 0;
 
     // Event-driven programming support
-    void setOnDataCallback(std::function<void(float)> callback);
+    void setEventBus(EventBus* bus) { eventBus = bus; }
     
     // State checking
     bool isInitialized() const { return initialized; }
 
 protected:
     void notifyDataReady(float data);
+    void notifyEvent(const SensorEvent& event);
 };
 
 #endif // SENSOR_H
@@ -0,0 +1,77 @@
+#include "StabilityDetector.h"
+
+StabilityDetector::StabilityDetector(uint8_t windowSize, float maxStdDev, float maxSlope)
+    : windowSize(2), maxStdDev(maxStdDev), maxSlope(maxSlope) {
+    setWindowSize(windowSize);
+}
+
+bool StabilityDetector::addSample(float value, uint32_t timestampMicros) {
+    if (count == 0) {
+        reference = value;
+    }
+
+    if (count == windowSize) {
+        double oldest = values[index] - reference;
+        sum -= oldest;
+        sumSquares -= oldest * oldest;
+    } else {
+        count++;
+    }
+
+    double shifted = value - reference;
+    sum += shifted;
+    sumSquares += shifted * shifted;
+
+    values[index] = value;
+    timestamps[index] = timestampMicros;
+    index = (index + 1) % windowSize;
+
+    bool nowStable = count == windowSize &&
+                     getStdDev() <= maxStdDev &&
+                     fabsf(getSlope()) <= maxSlope;
+
+    if (nowStable != stable) {
+        stable = nowStable;
+        return true;
+    }
+    return false;
+}
+
+void StabilityDetector::reset() {
+    index = 0;
+    count = 0;
+    sum = 0.0;
+    sumSquares = 0.0;
+    stable = false;
+}
+
+float StabilityDetector::getMean() const {
+    if (count == 0) return 0.0;
+    return reference + (float)(sum / count);
+}
+
+float StabilityDetector::getStdDev() const {
+    if (count < 2) return 0.0;
+    double mean = sum / count;
+    double variance = (sumSquares - mean * sum) / (count - 1);
+    return variance > 0.0 ? (float)sqrt(variance) : 0.0f;
+}
+
+float StabilityDetector::getSlope() const {
+    if (count < 2) return 0.0;
+
+    // index points at the oldest sample once the window is full
+    uint8_t oldest = (count == windowSize) ? index : 0;
+    uint8_t newest = (index + windowSize - 1) % windowSize;
+    uint32_t elapsed = timestamps[newest] - timestamps[oldest];
+    if (elapsed == 0) return 0.0;
+
+    return (values[newest] - values[oldest]) * 1000000.0f / elapsed;
+}
+
+void StabilityDetector::setWindowSize(uint8_t size) {
+    if (size < 2) size = 2;
+    if (size > MAX_WINDOW) size = MAX_WINDOW;
+    windowSize = size;
+    reset();
+}
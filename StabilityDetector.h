@@ -0,0 +1,50 @@
+#ifndef STABILITY_DETECTOR_H
+#define STABILITY_DETECTOR_H
+
+#include <Arduino.h>
+
+/**
+ * @brief Settle detector for the weight signal
+ *
+ * Keeps a sliding window of recent samples and reports the signal as stable when
+ * both the window standard deviation and the end-to-end slope stay within bounds.
+ * Window statistics are updated in O(1) per sample.
+ */
+class StabilityDetector {
+public:
+    static const uint8_t MAX_WINDOW = 32;
+
+private:
+    float values[MAX_WINDOW];
+    uint32_t timestamps[MAX_WINDOW]; // micros()
+    uint8_t windowSize;
+    uint8_t index = 0;
+    uint8_t count = 0;
+
+    // Sums are kept relative to a reference value to avoid cancellation at high loads
+    float reference = 0.0;
+    double sum = 0.0;
+    double sumSquares = 0.0;
+
+    float maxStdDev;   // grams
+    float maxSlope;    // grams per second
+    bool stable = false;
+
+public:
+    StabilityDetector(uint8_t windowSize = 10, float maxStdDev = 2.0f, float maxSlope = 5.0f);
+
+    // Returns true when the stable/unstable state changed with this sample
+    bool addSample(float value, uint32_t timestampMicros);
+    void reset();
+
+    bool isStable() const { return stable; }
+    float getMean() const;
+    float getStdDev() const;
+    float getSlope() const;
+
+    void setWindowSize(uint8_t size);
+    void setMaxStdDev(float value) { maxStdDev = value; }
+    void setMaxSlope(float value) { maxSlope = value; }
+};
+
+#endif // STABILITY_DETECTOR_H
@@ -0,0 +1,273 @@
+#ifndef STATE_MACHINE_H
+#define STATE_MACHINE_H
+
+#include <Arduino.h>
+#include <assert.h>
+#include "SampleRing.h"
+
+// Marks a transition row that applies in every state
+struct AnyState {};
+constexpr AnyState ANY_STATE = AnyState();
+
+/**
+ * @brief One row of a transition table: (from, event, guard) -> (to, action)
+ *
+ * Guards must not change the context; actions may, and may post further events.
+ * A row whose target equals the current state is an internal transition: the
+ * action runs but the state-change hook (exit/entry) does not.
+ */
+template <typename State, typename Event, typename Context>
+struct FsmTransition {
+    typedef bool (*Guard)(const Context& context);
+    typedef void (*Action)(Context& context);
+    static const uint8_t ANY = 0xFF;
+
+    uint8_t from;
+    uint8_t event;
+    uint8_t to;
+    Guard guard;
+    Action action;
+
+    constexpr FsmTransition(State from, Event event, State to, Guard guard = nullptr, Action action = nullptr)
+        : from((uint8_t)from), event((uint8_t)event), to((uint8_t)to), guard(guard), action(action) {}
+    constexpr FsmTransition(AnyState, Event event, State to, Guard guard = nullptr, Action action = nullptr)
+        : from(ANY), event((uint8_t)event), to((uint8_t)to), guard(guard), action(action) {}
+};
+
+/**
+ * @brief Compile-time checks over a transition table, for use in static_assert
+ *
+ * Written as C++11 single-expression recursion over the rows.
+ */
+namespace FsmCheck {
+
+template <typename Row>
+constexpr bool appliesTo(const Row& row, uint8_t state) {
+    return row.from == state || row.from == Row::ANY;
+}
+
+// Some row leads into state from a different state
+template <typename Row>
+constexpr bool reaches(const Row* rows, size_t count, uint8_t state) {
+    return count > 0 && ((rows[0].to == state && rows[0].from != state) || reaches(rows + 1, count - 1, state));
+}
+
+// Some row leads out of state
+template <typename Row>
+constexpr bool exits(const Row* rows, size_t count, uint8_t state) {
+    return count > 0 && ((appliesTo(rows[0], state) && rows[0].to != state) || exits(rows + 1, count - 1, state));
+}
+
+template <typename Row>
+constexpr bool handles(const Row* rows, size_t count, uint8_t event) {
+    return count > 0 && (rows[0].event == event || handles(rows + 1, count - 1, event));
+}
+
+template <typename Row>
+constexpr size_t candidates(const Row* rows, size_t count, uint8_t state, uint8_t event) {
+    return count == 0 ? 0 :
+        (appliesTo(rows[0], state) && rows[0].event == event ? 1 : 0) + candidates(rows + 1, count - 1, state, event);
+}
+
+// Every state other than the initial one can be entered
+template <typename Row>
+constexpr bool allReachable(const Row* rows, size_t count, uint8_t initial, uint8_t stateCount, uint8_t state = 0) {
+    return state >= stateCount ||
+        ((state == initial || reaches(rows, count, state)) && allReachable(rows, count, initial, stateCount, state + 1));
+}
+
+// No state is a dead end
+template <typename Row>
+constexpr bool noDeadEnds(const Row* rows, size_t count, uint8_t stateCount, uint8_t state = 0) {
+    return state >= stateCount || (exits(rows, count, state) && noDeadEnds(rows, count, stateCount, state + 1));
+}
+
+// Every event is consumed by at least one row
+template <typename Row>
+constexpr bool allEventsHandled(const Row* rows, size_t count, uint8_t eventCount, uint8_t event = 0) {
+    return event >= eventCount || (handles(rows, count, event) && allEventsHandled(rows, count, eventCount, event + 1));
+}
+
+// No (state, event) pair has more guarded candidates than the dispatcher indexes
+template <typename Row>
+constexpr bool candidatesWithin(const Row* rows, size_t count, uint8_t stateCount, uint8_t eventCount,
+                                size_t limit, uint8_t state = 0, uint8_t event = 0) {
+    return state >= stateCount ||
+        (event >= eventCount ? candidatesWithin(rows, count, stateCount, eventCount, limit, state + 1, 0) :
+         candidates(rows, count, state, event) <= limit &&
+         candidatesWithin(rows, count, stateCount, eventCount, limit, state, event + 1));
+}
+
+// Rows referring to states or events beyond the counts would index out of range
+template <typename Row>
+constexpr bool inRange(const Row* rows, size_t count, uint8_t stateCount, uint8_t eventCount) {
+    return count == 0 ||
+        ((rows[0].from < stateCount || rows[0].from == Row::ANY) && rows[0].to < stateCount &&
+         rows[0].event < eventCount && inRange(rows + 1, count - 1, stateCount, eventCount));
+}
+
+}
+
+/**
+ * @brief Table-driven state machine with a bounded event queue
+ *
+ * post() only queues; step() handles the events that were queued when it was
+ * called, so actions that post more events never re-enter the machine and a
+ * burst cannot starve the caller. Dispatch goes through an index of up to
+ * MaxCandidates rows per (state, event), built once from the table, and takes
+ * the first row whose guard passes: state-specific rows before ANY_STATE rows,
+ * each in table order. Every row keeps a count and its run time.
+ */
+template <typename State, typename Event, typename Context, uint8_t StateCount, uint8_t EventCount,
+          uint8_t MaxRows = 32, size_t QueueCapacity = 8, uint8_t MaxCandidates = 3>
+class StateMachine {
+public:
+    typedef FsmTransition<State, Event, Context> Transition;
+    typedef void (*StateChangeHook)(Context& context, State from, State to);
+    static const uint8_t MAX_CANDIDATES = MaxCandidates;
+
+    struct RowStats {
+        uint32_t count;
+        uint32_t maxUs;
+        uint64_t totalUs;
+    };
+
+private:
+    static const uint8_t NO_ROW = 0xFF;
+
+    const Transition* rows = nullptr;
+    uint8_t rowCount = 0;
+    uint8_t index[StateCount][EventCount][MaxCandidates];
+    State current;
+    StateChangeHook onStateChange;
+    SampleRing<Event, QueueCapacity> queue;
+    RowStats stats[MaxRows] = {};
+    uint32_t ignoredCount = 0; // No row applied or every guard failed
+    uint32_t droppedCount = 0; // Posted while the queue was full
+
+public:
+    StateMachine(State initial, StateChangeHook hook) : current(initial), onStateChange(hook) {
+        memset(index, NO_ROW, sizeof(index));
+    }
+
+    // The table is usually constexpr and validated with FsmCheck where it is defined. A table
+    // that still overflows MaxRows, or MaxCandidates for some (state, event), asserts in debug
+    // builds; otherwise the rows that fit are indexed and false is returned
+    bool setTable(const Transition* table, uint8_t count) {
+        assert(count <= MaxRows);
+        rows = table;
+        rowCount = count < MaxRows ? count : MaxRows;
+        memset(index, NO_ROW, sizeof(index));
+        bool fits = count <= MaxRows;
+
+        // Two passes keep state-specific rows ahead of ANY_STATE rows
+        for (uint8_t pass = 0; pass < 2; pass++) {
+            for (uint8_t i = 0; i < rowCount; i++) {
+                const Transition& row = rows[i];
+                if ((row.from == Transition::ANY) != (pass == 1)) continue;
+
+                for (uint8_t state = 0; state < StateCount; state++) {
+                    if (row.from != Transition::ANY && row.from != state) continue;
+                    uint8_t* slots = index[state][row.event];
+                    uint8_t slot = 0;
+                    while (slot < MaxCandidates && slots[slot] != NO_ROW) slot++;
+                    if (slot == MaxCandidates) {
+                        fits = false;
+                        continue;
+                    }
+                    slots[slot] = i;
+                }
+            }
+        }
+        assert(fits);
+        return fits;
+    }
+
+    bool post(Event event) {
+        if (!queue.push(event)) {
+            droppedCount++;
+            return false;
+        }
+        return true;
+    }
+
+    size_t step(Context& context) {
+        size_t pending = queue.size();
+        size_t handled = 0;
+        Event event;
+        while (handled < pending && queue.pop(event)) {
+            dispatch(context, event);
+            handled++;
+        }
+        return handled;
+    }
+
+    State getState() const { return current; }
+    size_t pending() const { return queue.size(); }
+    uint32_t getIgnoredCount() const { return ignoredCount; }
+    uint32_t getDroppedCount() const { return droppedCount; }
+    const RowStats& getRowStats(uint8_t row) const { return stats[row < MaxRows ? row : 0]; }
+
+    void printStats(Print& out, const char* (*stateName)(State), const char* (*eventName)(Event)) const {
+        out.print("State machine: ");
+        out.print(stateName(current));
+        out.print(", queued ");
+        out.print((unsigned long)queue.size());
+        out.print(", ignored ");
+        out.print(ignoredCount);
+        out.print(", dropped ");
+        out.println(droppedCount);
+
+        for (uint8_t i = 0; i < rowCount; i++) {
+            const Transition& row = rows[i];
+            const RowStats& rowStats = stats[i];
+            out.print("  ");
+            out.print(row.from == Transition::ANY ? "*" : stateName((State)row.from));
+            out.print(" --");
+            out.print(eventName((Event)row.event));
+            out.print(row.guard ? "[guard]" : "");
+            out.print("--> ");
+            out.print(stateName((State)row.to));
+            out.print(": ");
+            out.print(rowStats.count);
+            if (rowStats.count > 0) {
+                out.print(" x, mean ");
+                out.print((unsigned long)(rowStats.totalUs / rowStats.count));
+                out.print("us, max ");
+                out.print(rowStats.maxUs);
+                out.print("us");
+            }
+            out.println();
+        }
+    }
+
+private:
+    void dispatch(Context& context, Event event) {
+        const uint8_t* slots = index[(uint8_t)current][(uint8_t)event];
+        for (uint8_t slot = 0; slot < MaxCandidates && slots[slot] != NO_ROW; slot++) {
+            const Transition& row = rows[slots[slot]];
+            if (row.guard && !row.guard(context)) continue;
+
+            uint32_t start = micros();
+            if (row.action) {
+                row.action(context);
+            }
+            State from = current;
+            State to = (State)row.to;
+            if (to != from) {
+                current = to;
+                onStateChange(context, from, to);
+            }
+
+            RowStats& rowStats = stats[slots[slot]];
+            uint32_t elapsed = micros() - start;
+            rowStats.count++;
+            rowStats.totalUs += elapsed;
+            if (elapsed > rowStats.maxUs) rowStats.maxUs = elapsed;
+            return;
+        }
+        ignoredCount++;
+    }
+};
+
+#endif // STATE_MACHINE_H
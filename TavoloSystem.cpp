@@ -1,42 +1,361 @@
 #include "TavoloSystem.h"
 
+#ifdef ARDUINO_ARCH_ESP32
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#endif
+
+/**
+ * @brief Guards and actions of the system state machine
+ *
+ * Friend of TavoloSystem so the transition table can be a namespace-scope
+ * constexpr array and be checked by static_assert below.
+ */
+struct TavoloTransitions {
+    typedef TavoloSystem::SystemState State;
+    typedef TavoloSystem::SystemEvent Event;
+    typedef TavoloSystem::SystemStateMachine::Transition Row;
+
+    static bool calibrationDone(const TavoloSystem& system) {
+        return millis() - system.calibrationStart >= TavoloSystem::CALIBRATION_PERIOD;
+    }
+    static bool loadDetected(const TavoloSystem& system) {
+        return system.weightSensor->hasNewData() && !system.isTableEmpty();
+    }
+    static bool overThreshold(const TavoloSystem& system) {
+        return system.currentWeight > system.config.weightThreshold;
+    }
+    static bool belowThreshold(const TavoloSystem& system) {
+        return system.currentWeight < system.config.weightThreshold * 0.9; // 10% hysteresis
+    }
+    static bool emptyTimedOut(const TavoloSystem& system) {
+        return system.config.idleTimeout != 0 && system.emptySince != 0 &&
+               millis() - system.emptySince >= system.config.idleTimeout;
+    }
+    static void trackEmptyTable(TavoloSystem& system) {
+        if (!system.isTableEmpty()) {
+            system.emptySince = 0;
+        } else if (system.emptySince == 0) {
+            system.emptySince = millis();
+        }
+    }
+};
+
+namespace {
+
+typedef TavoloTransitions T;
+
+// Rows for the same (state, event) are tried in order; ANY_STATE rows come after state-specific ones
+constexpr T::Row TRANSITIONS[] = {
+    T::Row(T::State::INITIALIZING,       T::Event::SETUP_COMPLETE,      T::State::CALIBRATING),
+    T::Row(T::State::CALIBRATING,        T::Event::TICK,                T::State::IDLE, T::calibrationDone),
+    T::Row(T::State::IDLE,               T::Event::TICK,                T::State::MEASURING, T::loadDetected),
+    T::Row(T::State::IDLE,               T::Event::START,               T::State::MEASURING),
+    T::Row(T::State::MEASURING,          T::Event::TICK,                T::State::THRESHOLD_EXCEEDED, T::overThreshold),
+    T::Row(T::State::MEASURING,          T::Event::TICK,                T::State::IDLE, T::emptyTimedOut),
+    T::Row(T::State::MEASURING,          T::Event::TICK,                T::State::MEASURING, nullptr, T::trackEmptyTable),
+    T::Row(T::State::MEASURING,          T::Event::STOP,                T::State::IDLE),
+    T::Row(T::State::THRESHOLD_EXCEEDED, T::Event::TICK,                T::State::MEASURING, T::belowThreshold),
+    T::Row(T::State::THRESHOLD_EXCEEDED, T::Event::STOP,                T::State::IDLE),
+    T::Row(T::State::COMMUNICATION_ERROR, T::Event::CONNECTION_RESTORED, T::State::IDLE),
+    T::Row(ANY_STATE,                    T::Event::CONNECTION_LOST,     T::State::COMMUNICATION_ERROR),
+    T::Row(ANY_STATE,                    T::Event::CALIBRATE,           T::State::CALIBRATING),
+    T::Row(ANY_STATE,                    T::Event::MAINTENANCE,         T::State::MAINTENANCE),
+    T::Row(ANY_STATE,                    T::Event::RESUME,              T::State::IDLE),
+};
+
+constexpr size_t TRANSITION_COUNT = sizeof(TRANSITIONS) / sizeof(TRANSITIONS[0]);
+constexpr uint8_t STATES = TavoloSystem::SYSTEM_STATE_COUNT;
+constexpr uint8_t EVENTS = TavoloSystem::SYSTEM_EVENT_COUNT;
+
+static_assert(TRANSITION_COUNT <= 32, "Transition table exceeds the state machine's row capacity");
+static_assert(FsmCheck::inRange(TRANSITIONS, TRANSITION_COUNT, STATES, EVENTS),
+              "Transition refers to an unknown state or event");
+static_assert(FsmCheck::allReachable(TRANSITIONS, TRANSITION_COUNT, (uint8_t)T::State::INITIALIZING, STATES),
+              "Some system state can never be entered");
+static_assert(FsmCheck::noDeadEnds(TRANSITIONS, TRANSITION_COUNT, STATES),
+              "Some system state has no outgoing transition");
+static_assert(FsmCheck::allEventsHandled(TRANSITIONS, TRANSITION_COUNT, EVENTS),
+              "Some system event is not handled by any transition");
+static_assert(FsmCheck::candidatesWithin(TRANSITIONS, TRANSITION_COUNT, STATES, EVENTS,
+                                         TavoloSystem::SystemStateMachine::MAX_CANDIDATES),
+              "Too many guarded rows for one (state, event) pair");
+
+// Reads the next "<key>=<number>" of a comma-separated command value such as "avg=4,interval=1000"
+bool nextSetting(const char*& cursor, char* key, size_t keySize, unsigned long& value) {
+    const char* separator = strchr(cursor, '=');
+    if (separator == nullptr) return false;
+    size_t keyLength = separator - cursor;
+    if (keyLength == 0 || keyLength >= keySize) return false;
+    
+    char* end = nullptr;
+    value = strtoul(separator + 1, &end, 10);
+    if (end == separator + 1 || (*end != ',' && *end != '\0')) return false;
+    
+    memcpy(key, cursor, keyLength);
+    key[keyLength] = '\0';
+    cursor = *end == ',' ? end + 1 : end;
+    return true;
+}
+
+}
+
+#if TAVOLO_PROFILING
+const char* const TavoloSystem::LATENCY_SECTION_NAMES[LATENCY_SECTION_COUNT] = {
+    "sensor", "led", "fsm", "edge", "display"
+};
+#endif
+
 TavoloSystem::TavoloSystem(int weightDataPin, int weightClockPin, int ledPin, uint8_t lcdAddress)
-    : Device() {
+    : Device(), stateMachine(SystemState::INITIALIZING, onStateMachineTransition) {
     
+    weightSensor = weightSensorStorage.construct(weightDataPin, weightClockPin, config.calibrationFactor);
+    createComponents(ledPin, lcdAddress);
+}
+
+TavoloSystem::TavoloSystem(const uint8_t* weightDataPins, uint8_t cellCount, int weightClockPin,
+                           int ledPin, uint8_t lcdAddress)
+    : Device(), stateMachine(SystemState::INITIALIZING, onStateMachineTransition) {
+    
+    weightSensor = weightSensorStorage.construct(weightDataPins, cellCount, weightClockPin, config.calibrationFactor);
+    createComponents(ledPin, lcdAddress);
+}
+
+void TavoloSystem::createComponents(int ledPin, uint8_t lcdAddress) {
     // Initialize hardware components
-    weightSensor = new WeightSensor(weightDataPin, weightClockPin, config.calibrationFactor);
-    ledActuator = new LedActuator(ledPin);
-    displayManager = new DisplayManager(lcdAddress);
-    edgeCommunication = new EdgeCommunication(getDeviceId());
+    weightSensor->setEventThreshold(LOAD_EVENT_THRESHOLD);
+    applySamplingPolicy();
+    applySummaryWindows();
+    ledActuator = ledActuatorStorage.construct(ledPin);
+    displayManager = displayManagerStorage.construct(lcdAddress);
+    edgeCommunication = edgeCommunicationStorage.construct(getDeviceId());
+    offlineStorage = offlineStorageStorage.construct();
+    offlineQueue = offlineQueueStorage.construct(*offlineStorage);
+    powerManager = powerManagerStorage.construct(*weightSensor);
+    
+    if (!stateMachine.setTable(TRANSITIONS, TRANSITION_COUNT)) {
+        TAVOLO_LOG_ERROR(LOG_SYSTEM, "Transition table does not fit the state machine; some rows ignored");
+    }
     
     // Set up event-driven callbacks
     setupEventCallbacks();
+    registerCommands();
 }
 
 void TavoloSystem::setupEventCallbacks() {
-    // Weight sensor callback
-    weightSensor->setOnDataCallback([this](float weight) {
-        this->onWeightDataReceived(weight);
-    });
+    // Sensing-core sources publish on the bus; handlers run from its dispatch task
+    weightSensor->setEventBus(&eventBus);
+    weightSensor->setConversionHandler([](void* context, uint32_t timestampMicros, float weight) {
+        static_cast<WeightTrace*>(context)->record(timestampMicros, weight);
+    }, &weightTrace);
+    weightSensor->setSampleHandler([](void* context, uint32_t timestampMicros, float weight) {
+        static_cast<TavoloSystem*>(context)->aggregateSample(timestampMicros, weight);
+    }, this);
+    ledActuator->setEventBus(&eventBus);
+    setEventBus(&eventBus);
     
-    // Edge communication callbacks
-    edgeCommunication->setOnCommandCallback([this](const EdgeCommunication::EdgeCommand& cmd) {
-        this->onEdgeCommandReceived(cmd);
-    });
+    eventBus.subscribe("measure", EventBus::WEIGHT_SAMPLE, [](void* context, const EventBus::Event& event) {
+        static_cast<TavoloSystem*>(context)->onWeightDataReceived(event.value, event.timestamp);
+    }, this);
+    uplinkSubscriber = eventBus.subscribe("uplink", EventBus::WEIGHT_SAMPLE, [](void* context, const EventBus::Event& event) {
+        static_cast<TavoloSystem*>(context)->reportWeightSample(event.value, event.timestamp);
+    }, this);
+    applyUplinkRate();
+    eventBus.subscribe("load", EventBus::LOAD_EVENT, [](void* context, const EventBus::Event& event) {
+        static_cast<TavoloSystem*>(context)->onWeightEventReceived(event);
+    }, this);
+    eventBus.subscribe("connection", EventBus::CONNECTION_STATE, [](void* context, const EventBus::Event& event) {
+        static_cast<TavoloSystem*>(context)->onConnectionStateChanged((EdgeCommunication::ConnectionState)event.code);
+    }, this);
     
-    edgeCommunication->setOnConnectionStateCallback([this](EdgeCommunication::ConnectionState state) {
-        this->onConnectionStateChanged(state);
+    // Edge communication callbacks run on the network core; hand them over to the sensing core
+    edgeCommunication->setOnCommandCallback([](void* context, const EdgeCommunication::EdgeCommand& cmd) {
+        TavoloSystem* system = static_cast<TavoloSystem*>(context);
+        InboundMessage message = {};
+        message.kind = InboundMessage::COMMAND;
+        message.timestamp = cmd.timestamp;
+        message.parseMicros = cmd.parseMicros;
+        strlcpy(message.command, cmd.command, sizeof(message.command));
+        strlcpy(message.value, cmd.value, sizeof(message.value));
+        if (system->inboundChannel.send(message)) {
+            system->scheduler.signal(system->inboundTask);
+        }
+    }, this);
+    
+    edgeCommunication->setOnConnectionStateCallback([](void* context, EdgeCommunication::ConnectionState state) {
+        TavoloSystem* system = static_cast<TavoloSystem*>(context);
+        InboundMessage message = {};
+        message.kind = InboundMessage::CONNECTION_STATE;
+        message.connectionState = (uint8_t)state;
+        message.timestamp = millis();
+        if (system->inboundChannel.send(message)) {
+            system->scheduler.signal(system->inboundTask);
+        }
+    }, this);
+}
+
+void TavoloSystem::registerCommands() {
+    static const char* const PAYLOAD_FORMATS[] = { "JSON", "BINARY" };
+    static const char* const POWER_PROFILES[] = { "PERFORMANCE", "BALANCED", "ECO" };
+    static const char* const TRACE_MODES[] = { "OFF", "ON" };
+    
+    commandRegistry.add("SET_THRESHOLD", CommandArg::FLOAT, [](TavoloSystem& system, const CommandArg& arg) {
+        system.setWeightThreshold(arg.floatValue);
+    });
+    commandRegistry.add("LED_ON", CommandArg::NONE, [](TavoloSystem& system, const CommandArg& arg) {
+        system.ledActuator->setPattern(LedActuator::BlinkPattern::ON);
+    });
+    commandRegistry.add("LED_OFF", CommandArg::NONE, [](TavoloSystem& system, const CommandArg& arg) {
+        system.ledActuator->setPattern(LedActuator::BlinkPattern::OFF);
+    });
+    commandRegistry.add("TARE", CommandArg::NONE, [](TavoloSystem& system, const CommandArg& arg) {
+        system.tare();
+    });
+    commandRegistry.add("CALIBRATE", CommandArg::NONE, [](TavoloSystem& system, const CommandArg& arg) {
+        system.calibrate();
+    });
+    commandRegistry.add("MAINTENANCE", CommandArg::NONE, [](TavoloSystem& system, const CommandArg& arg) {
+        system.stateMachine.post(SystemEvent::MAINTENANCE);
+    });
+    commandRegistry.add("RESUME", CommandArg::NONE, [](TavoloSystem& system, const CommandArg& arg) {
+        system.stateMachine.post(SystemEvent::RESUME);
+    });
+    commandRegistry.add("UPLOAD_FLIGHT_LOG", CommandArg::NONE, [](TavoloSystem& system, const CommandArg& arg) {
+        TelemetryMessage message = {};
+        message.kind = TelemetryMessage::FLIGHT_LOG;
+        system.sendTelemetry(message);
+    });
+    commandRegistry.add("SET_FORMAT", PAYLOAD_FORMATS, 2, [](TavoloSystem& system, const CommandArg& arg) {
+        // Choice index matches the PayloadFormat enumerator order; applied on the network core
+        TelemetryMessage message = {};
+        message.kind = TelemetryMessage::PAYLOAD_FORMAT;
+        message.format = arg.enumValue;
+        system.sendTelemetry(message);
+    });
+    commandRegistry.add("SET_POWER", POWER_PROFILES, 3, [](TavoloSystem& system, const CommandArg& arg) {
+        // Choice index matches the PowerManager::Profile enumerator order
+        system.setIdlePowerProfile((PowerManager::Profile)arg.enumValue);
+    });
+    commandRegistry.add("SET_IDLE", CommandArg::TEXT, [](TavoloSystem& system, const CommandArg& arg) {
+        // Value format: comma-separated "<key>=<number>" with keys timeout (ms of empty table before
+        // MEASURING returns to IDLE, 0 never) and load (g that count as a loaded table),
+        // e.g. "timeout=30000,load=5"; missing keys keep their value
+        unsigned long timeout = system.config.idleTimeout;
+        float load = system.config.loadedWeight;
+        
+        const char* cursor = arg.text;
+        char key[12];
+        unsigned long value;
+        while (*cursor != '\0') {
+            if (!nextSetting(cursor, key, sizeof(key), value)) return;
+            
+            if (strcmp(key, "timeout") == 0) {
+                timeout = value;
+            } else if (strcmp(key, "load") == 0) {
+                load = (float)value;
+            } else {
+                return;
+            }
+        }
+        system.setIdleRules(timeout, load);
+    });
+    commandRegistry.add("TRACE", TRACE_MODES, 2, [](TavoloSystem& system, const CommandArg& arg) {
+        system.weightTrace.setEnabled(arg.enumValue == 1);
+    });
+    commandRegistry.add("SET_FILTER", CommandArg::TEXT, [](TavoloSystem& system, const CommandArg& arg) {
+        // Value format: "<stage>.<param>=<number>", e.g. "ema.alpha=0.2"
+        const char* separator = strchr(arg.text, '=');
+        char key[24];
+        size_t keyLength = separator ? separator - arg.text : 0;
+        if (keyLength > 0 && keyLength < sizeof(key)) {
+            memcpy(key, arg.text, keyLength);
+            key[keyLength] = '\0';
+            system.weightSensor->setFilterParameter(key, strtof(separator + 1, nullptr));
+        }
+    });
+    commandRegistry.add("SET_SAMPLING", CommandArg::TEXT, [](TavoloSystem& system, const CommandArg& arg) {
+        // Value format: comma-separated "<key>=<number>" with keys rate, avg, idle_after and interval,
+        // e.g. "rate=80,avg=4,idle_after=3000,interval=1000"; missing keys keep their value
+        SystemConfig& config = system.config;
+        uint16_t rate = config.activeSampleRate;
+        uint8_t averaging = config.activeAveraging;
+        unsigned long idleAfter = config.idleAfter;
+        unsigned long interval = config.measurementInterval;
+        
+        const char* cursor = arg.text;
+        char key[12];
+        unsigned long value;
+        while (*cursor != '\0') {
+            if (!nextSetting(cursor, key, sizeof(key), value)) return;
+            
+            if (strcmp(key, "rate") == 0) {
+                rate = value > UINT16_MAX ? 0 : (uint16_t)value;
+            } else if (strcmp(key, "avg") == 0) {
+                averaging = value > UINT8_MAX ? 0 : (uint8_t)value;
+            } else if (strcmp(key, "idle_after") == 0) {
+                idleAfter = value;
+            } else if (strcmp(key, "interval") == 0) {
+                interval = value;
+            } else {
+                return;
+            }
+        }
+        
+        unsigned long previousInterval = config.measurementInterval;
+        config.measurementInterval = interval;
+        if (!system.setSamplingPolicy(rate, averaging, idleAfter)) {
+            config.measurementInterval = previousInterval;
+        }
+    });
+    commandRegistry.add("SET_WINDOW", CommandArg::TEXT, [](TavoloSystem& system, const CommandArg& arg) {
+        // Value format: comma-separated "<key>=<number>" with keys tumbling, sliding (ms, 0 disables)
+        // and panes, e.g. "tumbling=60000,sliding=300000,panes=5"; missing keys keep their value
+        const SystemConfig& config = system.config;
+        unsigned long tumbling = config.tumblingWindow;
+        unsigned long sliding = config.slidingWindow;
+        unsigned long panes = config.slidingPanes;
+        
+        const char* cursor = arg.text;
+        char key[12];
+        unsigned long value;
+        while (*cursor != '\0') {
+            if (!nextSetting(cursor, key, sizeof(key), value)) return;
+            
+            if (strcmp(key, "tumbling") == 0) {
+                tumbling = value;
+            } else if (strcmp(key, "sliding") == 0) {
+                sliding = value;
+            } else if (strcmp(key, "panes") == 0) {
+                panes = value;
+            } else {
+                return;
+            }
+        }
+        
+        system.setSummaryWindows(tumbling, sliding, panes > UINT8_MAX ? 0 : (uint8_t)panes);
+    });
+    commandRegistry.add("SET_CELL_CAL", CommandArg::TEXT, [](TavoloSystem& system, const CommandArg& arg) {
+        // Value format: "<cell>=<factor>", e.g. "2=0.418"
+        char* end = nullptr;
+        unsigned long cell = strtoul(arg.text, &end, 10);
+        if (end != arg.text && *end == '=' && cell <= UINT8_MAX) {
+            system.weightSensor->setCellCalibrationFactor((uint8_t)cell, strtof(end + 1, nullptr));
+        }
     });
 }
 
 TavoloSystem::~TavoloSystem() {
-    delete weightSensor;
-    delete ledActuator;
-    delete displayManager;
-    delete edgeCommunication;
+    weightSensorStorage.destroy();
+    ledActuatorStorage.destroy();
+    displayManagerStorage.destroy();
+    edgeCommunicationStorage.destroy();
+    offlineQueueStorage.destroy();
+    offlineStorageStorage.destroy();
+    powerManagerStorage.destroy();
 }
 
 void TavoloSystem::setup() {
+    FlightRecorder::begin();
     Device::setup();
     
     Serial.println("=== TAVOLO SMART WEIGHT DETECTION SYSTEM ===");
@@ -46,23 +365,36 @@ void TavoloSystem::setup() {
     
     // Show boot screen
     displayManager->begin();
-    displayManager->showBootScreen(getDeviceId());
-    
-    changeSystemState(SystemState::INITIALIZING);
+    displayManager->showBootScreen(getDeviceId().c_str());
     
     // Initialize components in order
     Serial.println("Initializing Weight Sensor...");
     weightSensor->begin();
     
+    Serial.println("Initializing Power Manager...");
+    powerManager->begin();
+    
     Serial.println("Initializing LED Actuator...");
     ledActuator->begin();
     ledActuator->setPattern(LedActuator::BlinkPattern::SLOW_BLINK);
     
+    Serial.println("Initializing Offline Queue...");
+    if (offlineQueue->begin()) {
+        edgeCommunication->setOfflineQueue(offlineQueue);
+    }
+    
     Serial.println("Initializing Edge Communication...");
+    applyBatchConfig();
     edgeCommunication->begin();
     
     // Move to calibration state
-    changeSystemState(SystemState::CALIBRATING);
+    stateMachine.post(SystemEvent::SETUP_COMPLETE);
+    stateMachine.step(*this);
+    publishSnapshot();
+    publishNetworkStatus(); // The network task is not running yet
+    
+    registerTasks();
+    startNetworkTask();
     
     Serial.println("System initialization complete!");
     showSystemStatus();
@@ -71,84 +403,253 @@ void TavoloSystem::setup() {
 void TavoloSystem::loop() {
     Device::loop();
     
-    // Update all components (reactive programming)
-    weightSensor->update();
-    ledActuator->update();
-    displayManager->update();
-    edgeCommunication->update();
+    // Run whatever is due; the caller sleeps with scheduler.waitForNext()
+    scheduler.runDue();
+    
+    if (!networkTaskRunning) {
+        networkScheduler.runDue();
+    }
+}
+
+void TavoloSystem::registerTasks() {
+    eventBus.attach(scheduler);
+    
+    // Sensing core: acquisition, filtering, LED and state machine
+    sensorTask = scheduler.addPeriodic("sensor", SENSOR_TASK_PERIOD, [this]() {
+        TAVOLO_PROFILE_SCOPE(latency[LATENCY_SENSOR]);
+        weightSensor->update();
+        
+        // An idle table needs far fewer passes; the first moving conversion switches back
+        WeightSensor::SamplingMode mode = weightSensor->getSamplingMode();
+        if (mode != sensorTaskMode) {
+            sensorTaskMode = mode;
+            scheduler.setPeriod(sensorTask, mode == WeightSensor::SamplingMode::IDLE ?
+                                IDLE_SENSOR_TASK_PERIOD : SENSOR_TASK_PERIOD);
+        }
+    });
+    scheduler.addPeriodic("led", LED_TASK_PERIOD, [this]() {
+        TAVOLO_PROFILE_SCOPE(latency[LATENCY_LED]);
+        ledActuator->update();
+    });
+    inboundTask = scheduler.addEvent("inbound", [this]() {
+        processInbound();
+    });
     
-    // Update state machine
-    updateStateMachine();
+    // Update state machine and system operations
+    scheduler.addPeriodic("fsm", FSM_TASK_PERIOD, [this]() {
+        TAVOLO_PROFILE_SCOPE(latency[LATENCY_FSM]);
+        processInbound();
+        stateMachine.post(SystemEvent::TICK);
+        stateMachine.step(*this);
+        updateMeasurements();
+        updateCommunication();
+        powerManager->update();
+        publishSnapshot();
+    });
     
-    // Update system operations
-    updateMeasurements();
-    updateDisplay();
-    updateCommunication();
+    // Network core: MQTT and LCD
+    telemetryTask = networkScheduler.addEvent("telemetry", [this]() {
+        processTelemetry();
+    });
+    networkScheduler.addPeriodic("edge", EDGE_TASK_PERIOD, [this]() {
+        TAVOLO_PROFILE_SCOPE(latency[LATENCY_EDGE]);
+        processTelemetry();
+        edgeCommunication->update();
+        publishNetworkStatus();
+    });
+    networkScheduler.addPeriodic("trace", TRACE_TASK_PERIOD, [this]() {
+        // Chunks wait in the ring while disconnected; once it is full the newest are dropped
+        WeightTrace::Chunk chunk;
+        while (edgeCommunication->isConnected() && weightTrace.receive(chunk)) {
+            edgeCommunication->sendTraceChunk(chunk.data, chunk.length);
+        }
+    });
+    networkScheduler.addPeriodic("display", DISPLAY_TASK_PERIOD, [this]() {
+        TAVOLO_PROFILE_SCOPE(latency[LATENCY_DISPLAY]);
+        updateDisplay();
+        displayManager->update();
+    });
+    // Deferred log output shares the network core's spare time
+    networkScheduler.addPeriodic("log", LOG_TASK_PERIOD, []() {
+        DeferredLog::drain(Serial);
+    });
+#if TAVOLO_PROFILING
+    networkScheduler.addPeriodic("latency", LATENCY_REPORT_PERIOD, [this]() {
+        publishLatencyReport();
+    }, LATENCY_REPORT_PERIOD);
+#endif
 }
 
-void TavoloSystem::updateStateMachine() {
-    switch (currentSystemState) {
-        case SystemState::INITIALIZING:
-            // Automatically move to calibrating after components are ready
-            if (weightSensor->isReady() && ledActuator->isInitialized()) {
-                changeSystemState(SystemState::CALIBRATING);
-            }
-            break;
-            
-        case SystemState::CALIBRATING:
-            // Move to idle after a short calibration period
-            if (millis() > 5000) { // 5 seconds calibration time
-                changeSystemState(SystemState::IDLE);
-            }
-            break;
-            
-        case SystemState::IDLE:
-            // Move to measuring when weight sensor has new data
-            if (weightSensor->hasNewData()) {
-                changeSystemState(SystemState::MEASURING);
-            }
-            break;
-            
-        case SystemState::MEASURING:
-            // Check threshold and decide next state
-            checkThreshold();
-            break;
-            
-        case SystemState::THRESHOLD_EXCEEDED:
-            // Return to measuring if weight drops below threshold
-            if (currentWeight < config.weightThreshold * 0.9) { // 10% hysteresis
-                changeSystemState(SystemState::MEASURING);
+void TavoloSystem::startNetworkTask() {
+    // Tasks are registered before the task exists, so its scheduler is never shared
+#ifdef ARDUINO_ARCH_ESP32
+    networkTaskRunning = xTaskCreatePinnedToCore(networkTaskEntry, "tavolo_net", NETWORK_TASK_STACK, this,
+                                                 NETWORK_TASK_PRIORITY, nullptr, NETWORK_CORE) == pdPASS;
+#endif
+    if (networkTaskRunning) {
+        Serial.print("Network task started on core ");
+        Serial.println(NETWORK_CORE);
+    } else {
+        Serial.println("Network task unavailable, running network and display on the loop task");
+    }
+}
+
+void TavoloSystem::networkTaskEntry(void* arg) {
+    TavoloSystem* system = static_cast<TavoloSystem*>(arg);
+    for (;;) {
+        system->networkScheduler.runDue();
+        system->networkScheduler.waitForNext();
+    }
+}
+
+void TavoloSystem::publishSnapshot() {
+    Snapshot current;
+    current.weight = currentWeight;
+    current.state = getSystemState();
+    current.thresholdExceeded = thresholdExceeded;
+    current.timestamp = millis();
+    snapshot.write(current);
+}
+
+void TavoloSystem::publishNetworkStatus() {
+    // Counters owned by the network core, read by STATUS on the sensing core
+    const LcdFrameBuffer& frameBuffer = displayManager->getFrameBuffer();
+    NetworkStatus current;
+    current.connectPhase = edgeCommunication->getConnectPhase();
+    current.maxUpdateUs = edgeCommunication->getMaxUpdateTime();
+    current.budgetOverruns = edgeCommunication->getBudgetOverruns();
+    current.publishedCount = edgeCommunication->getPublishedCount();
+    current.publishFailureCount = edgeCommunication->getPublishFailureCount();
+    current.lcdBytesSent = frameBuffer.getBytesSent();
+    current.lcdBytesSaved = frameBuffer.getBytesSaved();
+    current.lcdTransactionsSaved = frameBuffer.getTransactionsSaved();
+    current.displayUpdates = displayManager->getUpdateCount();
+    current.displayCompositions = displayManager->getComposeCount();
+    current.queuePending = offlineQueue->size();
+    current.queueForwarded = offlineQueue->getForwardedCount();
+    current.queueDropped = offlineQueue->getDroppedCount();
+    current.timestamp = millis();
+    networkStatus.write(current);
+}
+
+void TavoloSystem::sendTelemetry(const TelemetryMessage& message) {
+    if (telemetryChannel.send(message)) {
+        networkScheduler.signal(telemetryTask);
+    }
+}
+
+void TavoloSystem::aggregateSample(uint32_t timestampMicros, float weight) {
+    // The sample is moments old: its age maps the conversion time onto millis()
+    uint32_t timestampMs = millis() - (micros() - timestampMicros) / 1000UL;
+    WindowAggregator::Summary summary;
+    if (tumblingAggregator.add(weight, timestampMs, summary)) {
+        sendSummary(summary);
+    }
+    if (slidingAggregator.add(weight, timestampMs, summary)) {
+        sendSummary(summary);
+    }
+}
+
+void TavoloSystem::sendSummary(const WindowAggregator::Summary& summary) {
+    if (summaryChannel.send(summary)) {
+        networkScheduler.signal(telemetryTask);
+    }
+}
+
+void TavoloSystem::processTelemetry() {
+    WindowAggregator::Summary summary;
+    while (summaryChannel.receive(summary)) {
+        edgeCommunication->sendWeightSummary(summary);
+    }
+    
+    TelemetryMessage message;
+    while (telemetryChannel.receive(message)) {
+        switch (message.kind) {
+            case TelemetryMessage::WEIGHT_SAMPLE:
+            case TelemetryMessage::WEIGHT_REPORT: {
+                EdgeCommunication::WeightData data;
+                data.weight = message.weight;
+                data.timestamp = message.timestamp;
+                if (message.kind == TelemetryMessage::WEIGHT_SAMPLE) {
+                    edgeCommunication->queueWeightData(data);
+                } else {
+                    // While disconnected the sample is kept in the offline queue
+                    edgeCommunication->sendWeightData(data);
+                }
+                break;
             }
-            break;
-            
-        case SystemState::COMMUNICATION_ERROR:
-            // Try to recover by returning to measuring
-            if (edgeCommunication->isConnected()) {
-                changeSystemState(SystemState::MEASURING);
+                
+            case TelemetryMessage::LOAD_EVENT: {
+                EdgeCommunication::WeightEvent event;
+                event.event = WeightSensor::eventTypeToString(message.eventType);
+                event.eventCode = message.eventType;
+                event.weight = message.weight;
+                event.delta = message.delta;
+                event.settleTime = message.settleTime;
+                event.timestamp = message.timestamp;
+                edgeCommunication->sendWeightEvent(event);
+                break;
             }
-            break;
-            
-        case SystemState::MAINTENANCE:
-            // Manual state - requires external command to exit
-            break;
+                
+            case TelemetryMessage::PAYLOAD_FORMAT:
+                edgeCommunication->setPayloadFormat((EdgeCommunication::PayloadFormat)message.format);
+                break;
+                
+            case TelemetryMessage::BATCH_CONFIG:
+                applyBatchConfig();
+                break;
+                
+            case TelemetryMessage::FLIGHT_LOG:
+                edgeCommunication->sendFlightLog();
+                break;
+        }
     }
 }
 
-void TavoloSystem::changeSystemState(SystemState newState) {
-    if (currentSystemState != newState) {
-        SystemState oldState = currentSystemState;
-        
-        handleStateExit(oldState);
-        currentSystemState = newState;
-        handleStateEntry(newState);
-        
-        Serial.print("System state changed: ");
-        Serial.print(stateToString(oldState));
-        Serial.print(" -> ");
-        Serial.println(stateToString(newState));
+void TavoloSystem::processInbound() {
+    InboundMessage message;
+    while (inboundChannel.receive(message)) {
+        if (message.kind == InboundMessage::CONNECTION_STATE) {
+            // Fanned out on the bus so other listeners see the same transitions
+            eventBus.publish(EventBus::CONNECTION_STATE, message.connectionState);
+        } else {
+            EdgeCommunication::EdgeCommand command;
+            command.command = message.command;
+            command.value = message.value;
+            command.timestamp = message.timestamp;
+            command.parseMicros = message.parseMicros;
+            onEdgeCommandReceived(command);
+        }
     }
 }
 
+void TavoloSystem::requestDisplay(const char* text, unsigned long timeout, bool error) {
+    DisplayRequest request = { text, timeout, error };
+    displayChannel.send(request);
+}
+
+void TavoloSystem::onStateMachineTransition(TavoloSystem& system, SystemState oldState, SystemState newState) {
+    system.applyStateChange(oldState, newState);
+}
+
+void TavoloSystem::applyStateChange(SystemState oldState, SystemState newState) {
+    // The machine has already switched state; run exit and entry work around it
+    FlightRecorder::record(FlightLog::STATE_CHANGE, (uint8_t)oldState, (uint16_t)newState);
+    handleStateExit(oldState);
+    handleStateEntry(newState);
+    applyPowerProfile();
+    publishSnapshot();
+    
+    EventBus::Event event = {};
+    event.topic = EventBus::SYSTEM_STATE;
+    event.code = (uint8_t)newState;
+    event.previous = (uint8_t)oldState;
+    event.timestamp = millis();
+    eventBus.publish(event);
+    
+    TAVOLO_LOG_INFO(LOG_SYSTEM, "System state changed: %s -> %s", stateToString(oldState), stateToString(newState));
+}
+
 void TavoloSystem::handleStateEntry(SystemState state) {
     switch (state) {
         case SystemState::INITIALIZING:
@@ -158,7 +659,8 @@ void TavoloSystem::handleStateEntry(SystemState state) {
             
         case SystemState::CALIBRATING:
             ledActuator->setPattern(LedActuator::BlinkPattern::PULSE);
-            displayManager->showStatusMessage("Calibrating...", 3000);
+            requestDisplay("Calibrating...", 3000);
+            calibrationStart = millis();
             if (config.autoTare) {
                 tare();
             }
@@ -170,25 +672,25 @@ void TavoloSystem::handleStateEntry(SystemState state) {
             break;
             
         case SystemState::MEASURING:
+            emptySince = 0;
             setState(DeviceState::ACTIVE);
             break;
             
         case SystemState::THRESHOLD_EXCEEDED:
             ledActuator->setPattern(LedActuator::BlinkPattern::ON);
-            if (onThresholdStateChangeCallback) {
-                onThresholdStateChangeCallback(true);
-            }
+            thresholdExceeded = true;
+            eventBus.publish(EventBus::THRESHOLD, 1, currentWeight);
             break;
             
         case SystemState::COMMUNICATION_ERROR:
             ledActuator->setPattern(LedActuator::BlinkPattern::FAST_BLINK);
-            displayManager->showErrorMessage("Comm Error", 5000);
+            requestDisplay("Comm Error", 5000, true);
             setState(DeviceState::ERROR);
             break;
             
         case SystemState::MAINTENANCE:
             ledActuator->setPattern(LedActuator::BlinkPattern::SLOW_BLINK);
-            displayManager->showStatusMessage("Maintenance Mode", 0);
+            requestDisplay("Maintenance Mode", 0);
             setState(DeviceState::MAINTENANCE);
             break;
     }
@@ -197,62 +699,62 @@ void TavoloSystem::handleStateEntry(SystemState state) {
 void TavoloSystem::handleStateExit(SystemState state) {
     switch (state) {
         case SystemState::THRESHOLD_EXCEEDED:
-            if (onThresholdStateChangeCallback) {
-                onThresholdStateChangeCallback(false);
-            }
+            thresholdExceeded = false;
+            eventBus.publish(EventBus::THRESHOLD, 0, currentWeight);
             break;
         default:
             break;
     }
 }
 
-void TavoloSystem::onWeightDataReceived(float weight) {
+void TavoloSystem::onWeightDataReceived(float weight, unsigned long timestamp) {
     currentWeight = weight;
-    lastMeasurementTime = millis();
-    
-    if (onWeightChangeCallback) {
-        onWeightChangeCallback(weight);
-    }
+    lastMeasurementTime = timestamp;
+    publishSnapshot();
+}
+
+void TavoloSystem::onWeightEventReceived(const EventBus::Event& event) {
+    TAVOLO_LOG_INFO(LOG_SYSTEM, "Load event: %s %.1fg -> %.1fg (settled in %lums)",
+                    WeightSensor::eventTypeToString(event.code), event.delta, event.value, event.duration);
     
-    // Report weight data if needed
-    if (shouldReportWeight()) {
-        reportWeightData();
-    }
+    // One message per physical action instead of one per intermediate sample;
+    // stored for later delivery while the edge is unreachable
+    TelemetryMessage message = {};
+    message.kind = TelemetryMessage::LOAD_EVENT;
+    message.eventType = event.code;
+    message.weight = event.value;
+    message.delta = event.delta;
+    message.settleTime = event.duration;
+    message.timestamp = event.timestamp;
+    sendTelemetry(message);
 }
 
 void TavoloSystem::onEdgeCommandReceived(const EdgeCommunication::EdgeCommand& command) {
-    Serial.print("Received edge command: ");
-    Serial.print(command.command);
-    Serial.print(" = ");
-    Serial.println(command.value);
-    
-    if (command.command == "SET_THRESHOLD") {
-        float newThreshold = command.value.toFloat();
-        setWeightThreshold(newThreshold);
-    } else if (command.command == "LED_ON") {
-        ledActuator->setPattern(LedActuator::BlinkPattern::ON);
-    } else if (command.command == "LED_OFF") {
-        ledActuator->setPattern(LedActuator::BlinkPattern::OFF);
-    } else if (command.command == "TARE") {
-        tare();
-    } else if (command.command == "CALIBRATE") {
-        calibrate();
-    } else if (command.command == "MAINTENANCE") {
-        changeSystemState(SystemState::MAINTENANCE);
-    } else if (command.command == "RESUME") {
-        changeSystemState(SystemState::IDLE);
-    }
+    unsigned long dispatchMicros;
+    auto result = commandRegistry.dispatch(*this, command.command, command.value, dispatchMicros);
+    FlightRecorder::record(FlightLog::COMMAND, (uint8_t)result, (uint16_t)commandHash(command.command));
+    
+    // The command text lives in a reused buffer, so log the registry's copy of the name
+    const char* name = commandRegistry.lookup(command.command);
+    TAVOLO_LOG_INFO(LOG_SYSTEM, "Received edge command: %s -> %s (parse %luus, dispatch %luus)",
+                    name ? name : "(unknown)", CommandRegistry<TavoloSystem>::resultToString(result),
+                    command.parseMicros, dispatchMicros);
+    
+    EventBus::Event event = {};
+    event.topic = EventBus::COMMAND;
+    event.code = (uint8_t)result;
+    event.name = name;
+    event.timestamp = millis();
+    eventBus.publish(event);
 }
 
 void TavoloSystem::onConnectionStateChanged(EdgeCommunication::ConnectionState state) {
+    edgeConnected = state == EdgeCommunication::ConnectionState::CONNECTED;
+    
     if (state == EdgeCommunication::ConnectionState::ERROR) {
-        if (currentSystemState != SystemState::COMMUNICATION_ERROR) {
-            changeSystemState(SystemState::COMMUNICATION_ERROR);
-        }
+        stateMachine.post(SystemEvent::CONNECTION_LOST);
     } else if (state == EdgeCommunication::ConnectionState::CONNECTED) {
-        if (currentSystemState == SystemState::COMMUNICATION_ERROR) {
-            changeSystemState(SystemState::IDLE);
-        }
+        stateMachine.post(SystemEvent::CONNECTION_RESTORED);
     }
 }
 
@@ -261,26 +763,23 @@ void TavoloSystem::updateMeasurements() {
     // The weight sensor will call onWeightDataReceived when new data is available
 }
 
-void TavoloSystem::checkThreshold() {
-    bool wasExceeded = thresholdExceeded;
-    thresholdExceeded = currentWeight > config.weightThreshold;
-    
-    if (thresholdExceeded != wasExceeded) {
-        if (thresholdExceeded) {
-            changeSystemState(SystemState::THRESHOLD_EXCEEDED);
-        } else if (currentSystemState == SystemState::THRESHOLD_EXCEEDED) {
-            changeSystemState(SystemState::MEASURING);
+void TavoloSystem::updateDisplay() {
+    // Runs on the network core: only channel messages and the snapshot are read here
+    DisplayRequest request;
+    while (displayChannel.receive(request)) {
+        if (request.error) {
+            displayManager->showErrorMessage(request.text, request.timeout);
+        } else {
+            displayManager->showStatusMessage(request.text, request.timeout);
         }
     }
-}
-
-void TavoloSystem::updateDisplay() {
-    if (currentSystemState == SystemState::MEASURING || 
-        currentSystemState == SystemState::THRESHOLD_EXCEEDED ||
-        currentSystemState == SystemState::IDLE) {
+    
+    Snapshot current = snapshot.read();
+    if (current.state == SystemState::MEASURING || 
+        current.state == SystemState::THRESHOLD_EXCEEDED ||
+        current.state == SystemState::IDLE) {
         
-        String status = thresholdExceeded ? "OVER LIMIT" : "NORMAL";
-        displayManager->showWeightData(currentWeight, status);
+        displayManager->showWeightData(current.weight, current.thresholdExceeded ? "OVER LIMIT" : "NORMAL");
     }
 }
 
@@ -289,63 +788,46 @@ void TavoloSystem::updateCommunication() {
     // It will automatically try to reconnect and handle MQTT operations
 }
 
-void TavoloSystem::reportWeightData() {
-    if (edgeCommunication->isConnected()) {
-        EdgeCommunication::WeightData data;
-        data.weight = currentWeight;
-        data.timestamp = millis();
-        data.deviceId = getDeviceId();
-        
-        if (edgeCommunication->sendWeightData(data)) {
-            lastReportedWeight = currentWeight;
-            lastReportTime = millis();
-        }
-    }
+void TavoloSystem::reportWeightSample(float weight, unsigned long timestamp) {
+    // Every sample goes into the batch and EdgeCommunication decides when to flush;
+    // unbatched, the bus limits this subscriber to one sample per REPORT_INTERVAL
+    TelemetryMessage message = {};
+    message.kind = config.batchWeightData ? TelemetryMessage::WEIGHT_SAMPLE : TelemetryMessage::WEIGHT_REPORT;
+    message.weight = weight;
+    message.timestamp = timestamp;
+    sendTelemetry(message);
+    
+    lastReportedWeight = weight;
 }
 
-bool TavoloSystem::shouldReportWeight() const {
-    unsigned long currentTime = millis();
-    
-    // Report if enough time has passed
-    if (currentTime - lastReportTime >= REPORT_INTERVAL) {
-        return true;
-    }
-    
-    // Report if weight changed significantly
-    if (abs(currentWeight - lastReportedWeight) >= WEIGHT_REPORT_THRESHOLD) {
-        return true;
-    }
-    
-    return false;
+void TavoloSystem::applyUplinkRate() {
+    // Significant changes between unbatched reports are sent as load events
+    eventBus.setRate(uplinkSubscriber, 1, config.batchWeightData ? 0 : REPORT_INTERVAL);
 }
 
+// Control requests are queued and applied on the next state machine tick
 void TavoloSystem::startMeasurement() {
-    if (currentSystemState == SystemState::IDLE) {
-        changeSystemState(SystemState::MEASURING);
-    }
+    stateMachine.post(SystemEvent::START);
 }
 
 void TavoloSystem::stopMeasurement() {
-    if (currentSystemState == SystemState::MEASURING || 
-        currentSystemState == SystemState::THRESHOLD_EXCEEDED) {
-        changeSystemState(SystemState::IDLE);
-    }
+    stateMachine.post(SystemEvent::STOP);
 }
 
 void TavoloSystem::calibrate() {
-    changeSystemState(SystemState::CALIBRATING);
+    stateMachine.post(SystemEvent::CALIBRATE);
 }
 
 void TavoloSystem::tare() {
     weightSensor->tare();
-    displayManager->showStatusMessage("Tare Complete", 2000);
+    requestDisplay("Tare Complete", 2000);
 }
 
 void TavoloSystem::setWeightThreshold(float threshold) {
     config.weightThreshold = threshold;
-    Serial.print("Weight threshold updated to: ");
-    Serial.print(threshold);
-    Serial.println("g");
+    tumblingAggregator.setThreshold(threshold);
+    slidingAggregator.setThreshold(threshold);
+    TAVOLO_LOG_INFO(LOG_SYSTEM, "Weight threshold updated to: %.2fg", threshold);
 }
 
 void TavoloSystem::setCalibrationFactor(float factor) {
@@ -354,28 +836,157 @@ void TavoloSystem::setCalibrationFactor(float factor) {
 }
 
 void TavoloSystem::setMeasurementInterval(unsigned long interval) {
+    unsigned long previous = config.measurementInterval;
     config.measurementInterval = interval;
+    if (!applySamplingPolicy()) {
+        config.measurementInterval = previous;
+    }
 }
 
-String TavoloSystem::getSystemStateString() const {
-    switch (currentSystemState) {
-        case SystemState::INITIALIZING: return "INITIALIZING";
-        case SystemState::CALIBRATING: return "CALIBRATING";
-        case SystemState::IDLE: return "IDLE";
-        case SystemState::MEASURING: return "MEASURING";
-        case SystemState::THRESHOLD_EXCEEDED: return "THRESHOLD_EXCEEDED";
-        case SystemState::COMMUNICATION_ERROR: return "COMMUNICATION_ERROR";
-        case SystemState::MAINTENANCE: return "MAINTENANCE";
-        default: return "UNKNOWN";
+bool TavoloSystem::setSummaryWindows(unsigned long tumbling, unsigned long sliding, uint8_t slidingPanes) {
+    SystemConfig previous = config;
+    config.tumblingWindow = tumbling;
+    config.slidingWindow = sliding;
+    config.slidingPanes = slidingPanes;
+    if (!applySummaryWindows()) {
+        config = previous;
+        applySummaryWindows();
+        TAVOLO_LOG_WARN(LOG_SYSTEM, "Invalid summary windows: %lu ms, %lu ms / %u panes",
+                        tumbling, sliding, slidingPanes);
+        return false;
+    }
+    TAVOLO_LOG_INFO(LOG_SYSTEM, "Summary windows: tumbling %lu ms, sliding %lu ms / %u panes",
+                    tumbling, sliding, slidingPanes);
+    return true;
+}
+
+bool TavoloSystem::applySummaryWindows() {
+    tumblingAggregator.setThreshold(config.weightThreshold);
+    slidingAggregator.setThreshold(config.weightThreshold);
+    return tumblingAggregator.configure(config.tumblingWindow) &&
+           slidingAggregator.configure(config.slidingWindow, config.slidingPanes);
+}
+
+void TavoloSystem::setSensorRatePin(int pin) {
+    weightSensor->setRatePin(pin);
+}
+
+void TavoloSystem::setMqttServer(const String& server, int port) {
+    edgeCommunication->setMqttServer(server, port);
+}
+
+bool TavoloSystem::setSamplingPolicy(uint16_t activeRate, uint8_t activeAveraging, unsigned long idleAfter) {
+    SystemConfig previous = config;
+    config.activeSampleRate = activeRate;
+    config.activeAveraging = activeAveraging;
+    config.idleAfter = idleAfter;
+    if (!applySamplingPolicy()) {
+        config = previous;
+        TAVOLO_LOG_WARN(LOG_SYSTEM, "Invalid sampling policy: rate %u, avg %u", activeRate, activeAveraging);
+        return false;
+    }
+    return true;
+}
+
+bool TavoloSystem::applySamplingPolicy() {
+    WeightSensor::SamplingPolicy policy;
+    policy.activeRate = config.activeSampleRate;
+    policy.activeAveraging = config.activeAveraging;
+    policy.idleInterval = config.measurementInterval;
+    policy.idleAfter = config.idleAfter;
+    return weightSensor->setSamplingPolicy(policy);
+}
+
+void TavoloSystem::setBatching(bool enabled, uint16_t maxSamples, unsigned long maxAge, uint16_t maxBytes) {
+    config.batchWeightData = enabled;
+    config.batchMaxSamples = maxSamples;
+    config.batchMaxAge = maxAge;
+    config.batchMaxBytes = maxBytes;
+    applyUplinkRate();
+    
+    // EdgeCommunication belongs to the network core; the channel orders the config writes first
+    TelemetryMessage message = {};
+    message.kind = TelemetryMessage::BATCH_CONFIG;
+    sendTelemetry(message);
+}
+
+void TavoloSystem::applyBatchConfig() {
+    EdgeCommunication::BatchConfig batch;
+    batch.enabled = config.batchWeightData;
+    batch.maxSamples = config.batchMaxSamples;
+    batch.maxAgeMs = config.batchMaxAge;
+    batch.maxBytes = config.batchMaxBytes;
+    edgeCommunication->setBatchConfig(batch);
+}
+
+void TavoloSystem::showFilterInfo() {
+    weightSensor->printFilterInfo(Serial);
+}
+
+void TavoloSystem::showCellInfo() {
+    weightSensor->printCellInfo(Serial);
+}
+
+void TavoloSystem::showCommandStats() {
+    commandRegistry.printStats(Serial);
+}
+
+void TavoloSystem::showPowerStats() {
+    powerManager->printStats(Serial);
+}
+
+void TavoloSystem::setIdlePowerProfile(PowerManager::Profile profile) {
+    config.idleProfile = profile;
+    applyPowerProfile();
+}
+
+bool TavoloSystem::setIdleRules(unsigned long idleTimeout, float loadedWeight) {
+    if (!(loadedWeight > 0.0f)) {
+        TAVOLO_LOG_WARN(LOG_SYSTEM, "Rejected idle rules: loaded weight must be above 0 g");
+        return false;
     }
+    config.idleTimeout = idleTimeout;
+    config.loadedWeight = loadedWeight;
+    emptySince = 0; // The empty-table timer restarts under the new rules
+    TAVOLO_LOG_INFO(LOG_SYSTEM, "Idle rules: back to IDLE after %lums empty, loaded from %.1fg",
+                    idleTimeout, loadedWeight);
+    return true;
+}
+
+void TavoloSystem::applyPowerProfile() {
+    // Calibration and tare need the sensor powered, so only IDLE uses the idle profile
+    powerManager->apply(getSystemState() == SystemState::IDLE ? config.idleProfile : config.activeProfile);
 }
 
-void TavoloSystem::setOnWeightChangeCallback(std::function<void(float)> callback) {
-    onWeightChangeCallback = callback;
+bool TavoloSystem::isTableEmpty() const {
+    return weightSensor->isStable() && abs(weightSensor->getStableWeight()) < config.loadedWeight;
 }
 
-void TavoloSystem::setOnThresholdStateChangeCallback(std::function<void(bool)> callback) {
-    onThresholdStateChangeCallback = callback;
+void TavoloSystem::showSchedulerStats() {
+    scheduler.printStatistics(Serial);
+    networkScheduler.printStatistics(Serial);
+}
+
+void TavoloSystem::showTraceStats() {
+    weightTrace.printStats(Serial);
+    weightTrace.benchmark(Serial);
+}
+
+void TavoloSystem::showWindowStats() {
+    tumblingAggregator.printStats(Serial, "Tumbling window");
+    slidingAggregator.printStats(Serial, "Sliding window");
+}
+
+void TavoloSystem::showPipelineStats() {
+    telemetryChannel.printStats(Serial, "Telemetry channel");
+    summaryChannel.printStats(Serial, "Summary channel");
+    displayChannel.printStats(Serial, "Display channel");
+    inboundChannel.printStats(Serial, "Inbound channel");
+    eventBus.printStats(Serial);
+    Serial.print("Snapshot version: ");
+    Serial.print(snapshot.getVersion());
+    Serial.print(", network status version: ");
+    Serial.println(networkStatus.getVersion());
 }
 
 void TavoloSystem::showSystemStatus() {
@@ -387,17 +998,113 @@ void TavoloSystem::showSystemStatus() {
     Serial.print("Current Weight: ");
     Serial.print(currentWeight);
     Serial.println("g");
+    if (weightSensor->getCellCount() > 1) {
+        weightSensor->printCellInfo(Serial);
+    }
     Serial.print("Weight Threshold: ");
     Serial.print(config.weightThreshold);
     Serial.println("g");
     Serial.print("Threshold Exceeded: ");
     Serial.println(thresholdExceeded ? "YES" : "NO");
     Serial.print("Edge Connected: ");
-    Serial.println(edgeCommunication->isConnected() ? "YES" : "NO");
+    Serial.println(edgeConnected ? "YES" : "NO");
+    // Network-core values come from its published status, never from the components
+    NetworkStatus network = networkStatus.read();
+    Serial.print("MQTT Phase: ");
+    Serial.println(edgeCommunication->phaseToString(network.connectPhase));
+    Serial.print("Edge Update Max/Overruns: ");
+    Serial.print(network.maxUpdateUs);
+    Serial.print("us/");
+    Serial.println(network.budgetOverruns);
+    Serial.print("LCD bytes sent/saved: ");
+    Serial.print(network.lcdBytesSent);
+    Serial.print("/");
+    Serial.print(network.lcdBytesSaved);
+    Serial.print(" (I2C transactions saved: ");
+    Serial.print(network.lcdTransactionsSaved);
+    Serial.println(")");
+    Serial.print("Display compositions: ");
+    Serial.print(network.displayCompositions);
+    Serial.print(" of ");
+    Serial.print(network.displayUpdates);
+    Serial.println(" updates");
+    const Scheduler::Statistics& schedulerStats = scheduler.getStatistics();
+    Serial.print("Scheduler wakeups: ");
+    Serial.print(schedulerStats.wakeups);
+    Serial.print(", latency last/max: ");
+    Serial.print(schedulerStats.lastLatencyUs);
+    Serial.print("/");
+    Serial.print(schedulerStats.maxLatencyUs);
+    Serial.println("us");
+    showPipelineStats();
+    Serial.print("MQTT Published: ");
+    Serial.print(network.publishedCount);
+    Serial.print(", failed: ");
+    Serial.println(network.publishFailureCount);
+    Serial.print("Offline Queue: ");
+    Serial.print(network.queuePending);
+    Serial.print(" pending, ");
+    Serial.print(network.queueForwarded);
+    Serial.print(" forwarded, ");
+    Serial.print(network.queueDropped);
+    Serial.println(" dropped");
+    Serial.print("Samples Acquired: ");
+    Serial.println(weightSensor->getSampleCount());
+    Serial.print("Sampling: ");
+    Serial.print(WeightSensor::samplingModeToString(weightSensor->getSamplingMode()));
+    Serial.print(", ");
+    Serial.print(weightSensor->getConversionRate());
+    Serial.print(" SPS, ");
+    Serial.print(weightSensor->getSamplePeriod());
+    Serial.print(" ms per sample, ");
+    Serial.print(weightSensor->getModeSwitchCount());
+    Serial.println(" switches");
+    Serial.print("Samples Missed/Overrun: ");
+    Serial.print(weightSensor->getMissedSampleCount());
+    Serial.print("/");
+    Serial.println(weightSensor->getOverrunCount());
+    Serial.print("Log messages written/dropped: ");
+    Serial.print(DeferredLog::getWrittenCount());
+    Serial.print("/");
+    Serial.println(DeferredLog::getDroppedCount());
+    showAllocationStats();
+    showLatencyStats();
     Serial.println("====================\n");
 }
 
-String TavoloSystem::stateToString(SystemState state) const {
+void TavoloSystem::showFlightLog() {
+    FlightRecorder::print(Serial, 32);
+}
+
+void TavoloSystem::showStateMachineStats() {
+    stateMachine.printStats(Serial, stateToString, eventToString);
+}
+
+void TavoloSystem::showAllocationStats() {
+    AllocationAudit::print(Serial);
+}
+
+void TavoloSystem::showLatencyStats() {
+#if TAVOLO_PROFILING
+    Serial.println("Task latency:");
+    for (uint8_t i = 0; i < LATENCY_SECTION_COUNT; i++) {
+        latency[i].print(Serial, LATENCY_SECTION_NAMES[i]);
+    }
+#else
+    Serial.println("Task latency: profiling disabled (TAVOLO_PROFILING=0)");
+#endif
+}
+
+void TavoloSystem::publishLatencyReport() {
+#if TAVOLO_PROFILING
+    // One message per section keeps each report within the MQTT message buffer
+    for (uint8_t i = 0; i < LATENCY_SECTION_COUNT; i++) {
+        edgeCommunication->sendLatencyReport(LATENCY_SECTION_NAMES[i], latency[i]);
+    }
+#endif
+}
+
+const char* TavoloSystem::stateToString(SystemState state) {
     switch (state) {
         case SystemState::INITIALIZING: return "INITIALIZING";
         case SystemState::CALIBRATING: return "CALIBRATING";
@@ -409,3 +1116,18 @@ String TavoloSystem::stateToString(SystemState state) const {
         default: return "UNKNOWN";
     }
 }
+
+const char* TavoloSystem::eventToString(SystemEvent event) {
+    switch (event) {
+        case SystemEvent::TICK: return "TICK";
+        case SystemEvent::SETUP_COMPLETE: return "SETUP_COMPLETE";
+        case SystemEvent::START: return "START";
+        case SystemEvent::STOP: return "STOP";
+        case SystemEvent::CALIBRATE: return "CALIBRATE";
+        case SystemEvent::MAINTENANCE: return "MAINTENANCE";
+        case SystemEvent::RESUME: return "RESUME";
+        case SystemEvent::CONNECTION_LOST: return "CONNECTION_LOST";
+        case SystemEvent::CONNECTION_RESTORED: return "CONNECTION_RESTORED";
+        default: return "UNKNOWN";
+    }
+}
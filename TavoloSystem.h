@@ -6,13 +6,32 @@
 #include "LedActuator.h"
 #include "DisplayManager.h"
 #include "EdgeCommunication.h"
-#include <functional>
+#include "FileLogStorage.h"
+#include "OfflineQueue.h"
+#include "CommandRegistry.h"
+#include "Scheduler.h"
+#include "PowerManager.h"
+#include "CoreChannel.h"
+#include "LatencyHistogram.h"
+#include "FlightRecorder.h"
+#include "DeferredLog.h"
+#include "EventBus.h"
+#include "InPlace.h"
+#include "AllocationAudit.h"
+#include "StateMachine.h"
+#include "WeightTrace.h"
+#include "WindowAggregator.h"
 
 /**
  * @brief Main Tavolo System implementing Finite State Machine and Event-Driven Architecture
  * 
  * This class orchestrates all system components following the Single Responsibility Principle
  * and implements a reactive system with state management.
+ *
+ * Work is split across the two cores: acquisition, filtering and the state machine run on
+ * the Arduino loop task, EdgeCommunication and DisplayManager on a network task pinned to
+ * the other core. The sides only exchange data through bounded lock-free channels and a
+ * seqlock-published snapshot, so a slow publish or LCD write cannot delay sampling.
  */
 class TavoloSystem : public Device {
 public:
@@ -28,9 +47,78 @@ public:
 
     struct SystemConfig {
         float weightThreshold = 100.0; // grams
-        unsigned long measurementInterval = 500; // ms
+        unsigned long measurementInterval = 1000; // ms per sample once the load has settled
+        
+        // Adaptive sampling while the load is moving
+        uint16_t activeSampleRate = WeightSensor::FAST_RATE; // SPS, needs the HX711 RATE pin
+        uint8_t activeAveraging = 4;   // Conversions averaged per sample
+        unsigned long idleAfter = 3000; // ms of stable reading before dropping to measurementInterval
+        
+        // Summary telemetry over the filtered sample stream; a window of 0 disables it
+        unsigned long tumblingWindow = 60000; // ms
+        unsigned long slidingWindow = 300000; // ms, advancing by one pane per summary
+        uint8_t slidingPanes = 5;
         float calibrationFactor = 0.42f;
         bool autoTare = true;
+        
+        // Weight telemetry batching (flush on whichever limit is reached first)
+        bool batchWeightData = true;
+        uint16_t batchMaxSamples = 20;
+        unsigned long batchMaxAge = 2000; // ms
+        uint16_t batchMaxBytes = 512;
+        
+        // Power profiles selected by the state machine
+        PowerManager::Profile activeProfile = PowerManager::Profile::PERFORMANCE;
+        PowerManager::Profile idleProfile = PowerManager::Profile::ECO;
+        
+        // IDLE <-> MEASURING: IDLE leaves once the table is not settled and empty, MEASURING
+        // returns once it has been settled and empty for idleTimeout
+        float loadedWeight = 5.0;          // g; a settled load below this counts as an empty table
+        unsigned long idleTimeout = 30000; // ms of settled, empty table before returning to IDLE; 0 never
+    };
+
+    // Inputs to the state machine; queued and applied once per FSM tick
+    enum class SystemEvent : uint8_t {
+        TICK,                // Periodic; guarded rows poll the sensor and timers
+        SETUP_COMPLETE,
+        START,
+        STOP,
+        CALIBRATE,
+        MAINTENANCE,
+        RESUME,
+        CONNECTION_LOST,
+        CONNECTION_RESTORED
+    };
+    
+    static const uint8_t SYSTEM_STATE_COUNT = (uint8_t)SystemState::MAINTENANCE + 1;
+    static const uint8_t SYSTEM_EVENT_COUNT = (uint8_t)SystemEvent::CONNECTION_RESTORED + 1;
+    typedef StateMachine<SystemState, SystemEvent, TavoloSystem, SYSTEM_STATE_COUNT, SYSTEM_EVENT_COUNT>
+        SystemStateMachine;
+    
+    // Published by the sensing core for the network/display core
+    struct Snapshot {
+        float weight;
+        SystemState state;
+        bool thresholdExceeded;
+        unsigned long timestamp;
+    };
+    
+    // Published by the network core for status output on the sensing core
+    struct NetworkStatus {
+        EdgeCommunication::ConnectPhase connectPhase;
+        unsigned long maxUpdateUs;
+        uint32_t budgetOverruns;
+        uint32_t publishedCount;
+        uint32_t publishFailureCount;
+        uint32_t lcdBytesSent;
+        uint32_t lcdBytesSaved;
+        uint32_t lcdTransactionsSaved;
+        uint32_t displayUpdates;
+        uint32_t displayCompositions;
+        uint32_t queuePending;
+        uint32_t queueForwarded;
+        uint32_t queueDropped;
+        unsigned long timestamp;
     };
 
 private:
@@ -39,29 +127,141 @@ private:
     LedActuator* ledActuator;
     DisplayManager* displayManager;
     EdgeCommunication* edgeCommunication;
+    FileLogStorage* offlineStorage;
+    OfflineQueue* offlineQueue;
+    PowerManager* powerManager;
     
-    // State management
-    SystemState currentSystemState = SystemState::INITIALIZING;
+    // Backing storage for the components above, so they never touch the heap
+    InPlace<WeightSensor> weightSensorStorage;
+    InPlace<LedActuator> ledActuatorStorage;
+    InPlace<DisplayManager> displayManagerStorage;
+    InPlace<EdgeCommunication> edgeCommunicationStorage;
+    InPlace<FileLogStorage> offlineStorageStorage;
+    InPlace<OfflineQueue> offlineQueueStorage;
+    InPlace<PowerManager> powerManagerStorage;
+    
+    // State management; transitions are defined in the table in TavoloSystem.cpp
+    friend struct TavoloTransitions;
+    SystemStateMachine stateMachine;
     SystemConfig config;
+    unsigned long calibrationStart = 0;
+    static const unsigned long CALIBRATION_PERIOD = 5000; // ms
     
     // Measurement data
     float currentWeight = 0.0;
     float lastReportedWeight = 0.0;
     unsigned long lastMeasurementTime = 0;
-    unsigned long lastReportTime = 0;
     bool thresholdExceeded = false;
+    unsigned long emptySince = 0; // 0 while the table is loaded or unsettled
+    
+    // Weight samples, state changes, connection changes and commands fan out from here
+    EventBus eventBus;
+    EventBus::SubscriberId uplinkSubscriber = EventBus::INVALID_SUBSCRIBER;
+    
+    // Full-rate compressed trace, filled by the sensor and published by the network core
+    WeightTrace weightTrace;
+    
+    // Window summaries of every filtered sample; published by the network core
+    WindowAggregator tumblingAggregator;
+    WindowAggregator slidingAggregator;
+    
+    // Drives every component from deadlines instead of a fixed-delay polling loop
+    Scheduler scheduler;        // Sensing core (Arduino loop task)
+    Scheduler networkScheduler; // Network core, or the loop task when no second task could start
+    bool networkTaskRunning = false;
+    Scheduler::TaskId telemetryTask = Scheduler::INVALID_TASK;
+    Scheduler::TaskId inboundTask = Scheduler::INVALID_TASK;
+    Scheduler::TaskId sensorTask = Scheduler::INVALID_TASK;
+    WeightSensor::SamplingMode sensorTaskMode = WeightSensor::SamplingMode::ACTIVE;
     
-    // Event-driven callbacks
-    std::function<void(float)> onWeightChangeCallback = nullptr;
-    std::function<void(bool)> onThresholdStateChangeCallback = nullptr;
+    // Cross-core pipeline messages
+    struct TelemetryMessage {
+        enum Kind : uint8_t {
+            WEIGHT_SAMPLE,   // Batched when batching is enabled
+            WEIGHT_REPORT,   // Always sent on its own
+            LOAD_EVENT,
+            PAYLOAD_FORMAT,
+            BATCH_CONFIG,    // Re-read config on the network core
+            FLIGHT_LOG       // Upload the flight recorder
+        };
+        uint8_t kind;
+        uint8_t eventType;
+        uint8_t format;
+        float weight;
+        float delta;
+        unsigned long settleTime;
+        unsigned long timestamp;
+    };
+    
+    struct DisplayRequest {
+        const char* text; // String literal
+        unsigned long timeout;
+        bool error;
+    };
+    
+    struct InboundMessage {
+        enum Kind : uint8_t {
+            COMMAND,
+            CONNECTION_STATE
+        };
+        uint8_t kind;
+        uint8_t connectionState;
+        unsigned long timestamp;
+        unsigned long parseMicros;
+        char command[24];
+        char value[48];
+    };
+    
+    CoreChannel<TelemetryMessage, 64> telemetryChannel; // Sensing -> network
+    CoreChannel<DisplayRequest, 8> displayChannel;      // Sensing -> display
+    CoreChannel<InboundMessage, 8> inboundChannel;      // Network -> sensing
+    CoreChannel<WindowAggregator::Summary, 8> summaryChannel; // Sensing -> network
+    SeqLock<Snapshot> snapshot;
+    SeqLock<NetworkStatus> networkStatus;
+    bool edgeConnected = false; // Last connection state received from the network core
+    
+    static const uint8_t NETWORK_CORE = 0;  // Shared with the WiFi stack
+    static const uint32_t NETWORK_TASK_STACK = 8192;
+    static const uint8_t NETWORK_TASK_PRIORITY = 1;
+    
+#if TAVOLO_PROFILING
+    // Run time of each task body, reported by STATUS and on the status topic
+    enum LatencySection : uint8_t {
+        LATENCY_SENSOR,
+        LATENCY_LED,
+        LATENCY_FSM,
+        LATENCY_EDGE,
+        LATENCY_DISPLAY,
+        LATENCY_SECTION_COUNT
+    };
+    LatencyHistogram latency[LATENCY_SECTION_COUNT];
+    static const char* const LATENCY_SECTION_NAMES[LATENCY_SECTION_COUNT];
+    static const unsigned long LATENCY_REPORT_PERIOD = 60000; // ms
+#endif
+    
+    // Edge commands, resolved by name hash instead of a comparison chain
+    CommandRegistry<TavoloSystem> commandRegistry;
+    
+    // Task periods (ms); each component still applies its own finer interval
+    static const unsigned long SENSOR_TASK_PERIOD = 10;
+    static const unsigned long IDLE_SENSOR_TASK_PERIOD = 100; // Ring holds 3.2 s at 10 SPS
+    static const unsigned long LED_TASK_PERIOD = 20;
+    static const unsigned long DISPLAY_TASK_PERIOD = 50;
+    static const unsigned long EDGE_TASK_PERIOD = 10;
+    static const unsigned long FSM_TASK_PERIOD = 50;
+    static const unsigned long LOG_TASK_PERIOD = 20;
+    static const unsigned long TRACE_TASK_PERIOD = 100;
     
     // Communication
     const unsigned long REPORT_INTERVAL = 5000; // 5 seconds
-    const float WEIGHT_REPORT_THRESHOLD = 5.0; // Report if weight changes by 5g
+    const float LOAD_EVENT_THRESHOLD = 5.0; // Settled change reported as placed/removed
 
 public:
     TavoloSystem(int weightDataPin, int weightClockPin, int ledPin, 
                  uint8_t lcdAddress = 0x27);
+    // One HX711 per load cell, all clocked from weightClockPin
+    TavoloSystem(const uint8_t* weightDataPins, uint8_t cellCount, int weightClockPin, int ledPin,
+                 uint8_t lcdAddress = 0x27);
     virtual ~TavoloSystem();
 
     // Device interface implementation
@@ -78,43 +278,85 @@ public:
     void setWeightThreshold(float threshold);
     void setCalibrationFactor(float factor);
     void setMeasurementInterval(unsigned long interval);
+    void setSensorRatePin(int pin); // HX711 RATE; call before setup()
+    void setMqttServer(const String& server, int port = 1883); // Call before setup()
+    bool setSamplingPolicy(uint16_t activeRate, uint8_t activeAveraging, unsigned long idleAfter);
+    bool setSummaryWindows(unsigned long tumbling, unsigned long sliding, uint8_t slidingPanes);
+    void setBatching(bool enabled, uint16_t maxSamples, unsigned long maxAge, uint16_t maxBytes);
+    void setIdlePowerProfile(PowerManager::Profile profile);
+    bool setIdleRules(unsigned long idleTimeout, float loadedWeight);
     
     // State management
-    SystemState getSystemState() const { return currentSystemState; }
-    String getSystemStateString() const;
+    SystemState getSystemState() const { return stateMachine.getState(); }
+    const char* getSystemStateString() const { return stateToString(getSystemState()); }
     
-    // Event callbacks
-    void setOnWeightChangeCallback(std::function<void(float)> callback);
-    void setOnThresholdStateChangeCallback(std::function<void(bool)> callback);
+    // Event subscriptions; handlers run on the sensing core
+    EventBus& getEventBus() { return eventBus; }
 
     // System status
+    const WeightSensor& getWeightSensor() const { return *weightSensor; } // Sensing core only
     void showSystemStatus();
+    void showFilterInfo();
+    void showCellInfo();
+    void showCommandStats();
+    void showSchedulerStats();
+    void showPowerStats();
+    void showPipelineStats();
+    void showLatencyStats();
+    void showFlightLog();
+    void showTraceStats();
+    void showWindowStats();
+    void showAllocationStats();
+    void showStateMachineStats();
+    Scheduler& getScheduler() { return scheduler; }
 
 private:
     // Initialization
+    void createComponents(int ledPin, uint8_t lcdAddress);
     void setupEventCallbacks();
+    void registerCommands();
+    void registerTasks();
+    void startNetworkTask();
+    static void networkTaskEntry(void* arg);
+    
+    // Cross-core pipeline
+    void publishSnapshot();
+    void publishNetworkStatus();
+    void sendTelemetry(const TelemetryMessage& message);
+    void processTelemetry();
+    void processInbound();
+    void requestDisplay(const char* text, unsigned long timeout, bool error = false);
     
     // State machine implementation
-    void updateStateMachine();
-    void changeSystemState(SystemState newState);
+    static void onStateMachineTransition(TavoloSystem& system, SystemState oldState, SystemState newState);
+    void applyStateChange(SystemState oldState, SystemState newState);
     void handleStateEntry(SystemState state);
     void handleStateExit(SystemState state);
     
     // Event handlers
-    void onWeightDataReceived(float weight);
+    void onWeightDataReceived(float weight, unsigned long timestamp);
+    void onWeightEventReceived(const EventBus::Event& event);
     void onEdgeCommandReceived(const EdgeCommunication::EdgeCommand& command);
     void onConnectionStateChanged(EdgeCommunication::ConnectionState state);
     
     // System operations
     void updateMeasurements();
-    void checkThreshold();
     void updateDisplay();
     void updateCommunication();
-    void reportWeightData();
+    void reportWeightSample(float weight, unsigned long timestamp);
+    void applyUplinkRate();
+    bool applySamplingPolicy();
+    bool applySummaryWindows();
+    void aggregateSample(uint32_t timestampMicros, float weight);
+    void sendSummary(const WindowAggregator::Summary& summary);
+    void applyBatchConfig();
+    void applyPowerProfile();
+    void publishLatencyReport();
     
     // Utility methods
-    bool shouldReportWeight() const;
-    String stateToString(SystemState state) const;
+    bool isTableEmpty() const;
+    static const char* stateToString(SystemState state);
+    static const char* eventToString(SystemEvent event);
 };
 
 #endif // TAVOLO_SYSTEM_H
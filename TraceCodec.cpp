@@ -0,0 +1,255 @@
+#include "TraceCodec.h"
+#include <string.h>
+
+uint32_t TraceCodec::floatBits(float value) {
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+uint8_t TraceCodec::leadingZeros(uint32_t value) {
+#if defined(__GNUC__)
+    return (uint8_t)__builtin_clz(value);
+#else
+    uint8_t zeros = 0;
+    while (!(value & 0x80000000UL)) {
+        value <<= 1;
+        zeros++;
+    }
+    return zeros;
+#endif
+}
+
+uint8_t TraceCodec::trailingZeros(uint32_t value) {
+#if defined(__GNUC__)
+    return (uint8_t)__builtin_ctz(value);
+#else
+    uint8_t zeros = 0;
+    while (!(value & 1)) {
+        value >>= 1;
+        zeros++;
+    }
+    return zeros;
+#endif
+}
+
+float TraceCodec::bitsFloat(uint32_t bits) {
+    float value;
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+void TraceCodec::writeU16(uint8_t* out, uint16_t value) {
+    out[0] = value & 0xFF;
+    out[1] = (value >> 8) & 0xFF;
+}
+
+uint16_t TraceCodec::readU16(const uint8_t* in) {
+    return (uint16_t)(in[0] | (in[1] << 8));
+}
+
+void TraceCodec::writeU32(uint8_t* out, uint32_t value) {
+    out[0] = value & 0xFF;
+    out[1] = (value >> 8) & 0xFF;
+    out[2] = (value >> 16) & 0xFF;
+    out[3] = (value >> 24) & 0xFF;
+}
+
+uint32_t TraceCodec::readU32(const uint8_t* in) {
+    return (uint32_t)in[0] | ((uint32_t)in[1] << 8) |
+           ((uint32_t)in[2] << 16) | ((uint32_t)in[3] << 24);
+}
+
+bool TraceEncoder::begin(uint8_t* chunk, size_t size) {
+    buffer = chunk;
+    capacity = size;
+    position = 0;
+    pending = 0;
+    pendingBits = 0;
+    count = 0;
+    previousLeading = 0xFF;
+    previousTrailing = 0;
+    return buffer != nullptr && capacity >= TraceCodec::HEADER_SIZE;
+}
+
+bool TraceEncoder::append(uint32_t timestamp, float value) {
+    if (buffer == nullptr || count == UINT16_MAX) return false;
+    uint32_t bits = TraceCodec::floatBits(value);
+
+    if (count == 0) {
+        if (capacity < TraceCodec::HEADER_SIZE) return false;
+        buffer[0] = 'T';
+        buffer[1] = 'R';
+        buffer[2] = TraceCodec::VERSION;
+        buffer[3] = 0;
+        TraceCodec::writeU32(buffer + 6, timestamp);
+        TraceCodec::writeU32(buffer + 10, bits);
+        previousTimestamp = timestamp;
+        previousDelta = 0;
+        previousValue = bits;
+        count = 1;
+        return true;
+    }
+
+    // Checked against the worst case so a sample is never half written
+    size_t needed = TraceCodec::HEADER_SIZE + position + (pendingBits + TraceCodec::MAX_SAMPLE_BITS + 7) / 8;
+    if (needed > capacity) return false;
+
+    writeTimestamp(timestamp);
+    writeValue(bits);
+    count++;
+    return true;
+}
+
+size_t TraceEncoder::finish() {
+    if (buffer == nullptr || count == 0) return 0;
+
+    if (pendingBits > 0) {
+        buffer[TraceCodec::HEADER_SIZE + position++] = (uint8_t)(pending << (8 - pendingBits));
+        pending = 0;
+        pendingBits = 0;
+    }
+    TraceCodec::writeU16(buffer + 4, count);
+    return TraceCodec::HEADER_SIZE + position;
+}
+
+void TraceEncoder::writeBits(uint32_t value, uint8_t bits) {
+    if (bits < 32) value &= (1UL << bits) - 1;
+    pending = (pending << bits) | value;
+    pendingBits += bits;
+    while (pendingBits >= 8) {
+        pendingBits -= 8;
+        buffer[TraceCodec::HEADER_SIZE + position++] = (uint8_t)(pending >> pendingBits);
+    }
+    pending &= (1U << pendingBits) - 1;
+}
+
+void TraceEncoder::writeTimestamp(uint32_t timestamp) {
+    int32_t delta = (int32_t)(timestamp - previousTimestamp);
+    int32_t deltaOfDelta = (int32_t)((uint32_t)delta - (uint32_t)previousDelta);
+    previousTimestamp = timestamp;
+    previousDelta = delta;
+
+    if (deltaOfDelta == 0) {
+        writeBits(0, 1);
+        return;
+    }
+
+    uint32_t zigzag = ((uint32_t)deltaOfDelta << 1) ^ (uint32_t)(deltaOfDelta >> 31);
+    writeBits(1, 1);
+    do {
+        uint32_t nibble = zigzag & 0x0F;
+        zigzag >>= 4;
+        writeBits((zigzag != 0 ? 0x10 : 0) | nibble, 5);
+    } while (zigzag != 0);
+}
+
+void TraceEncoder::writeValue(uint32_t bits) {
+    uint32_t difference = bits ^ previousValue;
+    previousValue = bits;
+
+    if (difference == 0) {
+        writeBits(0, 1);
+        return;
+    }
+
+    uint8_t leading = TraceCodec::leadingZeros(difference);
+    uint8_t trailing = TraceCodec::trailingZeros(difference);
+
+    if (previousLeading != 0xFF && leading >= previousLeading && trailing >= previousTrailing) {
+        writeBits(0x2, 2);
+        writeBits(difference >> previousTrailing, 32 - previousLeading - previousTrailing);
+        return;
+    }
+
+    uint8_t significant = 32 - leading - trailing;
+    writeBits(0x3, 2);
+    writeBits(leading, 5);
+    writeBits(significant - 1, 5);
+    writeBits(difference >> trailing, significant);
+    previousLeading = leading;
+    previousTrailing = trailing;
+}
+
+bool TraceDecoder::begin(const uint8_t* chunk, size_t size) {
+    buffer = chunk;
+    length = size;
+    position = 0;
+    pending = 0;
+    pendingBits = 0;
+    produced = 0;
+    truncated = false;
+    previousLeading = 0;
+    previousTrailing = 0;
+
+    if (buffer == nullptr || length < TraceCodec::HEADER_SIZE || buffer[0] != 'T' || buffer[1] != 'R') {
+        return false;
+    }
+    if (buffer[2] != TraceCodec::VERSION) return false;
+
+    count = TraceCodec::readU16(buffer + 4);
+    firstTimestamp = TraceCodec::readU32(buffer + 6);
+    firstValue = TraceCodec::readU32(buffer + 10);
+    return true;
+}
+
+bool TraceDecoder::next(uint32_t& timestamp, float& value) {
+    if (produced >= count || truncated) return false;
+
+    if (produced == 0) {
+        previousTimestamp = firstTimestamp;
+        previousDelta = 0;
+        previousValue = firstValue;
+    } else {
+        int32_t deltaOfDelta = 0;
+        if (readBits(1)) {
+            uint32_t zigzag = 0;
+            uint8_t shift = 0;
+            uint32_t group;
+            do {
+                group = readBits(5);
+                if (shift < 32) zigzag |= (group & 0x0F) << shift;
+                shift += 4;
+            } while ((group & 0x10) && !truncated);
+            deltaOfDelta = (int32_t)((zigzag >> 1) ^ (~(zigzag & 1) + 1));
+        }
+        previousDelta = (int32_t)((uint32_t)previousDelta + (uint32_t)deltaOfDelta);
+        previousTimestamp += (uint32_t)previousDelta;
+
+        if (readBits(1)) {
+            if (readBits(1)) {
+                previousLeading = (uint8_t)readBits(5);
+                uint8_t significant = (uint8_t)readBits(5) + 1;
+                if (previousLeading + significant > 32) {
+                    truncated = true; // Corrupt window
+                    return false;
+                }
+                previousTrailing = 32 - previousLeading - significant;
+            }
+            uint8_t significant = 32 - previousLeading - previousTrailing;
+            previousValue ^= readBits(significant) << previousTrailing;
+        }
+        if (truncated) return false;
+    }
+
+    produced++;
+    timestamp = previousTimestamp;
+    value = TraceCodec::bitsFloat(previousValue);
+    return true;
+}
+
+uint32_t TraceDecoder::readBits(uint8_t bits) {
+    while (pendingBits < bits) {
+        if (TraceCodec::HEADER_SIZE + position >= length) {
+            truncated = true;
+            return 0;
+        }
+        pending = (pending << 8) | buffer[TraceCodec::HEADER_SIZE + position++];
+        pendingBits += 8;
+    }
+    pendingBits -= bits;
+    uint32_t value = (uint32_t)(pending >> pendingBits);
+    if (bits < 32) value &= (1UL << bits) - 1;
+    pending &= (1ULL << pendingBits) - 1;
+    return value;
+}
@@ -0,0 +1,124 @@
+#ifndef TRACE_CODEC_H
+#define TRACE_CODEC_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief Gorilla-style compression of a (timestamp, float) sample stream
+ *
+ * A chunk carries a run of consecutive samples; all multi-byte header fields are
+ * little-endian and the body is a bitstream written most significant bit first.
+ *
+ *   CHUNK | 'T' | 'R' | ver | 0 | count:u16 | timestamp:u32 | value:f32 | bits |
+ *
+ * The first sample is stored in the header. Every following sample is:
+ *
+ *   timestamp  delta-of-delta, zigzag-encoded, as a bit varint:
+ *                '0'                     unchanged delta
+ *                '1' {more:1 data:4}...  low nibble first, more=0 on the last group
+ *   value      XOR with the previous value's bits:
+ *                '0'                     identical
+ *                '10' bits               fits the previous leading/trailing zero window
+ *                '11' lead:5 len-1:5 bits  new window
+ *
+ * A steady 80 SPS trace with a few microseconds of ISR jitter costs about 6 bits
+ * per timestamp. TraceCodec.cpp needs only the C library: tools/trace_decode is
+ * built from it alone, with no Arduino shims, and an edge decoder can do the same.
+ */
+class TraceCodec {
+public:
+    static const uint8_t VERSION = 1;
+    static const size_t HEADER_SIZE = 14;
+
+    // Worst case for one sample: 1 + 8 * 5 timestamp bits, 2 + 5 + 5 + 32 value bits
+    static const size_t MAX_SAMPLE_BITS = 85;
+
+    static uint32_t floatBits(float value);
+    static uint8_t leadingZeros(uint32_t value); // value != 0
+    static uint8_t trailingZeros(uint32_t value); // value != 0
+    static float bitsFloat(uint32_t bits);
+    static void writeU16(uint8_t* out, uint16_t value);
+    static uint16_t readU16(const uint8_t* in);
+    static void writeU32(uint8_t* out, uint32_t value);
+    static uint32_t readU32(const uint8_t* in);
+};
+
+/**
+ * @brief Appends samples to one chunk until it is full
+ *
+ * Keeps no allocation of its own: the caller provides the chunk buffer.
+ */
+class TraceEncoder {
+private:
+    uint8_t* buffer = nullptr;
+    size_t capacity = 0;
+    size_t position = 0;   // Bytes of bitstream written so far
+    uint64_t pending = 0;  // Bits not yet written out, right-aligned
+    uint8_t pendingBits = 0;
+    uint16_t count = 0;
+
+    uint32_t previousTimestamp = 0;
+    int32_t previousDelta = 0;
+    uint32_t previousValue = 0;
+    uint8_t previousLeading = 0xFF; // No window yet
+    uint8_t previousTrailing = 0;
+
+public:
+    // Returns false when the buffer cannot hold the header
+    bool begin(uint8_t* chunk, size_t size);
+
+    // Returns false, leaving the chunk untouched, when the sample might not fit
+    bool append(uint32_t timestamp, float value);
+
+    // Pads the last byte and writes the count; returns the chunk length in bytes
+    size_t finish();
+
+    uint16_t getCount() const { return count; }
+    size_t getBitCount() const { return position * 8 + pendingBits; }
+
+private:
+    void writeBits(uint32_t value, uint8_t bits);
+    void writeTimestamp(uint32_t timestamp);
+    void writeValue(uint32_t bits);
+};
+
+/**
+ * @brief Reads the samples of one chunk back in order
+ */
+class TraceDecoder {
+private:
+    const uint8_t* buffer = nullptr;
+    size_t length = 0;
+    size_t position = 0;
+    uint64_t pending = 0;
+    uint8_t pendingBits = 0;
+    uint16_t count = 0;
+    uint16_t produced = 0;
+    bool truncated = false;
+
+    uint32_t firstTimestamp = 0;
+    uint32_t firstValue = 0;
+    uint32_t previousTimestamp = 0;
+    int32_t previousDelta = 0;
+    uint32_t previousValue = 0;
+    uint8_t previousLeading = 0;
+    uint8_t previousTrailing = 0;
+
+public:
+    // Returns false for a bad magic, unknown version or truncated header
+    bool begin(const uint8_t* chunk, size_t size);
+
+    // Returns false after the last sample or when the bitstream ends early
+    bool next(uint32_t& timestamp, float& value);
+
+    uint16_t getCount() const { return count; }
+    bool isTruncated() const { return truncated; }
+    // Bytes read so far; after the last sample, the chunk's length (the next chunk starts there)
+    size_t getConsumedBytes() const { return TraceCodec::HEADER_SIZE + position; }
+
+private:
+    uint32_t readBits(uint8_t bits);
+};
+
+#endif // TRACE_CODEC_H
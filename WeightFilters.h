@@ -0,0 +1,380 @@
+#ifndef WEIGHT_FILTERS_H
+#define WEIGHT_FILTERS_H
+
+#include <Arduino.h>
+#include <string.h>
+
+/**
+ * @brief Allocation-free DSP stages for the weight signal
+ *
+ * Every stage exposes the same static interface (process, reset, setParameter, name)
+ * so FilterChain can compose them at compile time with no virtual dispatch.
+ * Parameters are addressed as "<stage>.<param>", e.g. "ema.alpha". setParameter()
+ * returns the stage's own literal for the key it applied, or nullptr, so callers
+ * can log the name after the caller's key buffer is gone.
+ */
+
+// Moving average over the last N samples, O(1) per sample
+template <uint8_t N>
+class MovingAverageFilter {
+    static_assert(N > 0, "MovingAverageFilter needs at least one sample");
+
+private:
+    float window[N];
+    float sum = 0.0;
+    uint8_t index = 0;
+    uint8_t count = 0;
+
+public:
+    static const char* name() { return "avg"; }
+
+    float process(float sample) {
+        if (count == N) {
+            sum -= window[index];
+        } else {
+            count++;
+        }
+        window[index] = sample;
+        sum += sample;
+        index = (index + 1) % N;
+        return sum / count;
+    }
+
+    void reset() {
+        sum = 0.0;
+        index = 0;
+        count = 0;
+    }
+
+    const char* setParameter(const char* key, float value) { return nullptr; }
+};
+
+// Running median over the last N samples, O(log N) per sample
+//
+// The window is split into a max-heap of the lower half and a min-heap of the upper
+// half. The heaps hold slot numbers into the arrival-order window and every slot knows
+// where it sits, so the sample that falls out is removed in place instead of searched for.
+template <uint8_t N>
+class RunningMedianFilter {
+    static_assert(N > 0, "RunningMedianFilter needs at least one sample");
+
+private:
+    enum Side : uint8_t { LOW_HALF = 0, HIGH_HALF = 1 };
+
+    float window[N];        // Arrival order
+    // Slot numbers; heap[LOW_HALF] is a max-heap, heap[HIGH_HALF] a min-heap. Between a push
+    // and the rebalance that follows it one half can hold (N + 3) / 2 slots.
+    uint8_t heap[2][(N + 3) / 2];
+    uint8_t heapSize[2] = { 0, 0 };
+    uint8_t sideOf[N];      // Which heap holds each slot
+    uint8_t positionOf[N];  // And where in it
+    uint8_t index = 0;
+    uint8_t count = 0;
+
+    // True when slot a belongs nearer the top of its heap than slot b
+    bool above(uint8_t side, uint8_t a, uint8_t b) const {
+        return side == LOW_HALF ? window[a] > window[b] : window[a] < window[b];
+    }
+
+    void place(uint8_t side, uint8_t position, uint8_t slot) {
+        heap[side][position] = slot;
+        sideOf[slot] = side;
+        positionOf[slot] = position;
+    }
+
+    void siftUp(uint8_t side, uint8_t position) {
+        uint8_t slot = heap[side][position];
+        while (position > 0) {
+            uint8_t parent = (position - 1) / 2;
+            if (!above(side, slot, heap[side][parent])) break;
+            place(side, position, heap[side][parent]);
+            position = parent;
+        }
+        place(side, position, slot);
+    }
+
+    void siftDown(uint8_t side, uint8_t position) {
+        uint8_t slot = heap[side][position];
+        uint8_t size = heapSize[side];
+        while (true) {
+            uint8_t child = 2 * position + 1;
+            if (child >= size) break;
+            if (child + 1 < size && above(side, heap[side][child + 1], heap[side][child])) child++;
+            if (!above(side, heap[side][child], slot)) break;
+            place(side, position, heap[side][child]);
+            position = child;
+        }
+        place(side, position, slot);
+    }
+
+    void push(uint8_t side, uint8_t slot) {
+        place(side, heapSize[side]++, slot);
+        siftUp(side, positionOf[slot]);
+    }
+
+    uint8_t popTop(uint8_t side) {
+        uint8_t top = heap[side][0];
+        remove(top);
+        return top;
+    }
+
+    void remove(uint8_t slot) {
+        uint8_t side = sideOf[slot];
+        uint8_t position = positionOf[slot];
+        uint8_t last = heap[side][--heapSize[side]];
+        if (position == heapSize[side]) return;
+        place(side, position, last);
+        siftUp(side, position);
+        siftDown(side, positionOf[last]);
+    }
+
+    // Lower half holds the extra sample when the count is odd
+    void rebalance() {
+        if (heapSize[LOW_HALF] > heapSize[HIGH_HALF] + 1) {
+            push(HIGH_HALF, popTop(LOW_HALF));
+        } else if (heapSize[HIGH_HALF] > heapSize[LOW_HALF]) {
+            push(LOW_HALF, popTop(HIGH_HALF));
+        }
+    }
+
+public:
+    static const char* name() { return "median"; }
+
+    float process(float sample) {
+        if (count == N) {
+            remove(index);
+            count--;
+        }
+
+        window[index] = sample;
+        bool lower = heapSize[LOW_HALF] > 0 ? sample <= window[heap[LOW_HALF][0]]
+                                            : heapSize[HIGH_HALF] == 0 || sample <= window[heap[HIGH_HALF][0]];
+        push(lower ? LOW_HALF : HIGH_HALF, index);
+        rebalance();
+        count++;
+        index = (index + 1) % N;
+
+        float middle = window[heap[LOW_HALF][0]];
+        return (count & 1) ? middle : (middle + window[heap[HIGH_HALF][0]]) * 0.5f;
+    }
+
+    void reset() {
+        heapSize[LOW_HALF] = 0;
+        heapSize[HIGH_HALF] = 0;
+        index = 0;
+        count = 0;
+    }
+
+    const char* setParameter(const char* key, float value) { return nullptr; }
+};
+
+// Exponential moving average, O(1) per sample
+class EmaFilter {
+private:
+    float alpha;
+    float state = 0.0;
+    bool primed = false;
+
+public:
+    explicit EmaFilter(float alpha = 0.3f) : alpha(alpha) {}
+
+    static const char* name() { return "ema"; }
+
+    float process(float sample) {
+        if (!primed) {
+            state = sample;
+            primed = true;
+        } else {
+            state += alpha * (sample - state);
+        }
+        return state;
+    }
+
+    void reset() { primed = false; }
+
+    const char* setParameter(const char* key, float value) {
+        static const char* const ALPHA = "ema.alpha";
+        if (strcmp(key, ALPHA) == 0 && value > 0.0f && value <= 1.0f) {
+            alpha = value;
+            return ALPHA;
+        }
+        return nullptr;
+    }
+};
+
+// Scalar Kalman filter for a constant-level model, O(1) per sample
+class KalmanFilter1D {
+private:
+    float processNoise;      // q: how fast the true weight is expected to drift
+    float measurementNoise;  // r: variance of a single conversion
+    float estimate = 0.0;
+    float errorCovariance = 1.0;
+    bool primed = false;
+
+public:
+    explicit KalmanFilter1D(float processNoise = 0.05f, float measurementNoise = 4.0f)
+        : processNoise(processNoise), measurementNoise(measurementNoise) {}
+
+    static const char* name() { return "kalman"; }
+
+    float process(float sample) {
+        if (!primed) {
+            estimate = sample;
+            errorCovariance = measurementNoise;
+            primed = true;
+            return estimate;
+        }
+
+        errorCovariance += processNoise;
+        float gain = errorCovariance / (errorCovariance + measurementNoise);
+        estimate += gain * (sample - estimate);
+        errorCovariance *= (1.0f - gain);
+        return estimate;
+    }
+
+    void reset() { primed = false; }
+
+    const char* setParameter(const char* key, float value) {
+        static const char* const Q = "kalman.q";
+        static const char* const R = "kalman.r";
+        if (value <= 0.0f) return nullptr;
+        if (strcmp(key, Q) == 0) {
+            processNoise = value;
+            return Q;
+        }
+        if (strcmp(key, R) == 0) {
+            measurementNoise = value;
+            return R;
+        }
+        return nullptr;
+    }
+};
+
+// Drops isolated jumps larger than maxDelta; a jump that persists is accepted as a real step
+class SpikeRejectFilter {
+private:
+    float maxDelta;
+    uint8_t confirmSamples;
+    float accepted = 0.0;
+    uint8_t rejectedRun = 0;
+    bool primed = false;
+
+public:
+    explicit SpikeRejectFilter(float maxDelta = 500.0f, uint8_t confirmSamples = 3)
+        : maxDelta(maxDelta), confirmSamples(confirmSamples) {}
+
+    static const char* name() { return "spike"; }
+
+    float process(float sample) {
+        if (!primed || fabsf(sample - accepted) <= maxDelta || ++rejectedRun >= confirmSamples) {
+            accepted = sample;
+            rejectedRun = 0;
+            primed = true;
+        }
+        return accepted;
+    }
+
+    void reset() {
+        primed = false;
+        rejectedRun = 0;
+    }
+
+    const char* setParameter(const char* key, float value) {
+        static const char* const DELTA = "spike.delta";
+        static const char* const CONFIRM = "spike.confirm";
+        if (strcmp(key, DELTA) == 0 && value > 0.0f) {
+            maxDelta = value;
+            return DELTA;
+        }
+        if (strcmp(key, CONFIRM) == 0 && value >= 1.0f) {
+            confirmSamples = (uint8_t)value;
+            return CONFIRM;
+        }
+        return nullptr;
+    }
+};
+
+/**
+ * @brief Compile-time composition of filter stages, applied left to right
+ */
+template <typename... Stages>
+class FilterChain;
+
+template <>
+class FilterChain<> {
+public:
+    float process(float sample) { return sample; }
+    void reset() {}
+    const char* setParameter(const char* key, float value) { return nullptr; }
+    void describe(Print& out) const {}
+    void benchmark(Print& out, uint16_t iterations) const {}
+};
+
+template <typename First, typename... Rest>
+class FilterChain<First, Rest...> {
+private:
+    First stage;
+    FilterChain<Rest...> rest;
+
+public:
+    float process(float sample) { return rest.process(stage.process(sample)); }
+
+    void reset() {
+        stage.reset();
+        rest.reset();
+    }
+
+    const char* setParameter(const char* key, float value) {
+        const char* handled = stage.setParameter(key, value);
+        const char* handledLater = rest.setParameter(key, value); // Every stage of that kind
+        return handled != nullptr ? handled : handledLater;
+    }
+
+    void describe(Print& out) const {
+        out.print(First::name());
+        if (sizeof...(Rest) > 0) {
+            out.print(" -> ");
+        }
+        rest.describe(out);
+    }
+
+    // Feeds a noisy step through a copy of each stage and prints its cost in ns/sample
+    void benchmark(Print& out, uint16_t iterations) const {
+        First probe = stage;
+        probe.reset();
+
+        volatile float sink = 0.0;
+        unsigned long start = micros();
+        for (uint16_t i = 0; i < iterations; i++) {
+            float sample = (i < iterations / 2 ? 0.0f : 250.0f) + (float)((i * 37) % 11) - 5.0f;
+            sink = probe.process(sample);
+        }
+        unsigned long elapsed = micros() - start;
+        (void)sink;
+
+        out.print("  ");
+        out.print(First::name());
+        out.print(": ");
+        out.print((elapsed * 1000UL) / iterations);
+        out.println(" ns/sample");
+
+        rest.benchmark(out, iterations);
+    }
+};
+
+// Build-time selection of the weight filter chain
+#ifndef TAVOLO_FILTER_PROFILE
+#define TAVOLO_FILTER_PROFILE 1
+#endif
+
+#if TAVOLO_FILTER_PROFILE == 0
+typedef FilterChain<> WeightFilterChain;                                       // Raw samples
+#elif TAVOLO_FILTER_PROFILE == 2
+typedef FilterChain<SpikeRejectFilter, KalmanFilter1D> WeightFilterChain;      // Smooth, slower settle
+#elif TAVOLO_FILTER_PROFILE == 3
+typedef FilterChain<MovingAverageFilter<3> > WeightFilterChain;                // Legacy get_units(3)
+#else
+typedef FilterChain<SpikeRejectFilter, RunningMedianFilter<5>, EmaFilter> WeightFilterChain;
+#endif
+
+#endif // WEIGHT_FILTERS_H
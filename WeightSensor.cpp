@@ -1,46 +1,61 @@
 #include "WeightSensor.h"
+#include "FlightRecorder.h"
+#include "DeferredLog.h"
+#include "CommandRegistry.h"
 
 WeightSensor::WeightSensor(int dataPin, int clockPin, float calibrationFactor)
-    : Sensor(dataPin), clockPin(clockPin), calibrationFactor(calibrationFactor) {}
+    : Sensor(dataPin), clockPin(clockPin), acquisition(dataPin, clockPin),
+      calibrationFactor(calibrationFactor), cellCount(1) {
+    cellFactors[0] = calibrationFactor;
+}
+
+WeightSensor::WeightSensor(const uint8_t* dataPins, uint8_t cellCount, int clockPin, float calibrationFactor)
+    : Sensor(dataPins[0]), clockPin(clockPin), acquisition(dataPins, cellCount, clockPin),
+      calibrationFactor(calibrationFactor), cellCount(acquisition.getChannelCount()) {
+    for (uint8_t i = 0; i < MAX_CELLS; i++) {
+        cellFactors[i] = calibrationFactor;
+    }
+}
 
 void WeightSensor::begin() {
     Serial.println("Initializing Weight Sensor (HX711)...");
     
     scale.begin(pin, clockPin);
-    scale.set_gain(128);
-    scale.set_scale(calibrationFactor);
     
     // Wait for the scale to stabilize
     Serial.println("Stabilizing scale...");
     delay(1000);
     
-    // Perform initial tare
-    tare();
+    if (ratePin >= 0) {
+        pinMode(ratePin, OUTPUT);
+        digitalWrite(ratePin, getConversionRate() == FAST_RATE ? HIGH : LOW);
+    }
+    
+    // Hand the data lines over to the interrupt-driven producer
+    acquisition.begin(128, getConversionRate());
+    acquisition.start();
+    applySamplingMode(SamplingMode::ACTIVE);
     
     initialized = true;
     calibrated = true;
     
+    // Initial tare of every cell from the first conversions
+    tare();
+    
     Serial.println("Weight Sensor initialized successfully.");
+    Serial.print("Load cells: ");
+    Serial.println(cellCount);
     Serial.print("Calibration Factor: ");
     Serial.println(calibrationFactor, 6);
 }
 
 float WeightSensor::read() {
     if (!initialized || !calibrated) {
-        Serial.println("Warning: Weight sensor not properly initialized");
+        TAVOLO_LOG_WARN(LOG_SENSOR, "Weight sensor not properly initialized");
         return 0.0;
     }
 
-    if (scale.is_ready()) {
-        float weight = scale.get_units(3); // Average of 3 readings
-        
-        // Apply basic filtering
-        if (weight < 0) weight = 0; // No negative weights
-        
-        return weight;
-    }
-    
-    return lastWeight; // Return last known good reading
+    return latestWeight; // Most recent filtered reading, never blocks
 }
 
 bool WeightSensor::isReady() const {
@@ -49,43 +64,409 @@ bool WeightSensor::isReady() const {
 
 void WeightSensor::tare() {
     if (!initialized) {
-        Serial.println("Error: Cannot tare - sensor not initialized");
+        TAVOLO_LOG_ERROR(LOG_SENSOR, "Cannot tare - sensor not initialized");
         return;
     }
     
-    Serial.println("Performing tare...");
-    scale.tare();
-    Serial.println("Tare completed.");
+    TAVOLO_LOG_INFO(LOG_SENSOR, "Performing tare...");
+    for (uint8_t i = 0; i < cellCount; i++) {
+        tareAccumulators[i] = 0;
+    }
+    tareSamplesRemaining = TARE_SAMPLES;
+    pendingSamples = 0;
+    resetBlock();
+    filterChain.reset();
 }
 
 void WeightSensor::setCalibrationFactor(float factor) {
+    if (factor == 0.0f) return;
+    
     calibrationFactor = factor;
+    for (uint8_t i = 0; i < cellCount; i++) {
+        cellFactors[i] = factor;
+    }
     if (initialized) {
-        scale.set_scale(calibrationFactor);
-        Serial.print("Calibration factor updated to: ");
-        Serial.println(calibrationFactor, 6);
+        TAVOLO_LOG_INFO(LOG_SENSOR, "Calibration factor updated to: %.6f", calibrationFactor);
     }
 }
 
+bool WeightSensor::setCellCalibrationFactor(uint8_t cell, float factor) {
+    if (cell >= cellCount || factor == 0.0f) return false;
+    
+    cellFactors[cell] = factor;
+    TAVOLO_LOG_INFO(LOG_SENSOR, "Cell %u calibration factor updated to: %.6f", cell, factor);
+    return true;
+}
+
+void WeightSensor::printCellInfo(Print& out) const {
+    out.print("Load cells: ");
+    out.println(cellCount);
+    for (uint8_t i = 0; i < cellCount; i++) {
+        out.print("  Cell ");
+        out.print(i);
+        out.print(": ");
+        out.print(cellWeights[i], 2);
+        out.print(" g, offset ");
+        out.print(cellOffsets[i]);
+        out.print(", factor ");
+        out.println(cellFactors[i], 6);
+    }
+    out.print("  Total: ");
+    out.print(latestWeight, 2);
+    out.println(" g (filtered)");
+}
+
 void WeightSensor::update() {
+    if (!isReady()) return;
+    
+    if (powerState == PowerState::POWERED_DOWN) {
+        if (millis() - poweredDownAt >= dutySleepMs) {
+            powerUp();
+        }
+        return;
+    }
+    
+    acquisition.service();
+    
+    // Drain everything the ISR produced since the last pass
+    HX711Acquisition::RawSample sample;
+    while (acquisition.pop(sample)) {
+        processSample(sample);
+    }
+    recordAnomalies();
+    
     unsigned long currentTime = millis();
+    updateSamplingMode(currentTime);
+    
+    // Samples already arrive at the mode's pace, one per averaged block
+    if (pendingSamples > 0) {
+        float newWeight = latestWeight;
+        pendingSamples = 0;
+        
+        if (shouldTriggerCallback(newWeight)) {
+            lastWeight = newWeight;
+            notifyDataReady(newWeight);
+        }
+        
+        lastReadTime = currentTime;
+    }
+    
+    // Duty cycling: go back to sleep once this wake's samples show an unchanged, settled load,
+    // and not halfway through an IDLE wake, whose next conversion decides it
+    if (dutySleepMs > 0 && powerState == PowerState::AWAKE && awakeSamplesRemaining == 0 &&
+        wakeHits == 0 && stabilityDetector.isStable() && !isTaring()) {
+        powerDown();
+    }
+}
+
+void WeightSensor::recordAnomalies() {
+    uint32_t overruns = acquisition.getOverrunCount();
+    if (overruns != recordedOverruns) {
+        recordedOverruns = overruns;
+        FlightRecorder::record(FlightLog::SAMPLE_OVERRUN, 0, overruns > UINT16_MAX ? UINT16_MAX : overruns);
+    }
+    
+    uint32_t missed = acquisition.getMissedCount();
+    if (missed != recordedMissed) {
+        recordedMissed = missed;
+        FlightRecorder::record(FlightLog::SAMPLE_MISSED, 0, missed > UINT16_MAX ? UINT16_MAX : missed);
+    }
+}
+
+void WeightSensor::setDutyCycle(unsigned long sleepMs) {
+    dutySleepMs = sleepMs;
+    if (sleepMs == 0 && powerState == PowerState::POWERED_DOWN) {
+        powerUp();
+    }
+    awakeSamplesRemaining = AWAKE_SAMPLES;
+    applySamplingMode(samplingMode); // The IDLE block length depends on the duty cycle
+}
+
+bool WeightSensor::setSamplingPolicy(const SamplingPolicy& policy) {
+    if ((policy.activeRate != SLOW_RATE && policy.activeRate != FAST_RATE) ||
+        policy.activeAveraging == 0 || policy.idleInterval == 0) {
+        return false;
+    }
+    
+    samplingPolicy = policy;
+    stableTiming = false; // Restart the idleAfter countdown under the new policy
+    applySamplingMode(samplingMode);
+    TAVOLO_LOG_INFO(LOG_SENSOR, "Sampling: active %u SPS x%u, idle %lu ms after %lu ms stable",
+                    policy.activeRate, policy.activeAveraging, policy.idleInterval, policy.idleAfter);
+    return true;
+}
+
+uint16_t WeightSensor::getConversionRate() const {
+    // Without a RATE line the converter runs at whatever the board straps it to
+    if (ratePin < 0) return SLOW_RATE;
+    return samplingMode == SamplingMode::ACTIVE ? samplingPolicy.activeRate : SLOW_RATE;
+}
+
+unsigned long WeightSensor::getSamplePeriod() const {
+    return (unsigned long)blockSamples * 1000UL / getConversionRate();
+}
+
+void WeightSensor::applySamplingMode(SamplingMode mode) {
+    if (mode != samplingMode) {
+        modeSwitchCount++;
+        TAVOLO_LOG_DEBUG(LOG_SENSOR, "Sampling mode %s", samplingModeToString(mode));
+    }
+    samplingMode = mode;
+    wakeHits = 0;
+    
+    uint16_t rate = getConversionRate();
+    if (initialized && rate != acquisition.getSampleRate()) {
+        if (ratePin >= 0) {
+            digitalWrite(ratePin, rate == FAST_RATE ? HIGH : LOW);
+        }
+        acquisition.setSampleRate(rate);
+        rateSettleRemaining = SETTLE_SAMPLES; // The digital filter restarts at the new rate
+    }
+    
+    if (mode == SamplingMode::ACTIVE) {
+        // Depth is given at activeRate; a strapped 10 SPS part keeps the same sample period
+        unsigned long conversions = (unsigned long)samplingPolicy.activeAveraging * rate / samplingPolicy.activeRate;
+        blockSamples = conversions == 0 ? 1 : conversions;
+    } else if (dutySleepMs > 0) {
+        blockSamples = AWAKE_SAMPLES; // Duty cycling already spaces the readings out
+    } else {
+        unsigned long conversions = samplingPolicy.idleInterval * rate / 1000;
+        blockSamples = conversions == 0 ? 1 : (conversions > UINT16_MAX ? UINT16_MAX : conversions);
+    }
+    resetBlock();
+}
+
+void WeightSensor::updateSamplingMode(unsigned long now) {
+    if (!stabilityDetector.isStable() || isTaring()) {
+        stableTiming = false;
+        if (samplingMode == SamplingMode::IDLE) {
+            applySamplingMode(SamplingMode::ACTIVE);
+        }
+        return;
+    }
+    
+    if (!stableTiming) {
+        stableTiming = true;
+        stableSince = now;
+    }
+    if (samplingMode == SamplingMode::ACTIVE && now - stableSince >= samplingPolicy.idleAfter) {
+        applySamplingMode(SamplingMode::IDLE);
+    }
+}
+
+float WeightSensor::conversionWeight(const HX711Acquisition::RawSample& sample) const {
+    float total = 0.0f;
+    for (uint8_t i = 0; i < cellCount; i++) {
+        total += (sample.values[i] - cellOffsets[i]) / cellFactors[i];
+    }
+    return total;
+}
+
+void WeightSensor::setConversionHandler(SampleHandler handler, void* context) {
+    conversionHandler = handler;
+    conversionContext = context;
+}
+
+void WeightSensor::setSampleHandler(SampleHandler handler, void* context) {
+    sampleHandler = handler;
+    sampleContext = context;
+}
+
+void WeightSensor::setPowerHandler(PowerHandler handler, void* context) {
+    powerHandler = handler;
+    powerContext = context;
+}
+
+void WeightSensor::resetBlock() {
+    blockCount = 0;
+    for (uint8_t i = 0; i < cellCount; i++) {
+        blockSums[i] = 0;
+    }
+}
+
+const char* WeightSensor::samplingModeToString(SamplingMode mode) {
+    switch (mode) {
+        case SamplingMode::ACTIVE: return "ACTIVE";
+        case SamplingMode::IDLE: return "IDLE";
+        default: return "UNKNOWN";
+    }
+}
+
+void WeightSensor::powerDown() {
+    acquisition.stop();
+    scale.power_down();
+    powerState = PowerState::POWERED_DOWN;
+    poweredDownAt = millis();
+    if (powerHandler != nullptr) {
+        powerHandler(powerContext, true);
+    }
+}
+
+void WeightSensor::powerUp() {
+    if (powerHandler != nullptr) {
+        powerHandler(powerContext, false);
+    }
+    scale.power_up();
+    powerUpMicros = micros();
+    settleSamplesRemaining = SETTLE_SAMPLES;
+    powerState = PowerState::WAKING;
+    resetBlock();
+    acquisition.start();
+}
+
+void WeightSensor::processSample(const HX711Acquisition::RawSample& sample) {
+    if (powerState == PowerState::WAKING) {
+        // The converter needs a few conversions to settle after power-up
+        if (settleSamplesRemaining > 0) {
+            settleSamplesRemaining--;
+            return;
+        }
+        lastWakeLatencyUs = sample.timestamp - powerUpMicros;
+        wakeCount++;
+        powerState = PowerState::AWAKE;
+        awakeSamplesRemaining = AWAKE_SAMPLES;
+    }
+    if (rateSettleRemaining > 0) {
+        rateSettleRemaining--;
+        return;
+    }
+    if (awakeSamplesRemaining > 0) {
+        awakeSamplesRemaining--;
+    }
     
-    if (currentTime - lastReadTime >= READ_INTERVAL_MS) {
-        if (isReady() && scale.is_ready()) {
-            float newWeight = read();
-            
-            if (shouldTriggerCallback(newWeight)) {
-                lastWeight = newWeight;
-                notifyDataReady(newWeight);
+    if (tareSamplesRemaining > 0) {
+        for (uint8_t i = 0; i < cellCount; i++) {
+            tareAccumulators[i] += sample.values[i];
+        }
+        if (--tareSamplesRemaining == 0) {
+            for (uint8_t i = 0; i < cellCount; i++) {
+                cellOffsets[i] = (long)(tareAccumulators[i] / TARE_SAMPLES);
             }
-            
-            lastReadTime = currentTime;
+            stabilityDetector.reset();
+            lastStableWeight = 0.0;
+            unstableSinceMicros = sample.timestamp;
+            TAVOLO_LOG_INFO(LOG_SENSOR, "Tare completed.");
+        }
+        return;
+    }
+    
+    if (conversionHandler != nullptr) {
+        conversionHandler(conversionContext, sample.timestamp, conversionWeight(sample));
+    }
+    
+    // An idle table wakes to ACTIVE as soon as consecutive conversions have moved, not a second
+    // later; one alone may be a knock or a noise spike, and each wake costs a RATE change
+    if (samplingMode == SamplingMode::IDLE) {
+        if (abs(conversionWeight(sample) - lastStableWeight) < eventThreshold) {
+            wakeHits = 0;
+        } else if (++wakeHits >= WAKE_CONVERSIONS) {
+            stableTiming = false;
+            awakeSamplesRemaining = AWAKE_SAMPLES; // Duty cycling: stay up until the block sees the load
+            applySamplingMode(SamplingMode::ACTIVE);
+            return;
         }
     }
+    
+    for (uint8_t i = 0; i < cellCount; i++) {
+        blockSums[i] += sample.values[i];
+    }
+    if (++blockCount < blockSamples) {
+        return;
+    }
+    
+    // All cells were clocked out together, so their sum is one coherent reading
+    float total = 0.0f;
+    for (uint8_t i = 0; i < cellCount; i++) {
+        cellWeights[i] = ((float)blockSums[i] / blockCount - cellOffsets[i]) / cellFactors[i];
+        total += cellWeights[i];
+    }
+    resetBlock();
+    
+    float weight = filterChain.process(total);
+    
+    if (weight < 0) weight = 0; // No negative weights
+    
+    latestWeight = weight;
+    pendingSamples++;
+    if (sampleHandler != nullptr) {
+        sampleHandler(sampleContext, sample.timestamp, weight);
+    }
+    
+    updateStability(weight, sample.timestamp);
+}
+
+void WeightSensor::updateStability(float weight, uint32_t timestamp) {
+    if (!stabilityDetector.addSample(weight, timestamp)) {
+        return;
+    }
+    
+    if (!stabilityDetector.isStable()) {
+        unstableSinceMicros = timestamp;
+        return;
+    }
+    
+    // Settled: compare against the previous settled level and report the action once,
+    // as a single event carrying the delta
+    float settledWeight = stabilityDetector.getMean();
+    float delta = settledWeight - lastStableWeight;
+    unsigned long settleTime = (timestamp - unstableSinceMicros) / 1000;
+    
+    if (delta >= eventThreshold) {
+        emitLoadEvent(LOAD_PLACED, settledWeight, delta, settleTime);
+    } else if (delta <= -eventThreshold) {
+        emitLoadEvent(LOAD_REMOVED, settledWeight, delta, settleTime);
+    } else if (abs(delta) >= weightThreshold) {
+        emitLoadEvent(LOAD_STABLE, settledWeight, delta, settleTime);
+    }
+    
+    lastStableWeight = settledWeight;
+}
+
+void WeightSensor::emitLoadEvent(uint8_t type, float weight, float delta, unsigned long settleTime) {
+    SensorEvent event;
+    event.type = type;
+    event.value = weight;
+    event.delta = delta;
+    event.settleTime = settleTime;
+    event.timestamp = millis();
+    notifyEvent(event);
+}
+
+void WeightSensor::setStabilityBounds(float maxStdDev, float maxSlope) {
+    stabilityDetector.setMaxStdDev(maxStdDev);
+    stabilityDetector.setMaxSlope(maxSlope);
+}
+
+const char* WeightSensor::eventTypeToString(uint8_t type) {
+    switch (type) {
+        case LOAD_PLACED: return "LOAD_PLACED";
+        case LOAD_REMOVED: return "LOAD_REMOVED";
+        case LOAD_STABLE: return "LOAD_STABLE";
+        default: return "UNKNOWN";
+    }
+}
+
+bool WeightSensor::setFilterParameter(const char* key, float value) {
+    // key is the caller's buffer: log the stage's copy of the name, or the key's hash
+    const char* name = filterChain.setParameter(key, value);
+    if (name != nullptr) {
+        TAVOLO_LOG_INFO(LOG_SENSOR, "Filter parameter %s set to %.4f", name, value);
+    } else {
+        TAVOLO_LOG_WARN(LOG_SENSOR, "Filter parameter rejected: key hash %08x (%u chars), value %.4f",
+                        commandHash(key), (unsigned)strlen(key), value);
+    }
+    return name != nullptr;
+}
+
+void WeightSensor::printFilterInfo(Print& out) const {
+    out.print("Filter chain: ");
+    filterChain.describe(out);
+    out.println();
+    filterChain.benchmark(out, 1000);
 }
 
 bool WeightSensor::hasNewData() const {
-    return millis() - lastReadTime < READ_INTERVAL_MS && initialized && calibrated;
+    return millis() - lastReadTime < getSamplePeriod() && initialized && calibrated;
 }
 
 bool WeightSensor::shouldTriggerCallback(float newWeight) const {
@@ -3,26 +3,124 @@
 
 #include "Sensor.h"
 #include "HX711.h"
+#include "HX711Acquisition.h"
+#include "WeightFilters.h"
+#include "StabilityDetector.h"
 
 /**
  * @brief HX711 Weight Sensor implementation following Single Responsibility Principle
  * 
  * This class handles all weight sensing operations using the HX711 load cell amplifier.
  * It provides calibrated weight readings and follows the Open/Closed Principle.
+ * Conversions are acquired by HX711Acquisition on the DRDY interrupt; update() only
+ * drains the sample ring and never waits on the converter.
+ *
+ * A table may carry one load cell per leg, each on its own HX711 sharing a common SCK.
+ * Every cell keeps its own offset and calibration factor; the filters, stability
+ * detection and events work on the summed weight.
  */
 class WeightSensor : public Sensor {
+public:
+    // SensorEvent type codes
+    enum LoadEventType : uint8_t {
+        LOAD_PLACED = 1,  // Settled weight rose by at least eventThreshold
+        LOAD_REMOVED = 2, // Settled weight fell by at least eventThreshold
+        LOAD_STABLE = 3   // Settled at a new value, by less than eventThreshold
+    };
+    
+    static const uint8_t MAX_CELLS = HX711Acquisition::MAX_CHANNELS;
+    
+    // HX711 output data rates, selected by its RATE pin (low/high)
+    static const uint16_t SLOW_RATE = 10;
+    static const uint16_t FAST_RATE = 80;
+    
+    // ACTIVE while the load is moving; IDLE once it has been stable for idleAfter
+    enum class SamplingMode : uint8_t { ACTIVE, IDLE };
+    
+    // Taps on the sample stream; they run on the sensing core inside update()
+    typedef void (*SampleHandler)(void* context, uint32_t timestampMicros, float weight);
+    // Duty cycling switched the converter off (true) or back on (false)
+    typedef void (*PowerHandler)(void* context, bool poweredDown);
+    
+    struct SamplingPolicy {
+        uint16_t activeRate = FAST_RATE;    // SPS while ACTIVE, SLOW_RATE or FAST_RATE
+        uint8_t activeAveraging = 4;        // Conversions averaged into each ACTIVE sample
+        unsigned long idleInterval = 1000;  // ms per IDLE sample
+        unsigned long idleAfter = 3000;     // ms of stable reading before going IDLE
+    };
+
 private:
     int clockPin;
-    HX711 scale;
+    HX711 scale; // Power control only; shared SCK powers every cell down together
+    HX711Acquisition acquisition;
     float calibrationFactor;
+    
+    // Per-cell conversion from raw counts to grams
+    uint8_t cellCount;
+    long cellOffsets[MAX_CELLS] = {};
+    float cellFactors[MAX_CELLS];
+    float cellWeights[MAX_CELLS] = {}; // Latest unfiltered weight per cell
     bool calibrated = false;
     unsigned long lastReadTime = 0;
-    const unsigned long READ_INTERVAL_MS = 100; // 10 Hz sampling rate
     float lastWeight = 0.0;
+    float latestWeight = 0.0;
     float weightThreshold = 1.0; // Minimum weight change to trigger callback
+    
+    // Signal conditioning, selected at build time via TAVOLO_FILTER_PROFILE
+    WeightFilterChain filterChain;
+    uint16_t pendingSamples = 0; // Filtered samples since the last notification
+    
+    // Settle detection and load-event extraction
+    StabilityDetector stabilityDetector;
+    float lastStableWeight = 0.0;
+    uint32_t unstableSinceMicros = 0;
+    float eventThreshold = 5.0; // Minimum settled change reported as placed/removed
+    
+    // Adaptive sampling: conversions are averaged in blocks whose length follows the mode
+    int ratePin = -1; // HX711 RATE, or -1 when it is strapped to 10 SPS
+    SamplingPolicy samplingPolicy;
+    SamplingMode samplingMode = SamplingMode::ACTIVE;
+    uint16_t blockSamples = 1;
+    uint16_t blockCount = 0;
+    int64_t blockSums[MAX_CELLS] = {};
+    uint8_t rateSettleRemaining = 0; // Conversions discarded after a RATE change
+    static const uint8_t WAKE_CONVERSIONS = 2; // Consecutive moved conversions that wake IDLE
+    uint8_t wakeHits = 0;
+    bool stableTiming = false;
+    unsigned long stableSince = 0;
+    uint32_t modeSwitchCount = 0;
+    SampleHandler conversionHandler = nullptr;
+    void* conversionContext = nullptr;
+    SampleHandler sampleHandler = nullptr;
+    void* sampleContext = nullptr;
+    
+    // Non-blocking tare: the next TARE_SAMPLES conversions are averaged into the offset
+    const uint8_t TARE_SAMPLES = 10;
+    uint8_t tareSamplesRemaining = 0;
+    int64_t tareAccumulators[MAX_CELLS] = {};
+    
+    // HX711 duty cycling: power down while stable, wake every dutySleepMs to check
+    enum class PowerState : uint8_t { AWAKE, POWERED_DOWN, WAKING };
+    static const uint8_t SETTLE_SAMPLES = 4;  // Conversions discarded after power-up
+    static const uint8_t AWAKE_SAMPLES = 4;   // Valid conversions taken per wake
+    PowerState powerState = PowerState::AWAKE;
+    unsigned long dutySleepMs = 0;
+    unsigned long poweredDownAt = 0;
+    uint32_t powerUpMicros = 0;
+    uint8_t settleSamplesRemaining = 0;
+    uint8_t awakeSamplesRemaining = 0;
+    uint32_t wakeCount = 0;
+    uint32_t lastWakeLatencyUs = 0;
+    PowerHandler powerHandler = nullptr;
+    void* powerContext = nullptr;
+    
+    // Acquisition totals last written to the flight recorder
+    uint32_t recordedOverruns = 0;
+    uint32_t recordedMissed = 0;
 
 public:
     WeightSensor(int dataPin, int clockPin, float calibrationFactor = 0.42f);
+    WeightSensor(const uint8_t* dataPins, uint8_t cellCount, int clockPin, float calibrationFactor = 0.42f);
     virtual ~WeightSensor() = default;
 
     // Sensor interface implementation
@@ -35,6 +133,53 @@ public:
     void setCalibrationFactor(float factor);
     float getCalibrationFactor() const { return calibrationFactor; }
     void setWeightThreshold(float threshold) { weightThreshold = threshold; }
+    bool isTaring() const { return tareSamplesRemaining > 0; }
+    
+    // Load cells
+    uint8_t getCellCount() const { return cellCount; }
+    float getCellWeight(uint8_t cell) const { return cell < cellCount ? cellWeights[cell] : 0.0f; }
+    long getCellOffset(uint8_t cell) const { return cell < cellCount ? cellOffsets[cell] : 0; }
+    float getCellCalibrationFactor(uint8_t cell) const { return cell < cellCount ? cellFactors[cell] : 0.0f; }
+    bool setCellCalibrationFactor(uint8_t cell, float factor);
+    void printCellInfo(Print& out) const;
+    
+    // Stability detection
+    bool isStable() const { return stabilityDetector.isStable(); }
+    float getStableWeight() const { return lastStableWeight; }
+    void setEventThreshold(float threshold) { eventThreshold = threshold; }
+    void setStabilityBounds(float maxStdDev, float maxSlope);
+    static const char* eventTypeToString(uint8_t type);
+    
+    // Filter pipeline
+    bool setFilterParameter(const char* key, float value);
+    void printFilterInfo(Print& out) const;
+    
+    // Acquisition statistics
+    uint32_t getSampleCount() const { return acquisition.getProducedCount(); }
+    uint32_t getOverrunCount() const { return acquisition.getOverrunCount(); }
+    uint32_t getMissedSampleCount() const { return acquisition.getMissedCount(); }
+    
+    // Power control; a sleep period of 0 keeps the converter powered
+    void setDutyCycle(unsigned long sleepMs);
+    bool isPoweredDown() const { return powerState == PowerState::POWERED_DOWN; }
+    void setPowerHandler(PowerHandler handler, void* context); // Before power-up, after power-down
+    uint32_t getWakeCount() const { return wakeCount; }
+    uint32_t getLastWakeLatency() const { return lastWakeLatencyUs; } // Power-up to first valid sample, us
+    
+    // Adaptive sampling; the RATE pin must be set before begin() to reach FAST_RATE
+    void setRatePin(int pin) { ratePin = pin; }
+    bool setSamplingPolicy(const SamplingPolicy& policy);
+    const SamplingPolicy& getSamplingPolicy() const { return samplingPolicy; }
+    SamplingMode getSamplingMode() const { return samplingMode; }
+    uint16_t getConversionRate() const;
+    unsigned long getSamplePeriod() const; // ms per filtered sample in the current mode
+    uint32_t getModeSwitchCount() const { return modeSwitchCount; }
+    static const char* samplingModeToString(SamplingMode mode);
+    
+    // Every valid conversion, summed over the cells, before averaging and filtering
+    void setConversionHandler(SampleHandler handler, void* context);
+    // Every filtered sample, whether or not it changed enough to be notified
+    void setSampleHandler(SampleHandler handler, void* context);
     
     // Reactive programming support
     void update(); // Non-blocking update method
@@ -42,6 +187,16 @@ public:
 
 private:
     bool shouldTriggerCallback(float newWeight) const;
+    void processSample(const HX711Acquisition::RawSample& sample);
+    void updateStability(float weight, uint32_t timestamp);
+    void emitLoadEvent(uint8_t type, float weight, float delta, unsigned long settleTime);
+    void applySamplingMode(SamplingMode mode);
+    void updateSamplingMode(unsigned long now);
+    float conversionWeight(const HX711Acquisition::RawSample& sample) const;
+    void resetBlock();
+    void powerDown();
+    void powerUp();
+    void recordAnomalies();
 };
 
 #endif // WEIGHT_SENSOR_H
@@ -0,0 +1,115 @@
+#include "WeightTrace.h"
+#include "DeferredLog.h"
+
+WeightTrace::WeightTrace() {
+    current.length = 0;
+    current.count = 0;
+    lastSealed.length = 0;
+    lastSealed.count = 0;
+}
+
+void WeightTrace::setEnabled(bool on) {
+    if (on == enabled) return;
+
+    if (on) {
+        encoder.begin(current.data, sizeof(current.data));
+    } else {
+        flush(); // The edge gets the tail of the trace too
+    }
+    enabled = on;
+    TAVOLO_LOG_INFO(LOG_SENSOR, "Weight trace %s", on ? "started" : "stopped");
+}
+
+void WeightTrace::record(uint32_t timestampMicros, float weight) {
+    if (!enabled) return;
+
+    if (!encoder.append(timestampMicros, weight)) {
+        seal();
+        encoder.append(timestampMicros, weight); // Always fits an empty chunk
+    }
+    sampleCount++;
+}
+
+void WeightTrace::flush() {
+    if (encoder.getCount() > 0) {
+        seal();
+    }
+}
+
+void WeightTrace::seal() {
+    current.count = encoder.getCount();
+    current.length = (uint16_t)encoder.finish();
+    sealedSamples += current.count;
+    sealedBytes += current.length;
+    lastSealed = current;
+    channel.send(current);
+
+    encoder.begin(current.data, sizeof(current.data));
+}
+
+void WeightTrace::printStats(Print& out) const {
+    out.print("Weight trace: ");
+    out.print(enabled ? "on" : "off");
+    out.print(", ");
+    out.print(sampleCount);
+    out.print(" samples, ");
+    out.print(sealedBytes);
+    out.print(" bytes sealed");
+    if (sealedSamples > 0) {
+        out.print(", ");
+        out.print(sealedBytes * 8.0f / sealedSamples, 2);
+        out.print(" bits/sample");
+    }
+    out.println();
+    channel.printStats(out, "  chunks");
+}
+
+void WeightTrace::benchmark(Print& out, uint8_t repetitions) const {
+    if (lastSealed.count == 0) {
+        out.println("  No sealed chunk to benchmark yet");
+        return;
+    }
+
+    // Decode the recorded chunk once, checking the round trip, then time re-encoding it
+    static const uint16_t MAX_SAMPLES = 256;
+    static uint32_t timestamps[MAX_SAMPLES];
+    static float values[MAX_SAMPLES];
+    TraceDecoder decoder;
+    uint16_t samples = 0;
+    if (decoder.begin(lastSealed.data, lastSealed.length)) {
+        while (samples < MAX_SAMPLES && decoder.next(timestamps[samples], values[samples])) {
+            samples++;
+        }
+    }
+    if (samples == 0 || decoder.isTruncated()) {
+        out.println("  Last chunk failed to decode");
+        return;
+    }
+
+    static uint8_t scratch[CHUNK_BYTES];
+    TraceEncoder bench;
+    size_t length = 0;
+    uint32_t start = micros();
+    for (uint8_t r = 0; r < repetitions; r++) {
+        bench.begin(scratch, sizeof(scratch));
+        for (uint16_t i = 0; i < samples; i++) {
+            bench.append(timestamps[i], values[i]);
+        }
+        length = bench.finish();
+    }
+    uint32_t elapsed = micros() - start;
+
+    bool identical = samples < lastSealed.count || memcmp(scratch, lastSealed.data, length) == 0;
+    out.print("  Last chunk: ");
+    out.print(lastSealed.count);
+    out.print(" samples in ");
+    out.print(lastSealed.length);
+    out.print(" bytes (");
+    out.print(lastSealed.length * 8.0f / lastSealed.count, 2);
+    out.print(" bits/sample), encode ");
+    out.print(elapsed * 1000.0f / ((uint32_t)samples * repetitions), 0);
+    out.print(" ns/sample over ");
+    out.print(samples);
+    out.print(" samples, round trip ");
+    out.println(identical ? "OK" : "MISMATCH");
+}
@@ -0,0 +1,61 @@
+#ifndef WEIGHT_TRACE_H
+#define WEIGHT_TRACE_H
+
+#include <Arduino.h>
+#include "CoreChannel.h"
+#include "TraceCodec.h"
+
+/**
+ * @brief Full-rate weight trace, compressed on the sensing core for the edge
+ *
+ * While enabled, every HX711 conversion (summed over the cells, tare-corrected,
+ * before averaging and filtering) is appended to a TraceCodec chunk. Full chunks
+ * are handed to the network core through a small ring and published whole, so
+ * an 80 SPS trace fits over WiFi where one JSON message per sample would not.
+ * A full ring drops the newest chunk and counts it.
+ */
+class WeightTrace {
+public:
+    static const size_t CHUNK_BYTES = 512;
+    static const size_t CHUNK_COUNT = 4; // About 8 s of noisy 80 SPS signal
+
+    struct Chunk {
+        uint16_t length;
+        uint16_t count;
+        uint8_t data[CHUNK_BYTES];
+    };
+
+private:
+    // Sensing core
+    TraceEncoder encoder;
+    Chunk current;
+    Chunk lastSealed; // Kept for benchmark()
+    bool enabled = false;
+    uint32_t sampleCount = 0;
+    uint32_t sealedSamples = 0;
+    uint32_t sealedBytes = 0;
+
+    CoreChannel<Chunk, CHUNK_COUNT> channel;
+
+public:
+    WeightTrace();
+
+    // Sensing core
+    void setEnabled(bool on);
+    bool isEnabled() const { return enabled; }
+    void record(uint32_t timestampMicros, float weight);
+    void flush(); // Seals a partly filled chunk
+
+    // Network core
+    bool receive(Chunk& chunk) { return channel.receive(chunk); }
+    size_t pending() const { return channel.depth(); }
+
+    // Sensing core: live compression ratio, then encode cost replayed over the last chunk
+    void printStats(Print& out) const;
+    void benchmark(Print& out, uint8_t repetitions = 20) const;
+
+private:
+    void seal();
+};
+
+#endif // WEIGHT_TRACE_H
@@ -0,0 +1,171 @@
+#include "WindowAggregator.h"
+
+WindowAggregator::WindowAggregator() {
+    clear(open);
+    memset(&lastSummary, 0, sizeof(lastSummary));
+}
+
+bool WindowAggregator::configure(unsigned long windowMs, uint8_t panes) {
+    if (windowMs == 0) {
+        paneMs = 0;
+        started = false;
+        return true;
+    }
+    if (panes == 0 || panes > MAX_PANES) return false;
+
+    unsigned long length = windowMs / panes;
+    if (length == 0) return false;
+
+    paneCount = panes;
+    paneMs = length;
+    closedPanes = 0;
+    nextPane = 0;
+    started = false;
+    clear(open);
+    return true;
+}
+
+bool WindowAggregator::add(float value, uint32_t timestampMs, Summary& summary) {
+    if (paneMs == 0) return false;
+
+    if (!started) {
+        started = true;
+        paneStart = timestampMs;
+        lastTimestamp = timestampMs;
+        lastAbove = value > threshold;
+        clear(open);
+    }
+
+    // The previous level is held until this sample; the interval is split at pane boundaries
+    bool closed = false;
+    uint32_t elapsed = timestampMs - paneStart;
+    if (elapsed >= paneMs) {
+        uint32_t passed = elapsed / paneMs;
+        if (lastAbove) {
+            open.aboveMs += paneStart + paneMs - lastTimestamp;
+        }
+        closePane();
+        closed = summarize(paneStart + paneMs, summary);
+
+        // Panes skipped by a gap in the samples (sensor powered down, tare) hold the last level
+        for (uint32_t i = 1; i < passed && i <= paneCount; i++) {
+            open.aboveMs = lastAbove ? paneMs : 0;
+            closePane();
+        }
+        paneStart += passed * paneMs;
+        lastTimestamp = paneStart;
+    }
+    if (lastAbove) {
+        open.aboveMs += timestampMs - lastTimestamp;
+    }
+
+    open.count++;
+    if (open.count == 1) {
+        open.min = value;
+        open.max = value;
+    } else {
+        if (value < open.min) open.min = value;
+        if (value > open.max) open.max = value;
+    }
+    float delta = value - open.mean;
+    open.mean += delta / open.count;
+    open.m2 += delta * (value - open.mean);
+
+    lastTimestamp = timestampMs;
+    lastAbove = value > threshold;
+    return closed;
+}
+
+void WindowAggregator::clear(Pane& pane) {
+    pane.count = 0;
+    pane.min = 0.0f;
+    pane.max = 0.0f;
+    pane.mean = 0.0f;
+    pane.m2 = 0.0f;
+    pane.aboveMs = 0;
+}
+
+void WindowAggregator::merge(Pane& into, const Pane& pane) {
+    if (pane.count == 0) return;
+    if (into.count == 0) {
+        uint32_t aboveMs = into.aboveMs;
+        into = pane;
+        into.aboveMs = aboveMs;
+        return;
+    }
+
+    uint32_t total = into.count + pane.count;
+    float delta = pane.mean - into.mean;
+    into.mean += delta * pane.count / total;
+    into.m2 += pane.m2 + delta * delta * ((float)into.count * pane.count / total);
+    into.count = total;
+    if (pane.min < into.min) into.min = pane.min;
+    if (pane.max > into.max) into.max = pane.max;
+}
+
+void WindowAggregator::closePane() {
+    panes[nextPane] = open;
+    nextPane = (nextPane + 1) % paneCount;
+    if (closedPanes < paneCount) {
+        closedPanes++;
+    }
+    clear(open);
+}
+
+bool WindowAggregator::summarize(uint32_t windowEnd, Summary& summary) {
+    // A sliding window is only reported once it spans its full length
+    if (closedPanes < paneCount) return false;
+
+    Pane window;
+    clear(window);
+    uint32_t aboveMs = 0;
+    for (uint8_t i = 0; i < paneCount; i++) {
+        merge(window, panes[i]);
+        aboveMs += panes[i].aboveMs;
+    }
+    if (window.count == 0) return false;
+
+    summary.windowMs = paneMs * paneCount;
+    summary.hopMs = paneMs;
+    summary.timestamp = windowEnd;
+    summary.count = window.count;
+    summary.min = window.min;
+    summary.max = window.max;
+    summary.mean = window.mean;
+    summary.variance = window.count > 1 ? window.m2 / (window.count - 1) : 0.0f;
+    summary.aboveMs = aboveMs;
+
+    summaryCount++;
+    lastSummary = summary;
+    return true;
+}
+
+void WindowAggregator::printStats(Print& out, const char* name) const {
+    out.print(name);
+    if (paneMs == 0) {
+        out.println(": disabled");
+        return;
+    }
+    out.print(": ");
+    out.print(paneMs * paneCount);
+    out.print(" ms window, hop ");
+    out.print(paneMs);
+    out.print(" ms, ");
+    out.print(summaryCount);
+    out.println(" summaries");
+    if (summaryCount == 0) return;
+
+    out.print("  last: ");
+    out.print(lastSummary.count);
+    out.print(" samples, min ");
+    out.print(lastSummary.min, 1);
+    out.print(" g, max ");
+    out.print(lastSummary.max, 1);
+    out.print(" g, mean ");
+    out.print(lastSummary.mean, 1);
+    out.print(" g, stddev ");
+    out.print(sqrtf(lastSummary.variance), 2);
+    out.print(" g, above threshold ");
+    out.print(lastSummary.aboveMs);
+    out.println(" ms");
+}
@@ -0,0 +1,83 @@
+#ifndef WINDOW_AGGREGATOR_H
+#define WINDOW_AGGREGATOR_H
+
+#include <Arduino.h>
+
+/**
+ * @brief Running summary of the weight signal over tumbling or sliding time windows
+ *
+ * The window is split into panes of windowMs / panes. Each sample updates the
+ * open pane in O(1): count, min, max, Welford mean/M2, and time spent above the
+ * threshold (the previous sample's level is held until the next one). When a pane
+ * closes, the last `panes` panes are merged (Chan's parallel variance) into one
+ * summary. With one pane the window is tumbling; with more it slides by one pane
+ * per summary. Samples taken while the sensor is idle arrive at about 1 Hz, so
+ * the mean and variance are per sample rather than time-weighted.
+ *
+ * Timestamps are millis() values: the counters span the 49-day wrap of that clock,
+ * where microseconds would alias any gap longer than 71 minutes.
+ */
+class WindowAggregator {
+public:
+    static const uint8_t MAX_PANES = 12;
+
+    struct Summary {
+        unsigned long windowMs;
+        unsigned long hopMs;
+        unsigned long timestamp; // millis() at the end of the last pane
+        uint32_t count;
+        float min;
+        float max;
+        float mean;
+        float variance;
+        unsigned long aboveMs;   // Time above the threshold within the window
+    };
+
+private:
+    struct Pane {
+        uint32_t count;
+        float min;
+        float max;
+        float mean;
+        float m2;
+        uint32_t aboveMs;
+    };
+
+    Pane panes[MAX_PANES];
+    Pane open;
+    uint8_t paneCount = 1;
+    uint8_t closedPanes = 0; // Saturates at paneCount
+    uint8_t nextPane = 0;
+    uint32_t paneMs = 0;     // 0 while disabled
+    uint32_t paneStart = 0;
+    bool started = false;
+
+    float threshold = 0.0f;
+    uint32_t lastTimestamp = 0;
+    bool lastAbove = false;
+
+    uint32_t summaryCount = 0;
+    Summary lastSummary;
+
+public:
+    WindowAggregator();
+
+    // A window of 0 disables the aggregator; returns false for invalid settings
+    bool configure(unsigned long windowMs, uint8_t panes = 1);
+    void setThreshold(float value) { threshold = value; }
+    bool isEnabled() const { return paneMs > 0; }
+
+    // Returns true when a window closed with this sample and fills summary
+    bool add(float value, uint32_t timestampMs, Summary& summary);
+
+    uint32_t getSummaryCount() const { return summaryCount; }
+    void printStats(Print& out, const char* name) const;
+
+private:
+    static void clear(Pane& pane);
+    static void merge(Pane& into, const Pane& pane);
+    void closePane();
+    bool summarize(uint32_t windowEnd, Summary& summary);
+};
+
+#endif // WINDOW_AGGREGATOR_H
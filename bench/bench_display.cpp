@@ -0,0 +1,151 @@
+// Host cost of the weight screen per loop pass: String composition on every call, as
+// DisplayManager used to do it, against the lazy char-buffer composition it does now
+//
+// Both sides run the same loop as TavoloSystem: showWeightData() and update() on every
+// 10 ms pass, LCD refresh every 200 ms, through the same LcdFrameBuffer and LCD model.
+// Usage: bench_display [passes]
+#include <DisplayManager.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+namespace {
+
+const uint8_t LEGACY_ADDRESS = 0x26;
+const uint8_t LAZY_ADDRESS = 0x25;
+
+// The String-based composition, condensed from DisplayManager before it went lazy
+class LegacyWeightScreen {
+private:
+    LiquidCrystal_I2C lcd;
+    LcdFrameBuffer frameBuffer;
+    String line1Content, line2Content, line3Content, line4Content;
+    unsigned long lastUpdate = 0;
+    uint32_t composeCount = 0;
+
+    static String centerText(const String& text, int width) {
+        if ((int)text.length() >= width) {
+            return text.substring(0, width);
+        }
+        int padding = (width - text.length()) / 2;
+        String result = "";
+        for (int i = 0; i < padding; i++) {
+            result += " ";
+        }
+        result += text;
+        while ((int)result.length() < width) {
+            result += " ";
+        }
+        return result;
+    }
+
+    static String formatWeight(float weight) {
+        if (weight < 1000) {
+            return String(weight, 1) + " g";
+        }
+        return String(weight / 1000.0, 2) + " kg";
+    }
+
+public:
+    LegacyWeightScreen() : lcd(LEGACY_ADDRESS, 20, 4), frameBuffer(20, 4) {}
+
+    void begin() {
+        lcd.init();
+        lcd.clear();
+        frameBuffer.markCleared();
+    }
+
+    void showWeightData(float weight, const String& status) {
+        line1Content = centerText("TAVOLO WEIGHT", 20);
+        line2Content = centerText(formatWeight(weight), 20);
+        line3Content = centerText("Status: " + status, 20);
+        line4Content = centerText("Connected to Edge", 20);
+        composeCount++;
+    }
+
+    void update() {
+        unsigned long currentTime = millis();
+        if (currentTime - lastUpdate >= 200) {
+            frameBuffer.setLine(0, line1Content.c_str());
+            frameBuffer.setLine(1, line2Content.c_str());
+            frameBuffer.setLine(2, line3Content.c_str());
+            frameBuffer.setLine(3, line4Content.c_str());
+            frameBuffer.flush(lcd);
+            lastUpdate = currentTime;
+        }
+    }
+
+    uint32_t getComposeCount() const { return composeCount; }
+};
+
+uint64_t nowNanos() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+// Weight seen on pass i: settled for long stretches, or changing on every pass
+float weightAt(uint32_t pass, bool noisy) {
+    if (noisy) return 250.0f + (float)(pass % 17) * 0.1f;
+    return (pass / 500) % 2 ? 250.0f : 0.0f;
+}
+
+struct Result {
+    double nsPerPass;
+    uint32_t compositions;
+};
+
+Result runLegacy(uint32_t passes, bool noisy) {
+    LegacyWeightScreen screen;
+    screen.begin();
+    uint64_t busy = 0;
+    for (uint32_t i = 0; i < passes; i++) {
+        uint64_t start = nowNanos();
+        // The caller built its status String every pass too
+        String status = weightAt(i, noisy) > 200.0f ? "OVER LIMIT" : "NORMAL";
+        screen.showWeightData(weightAt(i, noisy), status);
+        screen.update();
+        busy += nowNanos() - start;
+        delay(10);
+    }
+    Result result = { (double)busy / passes, screen.getComposeCount() };
+    return result;
+}
+
+Result runLazy(uint32_t passes, bool noisy) {
+    DisplayManager display(LAZY_ADDRESS, 20, 4);
+    display.begin();
+    uint64_t busy = 0;
+    for (uint32_t i = 0; i < passes; i++) {
+        uint64_t start = nowNanos();
+        display.showWeightData(weightAt(i, noisy), weightAt(i, noisy) > 200.0f ? "OVER LIMIT" : "NORMAL");
+        display.update();
+        busy += nowNanos() - start;
+        delay(10);
+    }
+    Result result = { (double)busy / passes, display.getComposeCount() };
+    return result;
+}
+
+void report(const char* scenario, uint32_t passes, bool noisy) {
+    Result legacy = runLegacy(passes, noisy);
+    Result lazy = runLazy(passes, noisy);
+    printf("%s:\n", scenario);
+    printf("  %-28s %8.1f ns/pass, %u compositions\n", "String, every call", legacy.nsPerPass,
+           (unsigned)legacy.compositions);
+    printf("  %-28s %8.1f ns/pass, %u compositions\n", "char buffers, lazy", lazy.nsPerPass,
+           (unsigned)lazy.compositions);
+}
+
+}
+
+int main(int argc, char** argv) {
+    uint32_t passes = argc > 1 ? strtoul(argv[1], nullptr, 10) : 100000;
+    if (passes == 0) passes = 100000;
+    Serial.setEcho(false);
+
+    printf("Weight screen, %u loop passes of 10 ms, refresh every 200 ms\n", (unsigned)passes);
+    report("Settled weight (changes every 5 s)", passes, false);
+    report("Weight changing on every pass", passes, true);
+    return 0;
+}
@@ -0,0 +1,117 @@
+// Host cost of each weight filter stage in ns/sample, on the wall clock
+//
+// FilterChain::benchmark() times stages with micros(), which is the virtual clock on the
+// host and never moves during a computation, so this measures with CLOCK_MONOTONIC instead.
+// Usage: bench_filters [samples]
+#include <WeightFilters.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+namespace {
+
+// The sorted-array median the two-heap one replaced, kept here for comparison
+template <uint8_t N>
+class SortedArrayMedian {
+private:
+    float window[N];
+    float sorted[N];
+    uint8_t index = 0;
+    uint8_t count = 0;
+
+    uint8_t lowerBound(float value) const {
+        uint8_t low = 0;
+        uint8_t high = count;
+        while (low < high) {
+            uint8_t mid = (low + high) / 2;
+            if (sorted[mid] < value) {
+                low = mid + 1;
+            } else {
+                high = mid;
+            }
+        }
+        return low;
+    }
+
+public:
+    float process(float sample) {
+        if (count == N) {
+            uint8_t oldest = lowerBound(window[index]);
+            memmove(&sorted[oldest], &sorted[oldest + 1], (count - oldest - 1) * sizeof(float));
+            count--;
+        }
+        uint8_t position = lowerBound(sample);
+        memmove(&sorted[position + 1], &sorted[position], (count - position) * sizeof(float));
+        sorted[position] = sample;
+        count++;
+        window[index] = sample;
+        index = (index + 1) % N;
+        return (count & 1) ? sorted[count / 2] : (sorted[count / 2 - 1] + sorted[count / 2]) * 0.5f;
+    }
+};
+
+uint64_t nowNanos() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+// Noisy steps between 0 and 250 g, precomputed so generating them is not timed
+float* makeInput(size_t samples) {
+    float* input = new float[samples];
+    uint32_t state = 0x2545F491;
+    for (size_t i = 0; i < samples; i++) {
+        state = state * 1664525u + 1013904223u;
+        float noise = (float)((state >> 8) % 1000) / 100.0f - 5.0f;
+        input[i] = ((i / 4096) & 1 ? 250.0f : 0.0f) + noise;
+    }
+    return input;
+}
+
+volatile float sink;
+
+template <typename Stage>
+void measure(const char* label, Stage stage, const float* input, size_t samples) {
+    double best = 0.0;
+    for (int run = 0; run < 5; run++) {
+        uint64_t start = nowNanos();
+        for (size_t i = 0; i < samples; i++) {
+            sink = stage.process(input[i]);
+        }
+        double perSample = (double)(nowNanos() - start) / samples;
+        if (run == 0 || perSample < best) best = perSample;
+    }
+    printf("  %-32s %8.2f ns/sample\n", label, best);
+}
+
+}
+
+int main(int argc, char** argv) {
+    size_t samples = argc > 1 ? strtoul(argv[1], nullptr, 10) : 1000000;
+    if (samples == 0) samples = 1000000;
+    float* input = makeInput(samples);
+
+    printf("Stages (%zu samples, best of 5):\n", samples);
+    measure("spike", SpikeRejectFilter(), input, samples);
+    measure("avg<3>", MovingAverageFilter<3>(), input, samples);
+    measure("median<5>", RunningMedianFilter<5>(), input, samples);
+    measure("ema", EmaFilter(), input, samples);
+    measure("kalman", KalmanFilter1D(), input, samples);
+
+    printf("Median, two heaps vs sorted array:\n");
+    measure("heaps<5>", RunningMedianFilter<5>(), input, samples);
+    measure("sorted<5>", SortedArrayMedian<5>(), input, samples);
+    measure("heaps<31>", RunningMedianFilter<31>(), input, samples);
+    measure("sorted<31>", SortedArrayMedian<31>(), input, samples);
+    measure("heaps<127>", RunningMedianFilter<127>(), input, samples);
+    measure("sorted<127>", SortedArrayMedian<127>(), input, samples);
+
+    printf("Chains:\n");
+    measure("profile 1 (spike, median, ema)",
+            FilterChain<SpikeRejectFilter, RunningMedianFilter<5>, EmaFilter>(), input, samples);
+    measure("profile 2 (spike, kalman)", FilterChain<SpikeRejectFilter, KalmanFilter1D>(), input, samples);
+    measure("profile 3 (avg<3>)", FilterChain<MovingAverageFilter<3> >(), input, samples);
+
+    delete[] input;
+    return 0;
+}
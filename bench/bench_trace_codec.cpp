@@ -0,0 +1,201 @@
+// Weight trace compression: bits/sample on the wire and encode/decode ns/sample
+//
+// With files, measures the traces recorded in them (TraceCodec chunks back to back, as
+// trace_decode reads them). Without, records its own through WeightSensor on four
+// simulated HX711s, at the rates it picks (80 SPS while the load moves, 10 once idle).
+// The simulated converters have no ISR jitter, so their timestamps cost a bit each; a
+// trace from the device shows the real timestamp cost.
+// Usage: bench_trace_codec [file...]
+#include <WeightSensor.h>
+#include <WeightTrace.h>
+#include "SimHx711.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+namespace {
+
+const size_t MAX_SAMPLES = 1 << 16;
+const uint8_t DATA_PINS[] = { 2, 16, 17, 18 };
+const uint8_t CELLS = sizeof(DATA_PINS);
+const uint8_t CLOCK_PIN = 4;
+const uint8_t RATE_PIN = 15;
+const float COUNTS_PER_GRAM = 420.0f; // A 5 kg cell set at gain 128, summed over the cells
+
+struct Trace {
+    uint32_t timestamps[MAX_SAMPLES];
+    float values[MAX_SAMPLES];
+    size_t count = 0;
+};
+
+Trace trace;
+uint8_t chunks[MAX_SAMPLES * TraceCodec::MAX_SAMPLE_BITS / 8 + 4096];
+
+uint64_t nowNanos() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+void record(void* context, uint32_t timestampMicros, float weight) {
+    Trace* into = static_cast<Trace*>(context);
+    if (into->count < MAX_SAMPLES) {
+        into->timestamps[into->count] = timestampMicros;
+        into->values[into->count] = weight;
+        into->count++;
+    }
+}
+
+// Every conversion WeightSensor hands to WeightTrace while the waveform plays
+void recordSimulated(const Waveform& waveform, int32_t noiseCounts) {
+    VirtualClock::reset();
+    HostGpio::reset();
+    SimHx711* cells[CELLS];
+    for (uint8_t i = 0; i < CELLS; i++) {
+        cells[i] = new SimHx711(DATA_PINS[i], CLOCK_PIN, RATE_PIN);
+        cells[i]->setCountsPerGram(COUNTS_PER_GRAM / CELLS);
+        cells[i]->setNoise(noiseCounts);
+        cells[i]->begin();
+    }
+    {
+        WeightSensor sensor(DATA_PINS, CELLS, CLOCK_PIN, COUNTS_PER_GRAM);
+        sensor.setRatePin(RATE_PIN);
+        sensor.begin();
+        for (uint8_t i = 0; i < CELLS; i++) cells[i]->play(waveform);
+        trace.count = 0;
+        sensor.setConversionHandler(record, &trace);
+        uint64_t end = VirtualClock::now() + (uint64_t)waveform.getDuration() * 1000;
+        while (VirtualClock::now() < end) {
+            sensor.update();
+            delay(1);
+        }
+    }
+    for (uint8_t i = 0; i < CELLS; i++) delete cells[i];
+}
+
+// Loads a file of chunks; returns false if any of it does not decode
+bool recordFile(const char* path) {
+    FILE* in = fopen(path, "rb");
+    if (in == nullptr) {
+        fprintf(stderr, "%s: cannot open\n", path);
+        return false;
+    }
+    size_t length = fread(chunks, 1, sizeof(chunks), in);
+    fclose(in);
+
+    trace.count = 0;
+    size_t offset = 0;
+    while (offset < length) {
+        TraceDecoder decoder;
+        if (!decoder.begin(chunks + offset, length - offset)) break;
+        while (trace.count < MAX_SAMPLES &&
+               decoder.next(trace.timestamps[trace.count], trace.values[trace.count])) {
+            trace.count++;
+        }
+        if (decoder.isTruncated()) break;
+        offset += decoder.getConsumedBytes();
+    }
+    if (offset != length) {
+        fprintf(stderr, "%s: bad chunk at byte %zu\n", path, offset);
+        return false;
+    }
+    return trace.count > 0;
+}
+
+// Encodes the whole trace into WeightTrace-sized chunks, sealing full ones as it does
+size_t encodeAll() {
+    TraceEncoder encoder;
+    size_t total = 0;
+    encoder.begin(chunks, WeightTrace::CHUNK_BYTES);
+    for (size_t i = 0; i < trace.count; i++) {
+        if (!encoder.append(trace.timestamps[i], trace.values[i])) {
+            total += encoder.finish();
+            encoder.begin(chunks + total, WeightTrace::CHUNK_BYTES);
+            encoder.append(trace.timestamps[i], trace.values[i]);
+        }
+    }
+    total += encoder.finish();
+    return total;
+}
+
+volatile uint32_t sink;
+
+size_t decodeAll(size_t length) {
+    size_t samples = 0;
+    size_t offset = 0;
+    while (offset < length) {
+        TraceDecoder decoder;
+        if (!decoder.begin(chunks + offset, length - offset)) break;
+        uint32_t timestamp;
+        float value;
+        while (decoder.next(timestamp, value)) {
+            sink = timestamp;
+            samples++;
+        }
+        offset += decoder.getConsumedBytes();
+    }
+    return samples;
+}
+
+void measure(const char* label) {
+    if (trace.count < 2) {
+        printf("  %-34s too short\n", label);
+        return;
+    }
+    double bestEncode = 0.0;
+    double bestDecode = 0.0;
+    size_t length = 0;
+    bool intact = true;
+    for (int run = 0; run < 5; run++) {
+        uint64_t start = nowNanos();
+        length = encodeAll();
+        double encode = (double)(nowNanos() - start) / trace.count;
+        start = nowNanos();
+        intact = decodeAll(length) == trace.count && intact;
+        double decode = (double)(nowNanos() - start) / trace.count;
+        if (run == 0 || encode < bestEncode) bestEncode = encode;
+        if (run == 0 || decode < bestDecode) bestDecode = decode;
+    }
+    double seconds = (uint32_t)(trace.timestamps[trace.count - 1] - trace.timestamps[0]) / 1e6;
+    printf("  %-34s %6zu samples %5.1f SPS %6.2f bits/sample %7.1f ns enc %7.1f ns dec %s\n", label,
+           trace.count, (trace.count - 1) / seconds, length * 8.0 / trace.count, bestEncode, bestDecode,
+           intact ? "" : "MISMATCH");
+}
+
+}
+
+int main(int argc, char** argv) {
+    Serial.setEcho(false);
+    printf("Chunks of %zu bytes, header included; raw is 64 bits/sample; best of 5:\n",
+           WeightTrace::CHUNK_BYTES);
+
+    if (argc > 1) {
+        int failures = 0;
+        for (int i = 1; i < argc; i++) {
+            if (recordFile(argv[i])) {
+                measure(argv[i]);
+            } else {
+                failures++;
+            }
+        }
+        return failures == 0 ? 0 : 1;
+    }
+
+    Waveform empty;
+    empty.set(0).hold(60000);
+    recordSimulated(empty, 0);
+    measure("empty table, no noise");
+    recordSimulated(empty, 40);
+    measure("empty table, noisy cells");
+
+    Waveform placement;
+    placement.set(0).hold(2000).rampTo(250, 300).jitter(3, 2000, 200).hold(20000).rampTo(0, 300).hold(5000);
+    recordSimulated(placement, 40);
+    measure("250 g placed and removed");
+
+    Waveform drift;
+    drift.set(1200).rampTo(1205, 60000);
+    recordSimulated(drift, 40);
+    measure("1.2 kg creeping 5 g a minute");
+    return 0;
+}
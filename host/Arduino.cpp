@@ -0,0 +1,529 @@
+#include <Arduino.h>
+#include <stdarg.h>
+#include <ctype.h>
+#include "VirtualClock.h"
+#include "HostGpio.h"
+
+HardwareSerial Serial;
+EspClass ESP;
+
+namespace {
+
+uint32_t cpuFrequencyMhz = 240;
+uint32_t randomState = 0x12345678;
+
+uint32_t nextRandom() {
+    // xorshift32: reproducible runs, unlike the target's hardware RNG
+    randomState ^= randomState << 13;
+    randomState ^= randomState >> 17;
+    randomState ^= randomState << 5;
+    return randomState;
+}
+
+}
+
+// ---------------------------------------------------------------------------
+// Time
+
+unsigned long millis() {
+    return (unsigned long)(VirtualClock::now() / 1000);
+}
+
+unsigned long micros() {
+    return (unsigned long)VirtualClock::now();
+}
+
+void delay(uint32_t ms) {
+    VirtualClock::advance((uint64_t)ms * 1000);
+}
+
+void delayMicroseconds(uint32_t us) {
+    VirtualClock::advance(us);
+}
+
+void yield() {}
+
+// ---------------------------------------------------------------------------
+// GPIO
+
+void pinMode(uint8_t pin, uint8_t mode) {
+    HostGpio::setMode(pin, mode);
+}
+
+void digitalWrite(uint8_t pin, uint8_t value) {
+    HostGpio::write(pin, value);
+}
+
+int digitalRead(uint8_t pin) {
+    return HostGpio::read(pin);
+}
+
+void analogWrite(uint8_t pin, int value) {
+    HostGpio::writeAnalog(pin, value);
+}
+
+void attachInterrupt(uint8_t pin, void (*handler)(void), int mode) {
+    HostGpio::attachInterrupt(pin, handler, mode);
+}
+
+void detachInterrupt(uint8_t pin) {
+    HostGpio::detachInterrupt(pin);
+}
+
+void noInterrupts() {
+    HostGpio::disableInterrupts();
+}
+
+void interrupts() {
+    HostGpio::enableInterrupts();
+}
+
+// ---------------------------------------------------------------------------
+// Misc
+
+long random(long max) {
+    return max <= 0 ? 0 : (long)(nextRandom() % (unsigned long)max);
+}
+
+long random(long min, long max) {
+    return max <= min ? min : min + random(max - min);
+}
+
+void randomSeed(unsigned long seed) {
+    randomState = seed ? (uint32_t)seed : 0x12345678;
+}
+
+bool setCpuFrequencyMhz(uint32_t mhz) {
+    cpuFrequencyMhz = mhz;
+    return true;
+}
+
+uint32_t getCpuFrequencyMhz() {
+    return cpuFrequencyMhz;
+}
+
+void configTime(long gmtOffsetSec, int daylightOffsetSec, const char* server1,
+                const char* server2, const char* server3) {}
+
+bool getLocalTime(struct tm* info, uint32_t timeoutMs) {
+    return false;
+}
+
+uint32_t EspClass::getCycleCount() {
+    return (uint32_t)(VirtualClock::now() * cpuFrequencyMhz);
+}
+
+void EspClass::restart() {
+    fprintf(stderr, "ESP.restart() called at %lu ms\n", millis());
+    exit(3);
+}
+
+// ---------------------------------------------------------------------------
+// String
+
+String::String(const char* text) {
+    assign(text ? text : "", text ? strlen(text) : 0);
+}
+
+String::String(const String& other) {
+    assign(other.c_str(), other.len);
+}
+
+String::String(String&& other) : buffer(other.buffer), capacity(other.capacity), len(other.len) {
+    other.buffer = nullptr;
+    other.capacity = 0;
+    other.len = 0;
+}
+
+String::String(char c) {
+    assign(&c, 1);
+}
+
+String::String(int value, unsigned char base) : String((long)value, base) {}
+
+String::String(unsigned int value, unsigned char base) : String((unsigned long)value, base) {}
+
+String::String(long value, unsigned char base) {
+    char text[72];
+    if (base == DEC) {
+        snprintf(text, sizeof(text), "%ld", value);
+        assign(text, strlen(text));
+    } else {
+        *this = String((unsigned long)value, base);
+    }
+}
+
+String::String(unsigned long value, unsigned char base) {
+    char text[72];
+    char* end = text + sizeof(text) - 1;
+    char* cursor = end;
+    *cursor = '\0';
+    if (base < 2) base = DEC;
+    do {
+        unsigned digit = value % base;
+        *--cursor = digit < 10 ? '0' + digit : 'a' + digit - 10;
+        value /= base;
+    } while (value > 0);
+    assign(cursor, end - cursor);
+}
+
+String::String(float value, unsigned int decimals) : String((double)value, decimals) {}
+
+String::String(double value, unsigned int decimals) {
+    char text[48];
+    snprintf(text, sizeof(text), "%.*f", (int)decimals, value);
+    assign(text, strlen(text));
+}
+
+String::~String() {
+    free(buffer);
+}
+
+String& String::operator=(const String& other) {
+    if (this != &other) assign(other.c_str(), other.len);
+    return *this;
+}
+
+String& String::operator=(String&& other) {
+    if (this != &other) {
+        free(buffer);
+        buffer = other.buffer;
+        capacity = other.capacity;
+        len = other.len;
+        other.buffer = nullptr;
+        other.capacity = 0;
+        other.len = 0;
+    }
+    return *this;
+}
+
+String& String::operator=(const char* text) {
+    assign(text ? text : "", text ? strlen(text) : 0);
+    return *this;
+}
+
+bool String::reserve(unsigned int size) {
+    if (buffer != nullptr && capacity >= size) return true;
+    char* grown = (char*)realloc(buffer, size + 1);
+    if (grown == nullptr) return false;
+    if (buffer == nullptr) grown[0] = '\0';
+    buffer = grown;
+    capacity = size;
+    return true;
+}
+
+void String::assign(const char* text, unsigned int length) {
+    if (!reserve(length)) {
+        len = 0;
+        return;
+    }
+    memmove(buffer, text, length);
+    buffer[length] = '\0';
+    len = length;
+}
+
+bool String::concat(const char* text, unsigned int length) {
+    if (text == nullptr) return false;
+    if (length == 0) return true;
+    if (!reserve(len + length)) return false;
+    memcpy(buffer + len, text, length);
+    len += length;
+    buffer[len] = '\0';
+    return true;
+}
+
+bool String::equalsIgnoreCase(const String& other) const {
+    if (len != other.len) return false;
+    for (unsigned int i = 0; i < len; i++) {
+        if (tolower((unsigned char)buffer[i]) != tolower((unsigned char)other.buffer[i])) return false;
+    }
+    return true;
+}
+
+char& String::operator[](unsigned int index) {
+    static char dummy;
+    if (index >= len) {
+        dummy = '\0';
+        return dummy;
+    }
+    return buffer[index];
+}
+
+bool String::startsWith(const String& prefix) const {
+    return prefix.len <= len && strncmp(c_str(), prefix.c_str(), prefix.len) == 0;
+}
+
+bool String::endsWith(const String& suffix) const {
+    return suffix.len <= len && strcmp(c_str() + len - suffix.len, suffix.c_str()) == 0;
+}
+
+int String::indexOf(char c, unsigned int from) const {
+    if (from >= len) return -1;
+    const char* found = strchr(c_str() + from, c);
+    return found ? (int)(found - c_str()) : -1;
+}
+
+int String::indexOf(const char* text, unsigned int from) const {
+    if (from > len) return -1;
+    const char* found = strstr(c_str() + from, text);
+    return found ? (int)(found - c_str()) : -1;
+}
+
+String String::substring(unsigned int from, unsigned int to) const {
+    if (from > to) std::swap(from, to);
+    if (from >= len) return String();
+    if (to > len) to = len;
+    String result;
+    result.assign(c_str() + from, to - from);
+    return result;
+}
+
+void String::replace(const String& find, const String& replacement) {
+    if (find.len == 0 || len == 0) return;
+    String result;
+    const char* cursor = c_str();
+    const char* found;
+    while ((found = strstr(cursor, find.c_str())) != nullptr) {
+        result.concat(cursor, found - cursor);
+        result.concat(replacement);
+        cursor = found + find.len;
+    }
+    result.concat(cursor);
+    *this = static_cast<String&&>(result);
+}
+
+void String::remove(unsigned int index, unsigned int count) {
+    if (index >= len) return;
+    if (count > len - index) count = len - index;
+    memmove(buffer + index, buffer + index + count, len - index - count + 1);
+    len -= count;
+}
+
+void String::toUpperCase() {
+    for (unsigned int i = 0; i < len; i++) buffer[i] = toupper((unsigned char)buffer[i]);
+}
+
+void String::toLowerCase() {
+    for (unsigned int i = 0; i < len; i++) buffer[i] = tolower((unsigned char)buffer[i]);
+}
+
+void String::trim() {
+    if (len == 0) return;
+    unsigned int start = 0;
+    while (start < len && isspace((unsigned char)buffer[start])) start++;
+    unsigned int end = len;
+    while (end > start && isspace((unsigned char)buffer[end - 1])) end--;
+    memmove(buffer, buffer + start, end - start);
+    len = end - start;
+    buffer[len] = '\0';
+}
+
+String operator+(const String& left, const String& right) {
+    String result(left);
+    result.concat(right);
+    return result;
+}
+
+String operator+(const String& left, const char* right) {
+    String result(left);
+    result.concat(right);
+    return result;
+}
+
+String operator+(const char* left, const String& right) {
+    String result(left);
+    result.concat(right);
+    return result;
+}
+
+String operator+(const String& left, char right) {
+    String result(left);
+    result.concat(right);
+    return result;
+}
+
+// ---------------------------------------------------------------------------
+// Print and Stream
+
+size_t Print::write(const uint8_t* data, size_t size) {
+    size_t written = 0;
+    while (size--) {
+        if (write(*data++) == 0) break;
+        written++;
+    }
+    return written;
+}
+
+size_t Print::printNumber(unsigned long long value, int base) {
+    char text[66];
+    char* cursor = text + sizeof(text) - 1;
+    *cursor = '\0';
+    if (base < 2) base = DEC;
+    do {
+        unsigned digit = value % base;
+        *--cursor = digit < 10 ? '0' + digit : 'A' + digit - 10;
+        value /= base;
+    } while (value > 0);
+    return write(cursor);
+}
+
+size_t Print::print(long value, int base) {
+    return print((long long)value, base);
+}
+
+size_t Print::print(unsigned long value, int base) {
+    return printNumber(value, base);
+}
+
+size_t Print::print(long long value, int base) {
+    if (base == DEC && value < 0) {
+        size_t n = print('-');
+        return n + printNumber(-(unsigned long long)value, base);
+    }
+    return printNumber((unsigned long long)value, base);
+}
+
+size_t Print::print(unsigned long long value, int base) {
+    return printNumber(value, base);
+}
+
+size_t Print::print(double value, int digits) {
+    // Same special cases as the Arduino core's printFloat
+    if (isnan(value)) return print("nan");
+    if (isinf(value)) return print("inf");
+    if (value > 4294967040.0 || value < -4294967040.0) return print("ovf");
+    char text[48];
+    snprintf(text, sizeof(text), "%.*f", digits < 0 ? 0 : digits, value);
+    return write(text);
+}
+
+size_t Print::print(const struct tm* info, const char* format) {
+    char text[64];
+    size_t length = strftime(text, sizeof(text), format ? format : "%c", info);
+    return write(text, length);
+}
+
+size_t Print::printf(const char* format, ...) {
+    char text[256];
+    va_list args;
+    va_start(args, format);
+    int length = vsnprintf(text, sizeof(text), format, args);
+    va_end(args);
+    if (length < 0) return 0;
+    return write(text, (size_t)length < sizeof(text) ? (size_t)length : sizeof(text) - 1);
+}
+
+int Stream::timedRead() {
+    unsigned long start = millis();
+    do {
+        int c = read();
+        if (c >= 0) return c;
+        delay(1); // The wait costs virtual time, as it would on the target
+    } while (millis() - start < timeout);
+    return -1;
+}
+
+size_t Stream::readBytes(char* buffer, size_t length) {
+    size_t count = 0;
+    while (count < length) {
+        int c = timedRead();
+        if (c < 0) break;
+        buffer[count++] = (char)c;
+    }
+    return count;
+}
+
+size_t Stream::readBytesUntil(char terminator, char* buffer, size_t length) {
+    size_t count = 0;
+    while (count < length) {
+        int c = timedRead();
+        if (c < 0 || c == terminator) break;
+        buffer[count++] = (char)c;
+    }
+    return count;
+}
+
+String Stream::readStringUntil(char terminator) {
+    String result;
+    int c = timedRead();
+    while (c >= 0 && c != terminator) {
+        result += (char)c;
+        c = timedRead();
+    }
+    return result;
+}
+
+// ---------------------------------------------------------------------------
+// IPAddress
+
+bool IPAddress::fromString(const char* text) {
+    unsigned parts[4];
+    char tail;
+    if (sscanf(text, "%u.%u.%u.%u%c", &parts[0], &parts[1], &parts[2], &parts[3], &tail) != 4) return false;
+    for (unsigned part : parts) {
+        if (part > 255) return false;
+    }
+    *this = IPAddress(parts[0], parts[1], parts[2], parts[3]);
+    return true;
+}
+
+String IPAddress::toString() const {
+    char text[16];
+    snprintf(text, sizeof(text), "%u.%u.%u.%u", (*this)[0], (*this)[1], (*this)[2], (*this)[3]);
+    return String(text);
+}
+
+size_t IPAddress::printTo(Print& out) const {
+    char text[16];
+    snprintf(text, sizeof(text), "%u.%u.%u.%u", (*this)[0], (*this)[1], (*this)[2], (*this)[3]);
+    return out.print(text);
+}
+
+// ---------------------------------------------------------------------------
+// HardwareSerial
+
+void HardwareSerial::begin(unsigned long baud) {}
+
+size_t HardwareSerial::write(const uint8_t* data, size_t size) {
+    if (echo < 0) {
+        echo = getenv("TAVOLO_HOST_ECHO") != nullptr;
+    }
+    if (echo) {
+        fwrite(data, 1, size, stdout);
+    }
+
+    // Keep the most recent output; the older half is dropped when the buffer fills
+    if (size > CAPTURE_SIZE) {
+        data += size - CAPTURE_SIZE;
+        size = CAPTURE_SIZE;
+    }
+    if (captureLength + size > CAPTURE_SIZE) {
+        size_t keep = CAPTURE_SIZE / 2 < captureLength ? CAPTURE_SIZE / 2 : captureLength;
+        if (keep + size > CAPTURE_SIZE) keep = CAPTURE_SIZE - size;
+        memmove(capture, capture + captureLength - keep, keep);
+        captureLength = keep;
+    }
+    memcpy(capture + captureLength, data, size);
+    captureLength += size;
+    capture[captureLength] = '\0';
+    return size;
+}
+
+void HardwareSerial::injectInput(const char* text) {
+    if (rxIndex == rxLength) {
+        rxIndex = 0;
+        rxLength = 0;
+    }
+    size_t length = strlen(text);
+    if (length > RX_SIZE - rxLength) length = RX_SIZE - rxLength;
+    memcpy(rxBuffer + rxLength, text, length);
+    rxLength += length;
+    if (receiveCallback) {
+        receiveCallback();
+    }
+}
+
+void HardwareSerial::clearCapturedOutput() {
+    captureLength = 0;
+    capture[0] = '\0';
+}
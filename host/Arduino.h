@@ -0,0 +1,326 @@
+#ifndef HOST_ARDUINO_H
+#define HOST_ARDUINO_H
+
+/**
+ * @brief Arduino core API for host builds
+ *
+ * Enough of the ESP32 Arduino core to build and run the firmware on a PC. Time is
+ * virtual (see VirtualClock.h): it only moves when the code under test waits with
+ * delay()/delayMicroseconds() or the scheduler sleeps, so hours of operation run in
+ * seconds and every run is reproducible. GPIO is backed by HostGpio, where simulated
+ * peripherals drive inputs, watch outputs and raise pin interrupts.
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <algorithm>
+#include <cmath>
+#include <functional>
+
+typedef uint8_t byte;
+typedef bool boolean;
+typedef unsigned int word;
+
+#define HIGH 0x1
+#define LOW 0x0
+
+#define INPUT 0x01
+#define OUTPUT 0x03
+#define PULLUP 0x04
+#define INPUT_PULLUP 0x05
+#define PULLDOWN 0x08
+#define INPUT_PULLDOWN 0x09
+
+#define RISING 0x01
+#define FALLING 0x02
+#define CHANGE 0x03
+
+#define DEC 10
+#define HEX 16
+#define OCT 8
+#define BIN 2
+
+#define IRAM_ATTR
+#define PROGMEM
+#define F(text) (text)
+
+#ifndef constrain
+#define constrain(amt, low, high) ((amt) < (low) ? (low) : ((amt) > (high) ? (high) : (amt)))
+#endif
+
+using std::abs;
+using std::isinf;
+using std::isnan;
+using std::max;
+using std::min;
+
+// Time, backed by the virtual clock
+unsigned long millis();
+unsigned long micros();
+void delay(uint32_t ms);
+void delayMicroseconds(uint32_t us);
+void yield();
+
+// GPIO, backed by HostGpio
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t value);
+int digitalRead(uint8_t pin);
+void analogWrite(uint8_t pin, int value);
+#define digitalPinToInterrupt(pin) (pin)
+void attachInterrupt(uint8_t pin, void (*handler)(void), int mode);
+void detachInterrupt(uint8_t pin);
+void noInterrupts();
+void interrupts();
+
+// Deterministic for a given seed, like a freshly booted target
+long random(long max);
+long random(long min, long max);
+void randomSeed(unsigned long seed);
+
+bool setCpuFrequencyMhz(uint32_t mhz);
+uint32_t getCpuFrequencyMhz();
+
+// NTP is not simulated; local time stays unavailable
+void configTime(long gmtOffsetSec, int daylightOffsetSec, const char* server1,
+                const char* server2 = nullptr, const char* server3 = nullptr);
+bool getLocalTime(struct tm* info, uint32_t timeoutMs = 5000);
+
+#if defined(__GLIBC__) && __GLIBC_PREREQ(2, 38)
+#define HOST_HAS_STRLCPY 1
+#endif
+#ifndef HOST_HAS_STRLCPY
+inline size_t strlcpy(char* destination, const char* source, size_t size) {
+    size_t length = strlen(source);
+    if (size > 0) {
+        size_t copied = length < size - 1 ? length : size - 1;
+        memcpy(destination, source, copied);
+        destination[copied] = '\0';
+    }
+    return length;
+}
+#endif
+
+/**
+ * Arduino String on malloc/realloc, like the core's, so it is not seen by the
+ * operator new audit either.
+ */
+class String {
+public:
+    String(const char* text = "");
+    String(const String& other);
+    String(String&& other);
+    explicit String(char c);
+    explicit String(int value, unsigned char base = DEC);
+    explicit String(unsigned int value, unsigned char base = DEC);
+    explicit String(long value, unsigned char base = DEC);
+    explicit String(unsigned long value, unsigned char base = DEC);
+    explicit String(float value, unsigned int decimals = 2);
+    explicit String(double value, unsigned int decimals = 2);
+    ~String();
+
+    String& operator=(const String& other);
+    String& operator=(String&& other);
+    String& operator=(const char* text);
+
+    bool reserve(unsigned int size);
+    unsigned int length() const { return len; }
+    bool isEmpty() const { return len == 0; }
+    const char* c_str() const { return buffer ? buffer : ""; }
+
+    bool concat(const char* text, unsigned int length);
+    bool concat(const char* text) { return concat(text, text ? strlen(text) : 0); }
+    bool concat(const String& other) { return concat(other.c_str(), other.len); }
+    bool concat(char c) { return concat(&c, 1); }
+    String& operator+=(const String& other) { concat(other); return *this; }
+    String& operator+=(const char* text) { concat(text); return *this; }
+    String& operator+=(char c) { concat(c); return *this; }
+
+    bool equals(const String& other) const { return len == other.len && strcmp(c_str(), other.c_str()) == 0; }
+    bool equals(const char* text) const { return strcmp(c_str(), text ? text : "") == 0; }
+    bool equalsIgnoreCase(const String& other) const;
+    bool operator==(const String& other) const { return equals(other); }
+    bool operator==(const char* text) const { return equals(text); }
+    bool operator!=(const String& other) const { return !equals(other); }
+    bool operator!=(const char* text) const { return !equals(text); }
+    bool operator<(const String& other) const { return strcmp(c_str(), other.c_str()) < 0; }
+
+    char charAt(unsigned int index) const { return index < len ? buffer[index] : '\0'; }
+    char operator[](unsigned int index) const { return charAt(index); }
+    char& operator[](unsigned int index);
+    bool startsWith(const String& prefix) const;
+    bool endsWith(const String& suffix) const;
+    int indexOf(char c, unsigned int from = 0) const;
+    int indexOf(const char* text, unsigned int from = 0) const;
+    int indexOf(const String& text, unsigned int from = 0) const { return indexOf(text.c_str(), from); }
+    String substring(unsigned int from) const { return substring(from, len); }
+    String substring(unsigned int from, unsigned int to) const;
+
+    void replace(const String& find, const String& replacement);
+    void remove(unsigned int index, unsigned int count = (unsigned int)-1);
+    void toUpperCase();
+    void toLowerCase();
+    void trim();
+
+    long toInt() const { return atol(c_str()); }
+    float toFloat() const { return (float)atof(c_str()); }
+    double toDouble() const { return atof(c_str()); }
+
+private:
+    char* buffer = nullptr;
+    unsigned int capacity = 0;
+    unsigned int len = 0;
+
+    void assign(const char* text, unsigned int length);
+};
+
+String operator+(const String& left, const String& right);
+String operator+(const String& left, const char* right);
+String operator+(const char* left, const String& right);
+String operator+(const String& left, char right);
+
+class Print;
+
+class Printable {
+public:
+    virtual ~Printable() {}
+    virtual size_t printTo(Print& out) const = 0;
+};
+
+class Print {
+public:
+    virtual ~Print() {}
+
+    virtual size_t write(uint8_t c) = 0;
+    virtual size_t write(const uint8_t* data, size_t size);
+    size_t write(const char* text) { return text ? write((const uint8_t*)text, strlen(text)) : 0; }
+    size_t write(const char* data, size_t size) { return write((const uint8_t*)data, size); }
+    virtual int availableForWrite() { return 0; }
+    virtual void flush() {}
+
+    size_t print(const String& text) { return write(text.c_str(), text.length()); }
+    size_t print(const char* text) { return write(text); }
+    size_t print(char c) { return write((uint8_t)c); }
+    size_t print(unsigned char value, int base = DEC) { return print((unsigned long)value, base); }
+    size_t print(int value, int base = DEC) { return print((long)value, base); }
+    size_t print(unsigned int value, int base = DEC) { return print((unsigned long)value, base); }
+    size_t print(long value, int base = DEC);
+    size_t print(unsigned long value, int base = DEC);
+    size_t print(long long value, int base = DEC);
+    size_t print(unsigned long long value, int base = DEC);
+    size_t print(double value, int digits = 2);
+    size_t print(const Printable& printable) { return printable.printTo(*this); }
+    size_t print(const struct tm* info, const char* format = nullptr);
+
+    size_t println() { return write("\r\n"); }
+    template<typename T> size_t println(const T& value) { size_t n = print(value); return n + println(); }
+    template<typename T> size_t println(const T& value, int option) { size_t n = print(value, option); return n + println(); }
+    size_t println(const char* text) { size_t n = print(text); return n + println(); }
+    size_t println(const struct tm* info, const char* format) { size_t n = print(info, format); return n + println(); }
+
+    size_t printf(const char* format, ...) __attribute__((format(printf, 2, 3)));
+
+private:
+    size_t printNumber(unsigned long long value, int base);
+};
+
+class Stream : public Print {
+public:
+    virtual int available() = 0;
+    virtual int read() = 0;
+    virtual int peek() = 0;
+
+    void setTimeout(unsigned long timeoutMs) { timeout = timeoutMs; }
+    unsigned long getTimeout() const { return timeout; }
+    size_t readBytes(char* buffer, size_t length);
+    size_t readBytes(uint8_t* buffer, size_t length) { return readBytes((char*)buffer, length); }
+    size_t readBytesUntil(char terminator, char* buffer, size_t length);
+    String readStringUntil(char terminator);
+
+protected:
+    unsigned long timeout = 1000; // ms of virtual time
+    int timedRead();
+};
+
+class IPAddress : public Printable {
+public:
+    IPAddress() : address(0) {}
+    IPAddress(uint8_t a, uint8_t b, uint8_t c, uint8_t d) : address(a | (b << 8) | (c << 16) | ((uint32_t)d << 24)) {}
+    explicit IPAddress(uint32_t networkOrder) : address(networkOrder) {}
+
+    operator uint32_t() const { return address; }
+    uint8_t operator[](int index) const { return (address >> (8 * index)) & 0xFF; }
+    bool operator==(const IPAddress& other) const { return address == other.address; }
+    bool fromString(const char* text);
+    String toString() const;
+    size_t printTo(Print& out) const override;
+
+private:
+    uint32_t address; // Network byte order, as lwIP keeps it
+};
+
+/**
+ * UART0. Output goes to a bounded capture buffer that tests can inspect, and to
+ * stdout when TAVOLO_HOST_ECHO is set in the environment. Input is injected by the
+ * test and fires the onReceive callback like the UART driver would.
+ */
+class HardwareSerial : public Stream {
+public:
+    typedef std::function<void(void)> OnReceiveCb;
+
+    void begin(unsigned long baud);
+    void end() {}
+    operator bool() const { return true; }
+
+    size_t write(uint8_t c) override { return write(&c, 1); }
+    size_t write(const uint8_t* data, size_t size) override;
+    using Print::write;
+    int availableForWrite() override { return TX_FIFO_SIZE; }
+    void flush() override {}
+
+    int available() override { return (int)(rxLength - rxIndex); }
+    int read() override { return rxIndex < rxLength ? (uint8_t)rxBuffer[rxIndex++] : -1; }
+    int peek() override { return rxIndex < rxLength ? (uint8_t)rxBuffer[rxIndex] : -1; }
+    void onReceive(OnReceiveCb callback, bool onlyOnTimeout = false) { receiveCallback = callback; }
+
+    // Host side
+    void injectInput(const char* text);
+    const char* capturedOutput() const { return capture; }
+    size_t capturedLength() const { return captureLength; }
+    void clearCapturedOutput();
+    void setEcho(bool enabled) { echo = enabled; }
+
+private:
+    static const int TX_FIFO_SIZE = 128;
+    static const size_t CAPTURE_SIZE = 16384;
+    static const size_t RX_SIZE = 256;
+
+    char capture[CAPTURE_SIZE + 1] = {};
+    size_t captureLength = 0;
+    char rxBuffer[RX_SIZE];
+    size_t rxLength = 0;
+    size_t rxIndex = 0;
+    OnReceiveCb receiveCallback;
+    int echo = -1; // -1 until the environment has been read
+};
+
+extern HardwareSerial Serial;
+
+class EspClass {
+public:
+    uint32_t getFreeHeap() { return 180000; }
+    uint32_t getMinFreeHeap() { return 170000; }
+    uint32_t getMaxAllocHeap() { return 110000; }
+    uint32_t getHeapSize() { return 320000; }
+    uint32_t getCycleCount();
+    uint32_t getCpuFreqMHz() { return getCpuFrequencyMhz(); }
+    void restart();
+};
+
+extern EspClass ESP;
+
+#endif // HOST_ARDUINO_H
@@ -0,0 +1,552 @@
+#ifndef HOST_ARDUINOJSON_H
+#define HOST_ARDUINOJSON_H
+
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <type_traits>
+
+/**
+ * @brief ArduinoJson 6 subset for host builds
+ *
+ * Covers what the firmware uses: flat objects built with doc["key"] = value,
+ * serializeJson()/measureJson() into a char buffer, and zero-copy
+ * deserializeJson() of a flat command object. A StaticJsonDocument<N> holds N/16
+ * members in place, like the 16-byte member slots of the real library on the ESP32,
+ * and never allocates. Strings are stored by pointer: assigned strings must outlive
+ * the document, and parsed strings are unescaped in place inside the input buffer.
+ * Nested objects and arrays are rejected by the parser.
+ */
+
+class JsonValue {
+public:
+    enum Type : uint8_t { NUL, STRING, SIGNED, UNSIGNED, FLOAT, DOUBLE, BOOLEAN };
+
+    Type type = NUL;
+    union {
+        const char* text;
+        int64_t integer;
+        uint64_t natural;
+        double real;
+        bool flag;
+    };
+
+    JsonValue() : natural(0) {}
+
+    void set(const char* value) {
+        if (value == nullptr) {
+            type = NUL;
+            return;
+        }
+        type = STRING;
+        text = value;
+    }
+    void set(bool value) { type = BOOLEAN; flag = value; }
+    void set(float value) { type = FLOAT; real = value; }
+    void set(double value) { type = DOUBLE; real = value; }
+
+    template <typename T>
+    typename std::enable_if<std::is_integral<T>::value && std::is_signed<T>::value>::type set(T value) {
+        type = SIGNED;
+        integer = value;
+    }
+    template <typename T>
+    typename std::enable_if<std::is_integral<T>::value && std::is_unsigned<T>::value &&
+                            !std::is_same<T, bool>::value>::type set(T value) {
+        type = UNSIGNED;
+        natural = value;
+    }
+
+    bool isNumber() const { return type == SIGNED || type == UNSIGNED || type == FLOAT || type == DOUBLE; }
+    bool isInteger() const { return type == SIGNED || type == UNSIGNED; }
+
+    double toDouble() const {
+        switch (type) {
+            case SIGNED: return (double)integer;
+            case UNSIGNED: return (double)natural;
+            case FLOAT:
+            case DOUBLE: return real;
+            case BOOLEAN: return flag ? 1.0 : 0.0;
+            default: return 0.0;
+        }
+    }
+
+    int64_t toInteger() const {
+        switch (type) {
+            case SIGNED: return integer;
+            case UNSIGNED: return (int64_t)natural;
+            case FLOAT:
+            case DOUBLE: return isfinite(real) ? (int64_t)real : 0;
+            case BOOLEAN: return flag ? 1 : 0;
+            default: return 0;
+        }
+    }
+};
+
+/**
+ * @brief Bounded output, counting what would have been written past the end
+ */
+class JsonWriter {
+public:
+    JsonWriter(char* buffer, size_t size) : buffer(buffer), size(size) {}
+
+    void put(char c) {
+        if (buffer != nullptr && written + 1 < size) {
+            buffer[written] = c;
+            written++;
+        }
+        needed++;
+    }
+    void put(const char* text) {
+        while (*text) put(*text++);
+    }
+    size_t finish() {
+        if (buffer != nullptr && size > 0) buffer[written] = '\0';
+        return written;
+    }
+    size_t getNeeded() const { return needed; }
+
+    void writeString(const char* text) {
+        put('"');
+        for (const char* p = text; *p; p++) {
+            char c = *p;
+            switch (c) {
+                case '"': put("\\\""); break;
+                case '\\': put("\\\\"); break;
+                case '\b': put("\\b"); break;
+                case '\f': put("\\f"); break;
+                case '\n': put("\\n"); break;
+                case '\r': put("\\r"); break;
+                case '\t': put("\\t"); break;
+                default:
+                    if ((unsigned char)c < 0x20) {
+                        char escaped[8];
+                        snprintf(escaped, sizeof(escaped), "\\u%04x", (unsigned)c);
+                        put(escaped);
+                    } else {
+                        put(c);
+                    }
+            }
+        }
+        put('"');
+    }
+
+    void writeValue(const JsonValue& value) {
+        char number[32];
+        switch (value.type) {
+            case JsonValue::STRING:
+                writeString(value.text);
+                return;
+            case JsonValue::SIGNED:
+                snprintf(number, sizeof(number), "%lld", (long long)value.integer);
+                break;
+            case JsonValue::UNSIGNED:
+                snprintf(number, sizeof(number), "%llu", (unsigned long long)value.natural);
+                break;
+            case JsonValue::FLOAT:
+            case JsonValue::DOUBLE:
+                if (!isfinite(value.real)) {
+                    put("null"); // JSON has no NaN or Infinity
+                    return;
+                }
+                snprintf(number, sizeof(number), value.type == JsonValue::FLOAT ? "%.7g" : "%.9g", value.real);
+                break;
+            case JsonValue::BOOLEAN:
+                put(value.flag ? "true" : "false");
+                return;
+            default:
+                put("null");
+                return;
+        }
+        put(number);
+    }
+
+private:
+    char* buffer;
+    size_t size;
+    size_t written = 0;
+    size_t needed = 0;
+};
+
+class JsonVariant {
+public:
+    JsonVariant() : data(nullptr) {}
+    explicit JsonVariant(JsonValue* data) : data(data) {}
+
+    bool isNull() const { return data == nullptr || data->type == JsonValue::NUL; }
+
+    template <typename T>
+    typename std::enable_if<std::is_same<T, const char*>::value, bool>::type is() const {
+        return data != nullptr && data->type == JsonValue::STRING;
+    }
+    template <typename T>
+    typename std::enable_if<std::is_same<T, bool>::value, bool>::type is() const {
+        return data != nullptr && data->type == JsonValue::BOOLEAN;
+    }
+    template <typename T>
+    typename std::enable_if<std::is_integral<T>::value && !std::is_same<T, bool>::value, bool>::type is() const {
+        return data != nullptr && data->isInteger();
+    }
+    template <typename T>
+    typename std::enable_if<std::is_floating_point<T>::value, bool>::type is() const {
+        return data != nullptr && data->isNumber();
+    }
+
+    template <typename T>
+    typename std::enable_if<std::is_same<T, const char*>::value, T>::type as() const {
+        return is<const char*>() ? data->text : nullptr;
+    }
+    template <typename T>
+    typename std::enable_if<std::is_same<T, bool>::value, T>::type as() const {
+        return data != nullptr && data->type == JsonValue::BOOLEAN ? data->flag : data != nullptr && data->toInteger() != 0;
+    }
+    template <typename T>
+    typename std::enable_if<std::is_integral<T>::value && !std::is_same<T, bool>::value, T>::type as() const {
+        return data != nullptr ? (T)data->toInteger() : 0;
+    }
+    template <typename T>
+    typename std::enable_if<std::is_floating_point<T>::value, T>::type as() const {
+        return data != nullptr ? (T)data->toDouble() : 0;
+    }
+
+    template <typename T>
+    T operator|(const T& fallback) const {
+        return is<T>() ? as<T>() : fallback;
+    }
+    const char* operator|(const char* fallback) const {
+        return is<const char*>() ? data->text : fallback;
+    }
+
+    const JsonValue* getData() const { return data; }
+
+private:
+    JsonValue* data;
+};
+
+class JsonDocument;
+
+/**
+ * @brief Result of doc["key"]: reads like a JsonVariant, assigning adds the member
+ */
+class JsonMemberProxy {
+public:
+    JsonMemberProxy(JsonDocument& doc, const char* key) : doc(doc), key(key) {}
+
+    template <typename T>
+    JsonMemberProxy& operator=(const T& value);
+    JsonMemberProxy& operator=(const char* value);
+
+    operator JsonVariant() const;
+    bool isNull() const { return JsonVariant(*this).isNull(); }
+    template <typename T> bool is() const { return JsonVariant(*this).template is<T>(); }
+    template <typename T> T as() const { return JsonVariant(*this).template as<T>(); }
+    template <typename T> T operator|(const T& fallback) const { return JsonVariant(*this) | fallback; }
+    const char* operator|(const char* fallback) const { return JsonVariant(*this) | fallback; }
+
+private:
+    JsonDocument& doc;
+    const char* key;
+};
+
+class DeserializationError {
+public:
+    enum Code { Ok, EmptyInput, IncompleteInput, InvalidInput, NoMemory, TooDeep };
+
+    DeserializationError(Code code = Ok) : code(code) {}
+    explicit operator bool() const { return code != Ok; }
+    bool operator==(Code other) const { return code == other; }
+    bool operator!=(Code other) const { return code != other; }
+    Code getCode() const { return code; }
+
+    const char* c_str() const {
+        static const char* const names[] = {
+            "Ok", "EmptyInput", "IncompleteInput", "InvalidInput", "NoMemory", "TooDeep"
+        };
+        return names[code];
+    }
+
+private:
+    Code code;
+};
+
+class JsonDocument {
+public:
+    struct Member {
+        const char* key;
+        JsonValue value;
+    };
+
+    JsonMemberProxy operator[](const char* key) { return JsonMemberProxy(*this, key); }
+    JsonVariant operator[](const char* key) const { return JsonVariant(const_cast<JsonDocument*>(this)->find(key)); }
+
+    bool containsKey(const char* key) const { return const_cast<JsonDocument*>(this)->find(key) != nullptr; }
+    void clear() { count = 0; }
+    size_t size() const { return count; }
+    size_t capacity() const { return slotCount * 16; }
+    size_t memoryUsage() const { return count * 16; }
+    bool overflowed() const { return overflow; }
+
+    const Member* begin() const { return members; }
+    const Member* end() const { return members + count; }
+
+    JsonValue* find(const char* key) {
+        for (size_t i = 0; i < count; i++) {
+            if (strcmp(members[i].key, key) == 0) return &members[i].value;
+        }
+        return nullptr;
+    }
+
+    JsonValue* getOrAdd(const char* key) {
+        JsonValue* existing = find(key);
+        if (existing != nullptr) return existing;
+        if (count >= slotCount) {
+            overflow = true; // Silently dropped, as the real library does when full
+            return nullptr;
+        }
+        members[count].key = key;
+        members[count].value = JsonValue();
+        return &members[count++].value;
+    }
+
+    void write(JsonWriter& out) const {
+        out.put('{');
+        for (size_t i = 0; i < count; i++) {
+            if (i > 0) out.put(',');
+            out.writeString(members[i].key);
+            out.put(':');
+            out.writeValue(members[i].value);
+        }
+        out.put('}');
+    }
+
+protected:
+    JsonDocument(Member* members, size_t slotCount) : members(members), slotCount(slotCount) {}
+    JsonDocument(const JsonDocument&) = delete;
+    JsonDocument& operator=(const JsonDocument&) = delete;
+
+private:
+    Member* members;
+    size_t slotCount;
+    size_t count = 0;
+    bool overflow = false;
+};
+
+template <size_t Capacity>
+class StaticJsonDocument : public JsonDocument {
+public:
+    StaticJsonDocument() : JsonDocument(storage, SLOTS) {}
+
+private:
+    static const size_t SLOTS = Capacity / 16 > 0 ? Capacity / 16 : 1;
+    Member storage[SLOTS];
+};
+
+template <typename T>
+inline JsonMemberProxy& JsonMemberProxy::operator=(const T& value) {
+    JsonValue* slot = doc.getOrAdd(key);
+    if (slot != nullptr) slot->set(value);
+    return *this;
+}
+
+inline JsonMemberProxy& JsonMemberProxy::operator=(const char* value) {
+    JsonValue* slot = doc.getOrAdd(key);
+    if (slot != nullptr) slot->set(value);
+    return *this;
+}
+
+inline JsonMemberProxy::operator JsonVariant() const {
+    return JsonVariant(doc.find(key));
+}
+
+inline size_t serializeJson(const JsonDocument& doc, char* buffer, size_t size) {
+    JsonWriter out(buffer, size);
+    doc.write(out);
+    return out.finish();
+}
+
+inline size_t serializeJson(const JsonVariant& variant, char* buffer, size_t size) {
+    JsonWriter out(buffer, size);
+    if (variant.getData() != nullptr) {
+        out.writeValue(*variant.getData());
+    } else {
+        out.put("null");
+    }
+    return out.finish();
+}
+
+inline size_t measureJson(const JsonDocument& doc) {
+    JsonWriter out(nullptr, 0);
+    doc.write(out);
+    return out.getNeeded();
+}
+
+namespace ArduinoJsonHost {
+
+class Parser {
+public:
+    Parser(char* input, size_t length) : cursor(input), end(input + length) {}
+
+    DeserializationError parse(JsonDocument& doc) {
+        doc.clear();
+        skipSpace();
+        if (cursor >= end || *cursor == '\0') return DeserializationError::EmptyInput;
+        if (*cursor != '{') return DeserializationError::InvalidInput;
+        cursor++;
+        skipSpace();
+        if (cursor < end && *cursor == '}') return DeserializationError::Ok;
+
+        for (;;) {
+            skipSpace();
+            if (cursor >= end) return DeserializationError::IncompleteInput;
+            if (*cursor != '"') return DeserializationError::InvalidInput;
+            char* key = nullptr;
+            DeserializationError error = parseString(key);
+            if (error) return error;
+
+            skipSpace();
+            if (cursor >= end) return DeserializationError::IncompleteInput;
+            if (*cursor != ':') return DeserializationError::InvalidInput;
+            cursor++;
+            skipSpace();
+            if (cursor >= end) return DeserializationError::IncompleteInput;
+
+            JsonValue value;
+            error = parseValue(value);
+            if (error) return error;
+            JsonValue* slot = doc.getOrAdd(key);
+            if (slot == nullptr) return DeserializationError::NoMemory;
+            *slot = value;
+
+            skipSpace();
+            if (cursor >= end) return DeserializationError::IncompleteInput;
+            if (*cursor == '}') {
+                cursor++;
+                return DeserializationError::Ok;
+            }
+            if (*cursor != ',') return DeserializationError::InvalidInput;
+            cursor++;
+        }
+    }
+
+private:
+    char* cursor;
+    char* end;
+
+    void skipSpace() {
+        while (cursor < end && (*cursor == ' ' || *cursor == '\t' || *cursor == '\n' || *cursor == '\r')) {
+            cursor++;
+        }
+    }
+
+    bool match(const char* word) {
+        size_t length = strlen(word);
+        if ((size_t)(end - cursor) < length || strncmp(cursor, word, length) != 0) return false;
+        cursor += length;
+        return true;
+    }
+
+    DeserializationError parseValue(JsonValue& value) {
+        char c = *cursor;
+        if (c == '"') {
+            char* text = nullptr;
+            DeserializationError error = parseString(text);
+            if (!error) value.set((const char*)text);
+            return error;
+        }
+        if (c == '{' || c == '[') return DeserializationError::TooDeep; // Flat documents only
+        if (match("true")) { value.set(true); return DeserializationError::Ok; }
+        if (match("false")) { value.set(false); return DeserializationError::Ok; }
+        if (match("null")) { value = JsonValue(); return DeserializationError::Ok; }
+        return parseNumber(value);
+    }
+
+    DeserializationError parseNumber(JsonValue& value) {
+        char text[32];
+        size_t length = 0;
+        bool isReal = false;
+        while (cursor < end && length < sizeof(text) - 1) {
+            char c = *cursor;
+            bool digit = (c >= '0' && c <= '9') || c == '-' || c == '+';
+            bool real = c == '.' || c == 'e' || c == 'E';
+            if (!digit && !real) break;
+            isReal = isReal || real;
+            text[length++] = c;
+            cursor++;
+        }
+        text[length] = '\0';
+        if (length == 0) return DeserializationError::InvalidInput;
+
+        char* stop = nullptr;
+        if (!isReal) {
+            if (text[0] == '-') {
+                long long parsed = strtoll(text, &stop, 10);
+                if (*stop == '\0') { value.set((int64_t)parsed); return DeserializationError::Ok; }
+            } else {
+                unsigned long long parsed = strtoull(text, &stop, 10);
+                if (*stop == '\0') { value.set((uint64_t)parsed); return DeserializationError::Ok; }
+            }
+        }
+        double parsed = strtod(text, &stop);
+        if (*stop != '\0') return DeserializationError::InvalidInput;
+        value.set(parsed);
+        return DeserializationError::Ok;
+    }
+
+    // Unescapes in place; the closing quote becomes the terminator
+    DeserializationError parseString(char*& result) {
+        cursor++; // Opening quote
+        char* out = cursor;
+        result = cursor;
+        while (cursor < end) {
+            char c = *cursor++;
+            if (c == '"') {
+                *out = '\0';
+                return DeserializationError::Ok;
+            }
+            if (c == '\\') {
+                if (cursor >= end) return DeserializationError::IncompleteInput;
+                char escaped = *cursor++;
+                switch (escaped) {
+                    case '"': c = '"'; break;
+                    case '\\': c = '\\'; break;
+                    case '/': c = '/'; break;
+                    case 'b': c = '\b'; break;
+                    case 'f': c = '\f'; break;
+                    case 'n': c = '\n'; break;
+                    case 'r': c = '\r'; break;
+                    case 't': c = '\t'; break;
+                    case 'u': {
+                        if (end - cursor < 4) return DeserializationError::IncompleteInput;
+                        char hex[5] = { cursor[0], cursor[1], cursor[2], cursor[3], '\0' };
+                        char* stop = nullptr;
+                        unsigned long code = strtoul(hex, &stop, 16);
+                        if (*stop != '\0') return DeserializationError::InvalidInput;
+                        cursor += 4;
+                        if (code >= 0x80) return DeserializationError::InvalidInput; // ASCII only
+                        c = (char)code;
+                        break;
+                    }
+                    default:
+                        return DeserializationError::InvalidInput;
+                }
+            }
+            *out++ = c;
+        }
+        return DeserializationError::IncompleteInput;
+    }
+};
+
+} // namespace ArduinoJsonHost
+
+inline DeserializationError deserializeJson(JsonDocument& doc, char* input, size_t length) {
+    ArduinoJsonHost::Parser parser(input, length);
+    return parser.parse(doc);
+}
+
+inline DeserializationError deserializeJson(JsonDocument& doc, char* input) {
+    return deserializeJson(doc, input, strlen(input));
+}
+
+#endif // HOST_ARDUINOJSON_H
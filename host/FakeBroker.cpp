@@ -0,0 +1,266 @@
+#include "FakeBroker.h"
+#include "VirtualClock.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+FakeBroker::~FakeBroker() {
+    end();
+}
+
+bool FakeBroker::begin() {
+    listenSocket = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+    if (listenSocket < 0) return false;
+
+    int reuse = 1;
+    setsockopt(listenSocket, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+
+    struct sockaddr_in address;
+    memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    address.sin_port = 0;
+
+    socklen_t length = sizeof(address);
+    if (bind(listenSocket, (struct sockaddr*)&address, sizeof(address)) != 0 ||
+        listen(listenSocket, 4) != 0 ||
+        getsockname(listenSocket, (struct sockaddr*)&address, &length) != 0) {
+        end();
+        return false;
+    }
+    fcntl(listenSocket, F_SETFL, fcntl(listenSocket, F_GETFL, 0) | O_NONBLOCK);
+    port = ntohs(address.sin_port);
+    return true;
+}
+
+void FakeBroker::end() {
+    closeClient();
+    if (listenSocket >= 0) {
+        close(listenSocket);
+        listenSocket = -1;
+    }
+}
+
+void FakeBroker::closeClient() {
+    if (clientSocket >= 0) {
+        close(clientSocket);
+        clientSocket = -1;
+    }
+    rxLength = 0;
+    sessionOpen = false;
+    subscriptionCount = 0;
+}
+
+void FakeBroker::dropConnection() {
+    closeClient();
+}
+
+void FakeBroker::poll() {
+    if (listenSocket < 0) return;
+
+    int accepted = accept(listenSocket, nullptr, nullptr);
+    if (accepted >= 0) {
+        closeClient(); // A reconnect replaces the previous session
+        clientSocket = accepted;
+        fcntl(clientSocket, F_SETFL, fcntl(clientSocket, F_GETFL, 0) | O_NONBLOCK);
+        int noDelay = 1;
+        setsockopt(clientSocket, IPPROTO_TCP, TCP_NODELAY, &noDelay, sizeof(noDelay));
+    }
+    if (clientSocket < 0) return;
+
+    for (;;) {
+        ssize_t received = recv(clientSocket, rx + rxLength, RX_SIZE - rxLength, MSG_DONTWAIT);
+        if (received == 0) {
+            closeClient(); // Client closed
+            return;
+        }
+        if (received < 0) {
+            if (errno != EAGAIN && errno != EWOULDBLOCK) closeClient();
+            break;
+        }
+        rxLength += received;
+        if (rxLength == RX_SIZE) break;
+    }
+
+    // Handle every complete packet in the buffer
+    size_t offset = 0;
+    while (offset + 2 <= rxLength) {
+        uint32_t remaining = 0;
+        uint32_t multiplier = 1;
+        size_t cursor = offset + 1;
+        bool complete = false;
+        while (cursor < rxLength && cursor - offset <= 4) {
+            uint8_t digit = rx[cursor++];
+            remaining += (digit & 0x7F) * multiplier;
+            multiplier *= 128;
+            if ((digit & 0x80) == 0) {
+                complete = true;
+                break;
+            }
+        }
+        if (!complete || cursor + remaining > rxLength) break;
+
+        if (!handlePacket(rx[offset], rx + cursor, remaining)) {
+            closeClient();
+            return;
+        }
+        offset = cursor + remaining;
+    }
+    if (offset > 0) {
+        memmove(rx, rx + offset, rxLength - offset);
+        rxLength -= offset;
+    }
+    if (rxLength == RX_SIZE) {
+        closeClient(); // Packet larger than the broker accepts
+    }
+}
+
+bool FakeBroker::handlePacket(uint8_t header, const uint8_t* body, size_t length) {
+    switch (header >> 4) {
+        case 1: { // CONNECT
+            connectCount++;
+            if (connAckMode == ConnAckMode::SILENT) return true;
+            if (connAckMode == ConnAckMode::MALFORMED) {
+                const uint8_t garbled[] = { 0x20, 0x7F, 0x00, 0x00 };
+                send(garbled, sizeof(garbled));
+                return true;
+            }
+            uint8_t code = connAckMode == ConnAckMode::ACCEPT ? 0 : connAckCode;
+            const uint8_t connAck[] = { 0x20, 0x02, 0x00, code };
+            send(connAck, sizeof(connAck));
+            sessionOpen = code == 0;
+            return true;
+        }
+        case 3: // PUBLISH
+            if (!sessionOpen) return false;
+            record(body, length, (header & 0x06) != 0);
+            return true;
+        case 8: { // SUBSCRIBE: packet id, then topic filter and requested QoS
+            if (!sessionOpen || length < 5) return false;
+            size_t topicLength = (body[2] << 8) | body[3];
+            if (4 + topicLength + 1 > length) return false;
+            if (grantSubscriptions && subscriptionCount < MAX_SUBSCRIPTIONS && topicLength < MAX_TOPIC) {
+                memcpy(subscriptions[subscriptionCount], body + 4, topicLength);
+                subscriptions[subscriptionCount][topicLength] = '\0';
+                subscriptionCount++;
+            }
+            uint8_t granted = grantSubscriptions ? body[4 + topicLength] : 0x80;
+            const uint8_t subAck[] = { 0x90, 0x03, body[0], body[1], granted };
+            send(subAck, sizeof(subAck));
+            return true;
+        }
+        case 12: { // PINGREQ
+            pingCount++;
+            const uint8_t pingResp[] = { 0xD0, 0x00 };
+            send(pingResp, sizeof(pingResp));
+            return true;
+        }
+        case 14: // DISCONNECT
+            return false;
+        default:
+            return true;
+    }
+}
+
+void FakeBroker::record(const uint8_t* body, size_t length, bool hasPacketId) {
+    if (length < 2) return;
+    size_t topicLength = (body[0] << 8) | body[1];
+    size_t payloadStart = 2 + topicLength + (hasPacketId ? 2 : 0);
+    if (payloadStart > length) return;
+
+    publishCount++;
+    size_t slot = (logStart + logCount) % LOG_SIZE;
+    if (logCount == LOG_SIZE) {
+        logStart = (logStart + 1) % LOG_SIZE; // Overwrite the oldest entry
+    } else {
+        logCount++;
+    }
+
+    Message& message = log[slot];
+    size_t copied = topicLength < MAX_TOPIC - 1 ? topicLength : MAX_TOPIC - 1;
+    memcpy(message.topic, body + 2, copied);
+    message.topic[copied] = '\0';
+    message.length = length - payloadStart;
+    if (message.length > MAX_PAYLOAD) message.length = MAX_PAYLOAD;
+    memcpy(message.payload, body + payloadStart, message.length);
+    message.payload[message.length] = '\0';
+    message.receivedMicros = VirtualClock::now();
+}
+
+bool FakeBroker::send(const uint8_t* data, size_t length) {
+    if (clientSocket < 0) return false;
+    return ::send(clientSocket, data, length, MSG_NOSIGNAL) == (ssize_t)length;
+}
+
+bool FakeBroker::injectPublish(const char* topic, const char* payload) {
+    if (!sessionOpen) return false;
+
+    size_t topicLength = strlen(topic);
+    size_t payloadLength = strlen(payload);
+    size_t remaining = 2 + topicLength + payloadLength;
+    if (remaining > 16383) return false;
+
+    uint8_t packet[3 + 2 + MAX_TOPIC + MAX_PAYLOAD];
+    if (topicLength >= MAX_TOPIC || payloadLength > MAX_PAYLOAD) return false;
+    size_t length = 0;
+    packet[length++] = 0x30;
+    if (remaining < 128) {
+        packet[length++] = remaining;
+    } else {
+        packet[length++] = 0x80 | (remaining & 0x7F);
+        packet[length++] = remaining >> 7;
+    }
+    packet[length++] = topicLength >> 8;
+    packet[length++] = topicLength & 0xFF;
+    memcpy(packet + length, topic, topicLength);
+    length += topicLength;
+    memcpy(packet + length, payload, payloadLength);
+    length += payloadLength;
+    return send(packet, length);
+}
+
+bool FakeBroker::isSubscribed(const char* topic) const {
+    for (uint8_t i = 0; i < subscriptionCount; i++) {
+        if (strcmp(subscriptions[i], topic) == 0) return true;
+    }
+    return false;
+}
+
+const FakeBroker::Message& FakeBroker::logEntry(size_t index) const {
+    return log[(logStart + index) % LOG_SIZE];
+}
+
+bool FakeBroker::endsWith(const char* text, const char* suffix) {
+    size_t textLength = strlen(text);
+    size_t suffixLength = strlen(suffix);
+    return suffixLength <= textLength && strcmp(text + textLength - suffixLength, suffix) == 0;
+}
+
+const FakeBroker::Message* FakeBroker::lastOn(const char* topicSuffix) const {
+    for (size_t i = logCount; i > 0; i--) {
+        const Message& message = logEntry(i - 1);
+        if (endsWith(message.topic, topicSuffix)) return &message;
+    }
+    return nullptr;
+}
+
+size_t FakeBroker::countOn(const char* topicSuffix, const char* contains) const {
+    size_t count = 0;
+    for (size_t i = 0; i < logCount; i++) {
+        const Message& message = logEntry(i);
+        if (!endsWith(message.topic, topicSuffix)) continue;
+        if (contains != nullptr && strstr((const char*)message.payload, contains) == nullptr) continue;
+        count++;
+    }
+    return count;
+}
+
+void FakeBroker::clearLog() {
+    logStart = 0;
+    logCount = 0;
+}
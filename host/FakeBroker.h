@@ -0,0 +1,101 @@
+#ifndef HOST_FAKE_BROKER_H
+#define HOST_FAKE_BROKER_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief Minimal MQTT 3.1.1 broker on a loopback socket, for scenario tests
+ *
+ * Serves one client at a time and is pumped from the test loop with poll(), so it
+ * answers between two passes of the firmware like a broker on the LAN would. The
+ * CONNACK return code, a malformed CONNACK, the SUBACK grant and plain silence are
+ * configurable; the connection can be dropped and commands injected at any time.
+ * Every PUBLISH is kept in a fixed-size log (newest entries win) so the tests can
+ * assert on what was sent without allocating while the firmware runs.
+ */
+class FakeBroker {
+public:
+    static const size_t MAX_TOPIC = 64;
+    static const size_t MAX_PAYLOAD = 1280;
+    static const size_t LOG_SIZE = 256;
+
+    struct Message {
+        char topic[MAX_TOPIC];
+        uint8_t payload[MAX_PAYLOAD + 1]; // NUL-terminated for JSON payloads
+        size_t length;
+        uint64_t receivedMicros;
+    };
+
+    enum class ConnAckMode {
+        ACCEPT,   // Return code 0
+        REFUSE,   // Return code from setConnAckCode()
+        SILENT,   // Never answer CONNECT
+        MALFORMED // CONNACK type with a wrong remaining length, then nothing
+    };
+
+    FakeBroker() = default;
+    ~FakeBroker();
+
+    bool begin();         // Listens on 127.0.0.1 with an ephemeral port
+    void end();
+    uint16_t getPort() const { return port; }
+
+    void poll();          // Accepts, reads and answers whatever is pending
+
+    // Behaviour
+    void setConnAck(ConnAckMode mode, uint8_t code = 5) { connAckMode = mode; connAckCode = code; }
+    void setGrantSubscriptions(bool grant) { grantSubscriptions = grant; }
+    void dropConnection();
+    bool injectPublish(const char* topic, const char* payload);
+
+    // State
+    bool hasClient() const { return clientSocket >= 0; }
+    bool isSessionOpen() const { return sessionOpen; }
+    bool isSubscribed(const char* topic) const;
+    uint8_t getSubscriptionCount() const { return subscriptionCount; }
+    uint32_t getConnectCount() const { return connectCount; }
+    uint32_t getPingCount() const { return pingCount; }
+
+    // Published messages
+    uint32_t getPublishCount() const { return publishCount; }
+    size_t logSize() const { return logCount; }
+    const Message& logEntry(size_t index) const; // 0 = oldest kept
+    const Message* lastOn(const char* topicSuffix) const;
+    size_t countOn(const char* topicSuffix, const char* contains = nullptr) const;
+    void clearLog();
+
+private:
+    int listenSocket = -1;
+    int clientSocket = -1;
+    uint16_t port = 0;
+
+    ConnAckMode connAckMode = ConnAckMode::ACCEPT;
+    uint8_t connAckCode = 5;
+    bool grantSubscriptions = true;
+    bool sessionOpen = false;
+
+    static const size_t RX_SIZE = 4096;
+    uint8_t rx[RX_SIZE];
+    size_t rxLength = 0;
+
+    static const uint8_t MAX_SUBSCRIPTIONS = 4;
+    char subscriptions[MAX_SUBSCRIPTIONS][MAX_TOPIC];
+    uint8_t subscriptionCount = 0;
+
+    Message log[LOG_SIZE];
+    size_t logStart = 0;
+    size_t logCount = 0;
+
+    uint32_t connectCount = 0;
+    uint32_t publishCount = 0;
+    uint32_t pingCount = 0;
+
+    void closeClient();
+    bool handlePacket(uint8_t header, const uint8_t* body, size_t length);
+    void record(const uint8_t* body, size_t length, bool hasPacketId);
+    bool send(const uint8_t* data, size_t length);
+    static bool endsWith(const char* text, const char* suffix);
+};
+
+#endif // HOST_FAKE_BROKER_H
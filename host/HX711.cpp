@@ -0,0 +1,116 @@
+#include "HX711.h"
+
+void HX711::begin(byte dataPin, byte clockPin, byte gain) {
+    pdSck = clockPin;
+    dout = dataPin;
+    pinMode(pdSck, OUTPUT);
+    pinMode(dout, INPUT_PULLUP);
+    set_gain(gain);
+}
+
+bool HX711::is_ready() {
+    return digitalRead(dout) == LOW;
+}
+
+void HX711::wait_ready(unsigned long delayMs) {
+    while (!is_ready()) {
+        delay(delayMs > 0 ? delayMs : 1);
+    }
+}
+
+bool HX711::wait_ready_retry(int retries, unsigned long delayMs) {
+    for (int count = 0; count < retries; count++) {
+        if (is_ready()) return true;
+        delay(delayMs > 0 ? delayMs : 1);
+    }
+    return false;
+}
+
+bool HX711::wait_ready_timeout(unsigned long timeout, unsigned long delayMs) {
+    unsigned long start = millis();
+    while (millis() - start < timeout) {
+        if (is_ready()) return true;
+        delay(delayMs > 0 ? delayMs : 1);
+    }
+    return false;
+}
+
+void HX711::set_gain(byte gain) {
+    switch (gain) {
+        case 64: gainPulses = 3; break;
+        case 32: gainPulses = 2; break;
+        default: gainPulses = 1; break;
+    }
+}
+
+long HX711::read() {
+    wait_ready();
+
+    uint32_t value = 0;
+    noInterrupts();
+    for (uint8_t i = 0; i < 24; i++) {
+        digitalWrite(pdSck, HIGH);
+        delayMicroseconds(1);
+        value = (value << 1) | (digitalRead(dout) ? 1 : 0);
+        digitalWrite(pdSck, LOW);
+        delayMicroseconds(1);
+    }
+    for (uint8_t i = 0; i < gainPulses; i++) {
+        digitalWrite(pdSck, HIGH);
+        delayMicroseconds(1);
+        digitalWrite(pdSck, LOW);
+        delayMicroseconds(1);
+    }
+    interrupts();
+
+    if (value & 0x800000UL) {
+        value |= 0xFF000000UL;
+    }
+    return (long)(int32_t)value;
+}
+
+long HX711::read_average(byte times) {
+    if (times == 0) times = 1;
+    long long sum = 0;
+    for (byte i = 0; i < times; i++) {
+        sum += read();
+    }
+    return (long)(sum / times);
+}
+
+double HX711::get_value(byte times) {
+    return read_average(times) - offset;
+}
+
+float HX711::get_units(byte times) {
+    return get_value(times) / scale;
+}
+
+void HX711::tare(byte times) {
+    set_offset(read_average(times));
+}
+
+void HX711::set_scale(float newScale) {
+    scale = newScale;
+}
+
+float HX711::get_scale() {
+    return scale;
+}
+
+void HX711::set_offset(long newOffset) {
+    offset = newOffset;
+}
+
+long HX711::get_offset() {
+    return offset;
+}
+
+void HX711::power_down() {
+    digitalWrite(pdSck, LOW);
+    digitalWrite(pdSck, HIGH);
+}
+
+void HX711::power_up() {
+    digitalWrite(pdSck, LOW);
+}
@@ -0,0 +1,41 @@
+#ifndef HOST_HX711_H
+#define HOST_HX711_H
+
+#include <Arduino.h>
+
+/**
+ * @brief bogde/HX711 library API for host builds
+ *
+ * Same pin protocol as the library: readings are bit-banged over PD_SCK, and
+ * power_down() holds PD_SCK high, so a simulated converter on the pins sees exactly
+ * what the real chip would.
+ */
+class HX711 {
+public:
+    void begin(byte dout, byte pdSck, byte gain = 128);
+    bool is_ready();
+    void wait_ready(unsigned long delayMs = 0);
+    bool wait_ready_retry(int retries = 3, unsigned long delayMs = 0);
+    bool wait_ready_timeout(unsigned long timeout = 1000, unsigned long delayMs = 0);
+    void set_gain(byte gain = 128);
+    long read();
+    long read_average(byte times = 10);
+    double get_value(byte times = 1);
+    float get_units(byte times = 1);
+    void tare(byte times = 10);
+    void set_scale(float scale = 1.f);
+    float get_scale();
+    void set_offset(long offset = 0);
+    long get_offset();
+    void power_down();
+    void power_up();
+
+private:
+    byte pdSck = 0;
+    byte dout = 0;
+    byte gainPulses = 1;
+    long offset = 0;
+    float scale = 1.0f;
+};
+
+#endif // HOST_HX711_H
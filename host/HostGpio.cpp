@@ -0,0 +1,164 @@
+#include "HostGpio.h"
+#include "VirtualClock.h"
+#include <Arduino.h>
+
+HostGpio::Pin HostGpio::pins[PIN_COUNT];
+bool HostGpio::interruptsEnabled = true;
+uint8_t HostGpio::isrDepth = 0;
+uint32_t HostGpio::interruptCount = 0;
+
+void HostGpio::setMode(uint8_t pin, uint8_t mode) {
+    if (pin >= PIN_COUNT) return;
+    Pin& p = pins[pin];
+    p.mode = mode;
+    if (mode == INPUT_PULLUP && !p.driven) {
+        setLevel(p, HIGH); // Nothing drives it, the pull-up wins
+    }
+}
+
+void HostGpio::write(uint8_t pin, uint8_t level) {
+    if (pin >= PIN_COUNT) return;
+    Pin& p = pins[pin];
+    setLevel(p, level ? HIGH : LOW);
+    for (uint8_t i = 0; i < p.listenerCount; i++) {
+        p.listeners[i]->onPinWrite(pin, p.level);
+    }
+}
+
+uint8_t HostGpio::read(uint8_t pin) {
+    return pin < PIN_COUNT ? pins[pin].level : LOW;
+}
+
+void HostGpio::writeAnalog(uint8_t pin, int value) {
+    if (pin >= PIN_COUNT) return;
+    PinStats& stats = pins[pin].stats;
+    if (stats.analogWrites == 0) {
+        stats.analogMin = value;
+        stats.analogMax = value;
+    } else {
+        if (value < stats.analogMin) stats.analogMin = value;
+        if (value > stats.analogMax) stats.analogMax = value;
+    }
+    stats.analogWrites++;
+    stats.analogValue = value;
+}
+
+void HostGpio::attachInterrupt(uint8_t pin, void (*handler)(), int mode) {
+    if (pin >= PIN_COUNT) return;
+    pins[pin].handler = handler;
+    pins[pin].interruptMode = mode;
+    pins[pin].pending = false; // The status bit is cleared when the handler is installed
+}
+
+void HostGpio::detachInterrupt(uint8_t pin) {
+    if (pin >= PIN_COUNT) return;
+    pins[pin].handler = nullptr;
+    pins[pin].pending = false;
+}
+
+void HostGpio::enableInterrupts() {
+    interruptsEnabled = true;
+    dispatchPending();
+}
+
+void HostGpio::drive(uint8_t pin, uint8_t level) {
+    if (pin >= PIN_COUNT) return;
+    Pin& p = pins[pin];
+    p.driven = true;
+    uint8_t previous = p.level;
+    setLevel(p, level ? HIGH : LOW);
+    if (p.level == previous || p.handler == nullptr) return;
+
+    bool rising = p.level == HIGH;
+    if (p.interruptMode == CHANGE || (rising && p.interruptMode == RISING) ||
+        (!rising && p.interruptMode == FALLING)) {
+        p.pending = true;
+        dispatchPending();
+    }
+}
+
+bool HostGpio::addListener(uint8_t pin, PinListener* listener) {
+    if (pin >= PIN_COUNT) return false;
+    Pin& p = pins[pin];
+    if (p.listenerCount >= MAX_LISTENERS) return false;
+    p.listeners[p.listenerCount++] = listener;
+    return true;
+}
+
+void HostGpio::removeListener(uint8_t pin, PinListener* listener) {
+    if (pin >= PIN_COUNT) return;
+    Pin& p = pins[pin];
+    for (uint8_t i = 0; i < p.listenerCount; i++) {
+        if (p.listeners[i] == listener) {
+            p.listeners[i] = p.listeners[--p.listenerCount];
+            return;
+        }
+    }
+}
+
+HostGpio::PinStats HostGpio::stats(uint8_t pin) {
+    PinStats result = {};
+    if (pin < PIN_COUNT) {
+        result = pins[pin].stats;
+        result.highMicros = highMicros(pin);
+    }
+    return result;
+}
+
+uint64_t HostGpio::highMicros(uint8_t pin) {
+    if (pin >= PIN_COUNT) return 0;
+    const Pin& p = pins[pin];
+    uint64_t total = p.stats.highMicros;
+    if (p.level == HIGH) {
+        total += VirtualClock::now() - p.highSince;
+    }
+    return total;
+}
+
+void HostGpio::resetStats(uint8_t pin) {
+    if (pin >= PIN_COUNT) return;
+    Pin& p = pins[pin];
+    p.stats = PinStats();
+    p.highSince = VirtualClock::now();
+}
+
+void HostGpio::reset() {
+    for (uint8_t i = 0; i < PIN_COUNT; i++) {
+        pins[i] = Pin();
+    }
+    interruptsEnabled = true;
+    isrDepth = 0;
+    interruptCount = 0;
+}
+
+void HostGpio::setLevel(Pin& pin, uint8_t level) {
+    if (pin.level == level) return;
+    uint64_t now = VirtualClock::now();
+    if (pin.level == HIGH) {
+        pin.stats.highMicros += now - pin.highSince;
+    } else {
+        pin.highSince = now;
+    }
+    pin.level = level;
+    pin.stats.transitions++;
+}
+
+void HostGpio::dispatchPending() {
+    if (!interruptsEnabled || isrDepth > 0) return;
+
+    isrDepth++;
+    bool ran = true;
+    while (ran) {
+        ran = false;
+        for (uint8_t i = 0; i < PIN_COUNT; i++) {
+            Pin& p = pins[i];
+            if (p.pending && p.handler != nullptr) {
+                p.pending = false;
+                interruptCount++;
+                p.handler();
+                ran = true;
+            }
+        }
+    }
+    isrDepth--;
+}
@@ -0,0 +1,89 @@
+#ifndef HOST_GPIO_H
+#define HOST_GPIO_H
+
+#include <stdint.h>
+
+/**
+ * @brief Simulated peripheral watching pins the firmware drives (SCK, RATE, ...)
+ */
+class PinListener {
+public:
+    virtual ~PinListener() {}
+    virtual void onPinWrite(uint8_t pin, uint8_t level) = 0;
+};
+
+/**
+ * @brief GPIO bank behind pinMode(), digitalWrite(), digitalRead() and the pin interrupts
+ *
+ * Outputs are written by the firmware and observed by listeners; inputs are driven by
+ * simulated peripherals through drive(). An edge on an input with an attached handler
+ * is latched and the handler runs at once, unless interrupts are disabled or another
+ * handler is running, in which case it runs as soon as that ends, like the ESP32
+ * interrupt status register.
+ *
+ * Every output also keeps write statistics (level changes, time spent high, PWM
+ * values), which is what the scenario tests read LED patterns from.
+ */
+class HostGpio {
+public:
+    static const uint8_t PIN_COUNT = 40;
+    static const uint8_t MAX_LISTENERS = 4;
+
+    struct PinStats {
+        uint32_t transitions;   // Digital level changes
+        uint64_t highMicros;    // Time spent high up to the last change
+        uint32_t analogWrites;
+        int analogMin;
+        int analogMax;
+        int analogValue;
+    };
+
+    // Firmware side
+    static void setMode(uint8_t pin, uint8_t mode);
+    static void write(uint8_t pin, uint8_t level);
+    static uint8_t read(uint8_t pin);
+    static void writeAnalog(uint8_t pin, int value);
+    static void attachInterrupt(uint8_t pin, void (*handler)(), int mode);
+    static void detachInterrupt(uint8_t pin);
+    static void disableInterrupts() { interruptsEnabled = false; }
+    static void enableInterrupts();
+    static bool inInterrupt() { return isrDepth > 0; }
+
+    // Peripheral side
+    static void drive(uint8_t pin, uint8_t level);
+    static bool addListener(uint8_t pin, PinListener* listener);
+    static void removeListener(uint8_t pin, PinListener* listener);
+
+    // Test side
+    static uint8_t getMode(uint8_t pin) { return pin < PIN_COUNT ? pins[pin].mode : 0; }
+    static uint8_t level(uint8_t pin) { return pin < PIN_COUNT ? pins[pin].level : 0; }
+    static PinStats stats(uint8_t pin);
+    static uint64_t highMicros(uint8_t pin); // Including the current high period
+    static void resetStats(uint8_t pin);
+    static uint32_t getInterruptCount() { return interruptCount; }
+    static void reset();
+
+private:
+    struct Pin {
+        uint8_t mode;
+        uint8_t level;
+        bool driven;             // A peripheral drives it; pull-ups no longer matter
+        void (*handler)();
+        int interruptMode;
+        bool pending;
+        uint64_t highSince;
+        PinStats stats;
+        PinListener* listeners[MAX_LISTENERS];
+        uint8_t listenerCount;
+    };
+
+    static Pin pins[PIN_COUNT];
+    static bool interruptsEnabled;
+    static uint8_t isrDepth;
+    static uint32_t interruptCount;
+
+    static void setLevel(Pin& pin, uint8_t level);
+    static void dispatchPending();
+};
+
+#endif // HOST_GPIO_H
@@ -0,0 +1,143 @@
+#include "LiquidCrystal_I2C.h"
+
+namespace {
+
+const uint8_t LCD_CLEARDISPLAY = 0x01;
+const uint8_t LCD_RETURNHOME = 0x02;
+const uint8_t LCD_SETCGRAMADDR = 0x40;
+const uint8_t LCD_SETDDRAMADDR = 0x80;
+const uint8_t ROW_OFFSETS[] = { 0x00, 0x40, 0x14, 0x54 };
+
+}
+
+LiquidCrystal_I2C* LiquidCrystal_I2C::modules[MAX_MODULES] = {};
+
+LiquidCrystal_I2C::LiquidCrystal_I2C(uint8_t address, uint8_t cols, uint8_t rows)
+    : address(address), cols(cols < MAX_COLS ? cols : MAX_COLS), rows(rows < MAX_ROWS ? rows : MAX_ROWS) {
+    memset(ddram, ' ', sizeof(ddram));
+    for (uint8_t i = 0; i < MAX_MODULES; i++) {
+        if (modules[i] == nullptr) {
+            modules[i] = this;
+            break;
+        }
+    }
+}
+
+LiquidCrystal_I2C::~LiquidCrystal_I2C() {
+    for (uint8_t i = 0; i < MAX_MODULES; i++) {
+        if (modules[i] == this) modules[i] = nullptr;
+    }
+}
+
+LiquidCrystal_I2C* LiquidCrystal_I2C::atAddress(uint8_t address) {
+    for (uint8_t i = 0; i < MAX_MODULES; i++) {
+        if (modules[i] != nullptr && modules[i]->address == address) return modules[i];
+    }
+    return nullptr;
+}
+
+void LiquidCrystal_I2C::init() {
+    // Power-on wait and the 4-bit initialisation sequence of the real library
+    delay(50);
+    for (uint8_t i = 0; i < 4; i++) {
+        send(false);
+        delayMicroseconds(4500);
+    }
+    displayOn = true;
+    clear();
+    addressCounter = 0;
+}
+
+void LiquidCrystal_I2C::clear() {
+    command(LCD_CLEARDISPLAY);
+    memset(ddram, ' ', sizeof(ddram));
+    addressCounter = 0;
+    delayMicroseconds(2000);
+}
+
+void LiquidCrystal_I2C::home() {
+    command(LCD_RETURNHOME);
+    addressCounter = 0;
+    delayMicroseconds(2000);
+}
+
+void LiquidCrystal_I2C::setCursor(uint8_t col, uint8_t row) {
+    if (row >= rows) {
+        row = rows - 1; // Same clamp as the library
+    }
+    command(LCD_SETDDRAMADDR | (col + ROW_OFFSETS[row]));
+}
+
+void LiquidCrystal_I2C::backlight() {
+    backlightOn = true;
+    delayMicroseconds(EXPANDER_WRITE_US);
+}
+
+void LiquidCrystal_I2C::noBacklight() {
+    backlightOn = false;
+    delayMicroseconds(EXPANDER_WRITE_US);
+}
+
+void LiquidCrystal_I2C::createChar(uint8_t location, uint8_t charmap[]) {
+    command(LCD_SETCGRAMADDR | ((location & 0x7) << 3));
+    for (uint8_t i = 0; i < 8; i++) {
+        send(true);
+    }
+}
+
+void LiquidCrystal_I2C::command(uint8_t value) {
+    send(false);
+    if (value & LCD_SETDDRAMADDR) {
+        uint8_t target = value & 0x7F;
+        addressCounter = ddramIndex(target) < DDRAM_SIZE ? target : 0;
+    }
+}
+
+size_t LiquidCrystal_I2C::write(uint8_t value) {
+    send(true);
+    uint8_t index = ddramIndex(addressCounter);
+    if (index < DDRAM_SIZE) {
+        ddram[index] = (char)value;
+    }
+
+    // Increment mode: line 1 runs on into line 2 and line 2 wraps to line 1
+    addressCounter++;
+    if (addressCounter == 0x28) {
+        addressCounter = 0x40;
+    } else if (addressCounter == 0x68) {
+        addressCounter = 0x00;
+    }
+    return 1;
+}
+
+char LiquidCrystal_I2C::glassAt(uint8_t col, uint8_t row) const {
+    if (col >= cols || row >= rows) return '\0';
+    return ddram[ddramIndex(ROW_OFFSETS[row] + col)];
+}
+
+void LiquidCrystal_I2C::readRow(uint8_t row, char* text) const {
+    for (uint8_t col = 0; col < cols; col++) {
+        text[col] = glassAt(col, row);
+    }
+    text[cols] = '\0';
+}
+
+void LiquidCrystal_I2C::resetCounters() {
+    dataBytes = 0;
+    commandBytes = 0;
+}
+
+void LiquidCrystal_I2C::send(bool data) {
+    if (data) {
+        dataBytes++;
+    } else {
+        commandBytes++;
+    }
+    delayMicroseconds(6 * EXPANDER_WRITE_US);
+}
+
+uint8_t LiquidCrystal_I2C::ddramIndex(uint8_t address) {
+    if (address < 0x28) return address;
+    if (address >= 0x40 && address < 0x68) return address - 0x40 + 0x28;
+    return DDRAM_SIZE;
+}
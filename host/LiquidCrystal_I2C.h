@@ -0,0 +1,75 @@
+#ifndef HOST_LIQUID_CRYSTAL_I2C_H
+#define HOST_LIQUID_CRYSTAL_I2C_H
+
+#include <Arduino.h>
+
+/**
+ * @brief LiquidCrystal_I2C API over a model of the HD44780 controller
+ *
+ * Characters land in display RAM at the controller's address counter, which
+ * advances after every write exactly like the chip's: on a 20x4 module the end of
+ * row 0 runs on into row 2, not row 1. glassAt() reads back what the panel shows.
+ *
+ * Each LCD byte costs six PCF8574 expander writes, as in the real library, and
+ * every expander write takes EXPANDER_WRITE_US of virtual time.
+ */
+class LiquidCrystal_I2C : public Print {
+public:
+    static const uint8_t MAX_COLS = 40;
+    static const uint8_t MAX_ROWS = 4;
+    static const uint32_t EXPANDER_WRITE_US = 100; // Address plus one byte at 100 kHz, rounded
+
+    LiquidCrystal_I2C(uint8_t address, uint8_t cols, uint8_t rows);
+    ~LiquidCrystal_I2C();
+
+    void init();
+    void begin() { init(); }
+    void clear();
+    void home();
+    void setCursor(uint8_t col, uint8_t row);
+    void backlight();
+    void noBacklight();
+    void display() { displayOn = true; }
+    void noDisplay() { displayOn = false; }
+    void cursor() {}
+    void noCursor() {}
+    void blink() {}
+    void noBlink() {}
+    void createChar(uint8_t location, uint8_t charmap[]);
+    void command(uint8_t value);
+
+    size_t write(uint8_t value) override;
+    using Print::write;
+
+    // Host side
+    static LiquidCrystal_I2C* atAddress(uint8_t address); // The module answering on the bus
+    char glassAt(uint8_t col, uint8_t row) const;
+    void readRow(uint8_t row, char* text) const; // cols characters plus a terminator
+    uint8_t getCols() const { return cols; }
+    uint8_t getRows() const { return rows; }
+    bool isBacklightOn() const { return backlightOn; }
+    uint32_t getDataBytes() const { return dataBytes; }
+    uint32_t getCommandBytes() const { return commandBytes; }
+    uint32_t getExpanderWrites() const { return (dataBytes + commandBytes) * 6; }
+    void resetCounters();
+
+private:
+    static const uint8_t DDRAM_SIZE = 80;
+    static const uint8_t MAX_MODULES = 4;
+    static LiquidCrystal_I2C* modules[MAX_MODULES];
+
+    uint8_t address;
+    uint8_t cols;
+    uint8_t rows;
+    char ddram[DDRAM_SIZE];
+    uint8_t addressCounter = 0; // 0x00-0x27 and 0x40-0x67
+    bool backlightOn = false;
+    bool displayOn = false;
+    uint32_t dataBytes = 0;
+    uint32_t commandBytes = 0;
+
+    void send(bool data);
+    static uint8_t ddramIndex(uint8_t address);
+};
+
+#endif // HOST_LIQUID_CRYSTAL_I2C_H
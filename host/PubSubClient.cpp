@@ -0,0 +1,401 @@
+#include "PubSubClient.h"
+
+PubSubClient::PubSubClient() {
+    setBufferSize(MQTT_MAX_PACKET_SIZE);
+}
+
+PubSubClient::PubSubClient(Client& client) : PubSubClient() {
+    setClient(client);
+}
+
+PubSubClient::~PubSubClient() {
+    free(buffer);
+}
+
+PubSubClient& PubSubClient::setServer(IPAddress newIp, uint16_t newPort) {
+    ip = newIp;
+    port = newPort;
+    domain = nullptr;
+    return *this;
+}
+
+PubSubClient& PubSubClient::setServer(const char* newDomain, uint16_t newPort) {
+    domain = newDomain;
+    port = newPort;
+    return *this;
+}
+
+PubSubClient& PubSubClient::setCallback(MQTT_CALLBACK_SIGNATURE) {
+    this->callback = callback;
+    return *this;
+}
+
+PubSubClient& PubSubClient::setClient(Client& newClient) {
+    client = &newClient;
+    return *this;
+}
+
+PubSubClient& PubSubClient::setKeepAlive(uint16_t seconds) {
+    keepAlive = seconds;
+    return *this;
+}
+
+PubSubClient& PubSubClient::setSocketTimeout(uint16_t seconds) {
+    socketTimeout = seconds;
+    return *this;
+}
+
+bool PubSubClient::setBufferSize(uint16_t size) {
+    if (size == 0) return false;
+    uint8_t* grown = (uint8_t*)realloc(buffer, size);
+    if (grown == nullptr) return false;
+    buffer = grown;
+    bufferSize = size;
+    return true;
+}
+
+bool PubSubClient::connect(const char* id) {
+    return connect(id, nullptr, nullptr);
+}
+
+bool PubSubClient::connect(const char* id, const char* user, const char* pass) {
+    if (connected()) return true;
+
+    int result;
+    if (client->connected()) {
+        result = 1;
+    } else if (domain != nullptr) {
+        result = client->connect(domain, port);
+    } else {
+        result = client->connect(ip, port);
+    }
+    if (result != 1) {
+        clientState = MQTT_CONNECT_FAILED;
+        return false;
+    }
+
+    nextMsgId = 1;
+    uint16_t length = MQTT_MAX_HEADER_SIZE;
+    const uint8_t header[] = { 0x00, 0x04, 'M', 'Q', 'T', 'T', MQTT_VERSION_3_1_1 };
+    memcpy(buffer + length, header, sizeof(header));
+    length += sizeof(header);
+
+    uint8_t flags = 0x02; // Clean session
+    if (user != nullptr) {
+        flags |= 0x80;
+        if (pass != nullptr) flags |= 0x40;
+    }
+    buffer[length++] = flags;
+    buffer[length++] = keepAlive >> 8;
+    buffer[length++] = keepAlive & 0xFF;
+
+    length = writeString(id, buffer, length);
+    if (user != nullptr) {
+        length = writeString(user, buffer, length);
+        if (pass != nullptr) length = writeString(pass, buffer, length);
+    }
+    writePacket(MQTTCONNECT, buffer, length - MQTT_MAX_HEADER_SIZE);
+
+    lastInActivity = lastOutActivity = millis();
+    while (!client->available()) {
+        if (millis() - lastInActivity >= socketTimeout * 1000UL) {
+            clientState = MQTT_CONNECTION_TIMEOUT;
+            client->stop();
+            return false;
+        }
+        delay(1);
+    }
+
+    uint8_t lengthLength;
+    uint32_t packetLength = readPacket(&lengthLength);
+    if (packetLength == 4) {
+        if (buffer[3] == 0) {
+            lastInActivity = millis();
+            pingOutstanding = false;
+            clientState = MQTT_CONNECTED;
+            return true;
+        }
+        clientState = buffer[3];
+    }
+    client->stop();
+    return false;
+}
+
+void PubSubClient::disconnect() {
+    buffer[0] = MQTTDISCONNECT;
+    buffer[1] = 0;
+    client->write(buffer, 2);
+    clientState = MQTT_DISCONNECTED;
+    client->flush();
+    client->stop();
+    lastInActivity = lastOutActivity = millis();
+}
+
+bool PubSubClient::readByte(uint8_t* result) {
+    unsigned long start = millis();
+    while (!client->available()) {
+        if (millis() - start >= socketTimeout * 1000UL) return false;
+        delay(1);
+    }
+    *result = client->read();
+    return true;
+}
+
+bool PubSubClient::readByte(uint8_t* result, uint16_t* index) {
+    uint16_t current = *index;
+    uint8_t* write = result + current;
+    if (readByte(write)) {
+        *index = current + 1;
+        return true;
+    }
+    return false;
+}
+
+uint32_t PubSubClient::readPacket(uint8_t* lengthLength) {
+    uint16_t length = 0;
+    if (!readByte(buffer, &length)) return 0;
+    bool isPublish = (buffer[0] & 0xF0) == MQTTPUBLISH;
+    uint32_t multiplier = 1;
+    uint32_t remaining = 0;
+    uint8_t digit = 0;
+    uint16_t skip = 0;
+    uint32_t start = 0;
+
+    do {
+        if (length == 5) {
+            clientState = MQTT_DISCONNECTED; // Invalid remaining length
+            client->stop();
+            return 0;
+        }
+        if (!readByte(&digit)) return 0;
+        buffer[length++] = digit;
+        remaining += (digit & 127) * multiplier;
+        multiplier <<= 7;
+    } while ((digit & 128) != 0);
+    *lengthLength = length - 1;
+
+    if (isPublish) {
+        // Topic length, so the payload can be streamed when it does not fit
+        if (!readByte(buffer, &length)) return 0;
+        if (!readByte(buffer, &length)) return 0;
+        skip = (buffer[*lengthLength + 1] << 8) + buffer[*lengthLength + 2];
+        start = 2;
+        if (buffer[0] & MQTTQOS1) {
+            skip += 2; // Message id
+        }
+    }
+
+    uint32_t index = 0;
+    for (uint32_t i = start; i < remaining; i++) {
+        if (!readByte(&digit)) return 0;
+        if (length < bufferSize) {
+            buffer[length] = digit;
+            length++;
+        } else {
+            index++;
+        }
+    }
+    (void)skip;
+
+    if (index > 0) {
+        length = 0; // Too large for the buffer: read and discarded
+    }
+    return length;
+}
+
+bool PubSubClient::loop() {
+    if (!connected()) return false;
+
+    unsigned long now = millis();
+    if (now - lastInActivity > keepAlive * 1000UL || now - lastOutActivity > keepAlive * 1000UL) {
+        if (pingOutstanding) {
+            clientState = MQTT_CONNECTION_TIMEOUT;
+            client->stop();
+            return false;
+        }
+        buffer[0] = MQTTPINGREQ;
+        buffer[1] = 0;
+        client->write(buffer, 2);
+        lastOutActivity = now;
+        lastInActivity = now;
+        pingOutstanding = true;
+    }
+
+    if (client->available()) {
+        uint8_t lengthLength;
+        uint16_t length = readPacket(&lengthLength);
+        if (length > 0) {
+            lastInActivity = now;
+            uint8_t type = buffer[0] & 0xF0;
+            if (type == MQTTPUBLISH) {
+                if (callback) {
+                    uint16_t topicLength = (buffer[lengthLength + 1] << 8) + buffer[lengthLength + 2];
+                    memmove(buffer + lengthLength + 2, buffer + lengthLength + 3, topicLength);
+                    buffer[lengthLength + 2 + topicLength] = 0;
+                    char* topic = (char*)buffer + lengthLength + 2;
+                    if ((buffer[0] & 0x06) == MQTTQOS1) {
+                        uint16_t msgId = (buffer[lengthLength + 3 + topicLength] << 8) +
+                                         buffer[lengthLength + 3 + topicLength + 1];
+                        uint8_t* payload = buffer + lengthLength + 3 + topicLength + 2;
+                        callback(topic, payload, length - lengthLength - 3 - topicLength - 2);
+                        buffer[0] = MQTTPUBACK;
+                        buffer[1] = 2;
+                        buffer[2] = msgId >> 8;
+                        buffer[3] = msgId & 0xFF;
+                        client->write(buffer, 4);
+                        lastOutActivity = now;
+                    } else {
+                        uint8_t* payload = buffer + lengthLength + 3 + topicLength;
+                        callback(topic, payload, length - lengthLength - 3 - topicLength);
+                    }
+                }
+            } else if (type == MQTTPINGREQ) {
+                buffer[0] = MQTTPINGRESP;
+                buffer[1] = 0;
+                client->write(buffer, 2);
+            } else if (type == MQTTPINGRESP) {
+                pingOutstanding = false;
+            }
+        } else if (!connected()) {
+            return false; // readPacket closed the connection
+        }
+    }
+    return true;
+}
+
+bool PubSubClient::publish(const char* topic, const char* payload) {
+    return publish(topic, (const uint8_t*)payload, payload ? strlen(payload) : 0, false);
+}
+
+bool PubSubClient::publish(const char* topic, const char* payload, bool retained) {
+    return publish(topic, (const uint8_t*)payload, payload ? strlen(payload) : 0, retained);
+}
+
+bool PubSubClient::publish(const char* topic, const uint8_t* payload, unsigned int length) {
+    return publish(topic, payload, length, false);
+}
+
+bool PubSubClient::publish(const char* topic, const uint8_t* payload, unsigned int length, bool retained) {
+    if (!connected()) return false;
+    if (bufferSize < MQTT_MAX_HEADER_SIZE + 2 + strnlen(topic, bufferSize) + length) {
+        return false; // Too long
+    }
+
+    uint16_t position = writeString(topic, buffer, MQTT_MAX_HEADER_SIZE);
+    for (unsigned int i = 0; i < length; i++) {
+        buffer[position++] = payload[i];
+    }
+    uint8_t header = MQTTPUBLISH;
+    if (retained) header |= 1;
+    return writePacket(header, buffer, position - MQTT_MAX_HEADER_SIZE);
+}
+
+bool PubSubClient::beginPublish(const char* topic, unsigned int length, bool retained) {
+    if (!connected()) return false;
+
+    uint16_t position = writeString(topic, buffer, MQTT_MAX_HEADER_SIZE);
+    uint8_t header = MQTTPUBLISH;
+    if (retained) header |= 1;
+    size_t headerLength = buildHeader(header, buffer, length + position - MQTT_MAX_HEADER_SIZE);
+    uint16_t written = client->write(buffer + (MQTT_MAX_HEADER_SIZE - headerLength),
+                                     position - (MQTT_MAX_HEADER_SIZE - headerLength));
+    lastOutActivity = millis();
+    return written == position - (MQTT_MAX_HEADER_SIZE - headerLength);
+}
+
+int PubSubClient::endPublish() {
+    return 1;
+}
+
+size_t PubSubClient::write(uint8_t value) {
+    lastOutActivity = millis();
+    return client->write(value);
+}
+
+size_t PubSubClient::write(const uint8_t* data, size_t size) {
+    lastOutActivity = millis();
+    return client->write(data, size);
+}
+
+bool PubSubClient::subscribe(const char* topic, uint8_t qos) {
+    size_t topicLength = strnlen(topic, bufferSize);
+    if (topic == nullptr || qos > 1) return false;
+    if (bufferSize < 9 + topicLength) return false;
+    if (!connected()) return false;
+
+    uint16_t length = MQTT_MAX_HEADER_SIZE;
+    nextMsgId++;
+    if (nextMsgId == 0) nextMsgId = 1;
+    buffer[length++] = nextMsgId >> 8;
+    buffer[length++] = nextMsgId & 0xFF;
+    length = writeString(topic, buffer, length);
+    buffer[length++] = qos;
+    return writePacket(MQTTSUBSCRIBE | MQTTQOS1, buffer, length - MQTT_MAX_HEADER_SIZE);
+}
+
+bool PubSubClient::unsubscribe(const char* topic) {
+    size_t topicLength = strnlen(topic, bufferSize);
+    if (topic == nullptr) return false;
+    if (bufferSize < 9 + topicLength) return false;
+    if (!connected()) return false;
+
+    uint16_t length = MQTT_MAX_HEADER_SIZE;
+    nextMsgId++;
+    if (nextMsgId == 0) nextMsgId = 1;
+    buffer[length++] = nextMsgId >> 8;
+    buffer[length++] = nextMsgId & 0xFF;
+    length = writeString(topic, buffer, length);
+    return writePacket(MQTTUNSUBSCRIBE | MQTTQOS1, buffer, length - MQTT_MAX_HEADER_SIZE);
+}
+
+bool PubSubClient::connected() {
+    if (client == nullptr) return false;
+
+    if (!client->connected()) {
+        if (clientState == MQTT_CONNECTED) {
+            clientState = MQTT_CONNECTION_LOST;
+            client->flush();
+            client->stop();
+        }
+        return false;
+    }
+    return clientState == MQTT_CONNECTED;
+}
+
+size_t PubSubClient::buildHeader(uint8_t header, uint8_t* buf, uint16_t length) {
+    uint8_t lengthBytes[4];
+    uint8_t count = 0;
+    uint16_t remaining = length;
+    do {
+        uint8_t digit = remaining & 127;
+        remaining >>= 7;
+        if (remaining > 0) digit |= 0x80;
+        lengthBytes[count++] = digit;
+    } while (remaining > 0);
+
+    buf[4 - count] = header;
+    for (uint8_t i = 0; i < count; i++) {
+        buf[MQTT_MAX_HEADER_SIZE - count + i] = lengthBytes[i];
+    }
+    return count + 1;
+}
+
+bool PubSubClient::writePacket(uint8_t header, uint8_t* buf, uint16_t length) {
+    size_t headerLength = buildHeader(header, buf, length);
+    size_t written = client->write(buf + (MQTT_MAX_HEADER_SIZE - headerLength), length + headerLength);
+    lastOutActivity = millis();
+    return written == length + headerLength;
+}
+
+uint16_t PubSubClient::writeString(const char* string, uint8_t* buf, uint16_t pos) {
+    const char* cursor = string;
+    uint16_t index = 0;
+    pos += 2;
+    while (*cursor && pos < bufferSize) {
+        buf[pos++] = *cursor++;
+        index++;
+    }
+    buf[pos - index - 2] = index >> 8;
+    buf[pos - index - 1] = index & 0xFF;
+    return pos;
+}
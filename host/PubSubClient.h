@@ -0,0 +1,108 @@
+#ifndef HOST_PUBSUBCLIENT_H
+#define HOST_PUBSUBCLIENT_H
+
+#include <Arduino.h>
+#include "Client.h"
+
+#define MQTT_VERSION_3_1_1 4
+#define MQTT_MAX_PACKET_SIZE 256
+#define MQTT_KEEPALIVE 15
+#define MQTT_SOCKET_TIMEOUT 15
+#define MQTT_MAX_HEADER_SIZE 5
+
+#define MQTT_CONNECTION_TIMEOUT -4
+#define MQTT_CONNECTION_LOST -3
+#define MQTT_CONNECT_FAILED -2
+#define MQTT_DISCONNECTED -1
+#define MQTT_CONNECTED 0
+#define MQTT_CONNECT_BAD_PROTOCOL 1
+#define MQTT_CONNECT_BAD_CLIENT_ID 2
+#define MQTT_CONNECT_UNAVAILABLE 3
+#define MQTT_CONNECT_BAD_CREDENTIALS 4
+#define MQTT_CONNECT_UNAUTHORIZED 5
+
+#define MQTTCONNECT 1 << 4
+#define MQTTCONNACK 2 << 4
+#define MQTTPUBLISH 3 << 4
+#define MQTTPUBACK 4 << 4
+#define MQTTSUBSCRIBE 8 << 4
+#define MQTTSUBACK 9 << 4
+#define MQTTUNSUBSCRIBE 10 << 4
+#define MQTTPINGREQ 12 << 4
+#define MQTTPINGRESP 13 << 4
+#define MQTTDISCONNECT 14 << 4
+
+#define MQTTQOS0 (0 << 1)
+#define MQTTQOS1 (1 << 1)
+
+#define MQTT_CALLBACK_SIGNATURE std::function<void(char*, uint8_t*, unsigned int)> callback
+
+/**
+ * @brief knolleary/PubSubClient 2.8 for host builds
+ *
+ * QoS 0 publish, QoS 0/1 subscribe, keep-alive and the blocking parts of the real
+ * library: connect() waits for CONNACK and a partial packet is read to the end,
+ * each bounded by the socket timeout. Waiting costs virtual time, so a caller that
+ * blocks here shows it in its own timing. The packet buffer is allocated by
+ * setBufferSize(), as in the library, and never reallocated afterwards.
+ */
+class PubSubClient : public Print {
+public:
+    PubSubClient();
+    explicit PubSubClient(Client& client);
+    ~PubSubClient();
+
+    PubSubClient& setServer(IPAddress ip, uint16_t port);
+    PubSubClient& setServer(const char* domain, uint16_t port);
+    PubSubClient& setCallback(MQTT_CALLBACK_SIGNATURE);
+    PubSubClient& setClient(Client& client);
+    PubSubClient& setKeepAlive(uint16_t keepAlive);
+    PubSubClient& setSocketTimeout(uint16_t timeout);
+    bool setBufferSize(uint16_t size);
+    uint16_t getBufferSize() const { return bufferSize; }
+
+    bool connect(const char* id);
+    bool connect(const char* id, const char* user, const char* pass);
+    void disconnect();
+
+    bool publish(const char* topic, const char* payload);
+    bool publish(const char* topic, const char* payload, bool retained);
+    bool publish(const char* topic, const uint8_t* payload, unsigned int length);
+    bool publish(const char* topic, const uint8_t* payload, unsigned int length, bool retained);
+    bool beginPublish(const char* topic, unsigned int length, bool retained);
+    int endPublish();
+    size_t write(uint8_t value) override;
+    size_t write(const uint8_t* buffer, size_t size) override;
+    using Print::write;
+
+    bool subscribe(const char* topic, uint8_t qos = 0);
+    bool unsubscribe(const char* topic);
+    bool loop();
+    bool connected();
+    int state() const { return clientState; }
+
+private:
+    Client* client = nullptr;
+    uint8_t* buffer = nullptr;
+    uint16_t bufferSize = 0;
+    uint16_t keepAlive = MQTT_KEEPALIVE;
+    uint16_t socketTimeout = MQTT_SOCKET_TIMEOUT;
+    uint16_t nextMsgId = 0;
+    unsigned long lastOutActivity = 0;
+    unsigned long lastInActivity = 0;
+    bool pingOutstanding = false;
+    MQTT_CALLBACK_SIGNATURE;
+    IPAddress ip;
+    const char* domain = nullptr;
+    uint16_t port = 0;
+    int clientState = MQTT_DISCONNECTED;
+
+    uint32_t readPacket(uint8_t* lengthLength);
+    bool readByte(uint8_t* result);
+    bool readByte(uint8_t* result, uint16_t* index);
+    bool writePacket(uint8_t header, uint8_t* buf, uint16_t length);
+    uint16_t writeString(const char* string, uint8_t* buf, uint16_t pos);
+    size_t buildHeader(uint8_t header, uint8_t* buf, uint16_t length);
+};
+
+#endif // HOST_PUBSUBCLIENT_H
@@ -0,0 +1,224 @@
+#include "SimHx711.h"
+#include <Arduino.h>
+
+void Waveform::add(uint32_t ms, float grams) {
+    if (count >= MAX_POINTS) return; // Scenario too long; the last value is held
+    points[count].ms = ms;
+    points[count].grams = grams;
+    count++;
+}
+
+Waveform& Waveform::set(float grams) {
+    add(getDuration(), grams);
+    return *this;
+}
+
+Waveform& Waveform::hold(uint32_t ms) {
+    if (count == 0) add(0, 0.0f);
+    add(getDuration() + ms, getFinalValue());
+    return *this;
+}
+
+Waveform& Waveform::rampTo(float grams, uint32_t ms) {
+    if (count == 0) add(0, 0.0f);
+    add(getDuration() + ms, grams);
+    return *this;
+}
+
+Waveform& Waveform::jitter(float amplitude, uint32_t ms, uint32_t periodMs) {
+    if (count == 0) add(0, 0.0f);
+    if (periodMs < 2) periodMs = 2;
+    float base = getFinalValue();
+    uint32_t end = getDuration() + ms;
+    bool high = true;
+    while (getDuration() + periodMs / 2 < end && count < MAX_POINTS - 1) {
+        float level = base + (high ? amplitude : -amplitude);
+        set(level);
+        hold(periodMs / 2);
+        high = !high;
+    }
+    set(base);
+    add(end, base);
+    return *this;
+}
+
+float Waveform::valueAt(uint64_t ms) const {
+    if (count == 0) return 0.0f;
+    if (ms <= points[0].ms) return points[0].grams;
+
+    for (uint8_t i = 1; i < count; i++) {
+        if (ms < points[i].ms) {
+            const Point& a = points[i - 1];
+            const Point& b = points[i];
+            float t = (float)(ms - a.ms) / (float)(b.ms - a.ms);
+            return a.grams + (b.grams - a.grams) * t;
+        }
+    }
+    return points[count - 1].grams;
+}
+
+SimHx711::SimHx711(uint8_t doutPin, uint8_t sckPin, int ratePin)
+    : doutPin(doutPin), sckPin(sckPin), ratePin(ratePin) {
+    noiseState ^= doutPin * 0x9E3779B9u; // Cells sharing SCK do not share noise
+}
+
+SimHx711::~SimHx711() {
+    end();
+}
+
+void SimHx711::begin() {
+    if (!attached) {
+        VirtualClock::attach(this);
+        HostGpio::addListener(sckPin, this);
+        if (ratePin >= 0) HostGpio::addListener(ratePin, this);
+        attached = true;
+    }
+    HostGpio::drive(doutPin, HIGH);
+    powered = HostGpio::level(sckPin) == LOW;
+    lastRateHigh = rateHigh();
+    restart(VirtualClock::now());
+}
+
+void SimHx711::end() {
+    if (!attached) return;
+    VirtualClock::detach(this);
+    HostGpio::removeListener(sckPin, this);
+    if (ratePin >= 0) HostGpio::removeListener(ratePin, this);
+    attached = false;
+}
+
+void SimHx711::play(const Waveform& newWaveform) {
+    waveform = newWaveform;
+    playStartMicros = VirtualClock::now();
+}
+
+void SimHx711::setWeight(float grams) {
+    Waveform constant;
+    constant.set(grams);
+    play(constant);
+}
+
+float SimHx711::currentLoad() const {
+    return waveform.valueAt((VirtualClock::now() - playStartMicros) / 1000);
+}
+
+uint32_t SimHx711::getPeriodMicros() const {
+    return rateHigh() ? 12500 : 100000;
+}
+
+bool SimHx711::rateHigh() const {
+    return ratePin >= 0 && HostGpio::level(ratePin) == HIGH;
+}
+
+uint64_t SimHx711::nextEventMicros() const {
+    return nextConversion < powerDownAt ? nextConversion : powerDownAt;
+}
+
+void SimHx711::onTime(uint64_t now) {
+    if (powerDownAt != NEVER && now >= powerDownAt) {
+        // SCK stayed high: the chip powers down and releases DOUT
+        powerDownAt = NEVER;
+        powered = false;
+        nextConversion = NEVER;
+        ready = false;
+        powerCycles++;
+        HostGpio::drive(doutPin, HIGH);
+        return;
+    }
+    if (nextConversion != NEVER && now >= nextConversion) {
+        convert(now);
+    }
+}
+
+void SimHx711::convert(uint64_t now) {
+    uint32_t period = getPeriodMicros();
+    if (ready && pulses > 0) {
+        // Being shifted out: the output register updates once the read completes
+        nextConversion = now + 50;
+        return;
+    }
+    nextConversion = now + period;
+
+    int32_t counts = sampleCounts();
+    if (settling > 0) {
+        // The digital filter is still filling after a reset or a RATE change
+        counts = offset + (counts - offset) / (int32_t)(settling + 1);
+        settling--;
+    }
+    if (ready) overwrittenCount++;
+    latched = (uint32_t)counts & 0xFFFFFF;
+    ready = true;
+    pulses = 0;
+    gain = nextGain;
+    conversionCount++;
+    HostGpio::drive(doutPin, LOW); // Falling edge only if the last result was read
+}
+
+void SimHx711::restart(uint64_t now) {
+    ready = false;
+    pulses = 0;
+    nextGain = 128;
+    settling = SETTLING_CONVERSIONS;
+    nextConversion = powered ? now + getPeriodMicros() : NEVER;
+}
+
+int32_t SimHx711::sampleCounts() {
+    // xorshift32: repeatable noise, independent of the host's rand()
+    noiseState ^= noiseState << 13;
+    noiseState ^= noiseState >> 17;
+    noiseState ^= noiseState << 5;
+    int32_t noise = 0;
+    if (noiseAmplitude > 0) {
+        noise = (int32_t)(noiseState % (uint32_t)(2 * noiseAmplitude + 1)) - noiseAmplitude;
+    }
+
+    float counts = offset + currentLoad() * countsPerGram + noise;
+    if (counts > 0x7FFFFF) counts = 0x7FFFFF;
+    if (counts < -0x800000) counts = -0x800000;
+    return (int32_t)counts;
+}
+
+void SimHx711::onPinWrite(uint8_t pin, uint8_t level) {
+    uint64_t now = VirtualClock::now();
+
+    if (ratePin >= 0 && pin == (uint8_t)ratePin) {
+        bool high = rateHigh();
+        if (high != lastRateHigh) {
+            lastRateHigh = high;
+            if (powered) {
+                settling = SETTLING_CONVERSIONS;
+                nextConversion = now + getPeriodMicros();
+            }
+        }
+        return;
+    }
+    if (pin != sckPin) return;
+
+    if (level == HIGH) {
+        sckHighSince = now;
+        if (!powered) return;
+        powerDownAt = now + POWER_DOWN_US;
+
+        pulses++;
+        if (pulses <= 24) {
+            HostGpio::drive(doutPin, ready && (latched >> (24 - pulses)) & 1 ? HIGH : LOW);
+        } else if (pulses == 25) {
+            HostGpio::drive(doutPin, HIGH);
+            ready = false;
+            readCount++;
+            nextGain = 128;
+        } else if (pulses == 26) {
+            nextGain = 32;  // Channel B
+        } else if (pulses == 27) {
+            nextGain = 64;
+        }
+        return;
+    }
+
+    // Falling edge
+    powerDownAt = NEVER;
+    if (!powered) {
+        powered = true;
+        restart(now);
+    }
+}
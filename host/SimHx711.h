@@ -0,0 +1,126 @@
+#ifndef HOST_SIM_HX711_H
+#define HOST_SIM_HX711_H
+
+#include <stdint.h>
+#include "HostGpio.h"
+#include "VirtualClock.h"
+
+/**
+ * @brief Load on a cell over time, as keyframes joined by straight lines
+ *
+ * Times are milliseconds from the start of playback; the last value is held
+ * afterwards. Built fluently, e.g. Waveform().set(0).hold(2000).rampTo(250, 300).
+ */
+class Waveform {
+public:
+    static const uint8_t MAX_POINTS = 64;
+
+    Waveform& set(float grams);                    // Step to a value at the current end
+    Waveform& hold(uint32_t ms);                   // Keep the current value
+    Waveform& rampTo(float grams, uint32_t ms);    // Linear change over ms
+    Waveform& jitter(float amplitude, uint32_t ms, uint32_t periodMs); // Square-wave wobble around the current value
+
+    float valueAt(uint64_t ms) const;
+    uint32_t getDuration() const { return count > 0 ? points[count - 1].ms : 0; }
+    float getFinalValue() const { return count > 0 ? points[count - 1].grams : 0.0f; }
+
+private:
+    struct Point {
+        uint32_t ms;
+        float grams;
+    };
+
+    Point points[MAX_POINTS];
+    uint8_t count = 0;
+
+    void add(uint32_t ms, float grams);
+};
+
+/**
+ * @brief HX711 converter behind one DOUT pin
+ *
+ * Converts continuously at the rate selected by the RATE pin (80 SPS when driven
+ * high, 10 SPS otherwise). A finished conversion pulls DOUT low; an unread result is
+ * overwritten by the next one without a new edge, as on the chip. Rising SCK edges
+ * 1..24 shift the result out MSB first, the 25th releases DOUT and further pulses
+ * select the next gain. SCK held high for more than 60 us powers the chip down; the
+ * falling edge that follows resets it, and the first conversions after a reset or a
+ * RATE change are still settling.
+ *
+ * Several instances may share one SCK, one per load cell. The load comes from a
+ * Waveform played against the virtual clock plus a small deterministic noise.
+ */
+class SimHx711 : public TimedDevice, public PinListener {
+public:
+    static const uint32_t POWER_DOWN_US = 60;
+    static const uint8_t SETTLING_CONVERSIONS = 3;
+
+    SimHx711(uint8_t doutPin, uint8_t sckPin, int ratePin = -1);
+    ~SimHx711();
+
+    void begin();
+    void end();
+
+    // Load and transfer function
+    void play(const Waveform& waveform);  // Starts now
+    void setWeight(float grams);          // Constant load from now on
+    void setOffset(int32_t counts) { offset = counts; }
+    void setCountsPerGram(float counts) { countsPerGram = counts; }
+    void setNoise(int32_t amplitudeCounts) { noiseAmplitude = amplitudeCounts; }
+
+    // Observation
+    float currentLoad() const;
+    bool isPoweredDown() const { return !powered; }
+    uint32_t getConversionCount() const { return conversionCount; }
+    uint32_t getReadCount() const { return readCount; }
+    uint32_t getOverwrittenCount() const { return overwrittenCount; } // Conversions never read
+    uint32_t getPowerCycles() const { return powerCycles; }
+    uint8_t getGain() const { return gain; }
+    uint32_t getPeriodMicros() const;
+
+    // TimedDevice
+    uint64_t nextEventMicros() const override;
+    void onTime(uint64_t nowMicros) override;
+
+    // PinListener
+    void onPinWrite(uint8_t pin, uint8_t level) override;
+
+private:
+    uint8_t doutPin;
+    uint8_t sckPin;
+    int ratePin;
+    bool attached = false;
+
+    Waveform waveform;
+    uint64_t playStartMicros = 0;
+
+    int32_t offset = 8000;
+    float countsPerGram = 0.42f;
+    int32_t noiseAmplitude = 0; // Off, like the Wokwi part the calibration factor comes from
+    uint32_t noiseState = 0x2545F491;
+
+    bool powered = true;
+    uint64_t nextConversion = NEVER;
+    uint64_t powerDownAt = NEVER;
+    uint64_t sckHighSince = 0;
+    uint8_t settling = SETTLING_CONVERSIONS;
+    bool lastRateHigh = false;
+
+    uint32_t latched = 0;    // 24-bit two's complement result
+    bool ready = false;      // Result waiting to be clocked out
+    uint8_t pulses = 0;      // SCK pulses since the result was latched
+    uint8_t gain = 128;
+    uint8_t nextGain = 128;
+
+    uint32_t conversionCount = 0;
+    uint32_t readCount = 0;
+    uint32_t overwrittenCount = 0;
+    uint32_t powerCycles = 0;
+
+    void convert(uint64_t now);
+    void restart(uint64_t now);
+    int32_t sampleCounts();
+    bool rateHigh() const;
+};
+
+#endif // HOST_SIM_HX711_H
@@ -0,0 +1,66 @@
+#include "VirtualClock.h"
+
+uint64_t VirtualClock::current = 0;
+uint64_t VirtualClock::eventCount = 0;
+uint8_t VirtualClock::depth = 0;
+TimedDevice* VirtualClock::devices[MAX_DEVICES] = {};
+uint8_t VirtualClock::deviceCount = 0;
+
+void VirtualClock::advance(uint64_t micros) {
+    advanceTo(current + micros);
+}
+
+void VirtualClock::advanceTo(uint64_t target) {
+    if (target <= current) return;
+
+    if (depth > 0) {
+        // Busy-wait inside a device event or an ISR: time passes, nothing else runs
+        current = target;
+        return;
+    }
+
+    depth++;
+    for (;;) {
+        TimedDevice* next = nullptr;
+        uint64_t when = TimedDevice::NEVER;
+        for (uint8_t i = 0; i < deviceCount; i++) {
+            uint64_t at = devices[i]->nextEventMicros();
+            if (at < when) {
+                when = at;
+                next = devices[i];
+            }
+        }
+        if (next == nullptr || when > target) break;
+
+        if (when > current) current = when;
+        eventCount++;
+        next->onTime(current);
+    }
+    if (target > current) current = target; // An ISR may already have run past it
+    depth--;
+}
+
+void VirtualClock::reset(uint64_t startMicros) {
+    current = startMicros;
+    eventCount = 0;
+    depth = 0;
+    deviceCount = 0;
+}
+
+bool VirtualClock::attach(TimedDevice* device) {
+    for (uint8_t i = 0; i < deviceCount; i++) {
+        if (devices[i] == device) return true;
+    }
+    if (deviceCount >= MAX_DEVICES) return false;
+    devices[deviceCount++] = device;
+    return true;
+}
+
+void VirtualClock::detach(TimedDevice* device) {
+    for (uint8_t i = 0; i < deviceCount; i++) {
+        if (devices[i] == device) {
+            devices[i] = devices[--deviceCount];
+            return;
+        }
+    }
+}
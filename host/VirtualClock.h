@@ -0,0 +1,53 @@
+#ifndef HOST_VIRTUAL_CLOCK_H
+#define HOST_VIRTUAL_CLOCK_H
+
+#include <stdint.h>
+
+/**
+ * @brief Simulated peripheral with its own timeline, e.g. an HX711 converting
+ */
+class TimedDevice {
+public:
+    static const uint64_t NEVER = UINT64_MAX;
+
+    virtual ~TimedDevice() {}
+    virtual uint64_t nextEventMicros() const = 0; // NEVER while idle
+    virtual void onTime(uint64_t nowMicros) = 0;  // Must move nextEventMicros() forward
+};
+
+/**
+ * @brief Host time base behind millis(), micros() and delay()
+ *
+ * Time is a 64-bit microsecond count that only moves forward when the code waits.
+ * advance() stops at every pending device event on the way and lets the device act
+ * at its exact time, so peripherals and their interrupts interleave with the code
+ * as they would on the target. Waits made from inside a device event or an ISR
+ * (bit-banging delays) only move the clock, they do not dispatch further events.
+ *
+ * millis() and micros() are truncated to unsigned long like on the target; with a
+ * 64-bit long on the host millis() never wraps, but micros() users that store the
+ * value in uint32_t still see it wrap every 71.6 minutes.
+ */
+class VirtualClock {
+public:
+    static const uint8_t MAX_DEVICES = 16;
+
+    static uint64_t now() { return current; }
+    static void advance(uint64_t micros);
+    static void advanceTo(uint64_t micros);
+    static void reset(uint64_t startMicros = 0);
+
+    static bool attach(TimedDevice* device);
+    static void detach(TimedDevice* device);
+
+    static uint64_t getEventCount() { return eventCount; }
+
+private:
+    static uint64_t current;
+    static uint64_t eventCount;
+    static uint8_t depth;
+    static TimedDevice* devices[MAX_DEVICES];
+    static uint8_t deviceCount;
+};
+
+#endif // HOST_VIRTUAL_CLOCK_H
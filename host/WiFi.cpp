@@ -0,0 +1,140 @@
+#include "WiFi.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+WiFiClass WiFi;
+
+namespace {
+
+const uint8_t MAC_ADDRESS[6] = { 0x24, 0x0A, 0xC4, 0x12, 0x34, 0x56 };
+
+}
+
+WiFiClient::WiFiClient(int fd) : fd(fd) {
+    if (fd >= 0) configure();
+}
+
+void WiFiClient::configure() {
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL, 0) | O_NONBLOCK);
+    // Virtual time outruns the kernel's delayed ACK, so Nagle would hold small packets
+    // back for what the firmware sees as seconds
+    int noDelay = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &noDelay, sizeof(noDelay));
+}
+
+int WiFiClient::connect(IPAddress ip, uint16_t port) {
+    stop();
+
+    int socketFd = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+    if (socketFd < 0) return 0;
+
+    struct sockaddr_in address;
+    memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_port = htons(port);
+    address.sin_addr.s_addr = (uint32_t)ip;
+    if (::connect(socketFd, (struct sockaddr*)&address, sizeof(address)) < 0) {
+        close(socketFd);
+        return 0;
+    }
+    fd = socketFd;
+    configure();
+    return 1;
+}
+
+int WiFiClient::connect(const char* host, uint16_t port) {
+    IPAddress ip;
+    if (!WiFi.hostByName(host, ip)) return 0;
+    return connect(ip, port);
+}
+
+size_t WiFiClient::write(const uint8_t* buffer, size_t size) {
+    if (fd < 0 || WiFi.hasSendFault()) return 0;
+    size_t sent = 0;
+    while (sent < size) {
+        ssize_t result = send(fd, buffer + sent, size - sent, MSG_NOSIGNAL);
+        if (result > 0) {
+            sent += result;
+        } else if (result < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            delay(1); // lwIP would block the caller until the send buffer drains
+        } else {
+            break;
+        }
+    }
+    return sent;
+}
+
+int WiFiClient::available() {
+    if (fd < 0) return 0;
+    int count = 0;
+    if (ioctl(fd, FIONREAD, &count) < 0) return 0;
+    return count;
+}
+
+int WiFiClient::read() {
+    uint8_t value;
+    return read(&value, 1) == 1 ? value : -1;
+}
+
+int WiFiClient::read(uint8_t* buffer, size_t size) {
+    if (fd < 0) return -1;
+    ssize_t result = recv(fd, buffer, size, MSG_DONTWAIT);
+    return result > 0 ? (int)result : -1;
+}
+
+int WiFiClient::peek() {
+    if (fd < 0) return -1;
+    uint8_t value;
+    return recv(fd, &value, 1, MSG_DONTWAIT | MSG_PEEK) == 1 ? value : -1;
+}
+
+void WiFiClient::stop() {
+    if (fd >= 0) {
+        close(fd);
+        fd = -1;
+    }
+}
+
+uint8_t WiFiClient::connected() {
+    if (fd < 0) return 0;
+    uint8_t value;
+    ssize_t result = recv(fd, &value, 1, MSG_DONTWAIT | MSG_PEEK);
+    if (result > 0) return 1;
+    if (result == 0) return 0; // Orderly shutdown by the peer
+    return errno == EAGAIN || errno == EWOULDBLOCK ? 1 : 0;
+}
+
+wl_status_t WiFiClass::begin(const char* ssid, const char* password) {
+    return linkStatus;
+}
+
+bool WiFiClass::disconnect(bool wifiOff) {
+    linkStatus = WL_DISCONNECTED;
+    return true;
+}
+
+String WiFiClass::macAddress() {
+    char text[18];
+    snprintf(text, sizeof(text), "%02X:%02X:%02X:%02X:%02X:%02X", MAC_ADDRESS[0], MAC_ADDRESS[1],
+             MAC_ADDRESS[2], MAC_ADDRESS[3], MAC_ADDRESS[4], MAC_ADDRESS[5]);
+    return String(text);
+}
+
+uint8_t* WiFiClass::macAddress(uint8_t* mac) {
+    memcpy(mac, MAC_ADDRESS, sizeof(MAC_ADDRESS));
+    return mac;
+}
+
+int WiFiClass::hostByName(const char* host, IPAddress& result) {
+    // Numeric addresses only; the simulation never leaves the loopback interface
+    struct in_addr address;
+    if (inet_pton(AF_INET, host, &address) != 1) return 0;
+    result = IPAddress(address.s_addr);
+    return 1;
+}
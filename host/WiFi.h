@@ -0,0 +1,88 @@
+#ifndef HOST_WIFI_H
+#define HOST_WIFI_H
+
+#include <Arduino.h>
+#include "Client.h"
+
+typedef enum {
+    WL_IDLE_STATUS = 0,
+    WL_NO_SSID_AVAIL = 1,
+    WL_SCAN_COMPLETED = 2,
+    WL_CONNECTED = 3,
+    WL_CONNECT_FAILED = 4,
+    WL_CONNECTION_LOST = 5,
+    WL_DISCONNECTED = 6
+} wl_status_t;
+
+typedef enum {
+    WIFI_OFF = 0,
+    WIFI_STA = 1,
+    WIFI_AP = 2,
+    WIFI_AP_STA = 3
+} wifi_mode_t;
+
+/**
+ * @brief TCP client on a host socket
+ *
+ * Copies share the socket like the ESP32 core's WiFiClient; stop() closes it.
+ * Reads never block. Nothing is allocated, so reconnecting stays off the heap.
+ */
+class WiFiClient : public Client {
+public:
+    WiFiClient() {}
+    explicit WiFiClient(int fd);
+
+    int connect(IPAddress ip, uint16_t port) override;
+    int connect(const char* host, uint16_t port) override;
+    size_t write(uint8_t value) override { return write(&value, 1); }
+    size_t write(const uint8_t* buffer, size_t size) override;
+    using Print::write;
+    int available() override;
+    int read() override;
+    int read(uint8_t* buffer, size_t size) override;
+    int peek() override;
+    void flush() override {}
+    void stop() override;
+    uint8_t connected() override;
+    operator bool() override { return fd >= 0; }
+    void setTimeout(uint32_t seconds) {}
+    int fileDescriptor() const { return fd; }
+
+private:
+    int fd = -1;
+
+    void configure();
+};
+
+/**
+ * @brief Station interface; the link state is set by the test
+ */
+class WiFiClass {
+public:
+    wl_status_t begin(const char* ssid, const char* password = nullptr);
+    bool mode(wifi_mode_t mode) { return true; }
+    bool disconnect(bool wifiOff = false);
+    wl_status_t status() { return linkStatus; }
+    bool isConnected() { return linkStatus == WL_CONNECTED; }
+    String macAddress();
+    uint8_t* macAddress(uint8_t* mac);
+    IPAddress localIP() { return IPAddress(127, 0, 0, 1); }
+    int8_t RSSI() { return linkStatus == WL_CONNECTED ? -55 : 0; }
+    bool setSleep(bool enabled) { sleepEnabled = enabled; return true; }
+    bool getSleep() const { return sleepEnabled; }
+    int hostByName(const char* host, IPAddress& result);
+
+    // Host side
+    void setStatus(wl_status_t status) { linkStatus = status; }
+    void setSendFault(bool fail) { sendFault = fail; } // Client writes fail, the socket stays open
+    bool hasSendFault() const { return sendFault; }
+
+private:
+    wl_status_t linkStatus = WL_CONNECTED;
+    bool sendFault = false;
+    bool sleepEnabled = false;
+};
+
+extern WiFiClass WiFi;
+
+#endif // HOST_WIFI_H
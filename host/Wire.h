@@ -0,0 +1,22 @@
+#ifndef HOST_WIRE_H
+#define HOST_WIRE_H
+
+#include <Arduino.h>
+
+// I2C bus; the LCD model accounts for its own bus time
+class TwoWire {
+public:
+    bool begin(int sda = -1, int scl = -1, uint32_t frequency = 0) { return true; }
+    bool setClock(uint32_t frequency) { clock = frequency; return true; }
+    uint32_t getClock() const { return clock; }
+    void beginTransmission(uint8_t address) {}
+    size_t write(uint8_t value) { return 1; }
+    uint8_t endTransmission(bool stop = true) { return 0; }
+
+private:
+    uint32_t clock = 100000;
+};
+
+extern TwoWire Wire;
+
+#endif // HOST_WIRE_H
@@ -59,8 +59,9 @@
 #include <time.h>
 
 // Hardware pin configuration (matching diagram.json)
-const int WEIGHT_DATA_PIN = 2;    // HX711 DT pin
-const int WEIGHT_CLOCK_PIN = 4;   // HX711 SCK pin
+const uint8_t WEIGHT_DATA_PINS[] = { 2 }; // HX711 DT pin per load cell, e.g. { 2, 16, 17, 18 } for four legs
+const int WEIGHT_CLOCK_PIN = 4;   // HX711 SCK pin, shared by every load cell
+const int WEIGHT_RATE_PIN = -1;   // HX711 RATE pin (e.g. 15) for 80 SPS while the load moves; -1 if strapped to 10 SPS
 const int LED_PIN = 5;            // LED indicator pin
 const uint8_t LCD_I2C_ADDRESS = 0x27; // LCD I2C address
 
@@ -73,12 +74,14 @@ const char* NTP_SERVER = "pool.ntp.org";
 const long GMT_OFFSET_SEC = -5 * 3600;  // GMT-5 (adjust for your timezone)
 const int DAYLIGHT_OFFSET_SEC = 0;
 
-// System instance
+// System instance, constructed in setup() into static storage
+InPlace<TavoloSystem> tavoloSystemStorage;
 TavoloSystem* tavoloSystem = nullptr;
 
 // Timing for non-blocking operations
-unsigned long lastStatusReport = 0;
 const unsigned long STATUS_REPORT_INTERVAL = 30000; // 30 seconds
+const unsigned long SERIAL_POLL_INTERVAL = 100;     // Fallback when no receive wakeup arrives
+Scheduler::TaskId serialTask = Scheduler::INVALID_TASK;
 
 void setup() {
     Serial.begin(115200);
@@ -96,8 +99,9 @@ void setup() {
     setupNTP();
     
     // Create and initialize the Tavolo system
-    tavoloSystem = new TavoloSystem(
-        WEIGHT_DATA_PIN, 
+    tavoloSystem = tavoloSystemStorage.construct(
+        WEIGHT_DATA_PINS, 
+        sizeof(WEIGHT_DATA_PINS), 
         WEIGHT_CLOCK_PIN, 
         LED_PIN, 
         LCD_I2C_ADDRESS
@@ -107,29 +111,35 @@ void setup() {
     setupEventCallbacks();
     
     // Initialize the system
+    tavoloSystem->setSensorRatePin(WEIGHT_RATE_PIN);
     tavoloSystem->setup();
     
+    // Sketch-level work runs on the system scheduler too
+    Scheduler& scheduler = tavoloSystem->getScheduler();
+    scheduler.addPeriodic("status", STATUS_REPORT_INTERVAL, periodicStatusReport, STATUS_REPORT_INTERVAL);
+    serialTask = scheduler.addPeriodic("serial", SERIAL_POLL_INTERVAL, handleSerialCommands);
+    Serial.onReceive([]() {
+        tavoloSystem->getScheduler().signal(serialTask);
+    });
+    
     Serial.println("System ready!");
     Serial.println("=====================================");
     
     // Show initial system status
     tavoloSystem->showSystemStatus();
+    
+    // From here on the heap should stay untouched; anything allocated is reported by STATUS/ALLOC
+    AllocationAudit::markBootComplete();
 }
 
 void loop() {
     // Main system loop - all operations are reactive and non-blocking
     if (tavoloSystem != nullptr) {
         tavoloSystem->loop();
+        
+        // Sleep until the next deadline or an external wakeup
+        tavoloSystem->getScheduler().waitForNext();
     }
-    
-    // Periodic status reporting
-    periodicStatusReport();
-    
-    // Handle serial commands for testing
-    handleSerialCommands();
-    
-    // Small delay to prevent overwhelming the system
-    delay(10);
 }
 
 void setupWiFi() {
@@ -178,22 +188,22 @@ void setupNTP() {
 void setupEventCallbacks() {
     if (tavoloSystem == nullptr) return;
     
-    // Weight change callback
-    tavoloSystem->setOnWeightChangeCallback([](float weight) {
-        // This could be used for additional processing
-        // For now, just log significant changes
+    EventBus& bus = tavoloSystem->getEventBus();
+    
+    // Weight change log, at most once per second whatever the sample rate
+    bus.subscribe("console", EventBus::WEIGHT_SAMPLE, [](void* context, const EventBus::Event& event) {
         static float lastLoggedWeight = 0;
-        if (abs(weight - lastLoggedWeight) > 10.0) { // Log every 10g change
+        if (abs(event.value - lastLoggedWeight) > 10.0) { // Log every 10g change
             Serial.print("Weight changed: ");
-            Serial.print(weight, 1);
+            Serial.print(event.value, 1);
             Serial.println("g");
-            lastLoggedWeight = weight;
+            lastLoggedWeight = event.value;
         }
-    });
+    }, nullptr, 1, 1000);
     
-    // Threshold state change callback
-    tavoloSystem->setOnThresholdStateChangeCallback([](bool exceeded) {
-        if (exceeded) {
+    // Threshold state changes
+    bus.subscribe("console", EventBus::THRESHOLD, [](void* context, const EventBus::Event& event) {
+        if (event.code) {
             Serial.println("⚠️  WEIGHT THRESHOLD EXCEEDED!");
         } else {
             Serial.println("✅ Weight back to normal range");
@@ -202,44 +212,73 @@ void setupEventCallbacks() {
 }
 
 void periodicStatusReport() {
-    unsigned long currentTime = millis();
-    
-    if (currentTime - lastStatusReport >= STATUS_REPORT_INTERVAL) {
-        if (tavoloSystem != nullptr) {
-            tavoloSystem->showSystemStatus();
-        }
-        lastStatusReport = currentTime;
+    if (tavoloSystem != nullptr) {
+        tavoloSystem->showSystemStatus();
     }
 }
 
 void handleSerialCommands() {
     if (Serial.available() > 0) {
-        String command = Serial.readStringUntil('\n');
-        command.trim();
-        command.toUpperCase();
+        // Fixed buffer instead of String so console input never touches the heap
+        char command[32];
+        size_t length = Serial.readBytesUntil('\n', command, sizeof(command) - 1);
+        while (length > 0 && isspace((unsigned char)command[length - 1])) {
+            length--;
+        }
+        command[length] = '\0';
+        
+        char* start = command;
+        while (isspace((unsigned char)*start)) {
+            start++;
+        }
+        for (char* c = start; *c; c++) {
+            *c = toupper((unsigned char)*c);
+        }
         
         if (tavoloSystem == nullptr) return;
         
         Serial.print("Processing command: ");
-        Serial.println(command);
+        Serial.println(start);
         
-        if (command == "STATUS") {
+        if (strcmp(start, "STATUS") == 0) {
             tavoloSystem->showSystemStatus();
-        } else if (command == "TARE") {
+        } else if (strcmp(start, "TARE") == 0) {
             tavoloSystem->tare();
-        } else if (command == "CALIBRATE") {
+        } else if (strcmp(start, "CALIBRATE") == 0) {
             tavoloSystem->calibrate();
-        } else if (command.startsWith("THRESHOLD=")) {
-            float threshold = command.substring(10).toFloat();
+        } else if (strncmp(start, "THRESHOLD=", 10) == 0) {
+            float threshold = strtof(start + 10, nullptr);
             tavoloSystem->setWeightThreshold(threshold);
             Serial.print("Threshold set to: ");
             Serial.print(threshold);
             Serial.println("g");
-        } else if (command == "START") {
+        } else if (strcmp(start, "START") == 0) {
             tavoloSystem->startMeasurement();
-        } else if (command == "STOP") {
+        } else if (strcmp(start, "STOP") == 0) {
             tavoloSystem->stopMeasurement();
-        } else if (command == "HELP") {
+        } else if (strcmp(start, "FILTERS") == 0) {
+            tavoloSystem->showFilterInfo();
+        } else if (strcmp(start, "CELLS") == 0) {
+            tavoloSystem->showCellInfo();
+        } else if (strcmp(start, "COMMANDS") == 0) {
+            tavoloSystem->showCommandStats();
+        } else if (strcmp(start, "SCHED") == 0) {
+            tavoloSystem->showSchedulerStats();
+        } else if (strcmp(start, "POWER") == 0) {
+            tavoloSystem->showPowerStats();
+        } else if (strcmp(start, "PIPELINE") == 0) {
+            tavoloSystem->showPipelineStats();
+        } else if (strcmp(start, "RECORDER") == 0) {
+            tavoloSystem->showFlightLog();
+        } else if (strcmp(start, "FSM") == 0) {
+            tavoloSystem->showStateMachineStats();
+        } else if (strcmp(start, "ALLOC") == 0) {
+            tavoloSystem->showAllocationStats();
+        } else if (strcmp(start, "TRACE") == 0) {
+            tavoloSystem->showTraceStats();
+        } else if (strcmp(start, "WINDOWS") == 0) {
+            tavoloSystem->showWindowStats();
+        } else if (strcmp(start, "HELP") == 0) {
             printHelp();
         } else {
             Serial.println("Unknown command. Type HELP for available commands.");
@@ -255,12 +294,23 @@ void printHelp() {
     Serial.println("THRESHOLD=X  - Set weight threshold to X grams");
     Serial.println("START        - Start weight measurements");
     Serial.println("STOP         - Stop weight measurements");
+    Serial.println("FILTERS      - Show filter chain and cost per stage");
+    Serial.println("CELLS        - Show per-cell weight, offset and factor");
+    Serial.println("COMMANDS     - Show edge command counters and dispatch latency");
+    Serial.println("SCHED        - Show scheduler tasks and wakeup latency");
+    Serial.println("POWER        - Show power profiles and sensor wake latency");
+    Serial.println("PIPELINE     - Show cross-core channel depth and drops");
+    Serial.println("RECORDER     - Show the last flight recorder entries");
+    Serial.println("FSM          - Show state machine transition counts and timing");
+    Serial.println("ALLOC        - Show heap allocations made after boot");
+    Serial.println("TRACE        - Show weight trace compression and encode cost");
+    Serial.println("WINDOWS      - Show window summary settings and the last summaries");
     Serial.println("HELP         - Show this help message");
     Serial.println("===========================\n");
 }
 
 // Error handling for system crashes
-void handleSystemError(const String& error) {
+void handleSystemError(const char* error) {
     Serial.print("SYSTEM ERROR: ");
     Serial.println(error);
     
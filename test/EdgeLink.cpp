@@ -0,0 +1,57 @@
+#include "EdgeLink.h"
+#include "QueueDirectory.h"
+#include <InPlace.h>
+#include <WiFi.h>
+
+const char* const EdgeLink::DEVICE_ID = "TAVOLO_TEST";
+
+namespace {
+
+InPlace<EdgeCommunication> linkStorage;
+InPlace<FileLogStorage> fileStorage;
+InPlace<OfflineQueue> queueStorage;
+
+}
+
+EdgeLink::EdgeLink(const char* deviceId) {
+    VirtualClock::reset();
+    clearQueueDirectory();
+    mqttBroker.begin();
+    WiFi.setStatus(WL_CONNECTED);
+    WiFi.setSendFault(false);
+
+    link = linkStorage.construct(String(deviceId));
+    link->setMqttServer("127.0.0.1", mqttBroker.getPort());
+    link->begin();
+    storage = fileStorage.construct();
+    offlineQueue = queueStorage.construct(*storage);
+    if (offlineQueue->begin()) {
+        link->setOfflineQueue(offlineQueue);
+    }
+    link->connect();
+}
+
+EdgeLink::~EdgeLink() {
+    linkStorage.destroy();
+    queueStorage.destroy();
+    fileStorage.destroy();
+    mqttBroker.end();
+    VirtualClock::reset();
+}
+
+void EdgeLink::step() {
+    mqttBroker.poll();
+    link->update();
+    delay(10);
+}
+
+void EdgeLink::runFor(uint32_t ms) {
+    uint64_t end = VirtualClock::now() + (uint64_t)ms * 1000;
+    while (VirtualClock::now() < end) {
+        step();
+    }
+}
+
+bool EdgeLink::waitOnline(uint32_t timeoutMs) {
+    return runUntil([this]() { return link->isConnected() && mqttBroker.getSubscriptionCount() > 0; }, timeoutMs);
+}
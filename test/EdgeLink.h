@@ -0,0 +1,50 @@
+#ifndef TEST_EDGE_LINK_H
+#define TEST_EDGE_LINK_H
+
+#include <EdgeCommunication.h>
+#include <FileLogStorage.h>
+#include <OfflineQueue.h>
+#include "FakeBroker.h"
+#include "VirtualClock.h"
+
+/**
+ * @brief One EdgeCommunication talking to a FakeBroker, without the rest of the system
+ *
+ * For tests of the publish path: update() is called every 10 ms of virtual time, as
+ * the network task does, and the broker is pumped before each call. An offline queue
+ * in the scratch directory is attached, emptied first. Like Simulation, only one may
+ * exist at a time.
+ */
+class EdgeLink {
+public:
+    static const char* const DEVICE_ID;
+
+    explicit EdgeLink(const char* deviceId = DEVICE_ID);
+    ~EdgeLink();
+
+    EdgeCommunication& edge() { return *link; }
+    FakeBroker& broker() { return mqttBroker; }
+    OfflineQueue& queue() { return *offlineQueue; }
+
+    void step();                          // Pump the broker, update(), advance 10 ms
+    void runFor(uint32_t ms);
+    bool waitOnline(uint32_t timeoutMs = 5000);
+
+    template <typename Predicate>
+    bool runUntil(Predicate done, uint32_t timeoutMs) {
+        uint64_t end = VirtualClock::now() + (uint64_t)timeoutMs * 1000;
+        while (!done()) {
+            if (VirtualClock::now() >= end) return false;
+            step();
+        }
+        return true;
+    }
+
+private:
+    EdgeCommunication* link = nullptr;
+    FileLogStorage* storage = nullptr;
+    OfflineQueue* offlineQueue = nullptr;
+    FakeBroker mqttBroker;
+};
+
+#endif // TEST_EDGE_LINK_H
@@ -0,0 +1,23 @@
+#ifndef TEST_QUEUE_DIRECTORY_H
+#define TEST_QUEUE_DIRECTORY_H
+
+#include <dirent.h>
+#include <limits.h>
+#include <stdio.h>
+#include <unistd.h>
+
+// Segments left by a previous test would be forwarded as backlog
+inline void clearQueueDirectory() {
+    DIR* directory = opendir(TAVOLO_OFFLINE_QUEUE_PATH);
+    if (directory == nullptr) return;
+    char path[sizeof(TAVOLO_OFFLINE_QUEUE_PATH) + NAME_MAX + 1];
+    struct dirent* entry;
+    while ((entry = readdir(directory)) != nullptr) {
+        if (entry->d_name[0] == '.') continue;
+        snprintf(path, sizeof(path), "%s/%s", TAVOLO_OFFLINE_QUEUE_PATH, entry->d_name);
+        unlink(path);
+    }
+    closedir(directory);
+}
+
+#endif // TEST_QUEUE_DIRECTORY_H
@@ -0,0 +1,153 @@
+#include "Simulation.h"
+#include "QueueDirectory.h"
+#include <WiFi.h>
+#include <math.h>
+#include <stdlib.h>
+
+const uint8_t Simulation::DATA_PINS[MAX_CELLS] = { 2, 16, 17, 18 };
+
+namespace {
+
+// Same storage scheme as the sketch: nothing the firmware owns lives on the heap
+InPlace<TavoloSystem> systemStorage;
+InPlace<SimHx711> cellStorage[Simulation::MAX_CELLS];
+
+}
+
+Simulation::Simulation() : Simulation(Options()) {}
+
+Simulation::Simulation(const Options& options) : options(options) {
+    VirtualClock::reset();
+    HostGpio::reset();
+    Serial.clearCapturedOutput();
+    clearQueueDirectory();
+
+    cellCount = options.cells == 0 ? 1 : (options.cells > MAX_CELLS ? MAX_CELLS : options.cells);
+    for (uint8_t i = 0; i < cellCount; i++) {
+        cells[i] = cellStorage[i].construct(DATA_PINS[i], CLOCK_PIN, options.ratePin ? RATE_PIN : -1);
+        cells[i]->setCountsPerGram(0.42f / cellCount); // Each cell carries an equal share
+        cells[i]->begin();
+    }
+
+    WiFi.setSendFault(false);
+    if (options.broker) {
+        mqttBroker.begin();
+        WiFi.setStatus(WL_CONNECTED);
+    } else {
+        WiFi.setStatus(WL_DISCONNECTED);
+    }
+
+    if (options.boot) {
+        boot();
+    }
+}
+
+Simulation::~Simulation() {
+    systemStorage.destroy();
+    for (uint8_t i = 0; i < cellCount; i++) {
+        cellStorage[i].destroy();
+        cells[i] = nullptr;
+    }
+    mqttBroker.end();
+    VirtualClock::reset();
+    HostGpio::reset();
+}
+
+void Simulation::boot() {
+    tavolo = systemStorage.construct(DATA_PINS, cellCount, CLOCK_PIN, LED_PIN, LCD_ADDRESS);
+    if (options.broker) {
+        tavolo->setMqttServer("127.0.0.1", mqttBroker.getPort());
+    }
+    if (options.ratePin) {
+        tavolo->setSensorRatePin(RATE_PIN);
+    }
+    tavolo->setup();
+    AllocationAudit::markBootComplete();
+}
+
+void Simulation::step() {
+    mqttBroker.poll();
+    tavolo->loop();
+    tavolo->getScheduler().waitForNext();
+}
+
+void Simulation::runFor(uint32_t ms) {
+    uint64_t end = VirtualClock::now() + (uint64_t)ms * 1000;
+    while (VirtualClock::now() < end) {
+        step();
+    }
+}
+
+void Simulation::play(const Waveform& waveform) {
+    for (uint8_t i = 0; i < cellCount; i++) {
+        cells[i]->play(waveform);
+    }
+}
+
+void Simulation::setWeight(float grams) {
+    Waveform constant;
+    constant.set(grams);
+    play(constant);
+}
+
+Simulation::LedActivity Simulation::watchLed(uint32_t ms) {
+    HostGpio::resetStats(LED_PIN);
+    uint64_t start = VirtualClock::now();
+    runFor(ms);
+    uint64_t elapsed = VirtualClock::now() - start;
+
+    HostGpio::PinStats stats = HostGpio::stats(LED_PIN);
+    LedActivity activity;
+    activity.transitions = stats.transitions;
+    activity.dutyPercent = elapsed > 0 ? (uint32_t)(stats.highMicros * 100 / elapsed) : 0;
+    activity.analogWrites = stats.analogWrites;
+    activity.analogMin = stats.analogMin;
+    activity.analogMax = stats.analogMax;
+    return activity;
+}
+
+LedActuator::BlinkPattern Simulation::ledPattern(uint32_t ms) {
+    LedActivity activity = watchLed(ms);
+
+    if (activity.analogWrites > 0 && activity.analogMax - activity.analogMin > 64) {
+        return LedActuator::BlinkPattern::PULSE;
+    }
+    if (activity.transitions == 0) {
+        return HostGpio::level(LED_PIN) == HIGH ? LedActuator::BlinkPattern::ON : LedActuator::BlinkPattern::OFF;
+    }
+    // Toggles per second: 2 for the 500 ms slow blink, 10 for the 100 ms fast blink
+    uint32_t perSecond = activity.transitions * 1000 / ms;
+    return perSecond >= 6 ? LedActuator::BlinkPattern::FAST_BLINK : LedActuator::BlinkPattern::SLOW_BLINK;
+}
+
+LiquidCrystal_I2C& Simulation::lcd() const {
+    return *LiquidCrystal_I2C::atAddress(LCD_ADDRESS);
+}
+
+void Simulation::lcdRow(uint8_t row, char* text) const {
+    lcd().readRow(row, text);
+}
+
+bool Simulation::lcdShows(const char* text) const {
+    char row[LiquidCrystal_I2C::MAX_COLS + 1];
+    for (uint8_t i = 0; i < lcd().getRows(); i++) {
+        lcd().readRow(i, row);
+        if (strstr(row, text) != nullptr) return true;
+    }
+    return false;
+}
+
+float Simulation::lcdWeight() const {
+    char row[LiquidCrystal_I2C::MAX_COLS + 1];
+    lcd().readRow(1, row);
+    char* end = nullptr;
+    float grams = strtof(row, &end);
+    return end != row && strstr(end, " g") == end ? grams : NAN;
+}
+
+bool Simulation::waitForBrokerSession(uint32_t timeoutMs) {
+    // Online once the broker has seen the subscription and the CONNECTED status
+    return runUntil([this]() {
+        return mqttBroker.getSubscriptionCount() > 0 && mqttBroker.countOn("/status", "\"CONNECTED\"") > 0;
+    }, timeoutMs);
+}
@@ -0,0 +1,91 @@
+#ifndef TEST_SIMULATION_H
+#define TEST_SIMULATION_H
+
+#include <TavoloSystem.h>
+#include "SimHx711.h"
+#include "FakeBroker.h"
+#include "HostGpio.h"
+#include "VirtualClock.h"
+
+/**
+ * @brief The sketch's setup()/loop() around a TavoloSystem, on simulated hardware
+ *
+ * Wires the firmware to one SimHx711 per load cell, the LCD model and, optionally,
+ * a FakeBroker on loopback, then runs the same loop as sketch.ino against the
+ * virtual clock: hours of operation take seconds. The broker is pumped between
+ * passes, so it answers within one loop period.
+ *
+ * Only one Simulation may exist at a time: the clock, the GPIO bank and the
+ * system's storage are process-wide, as they are on the device.
+ */
+class Simulation {
+public:
+    static const uint8_t CLOCK_PIN = 4;
+    static const uint8_t LED_PIN = 5;
+    static const uint8_t RATE_PIN = 15;
+    static const uint8_t LCD_ADDRESS = 0x27;
+    static const uint8_t MAX_CELLS = 4;
+
+    struct Options {
+        bool broker = true;     // Otherwise WiFi reports no link
+        bool ratePin = false;   // Wire the HX711 RATE line for 80 SPS while active
+        uint8_t cells = 1;
+        bool boot = true;       // Run setup() in the constructor
+    };
+
+    explicit Simulation(const Options& options);
+    Simulation();
+    ~Simulation();
+
+    void boot();                       // Construct the system and run setup()
+    void step();                       // One pass of loop()
+    void runFor(uint32_t ms);
+
+    template <typename Predicate>
+    bool runUntil(Predicate done, uint32_t timeoutMs) {
+        uint64_t end = VirtualClock::now() + (uint64_t)timeoutMs * 1000;
+        while (!done()) {
+            if (VirtualClock::now() >= end) return false;
+            step();
+        }
+        return true;
+    }
+
+    // Load on the table, shared evenly between the cells
+    void play(const Waveform& waveform);
+    void setWeight(float grams);
+
+    // Observations
+    struct LedActivity {
+        uint32_t transitions;
+        uint32_t dutyPercent;   // Time spent high
+        uint32_t analogWrites;
+        int analogMin;
+        int analogMax;
+    };
+    LedActivity watchLed(uint32_t ms);
+    LedActuator::BlinkPattern ledPattern(uint32_t ms = 2000); // Classifies watchLed()
+    bool lcdShows(const char* text) const;                     // On any row of the glass
+    void lcdRow(uint8_t row, char* text) const;
+    float lcdWeight() const;                                   // Grams on the weight screen, NAN if none
+
+    TavoloSystem& system() { return *tavolo; }
+    SimHx711& cell(uint8_t index = 0) { return *cells[index]; }
+    FakeBroker& broker() { return mqttBroker; }
+    LiquidCrystal_I2C& lcd() const;
+    uint64_t nowMs() const { return VirtualClock::now() / 1000; }
+    uint8_t getDataPin(uint8_t cell) const { return DATA_PINS[cell]; }
+
+    bool waitForBrokerSession(uint32_t timeoutMs = 10000);
+
+private:
+    static const uint8_t DATA_PINS[MAX_CELLS];
+
+    Options options;
+    TavoloSystem* tavolo = nullptr;
+    SimHx711* cells[MAX_CELLS] = {};
+    uint8_t cellCount = 0;
+    FakeBroker mqttBroker;
+};
+
+#endif // TEST_SIMULATION_H
@@ -0,0 +1,107 @@
+#ifndef TEST_HARNESS_H
+#define TEST_HARNESS_H
+
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+/**
+ * @brief Just enough of a unit test framework for the host build
+ *
+ * TEST(name) registers a case; CHECK* record a failure and keep going, REQUIRE*
+ * abandon the case. Each test executable links TestMain.cpp, which runs every
+ * registered case (or those whose name contains argv[1]) and exits non-zero on
+ * any failure, which is all ctest needs.
+ */
+namespace TestHarness {
+
+typedef void (*TestFunction)();
+
+struct TestCase {
+    const char* name;
+    TestFunction function;
+};
+
+bool registerTest(const char* name, TestFunction function);
+void fail(const char* file, int line, const char* message);
+bool currentFailed();
+
+struct Abort {};
+
+} // namespace TestHarness
+
+#define TEST(name)                                                                 \
+    static void test_##name();                                                     \
+    static bool registered_##name = TestHarness::registerTest(#name, test_##name); \
+    static void test_##name()
+
+#define TEST_FAIL_(message, fatal)                                 \
+    do {                                                           \
+        TestHarness::fail(__FILE__, __LINE__, message);            \
+        if (fatal) throw TestHarness::Abort();                     \
+    } while (0)
+
+#define CHECK_IMPL_(condition, text, fatal)                        \
+    do {                                                           \
+        if (!(condition)) TEST_FAIL_(text, fatal);                 \
+    } while (0)
+
+#define CHECK(condition) CHECK_IMPL_((condition), #condition, false)
+#define REQUIRE(condition) CHECK_IMPL_((condition), #condition, true)
+
+#define CHECK_CMP_IMPL_(a, op, b, fatal)                                                   \
+    do {                                                                                   \
+        double a_ = (double)(a);                                                           \
+        double b_ = (double)(b);                                                           \
+        if (!(a_ op b_)) {                                                                 \
+            char message_[256];                                                            \
+            snprintf(message_, sizeof(message_), "%s %s %s (%.6g vs %.6g)", #a, #op, #b, a_, b_); \
+            TEST_FAIL_(message_, fatal);                                                   \
+        }                                                                                  \
+    } while (0)
+
+#define CHECK_EQ(a, b) CHECK_CMP_IMPL_(a, ==, b, false)
+#define CHECK_NE(a, b) CHECK_CMP_IMPL_(a, !=, b, false)
+#define CHECK_LT(a, b) CHECK_CMP_IMPL_(a, <, b, false)
+#define CHECK_LE(a, b) CHECK_CMP_IMPL_(a, <=, b, false)
+#define CHECK_GT(a, b) CHECK_CMP_IMPL_(a, >, b, false)
+#define CHECK_GE(a, b) CHECK_CMP_IMPL_(a, >=, b, false)
+#define REQUIRE_EQ(a, b) CHECK_CMP_IMPL_(a, ==, b, true)
+
+#define CHECK_NEAR(a, b, tolerance)                                                        \
+    do {                                                                                   \
+        double a_ = (double)(a);                                                           \
+        double b_ = (double)(b);                                                           \
+        if (!(fabs(a_ - b_) <= (tolerance))) {                                             \
+            char message_[256];                                                            \
+            snprintf(message_, sizeof(message_), "%s ~= %s (%.6g vs %.6g, tolerance %g)",  \
+                     #a, #b, a_, b_, (double)(tolerance));                                 \
+            TEST_FAIL_(message_, false);                                                   \
+        }                                                                                  \
+    } while (0)
+
+#define CHECK_STR(a, b)                                                                    \
+    do {                                                                                   \
+        const char* a_ = (a);                                                              \
+        const char* b_ = (b);                                                              \
+        if (a_ == nullptr || b_ == nullptr || strcmp(a_, b_) != 0) {                       \
+            char message_[512];                                                            \
+            snprintf(message_, sizeof(message_), "%s == %s (\"%.200s\" vs \"%.200s\")", #a, #b, \
+                     a_ ? a_ : "(null)", b_ ? b_ : "(null)");                              \
+            TEST_FAIL_(message_, false);                                                   \
+        }                                                                                  \
+    } while (0)
+
+#define CHECK_CONTAINS(text, part)                                                         \
+    do {                                                                                   \
+        const char* t_ = (text);                                                           \
+        const char* p_ = (part);                                                           \
+        if (t_ == nullptr || strstr(t_, p_) == nullptr) {                                  \
+            char message_[512];                                                            \
+            snprintf(message_, sizeof(message_), "%s contains \"%s\" (got \"%.300s\")",    \
+                     #text, p_, t_ ? t_ : "(null)");                                       \
+            TEST_FAIL_(message_, false);                                                   \
+        }                                                                                  \
+    } while (0)
+
+#endif // TEST_HARNESS_H
@@ -0,0 +1,63 @@
+#include "TestHarness.h"
+#include <stdlib.h>
+
+namespace TestHarness {
+
+static const int MAX_TESTS = 128;
+static TestCase tests[MAX_TESTS];
+static int testCount = 0;
+static bool failed = false;
+
+bool registerTest(const char* name, TestFunction function) {
+    if (testCount >= MAX_TESTS) {
+        fprintf(stderr, "Too many tests, raise MAX_TESTS\n");
+        exit(2);
+    }
+    tests[testCount].name = name;
+    tests[testCount].function = function;
+    testCount++;
+    return true;
+}
+
+void fail(const char* file, int line, const char* message) {
+    fprintf(stderr, "  %s:%d: FAILED: %s\n", file, line, message);
+    failed = true;
+}
+
+bool currentFailed() {
+    return failed;
+}
+
+} // namespace TestHarness
+
+int main(int argc, char** argv) {
+    using namespace TestHarness;
+
+    const char* filter = argc > 1 ? argv[1] : nullptr;
+    int run = 0;
+    int failures = 0;
+
+    for (int i = 0; i < testCount; i++) {
+        if (filter != nullptr && strstr(tests[i].name, filter) == nullptr) continue;
+
+        printf("[ RUN  ] %s\n", tests[i].name);
+        fflush(stdout);
+        failed = false;
+        try {
+            tests[i].function();
+        } catch (const Abort&) {
+            // Failure already reported
+        }
+        run++;
+        if (failed) {
+            failures++;
+            printf("[ FAIL ] %s\n", tests[i].name);
+        } else {
+            printf("[  OK  ] %s\n", tests[i].name);
+        }
+        fflush(stdout);
+    }
+
+    printf("%d test(s), %d failure(s)\n", run, failures);
+    return failures == 0 && run > 0 ? 0 : 1;
+}
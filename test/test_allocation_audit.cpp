@@ -0,0 +1,90 @@
+// Allocation audit: standard operator new failure and a day without heap allocations
+#include "TestHarness.h"
+#include "Simulation.h"
+#include <AllocationAudit.h>
+#include <new>
+
+typedef TavoloSystem::SystemState State;
+
+namespace {
+
+uint32_t handlerCalls = 0;
+
+void releaseNothing() {
+    // A real handler would free a reserve; this one gives up on the second call
+    if (++handlerCalls >= 2) {
+        std::set_new_handler(nullptr);
+    }
+}
+
+// Far larger than any heap, so malloc() fails at once
+volatile size_t impossibleSize = (size_t)1 << (sizeof(size_t) * 8 - 2);
+
+}
+
+TEST(failed_new_calls_the_handler_then_throws_bad_alloc) {
+    handlerCalls = 0;
+    std::set_new_handler(releaseNothing);
+    bool threw = false;
+    try {
+        char* block = new char[impossibleSize];
+        delete[] block;
+    } catch (const std::bad_alloc&) {
+        threw = true;
+    }
+    std::set_new_handler(nullptr);
+    CHECK(threw);
+    CHECK_EQ(handlerCalls, 2u);
+}
+
+TEST(failed_nothrow_new_returns_null) {
+    char* block = new (std::nothrow) char[impossibleSize];
+    CHECK(block == nullptr);
+    delete[] block;
+
+    uint32_t before = AllocationAudit::getBootAllocations() + AllocationAudit::getPostBootAllocations();
+    int* value = new (std::nothrow) int(7);
+    REQUIRE(value != nullptr);
+    CHECK_EQ(*value, 7);
+    delete value;
+    CHECK_EQ(AllocationAudit::getBootAllocations() + AllocationAudit::getPostBootAllocations(), before + 1);
+}
+
+TEST(a_day_of_operation_allocates_nothing_after_boot) {
+    Simulation sim;
+    sim.setWeight(0);
+    REQUIRE(sim.runUntil([&]() { return sim.system().getSystemState() == State::IDLE; }, 10000));
+    REQUIRE(sim.waitForBrokerSession());
+    uint32_t before = AllocationAudit::getPostBootAllocations();
+
+    // Loads come and go all day; the threshold is crossed, commands arrive and the
+    // broker goes away for a while, so every task and the reconnect path run
+    Waveform day;
+    day.set(0);
+    for (int hour = 0; hour < 24; hour++) {
+        day.hold(900000).rampTo(60, 400).hold(900000).rampTo(180, 400).hold(600000)
+           .rampTo(0, 400).jitter(3, 10000, 250).hold(1188800);
+    }
+    sim.play(day);
+
+    char topic[64];
+    snprintf(topic, sizeof(topic), "tavolo/%s/command", sim.system().getDeviceId().c_str());
+    for (int hour = 0; hour < 24; hour++) {
+        sim.runFor(1800000);
+        sim.broker().injectPublish(topic, hour % 2 ? "{\"command\":\"UPLOAD_FLIGHT_LOG\"}"
+                                                   : "{\"command\":\"SET_THRESHOLD\",\"value\":100}");
+        if (hour == 12) {
+            sim.broker().dropConnection();
+        }
+        sim.runFor(1800000);
+    }
+
+    CHECK_GE(sim.nowMs(), 24ULL * 3600 * 1000);
+    CHECK_GE(sim.broker().getConnectCount(), 2u);
+    CHECK_GE(sim.broker().getPublishCount(), 24u * 60); // At least the heartbeats and summaries
+    CHECK_EQ(AllocationAudit::getPostBootAllocations() - before, 0u);
+    if (AllocationAudit::getPostBootAllocations() != before) {
+        AllocationAudit::print(Serial);
+        fputs(Serial.capturedOutput(), stdout);
+    }
+}
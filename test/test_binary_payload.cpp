@@ -0,0 +1,191 @@
+// BinaryPayload: byte layout, round trips, version and truncation handling
+#include "TestHarness.h"
+#include "EdgeLink.h"
+#include <BinaryPayload.h>
+#include <float.h>
+#include <stdint.h>
+
+namespace {
+
+typedef BinaryPayload::Message Message;
+
+// Every proper prefix of a valid message, and the message with a byte appended, must be refused
+void checkExactLength(const uint8_t* encoded, size_t length) {
+    Message message;
+    for (size_t prefix = 0; prefix < length; prefix++) {
+        if (BinaryPayload::decode(encoded, prefix, message)) {
+            char text[64];
+            snprintf(text, sizeof(text), "decoded a %u-byte prefix of %u bytes", (unsigned)prefix, (unsigned)length);
+            TEST_FAIL_(text, false);
+        }
+    }
+    uint8_t longer[BinaryPayload::MAX_MESSAGE_SIZE + 1];
+    memcpy(longer, encoded, length);
+    longer[length] = 0;
+    CHECK(!BinaryPayload::decode(longer, length + 1, message));
+}
+
+}
+
+TEST(weight_layout_is_little_endian) {
+    uint8_t buffer[BinaryPayload::WEIGHT_SIZE];
+    REQUIRE_EQ(BinaryPayload::encodeWeight(buffer, sizeof(buffer), 0x04030201u, 1.0f), 10u);
+    const uint8_t expected[] = { 1, 1, 0x01, 0x02, 0x03, 0x04, 0x00, 0x00, 0x80, 0x3F };
+    CHECK(memcmp(buffer, expected, sizeof(expected)) == 0);
+    CHECK_NE(buffer[0], '{'); // Never mistaken for JSON
+}
+
+TEST(weights_round_trip_bit_for_bit) {
+    const float weights[] = { 0.0f, -0.0f, 1.5f, -250.25f, 123456.789f, FLT_MIN, FLT_MAX, -FLT_MAX,
+                              INFINITY, -INFINITY };
+    const uint32_t timestamps[] = { 0, 1, 0x7FFFFFFFu, 0x80000000u, 0xFFFFFFFFu };
+    for (float weight : weights) {
+        for (uint32_t timestamp : timestamps) {
+            uint8_t buffer[BinaryPayload::WEIGHT_SIZE];
+            size_t length = BinaryPayload::encodeWeight(buffer, sizeof(buffer), timestamp, weight);
+            Message message;
+            REQUIRE(BinaryPayload::decode(buffer, length, message));
+            CHECK_EQ(message.version, BinaryPayload::VERSION);
+            CHECK(message.type == BinaryPayload::WEIGHT);
+            CHECK_EQ(message.timestamp, timestamp);
+            CHECK(memcmp(&message.weight, &weight, sizeof(float)) == 0);
+        }
+    }
+
+    // NaN keeps its payload bits, it is not canonicalised on the way
+    uint32_t nanBits = 0x7FC01234u;
+    float nan;
+    memcpy(&nan, &nanBits, sizeof(nan));
+    uint8_t buffer[BinaryPayload::WEIGHT_SIZE];
+    Message message;
+    REQUIRE(BinaryPayload::decode(buffer, BinaryPayload::encodeWeight(buffer, sizeof(buffer), 7, nan), message));
+    uint32_t decodedBits;
+    memcpy(&decodedBits, &message.weight, sizeof(decodedBits));
+    CHECK_EQ(decodedBits, nanBits);
+}
+
+TEST(status_round_trips_and_long_text_is_cut_to_the_limit) {
+    uint8_t buffer[BinaryPayload::MAX_MESSAGE_SIZE];
+    Message message;
+
+    size_t length = BinaryPayload::encodeStatus(buffer, sizeof(buffer), 42, "CONNECTED");
+    CHECK_EQ(length, 7u + 9u);
+    REQUIRE(BinaryPayload::decode(buffer, length, message));
+    CHECK(message.type == BinaryPayload::STATUS);
+    CHECK_EQ(message.timestamp, 42u);
+    CHECK_STR(message.status, "CONNECTED");
+
+    length = BinaryPayload::encodeStatus(buffer, sizeof(buffer), 42, "");
+    CHECK_EQ(length, 7u);
+    REQUIRE(BinaryPayload::decode(buffer, length, message));
+    CHECK_STR(message.status, "");
+
+    const char* longStatus = "0123456789abcdefghijklmnopqrstuvwxyz"; // 36 characters
+    length = BinaryPayload::encodeStatus(buffer, sizeof(buffer), 42, longStatus);
+    CHECK_EQ(length, BinaryPayload::MAX_MESSAGE_SIZE);
+    REQUIRE(BinaryPayload::decode(buffer, length, message));
+    CHECK_EQ(strlen(message.status), BinaryPayload::MAX_STATUS_LENGTH);
+    CHECK(strncmp(message.status, longStatus, BinaryPayload::MAX_STATUS_LENGTH) == 0);
+}
+
+TEST(heartbeat_round_trips) {
+    uint8_t buffer[BinaryPayload::HEARTBEAT_SIZE];
+    Message message;
+    size_t length = BinaryPayload::encodeHeartbeat(buffer, sizeof(buffer), 0xDEADBEEFu);
+    REQUIRE_EQ(length, BinaryPayload::HEARTBEAT_SIZE);
+    REQUIRE(BinaryPayload::decode(buffer, length, message));
+    CHECK(message.type == BinaryPayload::HEARTBEAT);
+    CHECK_EQ(message.timestamp, 0xDEADBEEFu);
+}
+
+TEST(encoders_refuse_a_short_buffer) {
+    uint8_t buffer[BinaryPayload::MAX_MESSAGE_SIZE];
+    memset(buffer, 0xAA, sizeof(buffer));
+    CHECK_EQ(BinaryPayload::encodeWeight(buffer, BinaryPayload::WEIGHT_SIZE - 1, 1, 1.0f), 0u);
+    CHECK_EQ(BinaryPayload::encodeHeartbeat(buffer, BinaryPayload::HEARTBEAT_SIZE - 1, 1), 0u);
+    CHECK_EQ(BinaryPayload::encodeStatus(buffer, 7 + 4, 1, "HELLO"), 0u);
+    CHECK_EQ(buffer[0], 0xAA); // Nothing written
+    CHECK_EQ(BinaryPayload::encodeStatus(buffer, 7 + 5, 1, "HELLO"), 12u);
+}
+
+TEST(truncated_and_padded_messages_are_refused) {
+    uint8_t buffer[BinaryPayload::MAX_MESSAGE_SIZE];
+    size_t length = BinaryPayload::encodeWeight(buffer, sizeof(buffer), 1000, 12.5f);
+    checkExactLength(buffer, length);
+    length = BinaryPayload::encodeStatus(buffer, sizeof(buffer), 1000, "MEASURING");
+    checkExactLength(buffer, length);
+    length = BinaryPayload::encodeHeartbeat(buffer, sizeof(buffer), 1000);
+    checkExactLength(buffer, length);
+
+    // A status length byte that disagrees with the message, or exceeds the limit
+    length = BinaryPayload::encodeStatus(buffer, sizeof(buffer), 1000, "IDLE");
+    Message message;
+    buffer[6] = 5;
+    CHECK(!BinaryPayload::decode(buffer, length, message));
+    buffer[6] = BinaryPayload::MAX_STATUS_LENGTH + 1;
+    uint8_t oversized[BinaryPayload::MAX_MESSAGE_SIZE + 1] = {};
+    memcpy(oversized, buffer, 7);
+    CHECK(!BinaryPayload::decode(oversized, sizeof(oversized), message));
+}
+
+TEST(unknown_versions_and_types_are_refused) {
+    uint8_t buffer[BinaryPayload::WEIGHT_SIZE];
+    size_t length = BinaryPayload::encodeWeight(buffer, sizeof(buffer), 1000, 12.5f);
+    Message message;
+
+    const uint8_t versions[] = { 0, BinaryPayload::VERSION + 1, '{', 0xFF };
+    for (uint8_t version : versions) {
+        buffer[0] = version;
+        CHECK(!BinaryPayload::decode(buffer, length, message));
+    }
+    buffer[0] = BinaryPayload::VERSION;
+
+    const uint8_t types[] = { 0, 4, 0x7F, 0xFF };
+    for (uint8_t type : types) {
+        buffer[1] = type;
+        CHECK(!BinaryPayload::decode(buffer, length, message));
+    }
+
+    // JSON on the same topic is not binary
+    const char* json = "{\"type\":\"heartbeat\"}";
+    CHECK(!BinaryPayload::decode((const uint8_t*)json, strlen(json), message));
+}
+
+TEST(published_binary_messages_decode_on_the_broker) {
+    EdgeLink link;
+    REQUIRE(link.waitOnline());
+    link.runFor(100); // Let the JSON CONNECTED status reach the broker first
+    link.edge().setPayloadFormat(EdgeCommunication::PayloadFormat::BINARY);
+    link.broker().clearLog();
+
+    EdgeCommunication::WeightData data;
+    data.weight = 321.5f;
+    data.timestamp = 123456;
+    REQUIRE(link.edge().sendWeightData(data));
+    REQUIRE(link.edge().sendStatusUpdate("MEASURING"));
+    link.runFor(31000); // One heartbeat
+
+    Message message;
+    const FakeBroker::Message* weight = link.broker().lastOn("/weight");
+    REQUIRE(weight != nullptr);
+    REQUIRE(BinaryPayload::decode(weight->payload, weight->length, message));
+    CHECK(message.type == BinaryPayload::WEIGHT);
+    CHECK_EQ(message.weight, 321.5f);
+    CHECK_EQ(message.timestamp, 123456u);
+
+    uint32_t statuses = 0;
+    uint32_t heartbeats = 0;
+    for (size_t i = 0; i < link.broker().logSize(); i++) {
+        const FakeBroker::Message& entry = link.broker().logEntry(i);
+        if (!strstr(entry.topic, "/status")) continue;
+        REQUIRE(BinaryPayload::decode(entry.payload, entry.length, message));
+        if (message.type == BinaryPayload::STATUS) {
+            CHECK_STR(message.status, "MEASURING");
+            statuses++;
+        } else if (message.type == BinaryPayload::HEARTBEAT) {
+            heartbeats++;
+        }
+    }
+    CHECK_EQ(statuses, 1u);
+    CHECK_GE(heartbeats, 1u);
+}
@@ -0,0 +1,214 @@
+// CommandRegistry: hashed lookup, typed argument decoding, rejection, and the MQTT entry point
+#include "TestHarness.h"
+#include "EdgeLink.h"
+#include <CommandRegistry.h>
+#include <DeferredLog.h>
+
+namespace {
+
+typedef CommandRegistry<struct Panel, 8> Registry;
+typedef Registry::Result Result;
+
+struct Panel {
+    uint32_t calls = 0;
+    CommandArg last;
+};
+
+const char* const MODES[] = { "OFF", "ON", "AUTO" };
+
+void remember(Panel& panel, const CommandArg& arg) {
+    panel.calls++;
+    panel.last = arg;
+}
+
+void fillRegistry(Registry& registry) {
+    REQUIRE(registry.add("LEVEL", CommandArg::FLOAT, remember));
+    REQUIRE(registry.add("COUNT", CommandArg::INT, remember));
+    REQUIRE(registry.add("MODE", MODES, 3, remember));
+    REQUIRE(registry.add("RESET", CommandArg::NONE, remember));
+    REQUIRE(registry.add("LABEL", CommandArg::TEXT, remember));
+}
+
+Result send(Registry& registry, Panel& panel, const char* name, const char* value) {
+    unsigned long dispatchUs;
+    return registry.dispatch(panel, name, value, dispatchUs);
+}
+
+// Every value must be refused before the handler runs
+void checkRefused(Registry& registry, const char* name, const char* const* values, size_t count) {
+    Panel panel;
+    for (size_t i = 0; i < count; i++) {
+        if (send(registry, panel, name, values[i]) != Result::BAD_ARGUMENT) {
+            char text[96];
+            snprintf(text, sizeof(text), "%s accepted \"%s\"", name, values[i]);
+            TEST_FAIL_(text, false);
+        }
+    }
+    CHECK_EQ(panel.calls, 0u);
+}
+
+}
+
+TEST(float_arguments_decode_and_refuse_what_is_not_a_number) {
+    Registry registry;
+    fillRegistry(registry);
+    Panel panel;
+    CHECK(send(registry, panel, "LEVEL", "2.5") == Result::OK);
+    CHECK_EQ(panel.last.type, CommandArg::FLOAT);
+    CHECK_EQ(panel.last.floatValue, 2.5f);
+    CHECK(send(registry, panel, "LEVEL", "-1e3") == Result::OK);
+    CHECK_EQ(panel.last.floatValue, -1000.0f);
+    CHECK_EQ(panel.calls, 2u);
+
+    const char* const bad[] = { "", "abc", "2.5x", " ", "1e99", "-1e99", "1e-60", "inf", "nan" };
+    checkRefused(registry, "LEVEL", bad, sizeof(bad) / sizeof(bad[0]));
+    CHECK(send(registry, panel, "LEVEL", nullptr) == Result::BAD_ARGUMENT); // Missing value
+}
+
+TEST(int_arguments_decode_and_refuse_out_of_range) {
+    Registry registry;
+    fillRegistry(registry);
+    Panel panel;
+    CHECK(send(registry, panel, "COUNT", "42") == Result::OK);
+    CHECK_EQ(panel.last.intValue, 42);
+    CHECK(send(registry, panel, "COUNT", "-7") == Result::OK);
+    CHECK_EQ(panel.last.intValue, -7);
+
+    const char* const bad[] = { "", "4.2", "0x10", "12 ", "99999999999999999999", "-99999999999999999999" };
+    checkRefused(registry, "COUNT", bad, sizeof(bad) / sizeof(bad[0]));
+}
+
+TEST(enum_arguments_match_a_choice_exactly) {
+    Registry registry;
+    fillRegistry(registry);
+    Panel panel;
+    CHECK(send(registry, panel, "MODE", "OFF") == Result::OK);
+    CHECK_EQ(panel.last.enumValue, 0);
+    CHECK(send(registry, panel, "MODE", "AUTO") == Result::OK);
+    CHECK_EQ(panel.last.enumValue, 2);
+
+    const char* const bad[] = { "", "on", "ONN", "3", "AUTO " };
+    checkRefused(registry, "MODE", bad, sizeof(bad) / sizeof(bad[0]));
+}
+
+TEST(none_and_text_arguments_pass_the_value_through) {
+    Registry registry;
+    fillRegistry(registry);
+    Panel panel;
+    CHECK(send(registry, panel, "RESET", "ignored") == Result::OK);
+    CHECK_EQ(panel.last.type, CommandArg::NONE);
+    const char* label = "kitchen,window";
+    CHECK(send(registry, panel, "LABEL", label) == Result::OK);
+    CHECK(panel.last.text == label);
+    CHECK(send(registry, panel, "LABEL", nullptr) == Result::OK);
+    CHECK_STR(panel.last.text, "");
+}
+
+TEST(lookup_hits_every_entry_and_misses_unknown_names) {
+    Registry registry;
+    fillRegistry(registry);
+    const char* names[] = { "LEVEL", "COUNT", "MODE", "RESET", "LABEL" };
+    for (const char* name : names) {
+        char copy[16];
+        strlcpy(copy, name, sizeof(copy));
+        const char* found = registry.lookup(copy);
+        CHECK(found != nullptr && found != copy && strcmp(found, name) == 0); // The registered spelling
+    }
+
+    Panel panel;
+    const char* unknown[] = { "", "LEVE", "LEVELS", "level", "COUNT\n" };
+    for (const char* name : unknown) {
+        CHECK(registry.lookup(name) == nullptr);
+        CHECK(send(registry, panel, name, "1") == Result::UNKNOWN_COMMAND);
+    }
+    CHECK(send(registry, panel, nullptr, "1") == Result::UNKNOWN_COMMAND);
+    CHECK_EQ(registry.getUnknownCount(), 6u);
+    CHECK_EQ(panel.calls, 0u);
+}
+
+TEST(hash_collisions_are_told_apart_by_name) {
+    // "costarring" and "liquid" share an FNV-1a hash
+    static_assert(commandHash("costarring") == commandHash("liquid"), "known FNV-1a collision");
+    Registry registry;
+    REQUIRE(registry.add("costarring", CommandArg::NONE, remember));
+    CHECK(!registry.add("liquid", CommandArg::NONE, remember)); // Would make lookups ambiguous
+
+    Panel panel;
+    CHECK(send(registry, panel, "liquid", "") == Result::UNKNOWN_COMMAND); // Hash hit, name miss
+    CHECK(send(registry, panel, "costarring", "") == Result::OK);
+    CHECK_EQ(panel.calls, 1u);
+}
+
+TEST(table_refuses_duplicates_and_overflow) {
+    Registry registry;
+    fillRegistry(registry);
+    CHECK(!registry.add("LEVEL", CommandArg::INT, remember));
+    CHECK(!registry.add("NULL_HANDLER", CommandArg::NONE, nullptr));
+    CHECK(registry.add("SIX", CommandArg::NONE, remember));
+    CHECK(registry.add("SEVEN", CommandArg::NONE, remember));
+    CHECK(registry.add("EIGHT", CommandArg::NONE, remember));
+    CHECK_EQ(registry.size(), 8);
+    CHECK(!registry.add("NINE", CommandArg::NONE, remember));
+
+    // Still sorted: every entry is found after the inserts
+    Panel panel;
+    const char* names[] = { "LEVEL", "COUNT", "MODE", "RESET", "LABEL", "SIX", "SEVEN", "EIGHT" };
+    for (const char* name : names) {
+        CHECK(send(registry, panel, name, strcmp(name, "MODE") == 0 ? "ON" : "1") == Result::OK);
+    }
+    CHECK_EQ(panel.calls, 8u);
+
+    Serial.clearCapturedOutput();
+    registry.printStats(Serial);
+    CHECK_CONTAINS(Serial.capturedOutput(), "LEVEL: calls=1 errors=0");
+}
+
+namespace {
+
+struct Received {
+    uint32_t count = 0;
+    char command[32];
+    char value[32];
+};
+
+void capture(void* context, const EdgeCommunication::EdgeCommand& command) {
+    Received& received = *static_cast<Received*>(context);
+    received.count++;
+    strlcpy(received.command, command.command, sizeof(received.command));
+    strlcpy(received.value, command.value, sizeof(received.value));
+}
+
+}
+
+TEST(mqtt_payloads_reach_the_handler_only_when_well_formed) {
+    EdgeLink link;
+    Received received;
+    link.edge().setOnCommandCallback(capture, &received);
+    REQUIRE(link.waitOnline());
+    char topic[64];
+    snprintf(topic, sizeof(topic), "tavolo/%s/command", EdgeLink::DEVICE_ID);
+
+    Serial.clearCapturedOutput();
+    const char* malformed[] = { "{\"command\":\"TARE\"", "TARE", "", "{\"command\":\"TARE\",}" };
+    for (const char* payload : malformed) {
+        REQUIRE(link.broker().injectPublish(topic, payload));
+        link.runFor(100);
+    }
+    DeferredLog::drain(Serial);
+    CHECK_EQ(received.count, 0u);
+    CHECK_CONTAINS(Serial.capturedOutput(), "Failed to parse JSON command");
+
+    // Numbers are handed on as text for the registry to decode
+    REQUIRE(link.broker().injectPublish(topic, "{\"command\":\"SET_THRESHOLD\",\"value\":2.5}"));
+    link.runFor(100);
+    REQUIRE_EQ(received.count, 1u);
+    CHECK_STR(received.command, "SET_THRESHOLD");
+    CHECK_STR(received.value, "2.5");
+
+    // No command or value: empty strings, which the registry refuses as unknown
+    REQUIRE(link.broker().injectPublish(topic, "{\"value\":\"ON\"}"));
+    link.runFor(100);
+    REQUIRE_EQ(received.count, 2u);
+    CHECK_STR(received.command, "");
+    CHECK_STR(received.value, "ON");
+}
@@ -0,0 +1,126 @@
+// CoreChannel drop and high-water accounting; SeqLock readers retrying around a concurrent write
+#include "TestHarness.h"
+#include <CoreChannel.h>
+
+TEST(full_channel_drops_the_new_message_and_counts_it) {
+    CoreChannel<uint32_t, 8> channel;
+    for (uint32_t i = 0; i < 8; i++) {
+        CHECK(channel.send(i));
+    }
+    CHECK(!channel.send(100));
+    CHECK(!channel.send(101));
+    CHECK_EQ(channel.getSentCount(), 8u);
+    CHECK_EQ(channel.getDropCount(), 2u);
+    CHECK_EQ(channel.getHighWater(), 8u);
+    CHECK_EQ(channel.depth(), 8u);
+
+    // The queued messages are untouched, oldest first
+    uint32_t message;
+    for (uint32_t i = 0; i < 5; i++) {
+        REQUIRE(channel.receive(message));
+        CHECK_EQ(message, i);
+    }
+
+    // High water keeps the peak while the depth falls and rises again below it
+    CHECK(channel.send(102));
+    CHECK_EQ(channel.depth(), 4u);
+    CHECK_EQ(channel.getHighWater(), 8u);
+    CHECK_EQ(channel.getSentCount(), 9u);
+    while (channel.receive(message)) {}
+    CHECK(!channel.receive(message));
+    CHECK_EQ(message, 102u);
+
+    Serial.clearCapturedOutput();
+    channel.printStats(Serial, "Test channel");
+    CHECK_CONTAINS(Serial.capturedOutput(), "Test channel: depth 0/8, high 8, sent 9, dropped 2");
+}
+
+TEST(high_water_follows_the_deepest_backlog) {
+    CoreChannel<uint8_t, 4> channel;
+    uint8_t message;
+    for (uint8_t round = 0; round < 10; round++) {
+        CHECK(channel.send(round));
+        REQUIRE(channel.receive(message));
+    }
+    CHECK_EQ(channel.getHighWater(), 1u);
+    channel.send(1);
+    channel.send(2);
+    channel.send(3);
+    CHECK_EQ(channel.getHighWater(), 3u);
+    CHECK_EQ(channel.getDropCount(), 0u);
+}
+
+namespace {
+
+/**
+ * Counts and optionally interrupts assignments, so the test can let the "other core"
+ * write while a reader is half way through its copy. A consistent copy always has
+ * the same number in both halves.
+ */
+struct Pair {
+    uint32_t first = 0;
+    uint32_t second = 0;
+
+    static bool interruptNext;
+    static void (*interrupt)();
+    static uint32_t assignments;
+
+    Pair() = default;
+    Pair(uint32_t value) : first(value), second(value) {}
+
+    Pair& operator=(const Pair& other) {
+        assignments++;
+        first = other.first;
+        if (interruptNext) {
+            interruptNext = false;
+            interrupt();
+        }
+        second = other.second;
+        return *this;
+    }
+};
+
+bool Pair::interruptNext = false;
+void (*Pair::interrupt)() = nullptr;
+uint32_t Pair::assignments = 0;
+
+SeqLock<Pair> shared;
+
+}
+
+TEST(seqlock_readers_see_the_latest_write) {
+    uint32_t version = shared.getVersion();
+    shared.write(Pair(1));
+    CHECK_EQ(shared.getVersion(), version + 1);
+    Pair copy = shared.read();
+    CHECK_EQ(copy.first, 1u);
+    CHECK_EQ(copy.second, 1u);
+
+    shared.write(Pair(2));
+    shared.write(Pair(3));
+    CHECK_EQ(shared.getVersion(), version + 3);
+    copy = shared.read();
+    CHECK_EQ(copy.first, 3u);
+    CHECK_EQ(copy.second, 3u);
+}
+
+TEST(seqlock_reader_retries_when_a_write_lands_mid_copy) {
+    shared.write(Pair(4));
+    uint32_t version = shared.getVersion();
+
+    // The reader copies "first" from value 4, then the writer stores 5 before it copies "second"
+    Pair::interrupt = []() { shared.write(Pair(5)); };
+    Pair::interruptNext = true;
+    Pair::assignments = 0;
+    Pair copy = shared.read();
+    CHECK(!Pair::interruptNext);
+    CHECK_EQ(Pair::assignments, 3u); // Torn copy, the write, and the retry
+    CHECK_EQ(copy.first, 5u);
+    CHECK_EQ(copy.second, 5u);
+    CHECK_EQ(shared.getVersion(), version + 1);
+
+    // Undisturbed, one copy is enough
+    Pair::assignments = 0;
+    copy = shared.read();
+    CHECK_EQ(Pair::assignments, 2u); // The read's copy and the assignment to copy here
+}
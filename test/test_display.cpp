@@ -0,0 +1,119 @@
+// LCD output: what the framebuffer tracks against what the controller model shows
+#include "TestHarness.h"
+#include "Simulation.h"
+#include <DisplayManager.h>
+#include <LcdFrameBuffer.h>
+
+namespace {
+
+const uint8_t TEST_LCD_ADDRESS = 0x26; // Apart from the one Simulation wires
+
+uint32_t lcg(uint32_t& state) {
+    state = state * 1664525u + 1013904223u;
+    return state >> 8;
+}
+
+// Every cell the framebuffer wants is on the glass, and its own glass copy agrees
+bool glassMatches(const LcdFrameBuffer& buffer, const LiquidCrystal_I2C& lcd) {
+    for (uint8_t row = 0; row < buffer.getRows(); row++) {
+        for (uint8_t col = 0; col < buffer.getCols(); col++) {
+            if (lcd.glassAt(col, row) != buffer.frameAt(col, row)) return false;
+            if (buffer.glassAt(col, row) != buffer.frameAt(col, row)) return false;
+        }
+    }
+    return true;
+}
+
+}
+
+TEST(partial_flushes_leave_the_glass_equal_to_the_frame) {
+    LiquidCrystal_I2C lcd(TEST_LCD_ADDRESS, 20, 4);
+    lcd.init();
+    lcd.clear();
+    LcdFrameBuffer buffer(20, 4);
+    buffer.markCleared();
+
+    // Random single-cell and whole-line edits, including runs that end on the last column,
+    // where the controller's address counter would carry on into another row
+    uint32_t state = 12345;
+    char line[LcdFrameBuffer::MAX_COLS + 1];
+    for (int round = 0; round < 500; round++) {
+        uint8_t row = lcg(state) % 4;
+        if (lcg(state) % 3 == 0) {
+            uint8_t length = lcg(state) % 21;
+            for (uint8_t i = 0; i < length; i++) line[i] = 'A' + lcg(state) % 26;
+            line[length] = '\0';
+            buffer.setLine(row, line);
+        } else {
+            // Rewrite the row with one to three cells changed
+            for (uint8_t col = 0; col < 20; col++) line[col] = buffer.frameAt(col, row);
+            line[20] = '\0';
+            for (uint8_t n = lcg(state) % 3 + 1; n > 0; n--) line[lcg(state) % 20] = '0' + lcg(state) % 10;
+            buffer.setLine(row, line);
+        }
+        buffer.flush(lcd);
+        if (!glassMatches(buffer, lcd)) {
+            char message[64];
+            snprintf(message, sizeof(message), "glass differs from the frame after round %d", round);
+            TEST_FAIL_(message, true);
+        }
+        CHECK(!buffer.isDirty());
+    }
+}
+
+TEST(unchanged_frame_sends_nothing_and_invalidate_rewrites_everything) {
+    LiquidCrystal_I2C lcd(TEST_LCD_ADDRESS, 20, 4);
+    lcd.init();
+    lcd.clear();
+    LcdFrameBuffer buffer(20, 4);
+    buffer.markCleared();
+
+    buffer.setLine(1, "12.5 g");
+    CHECK_GT(buffer.flush(lcd), 0u);
+    CHECK_EQ(buffer.flush(lcd), 0u);
+
+    // Something else scribbled on the panel behind the buffer's back
+    lcd.setCursor(0, 1);
+    lcd.print("XXXX");
+    CHECK(!glassMatches(buffer, lcd));
+    buffer.invalidate();
+    CHECK_EQ(buffer.flush(lcd), 4u * 21u); // One setCursor and 20 characters per row
+    CHECK(glassMatches(buffer, lcd));
+}
+
+TEST(display_manager_keeps_the_glass_in_step_across_modes) {
+    VirtualClock::reset();
+    DisplayManager display(TEST_LCD_ADDRESS, 20, 4);
+    display.begin();
+    LiquidCrystal_I2C& lcd = *LiquidCrystal_I2C::atAddress(TEST_LCD_ADDRESS);
+
+    display.showBootScreen("TAVOLO_TEST");
+    CHECK(glassMatches(display.getFrameBuffer(), lcd));
+
+    float weight = 0.0f;
+    for (int i = 0; i < 200; i++) {
+        if (i == 50) display.showStatusMessage("Tare Complete", 1000);
+        if (i == 120) display.showErrorMessage("Sensor fault", 500);
+        weight += i < 100 ? 7.3f : -3.1f;
+        display.showWeightData(weight, weight > 300.0f ? "OVER LIMIT" : "NORMAL");
+        display.update();
+        delay(50);
+        if (!glassMatches(display.getFrameBuffer(), lcd)) {
+            char message[64];
+            snprintf(message, sizeof(message), "glass differs from the frame at step %d", i);
+            TEST_FAIL_(message, true);
+        }
+    }
+
+    char row[LiquidCrystal_I2C::MAX_COLS + 1];
+    lcd.readRow(0, row);
+    CHECK_CONTAINS(row, "TAVOLO WEIGHT");
+    VirtualClock::reset();
+}
+
+TEST(boot_screen_is_on_the_glass_before_the_first_loop) {
+    Simulation sim; // Runs setup(), no loop() yet
+    CHECK(sim.lcdShows("TAVOLO SYSTEM v1.0"));
+    CHECK(sim.lcdShows(sim.system().getDeviceId().c_str()));
+    CHECK(sim.lcdShows("Initializing..."));
+}
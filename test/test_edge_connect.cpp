@@ -0,0 +1,147 @@
+// MQTT handshake against a misbehaving broker: CONNACK checks and the update() budget
+#include "TestHarness.h"
+#include "EdgeLink.h"
+#include <DeferredLog.h>
+#include <time.h>
+
+typedef EdgeCommunication::ConnectPhase Phase;
+
+namespace {
+
+const unsigned long BUDGET_US = 20000;
+
+uint64_t wallMicros() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000ULL + ts.tv_nsec / 1000;
+}
+
+// EdgeLink::runFor(), also timing each update() on the wall clock. A blocking wait shows up
+// in virtual time (it would call delay()), a slow socket call only in wall time.
+uint64_t runTimed(EdgeLink& link, uint32_t ms) {
+    uint64_t worst = 0;
+    uint64_t end = VirtualClock::now() + (uint64_t)ms * 1000;
+    while (VirtualClock::now() < end) {
+        link.broker().poll();
+        uint64_t start = wallMicros();
+        link.edge().update();
+        uint64_t elapsed = wallMicros() - start;
+        if (elapsed > worst) worst = elapsed;
+        DeferredLog::drain(Serial);
+        delay(10);
+    }
+    return worst;
+}
+
+bool logged(const char* text) {
+    return strstr(Serial.capturedOutput(), text) != nullptr;
+}
+
+void checkWithinBudget(EdgeLink& link, uint64_t worstWallUs) {
+    CHECK_LE(link.edge().getMaxUpdateTime(), BUDGET_US);
+    CHECK_EQ(link.edge().getBudgetOverruns(), 0u);
+    CHECK_LT(worstWallUs, BUDGET_US);
+}
+
+}
+
+TEST(refused_connack_fails_the_attempt_within_budget) {
+    EdgeLink link;
+    Serial.clearCapturedOutput();
+    link.edge().setUpdateBudget(BUDGET_US);
+    link.broker().setConnAck(FakeBroker::ConnAckMode::REFUSE, 5); // Not authorized
+
+    uint64_t worst = runTimed(link, 5000);
+    CHECK_GE(link.broker().getConnectCount(), 2u); // Retried after backoff
+    CHECK(!link.edge().isConnected());
+    CHECK_EQ(link.broker().getSubscriptionCount(), 0);
+    CHECK(logged("Return code: 5"));
+    checkWithinBudget(link, worst);
+}
+
+TEST(malformed_connack_is_rejected_instead_of_read) {
+    EdgeLink link;
+    Serial.clearCapturedOutput();
+    link.edge().setUpdateBudget(BUDGET_US);
+    // Remaining length 127: handed to PubSubClient it would wait its socket timeout for the rest
+    link.broker().setConnAck(FakeBroker::ConnAckMode::MALFORMED);
+
+    uint64_t worst = runTimed(link, 5000);
+    CHECK_GE(link.broker().getConnectCount(), 2u);
+    CHECK(!link.edge().isConnected());
+    CHECK(logged("Malformed CONNACK"));
+    checkWithinBudget(link, worst);
+}
+
+TEST(silent_broker_times_out_within_budget) {
+    EdgeLink link;
+    Serial.clearCapturedOutput();
+    link.edge().setUpdateBudget(BUDGET_US);
+    link.broker().setConnAck(FakeBroker::ConnAckMode::SILENT);
+
+    uint64_t worst = runTimed(link, 8000);
+    CHECK_EQ(link.broker().getConnectCount(), 2u); // 5 s CONNACK timeout, then a short backoff
+    CHECK(logged("CONNACK timeout"));
+    checkWithinBudget(link, worst);
+
+    // The broker wakes up and the next attempt goes through
+    link.broker().setConnAck(FakeBroker::ConnAckMode::ACCEPT);
+    REQUIRE(link.waitOnline(10000));
+    CHECK(link.edge().getConnectPhase() == Phase::ONLINE);
+}
+
+TEST(online_session_publishes_within_budget) {
+    EdgeLink link;
+    Serial.clearCapturedOutput();
+    link.edge().setUpdateBudget(BUDGET_US);
+    REQUIRE(link.waitOnline());
+
+    EdgeCommunication::WeightData data;
+    for (int i = 0; i < 200; i++) {
+        data.weight = 10.0f + i;
+        data.timestamp = millis();
+        link.edge().queueWeightData(data);
+        runTimed(link, 50);
+    }
+    uint64_t worst = runTimed(link, 60000); // Heartbeats and keep-alives
+    CHECK_GE(link.broker().countOn("/weight"), 1u);
+    CHECK_GE(link.broker().getPingCount(), 1u);
+    CHECK_EQ(link.broker().getConnectCount(), 1u);
+    checkWithinBudget(link, worst);
+}
+
+TEST(device_id_too_long_for_the_topics_is_never_used) {
+    // 46 characters is the most that fits "tavolo/<id>/flightlog" in 63
+    const char* longest = "TAVOLO_012345678901234567890123456789012345678";
+    FlightRecorder::begin(); // Something to upload
+    {
+        EdgeLink link(longest);
+        REQUIRE(link.waitOnline());
+        REQUIRE(link.edge().sendFlightLog());
+        link.runFor(100);
+        REQUIRE_EQ(link.broker().countOn("/flightlog"), 1u);
+        const FakeBroker::Message& message = link.broker().logEntry(link.broker().logSize() - 1);
+        CHECK_STR(message.topic, "tavolo/TAVOLO_012345678901234567890123456789012345678/flightlog");
+    }
+
+    EdgeLink link("TAVOLO_0123456789012345678901234567890123456789");
+    Serial.clearCapturedOutput();
+    runTimed(link, 5000);
+    CHECK(!link.edge().isConnected());
+    CHECK_EQ(link.broker().getSubscriptionCount(), 0);
+    CHECK(!link.edge().sendStatusUpdate("online"));
+    CHECK_EQ(link.broker().logSize(), 0u);
+    CHECK(logged("too long for MQTT topics"));
+}
+
+TEST(aborted_lookup_never_completes_a_later_attempt) {
+    MqttTransport transport;
+    REQUIRE(transport.beginResolve("127.0.0.1"));
+    CHECK(transport.pollResolve() == MqttTransport::Progress::DONE);
+
+    // The answer belonged to the aborted attempt; only a new lookup completes again
+    transport.abort();
+    CHECK(transport.pollResolve() == MqttTransport::Progress::PENDING);
+    REQUIRE(transport.beginResolve("127.0.0.2"));
+    CHECK(transport.pollResolve() == MqttTransport::Progress::DONE);
+}
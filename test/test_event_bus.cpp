@@ -0,0 +1,200 @@
+// EventBus: decimation, minimum intervals, queue overflow, subscriber limit, non-reentrant dispatch
+#include "TestHarness.h"
+#include <EventBus.h>
+#include "VirtualClock.h"
+
+namespace {
+
+struct Inbox {
+    uint32_t count = 0;
+    uint8_t codes[64];
+    unsigned long times[64];
+};
+
+void collect(void* context, const EventBus::Event& event) {
+    Inbox& inbox = *static_cast<Inbox*>(context);
+    if (inbox.count < 64) {
+        inbox.codes[inbox.count] = event.code;
+        inbox.times[inbox.count] = event.timestamp;
+    }
+    inbox.count++;
+}
+
+// Publishes and dispatches one sample per period, on the virtual clock
+void feed(EventBus& bus, uint8_t count, unsigned long periodMs) {
+    for (uint8_t i = 0; i < count; i++) {
+        bus.publish(EventBus::WEIGHT_SAMPLE, i, i * 10.0f);
+        bus.dispatch();
+        delay(periodMs);
+    }
+}
+
+}
+
+TEST(decimation_delivers_every_nth_event_per_subscriber) {
+    VirtualClock::reset();
+    EventBus bus;
+    Inbox all;
+    Inbox third;
+    REQUIRE(bus.subscribe("all", EventBus::WEIGHT_SAMPLE, collect, &all) != EventBus::INVALID_SUBSCRIBER);
+    EventBus::SubscriberId id = bus.subscribe("third", EventBus::WEIGHT_SAMPLE, collect, &third, 3);
+    REQUIRE(id != EventBus::INVALID_SUBSCRIBER);
+
+    feed(bus, 10, 10);
+    CHECK_EQ(all.count, 10u);
+    REQUIRE_EQ(third.count, 4u);
+    CHECK_EQ(third.codes[0], 0);
+    CHECK_EQ(third.codes[1], 3);
+    CHECK_EQ(third.codes[2], 6);
+    CHECK_EQ(third.codes[3], 9);
+
+    // A new rate starts over: the next event is delivered
+    bus.setRate(id, 2, 0);
+    feed(bus, 4, 10);
+    CHECK_EQ(third.count, 6u);
+    CHECK_EQ(third.codes[4], 0);
+    CHECK_EQ(third.codes[5], 2);
+
+    Serial.clearCapturedOutput();
+    bus.printStats(Serial);
+    CHECK_CONTAINS(Serial.capturedOutput(), "all <- WEIGHT_SAMPLE: delivered 14, skipped 0");
+    CHECK_CONTAINS(Serial.capturedOutput(), "third <- WEIGHT_SAMPLE: delivered 6, skipped 8");
+}
+
+TEST(min_interval_throttles_by_event_time) {
+    VirtualClock::reset();
+    EventBus bus;
+    Inbox slow;
+    EventBus::SubscriberId id = bus.subscribe("slow", EventBus::WEIGHT_SAMPLE, collect, &slow, 1, 100);
+    REQUIRE(id != EventBus::INVALID_SUBSCRIBER);
+
+    // Every 30 ms: delivered at 0, 120 and 240 ms
+    feed(bus, 10, 30);
+    REQUIRE_EQ(slow.count, 3u);
+    CHECK_EQ(slow.times[0], 0u);
+    CHECK_EQ(slow.times[1], 120u);
+    CHECK_EQ(slow.times[2], 240u);
+
+    // Exactly the interval apart is enough
+    Inbox edge;
+    bus.subscribe("edge", EventBus::THRESHOLD, collect, &edge, 1, 50);
+    bus.publish(EventBus::THRESHOLD, 1);
+    delay(49);
+    bus.publish(EventBus::THRESHOLD, 0);
+    delay(1);
+    bus.publish(EventBus::THRESHOLD, 1);
+    bus.dispatch();
+    CHECK_EQ(edge.count, 2u);
+
+    // Decimation counts first; an event the interval refuses does not restart the count,
+    // so after each delivery the next candidate is the first one at least 100 ms later
+    bus.setRate(id, 2, 100);
+    uint32_t before = slow.count;
+    feed(bus, 10, 30);
+    CHECK_EQ(slow.count - before, 3u); // Samples 0, 4 and 8
+}
+
+TEST(full_queue_drops_and_keeps_the_order) {
+    VirtualClock::reset();
+    EventBus bus;
+    Inbox inbox;
+    CHECK(!bus.publish(EventBus::COMMAND, 1)); // Nobody listens: discarded, not dropped
+    CHECK_EQ(bus.getDroppedCount(), 0u);
+
+    REQUIRE(bus.subscribe("inbox", EventBus::WEIGHT_SAMPLE, collect, &inbox) != EventBus::INVALID_SUBSCRIBER);
+    for (size_t i = 0; i < EventBus::QUEUE_CAPACITY; i++) {
+        CHECK(bus.publish(EventBus::WEIGHT_SAMPLE, (uint8_t)i));
+    }
+    CHECK(!bus.publish(EventBus::WEIGHT_SAMPLE, 99));
+    CHECK(!bus.publish(EventBus::WEIGHT_SAMPLE, 99));
+    CHECK_EQ(bus.getPublishedCount(), EventBus::QUEUE_CAPACITY);
+    CHECK_EQ(bus.getDroppedCount(), 2u);
+
+    Serial.clearCapturedOutput();
+    bus.printStats(Serial);
+    CHECK_CONTAINS(Serial.capturedOutput(), "depth 32/32, high 32, published 32, dropped 2");
+
+    CHECK_EQ(bus.dispatch(), EventBus::QUEUE_CAPACITY);
+    REQUIRE_EQ(inbox.count, EventBus::QUEUE_CAPACITY);
+    for (uint8_t i = 0; i < EventBus::QUEUE_CAPACITY; i++) {
+        CHECK_EQ(inbox.codes[i], i);
+    }
+    CHECK(bus.publish(EventBus::WEIGHT_SAMPLE, 100)); // Room again
+}
+
+TEST(subscriber_table_is_bounded) {
+    EventBus bus;
+    Inbox inbox;
+    CHECK(bus.subscribe("bad", EventBus::TOPIC_COUNT, collect, &inbox) == EventBus::INVALID_SUBSCRIBER);
+    CHECK(bus.subscribe("bad", EventBus::LOAD_EVENT, nullptr) == EventBus::INVALID_SUBSCRIBER);
+    CHECK(!bus.hasSubscribers(EventBus::LOAD_EVENT));
+
+    for (uint8_t i = 0; i < EventBus::MAX_SUBSCRIBERS; i++) {
+        CHECK_EQ(bus.subscribe("load", EventBus::LOAD_EVENT, collect, &inbox), (EventBus::SubscriberId)i);
+    }
+    CHECK(bus.subscribe("extra", EventBus::LOAD_EVENT, collect, &inbox) == EventBus::INVALID_SUBSCRIBER);
+    CHECK(bus.subscribe("extra", EventBus::THRESHOLD, collect, &inbox) == EventBus::INVALID_SUBSCRIBER);
+    CHECK(!bus.hasSubscribers(EventBus::THRESHOLD));
+
+    bus.publish(EventBus::LOAD_EVENT, 1);
+    bus.dispatch();
+    CHECK_EQ(inbox.count, EventBus::MAX_SUBSCRIBERS);
+}
+
+namespace {
+
+struct Relay {
+    EventBus* bus;
+    Inbox inbox;
+    size_t nestedDispatch = 99;
+};
+
+// Forwards every weight sample as a threshold event and tries to deliver it at once
+void relay(void* context, const EventBus::Event& event) {
+    Relay& self = *static_cast<Relay*>(context);
+    collect(&self.inbox, event);
+    self.bus->publish(EventBus::THRESHOLD, (uint8_t)(100 + event.code));
+    self.nestedDispatch = self.bus->dispatch();
+}
+
+}
+
+TEST(events_published_by_handlers_wait_their_turn) {
+    VirtualClock::reset();
+    EventBus bus;
+    Relay self;
+    self.bus = &bus;
+    REQUIRE(bus.subscribe("relay", EventBus::WEIGHT_SAMPLE, relay, &self) != EventBus::INVALID_SUBSCRIBER);
+    REQUIRE(bus.subscribe("sink", EventBus::THRESHOLD, collect, &self.inbox) != EventBus::INVALID_SUBSCRIBER);
+
+    bus.publish(EventBus::WEIGHT_SAMPLE, 1);
+    bus.publish(EventBus::WEIGHT_SAMPLE, 2);
+    CHECK_EQ(bus.dispatch(), 4u);
+    CHECK_EQ(self.nestedDispatch, 0u);
+
+    // Both samples first, then the events their handlers published, in publish order
+    REQUIRE_EQ(self.inbox.count, 4u);
+    CHECK_EQ(self.inbox.codes[0], 1);
+    CHECK_EQ(self.inbox.codes[1], 2);
+    CHECK_EQ(self.inbox.codes[2], 101);
+    CHECK_EQ(self.inbox.codes[3], 102);
+}
+
+TEST(attached_bus_dispatches_from_the_scheduler) {
+    VirtualClock::reset();
+    EventBus bus;
+    Inbox inbox;
+    bus.subscribe("inbox", EventBus::SYSTEM_STATE, collect, &inbox);
+    bus.publish(EventBus::SYSTEM_STATE, 1); // Before attach()
+
+    Scheduler scheduler;
+    bus.attach(scheduler);
+    scheduler.runDue();
+    CHECK_EQ(inbox.count, 1u);
+
+    bus.publish(EventBus::SYSTEM_STATE, 2);
+    CHECK_EQ(inbox.count, 1u); // Nothing is delivered inside publish()
+    scheduler.runDue();
+    REQUIRE_EQ(inbox.count, 2u);
+    CHECK_EQ(inbox.codes[1], 2);
+}
@@ -0,0 +1,188 @@
+// FlightRecorder and FlightLog: record layout, ring wrap, retention across a reset, chunk codec
+#include "TestHarness.h"
+#include <FlightRecorder.h>
+#include <FlightLog.h>
+#include "VirtualClock.h"
+
+namespace {
+
+const uint8_t KINDS[] = {
+    FlightLog::BOOT, FlightLog::STATE_CHANGE, FlightLog::CONNECTION_STATE, FlightLog::PUBLISH,
+    FlightLog::COMMAND, FlightLog::SAMPLE_OVERRUN, FlightLog::SAMPLE_MISSED,
+};
+const size_t KIND_COUNT = sizeof(KINDS) / sizeof(KINDS[0]);
+
+// A fresh ring with the clock at zero; begin() the first time, so records are accepted
+void freshRing() {
+    VirtualClock::reset();
+    Serial.setEcho(false);
+    FlightRecorder::begin();
+    FlightRecorder::clear();
+}
+
+bool sameRecord(const FlightLog::Record& a, const FlightLog::Record& b) {
+    return a.timestamp == b.timestamp && a.type == b.type && a.a == b.a && a.b == b.b;
+}
+
+}
+
+TEST(records_keep_their_fields_in_order) {
+    freshRing();
+    for (size_t i = 0; i < KIND_COUNT; i++) {
+        delay(10);
+        FlightRecorder::record(KINDS[i], (uint8_t)(0xF0 + i), (uint16_t)(0xAB00 + i));
+    }
+    CHECK_EQ(FlightRecorder::getSequence(), KIND_COUNT);
+    CHECK_EQ(FlightRecorder::getOldestSequence(), 0u);
+
+    uint32_t sequence = 0;
+    FlightLog::Record records[KIND_COUNT + 1];
+    REQUIRE_EQ(FlightRecorder::read(sequence, records, KIND_COUNT + 1), KIND_COUNT);
+    CHECK_EQ(sequence, 0u);
+    for (size_t i = 0; i < KIND_COUNT; i++) {
+        CHECK_EQ(records[i].timestamp, 10 * (i + 1));
+        CHECK_EQ(records[i].type, KINDS[i]);
+        CHECK_EQ(records[i].a, 0xF0 + i);
+        CHECK_EQ(records[i].b, 0xAB00 + i);
+    }
+
+    // Reading from the middle, and past the end
+    sequence = 5;
+    CHECK_EQ(FlightRecorder::read(sequence, records, KIND_COUNT), KIND_COUNT - 5);
+    CHECK_EQ(records[0].type, KINDS[5]);
+    sequence = KIND_COUNT;
+    CHECK_EQ(FlightRecorder::read(sequence, records, 1), 0u);
+}
+
+TEST(full_ring_overwrites_the_oldest_record) {
+    freshRing();
+    const uint32_t written = FlightRecorder::CAPACITY + 44;
+    for (uint32_t i = 0; i < written; i++) {
+        FlightRecorder::record(FlightLog::PUBLISH, 1, (uint16_t)i);
+    }
+    CHECK_EQ(FlightRecorder::getSequence(), written);
+    CHECK_EQ(FlightRecorder::getOldestSequence(), 44u);
+
+    // A reader still at sequence 0 is moved past what was overwritten
+    uint32_t sequence = 0;
+    FlightLog::Record records[FlightRecorder::CAPACITY];
+    REQUIRE_EQ(FlightRecorder::read(sequence, records, FlightRecorder::CAPACITY), FlightRecorder::CAPACITY);
+    CHECK_EQ(sequence, 44u);
+    CHECK_EQ(records[0].b, 44u);
+    CHECK_EQ(records[FlightRecorder::CAPACITY - 1].b, written - 1);
+
+    // Exactly full: nothing lost yet
+    freshRing();
+    for (uint32_t i = 0; i < FlightRecorder::CAPACITY; i++) {
+        FlightRecorder::record(FlightLog::PUBLISH, 1, (uint16_t)i);
+    }
+    CHECK_EQ(FlightRecorder::getOldestSequence(), 0u);
+    FlightRecorder::record(FlightLog::PUBLISH, 1, 0xFFFF);
+    CHECK_EQ(FlightRecorder::getOldestSequence(), 1u);
+    sequence = 0;
+    REQUIRE_EQ(FlightRecorder::read(sequence, records, 1), 1u);
+    CHECK_EQ(records[0].b, 1u);
+}
+
+TEST(records_survive_a_reset) {
+    freshRing();
+    uint16_t boots = FlightRecorder::getBootCount();
+    FlightRecorder::record(FlightLog::STATE_CHANGE, 1, 3);
+    FlightRecorder::record(FlightLog::COMMAND, 0, 0x1234);
+
+    // A watchdog or software reset: begin() runs again over the retained ring
+    VirtualClock::reset();
+    FlightRecorder::begin();
+    CHECK_EQ(FlightRecorder::getBootCount(), boots + 1);
+    REQUIRE_EQ(FlightRecorder::getSequence(), 3u);
+
+    uint32_t sequence = 0;
+    FlightLog::Record records[3];
+    REQUIRE_EQ(FlightRecorder::read(sequence, records, 3), 3u);
+    CHECK_EQ(records[0].type, FlightLog::STATE_CHANGE);
+    CHECK_EQ(records[1].type, FlightLog::COMMAND);
+    CHECK_EQ(records[1].b, 0x1234u);
+    CHECK_EQ(records[2].type, FlightLog::BOOT);
+    CHECK_EQ(records[2].b, boots + 1u);
+
+    Serial.clearCapturedOutput();
+    FlightRecorder::print(Serial, 2);
+    CHECK_CONTAINS(Serial.capturedOutput(), "1: ");
+    CHECK_CONTAINS(Serial.capturedOutput(), "COMMAND a=0 b=4660");
+    CHECK_CONTAINS(Serial.capturedOutput(), "BOOT");
+}
+
+TEST(chunks_round_trip_every_record_kind) {
+    FlightLog::Record records[KIND_COUNT * 2];
+    for (size_t i = 0; i < KIND_COUNT * 2; i++) {
+        records[i].timestamp = 0xFFFFFFF0u + (uint32_t)i * 3; // Crosses the millis() wrap
+        records[i].type = KINDS[i % KIND_COUNT];
+        records[i].a = (uint8_t)(i * 37);
+        records[i].b = (uint16_t)(0xFFFF - i * 1000);
+    }
+    FlightLog::ChunkHeader header;
+    header.version = FlightLog::VERSION;
+    header.count = KIND_COUNT * 2;
+    header.bootCount = 0xBEEF;
+    header.firstSequence = 0x01020304;
+
+    uint8_t buffer[FlightLog::CHUNK_HEADER_SIZE + KIND_COUNT * 2 * FlightLog::RECORD_SIZE];
+    size_t length = FlightLog::encodeChunk(buffer, sizeof(buffer), header, records);
+    REQUIRE_EQ(length, sizeof(buffer));
+    const uint8_t expectedHeader[] = { 'F', 'L', FlightLog::VERSION, KIND_COUNT * 2, 0xEF, 0xBE, 4, 3, 2, 1 };
+    CHECK(memcmp(buffer, expectedHeader, sizeof(expectedHeader)) == 0);
+    const uint8_t expectedRecord[] = { 0xF0, 0xFF, 0xFF, 0xFF, FlightLog::BOOT, 0, 0xFF, 0xFF };
+    CHECK(memcmp(buffer + FlightLog::CHUNK_HEADER_SIZE, expectedRecord, sizeof(expectedRecord)) == 0);
+
+    FlightLog::ChunkHeader decodedHeader;
+    FlightLog::Record decoded[KIND_COUNT * 2];
+    REQUIRE(FlightLog::decodeChunk(buffer, length, decodedHeader, decoded, KIND_COUNT * 2));
+    CHECK_EQ(decodedHeader.version, FlightLog::VERSION);
+    CHECK_EQ(decodedHeader.count, KIND_COUNT * 2);
+    CHECK_EQ(decodedHeader.bootCount, 0xBEEFu);
+    CHECK_EQ(decodedHeader.firstSequence, 0x01020304u);
+    for (size_t i = 0; i < KIND_COUNT * 2; i++) {
+        CHECK(sameRecord(decoded[i], records[i]));
+        CHECK(strcmp(FlightLog::typeToString(decoded[i].type), "UNKNOWN") != 0);
+    }
+
+    // An empty chunk is the header alone
+    header.count = 0;
+    CHECK_EQ(FlightLog::encodeChunk(buffer, sizeof(buffer), header, records), FlightLog::CHUNK_HEADER_SIZE);
+    CHECK(FlightLog::decodeChunk(buffer, FlightLog::CHUNK_HEADER_SIZE, decodedHeader, decoded, 0));
+    CHECK_EQ(decodedHeader.count, 0u);
+}
+
+TEST(bad_chunks_are_refused) {
+    FlightLog::Record records[4] = {};
+    FlightLog::ChunkHeader header;
+    header.version = FlightLog::VERSION;
+    header.count = 4;
+    header.bootCount = 1;
+    header.firstSequence = 0;
+    uint8_t buffer[FlightLog::CHUNK_HEADER_SIZE + 4 * FlightLog::RECORD_SIZE];
+    CHECK_EQ(FlightLog::encodeChunk(buffer, sizeof(buffer) - 1, header, records), 0u);
+    size_t length = FlightLog::encodeChunk(buffer, sizeof(buffer), header, records);
+    REQUIRE_EQ(length, sizeof(buffer));
+
+    FlightLog::ChunkHeader decodedHeader;
+    FlightLog::Record decoded[4];
+    CHECK(!FlightLog::decodeChunk(buffer, length - 1, decodedHeader, decoded, 4));     // Truncated
+    CHECK(!FlightLog::decodeChunk(buffer, FlightLog::CHUNK_HEADER_SIZE - 1, decodedHeader, decoded, 4));
+    CHECK(!FlightLog::decodeChunk(buffer, length, decodedHeader, decoded, 3));         // No room
+    buffer[2] = FlightLog::VERSION + 1;
+    CHECK(!FlightLog::decodeChunk(buffer, length, decodedHeader, decoded, 4));
+    buffer[2] = FlightLog::VERSION;
+    buffer[0] = 'T';
+    CHECK(!FlightLog::decodeChunk(buffer, length, decodedHeader, decoded, 4));
+}
+
+TEST(describe_names_the_record) {
+    FlightLog::Record record = { 12345, FlightLog::STATE_CHANGE, 2, 3 };
+    char line[48];
+    CHECK_EQ(FlightLog::describe(record, line, sizeof(line)), (int)strlen("12345 STATE_CHANGE a=2 b=3"));
+    CHECK_STR(line, "12345 STATE_CHANGE a=2 b=3");
+    record.type = 200;
+    FlightLog::describe(record, line, sizeof(line));
+    CHECK_STR(line, "12345 UNKNOWN a=2 b=3");
+}
@@ -0,0 +1,113 @@
+// LatencyHistogram: bucket placement, percentiles, the probe, and the build with profiling off
+#define TAVOLO_PROFILING 0 // This file is the disabled build; the histogram itself is always compiled
+#include "TestHarness.h"
+#include <LatencyHistogram.h>
+#include "VirtualClock.h"
+
+TEST(durations_land_in_their_log2_bucket) {
+    LatencyHistogram histogram;
+    const uint32_t durations[] = { 0, 1, 2, 3, 4, 7, 8, 1023, 1024, 32767, 32768, 40000, 0xFFFFFFFFu };
+    const uint8_t expected[]   = { 0, 0, 1, 1, 2, 2, 3, 9,    10,   14,    15,    15,    15 };
+    for (uint32_t us : durations) {
+        histogram.record(us);
+    }
+
+    uint32_t counts[LatencyHistogram::BUCKET_COUNT] = {};
+    for (uint8_t bucket : expected) {
+        counts[bucket]++;
+    }
+    for (uint8_t i = 0; i < LatencyHistogram::BUCKET_COUNT; i++) {
+        CHECK_EQ(histogram.getBucket(i), counts[i]);
+    }
+    CHECK_EQ(histogram.getBucket(LatencyHistogram::BUCKET_COUNT), 0u);
+    CHECK_EQ(histogram.getCount(), sizeof(durations) / sizeof(durations[0]));
+    CHECK_EQ(histogram.getMax(), 0xFFFFFFFFu);
+}
+
+TEST(percentiles_report_the_bucket_bound_capped_at_the_maximum) {
+    LatencyHistogram histogram;
+    CHECK_EQ(histogram.percentile(50), 0u);
+    CHECK_EQ(histogram.getMean(), 0u);
+
+    // 98 runs of 100 us and two of 5 ms
+    for (uint8_t i = 0; i < 98; i++) histogram.record(100);
+    histogram.record(5000);
+    histogram.record(5000);
+    CHECK_EQ(histogram.percentile(50), 128u);  // [64, 128)
+    CHECK_EQ(histogram.percentile(98), 128u);
+    CHECK_EQ(histogram.percentile(99), 5000u); // [4096, 8192), but nothing above 5000 was seen
+    CHECK_EQ(histogram.percentile(100), 5000u);
+    CHECK_EQ(histogram.getMean(), 198u);
+
+    // One slow run in a thousand stays out of p99
+    histogram.reset();
+    CHECK_EQ(histogram.getCount(), 0u);
+    for (uint16_t i = 0; i < 999; i++) histogram.record(10);
+    histogram.record(20000);
+    CHECK_EQ(histogram.percentile(50), 16u);
+    CHECK_EQ(histogram.percentile(99), 16u);
+    CHECK_EQ(histogram.getMax(), 20000u);
+
+    // Everything in the open-ended last bucket
+    histogram.reset();
+    histogram.record(50000);
+    histogram.record(70000);
+    CHECK_EQ(histogram.percentile(50), 70000u);
+}
+
+TEST(print_lists_percentiles_and_non_empty_buckets) {
+    LatencyHistogram histogram;
+    for (uint8_t i = 0; i < 98; i++) histogram.record(100);
+    histogram.record(5000);
+    histogram.record(40000);
+
+    Serial.clearCapturedOutput();
+    histogram.print(Serial, "sensor");
+    CHECK_CONTAINS(Serial.capturedOutput(), "sensor: n=100 mean=548us p50<=128us p99<=8192us max=40000us");
+    CHECK_CONTAINS(Serial.capturedOutput(), "<128:98 <8192:1 >=32768:1");
+}
+
+TEST(probe_times_its_scope) {
+    VirtualClock::reset();
+    LatencyHistogram histogram;
+    {
+        LatencyProbe probe(histogram);
+        delayMicroseconds(300);
+    }
+    REQUIRE_EQ(histogram.getCount(), 1u);
+    CHECK_EQ(histogram.getMax(), 300u);
+    CHECK_EQ(histogram.getBucket(8), 1u);
+}
+
+namespace {
+
+// The pattern instrumented components follow: the histogram only exists when profiling is on
+struct Instrumented {
+    uint32_t runs = 0;
+#if TAVOLO_PROFILING
+    LatencyHistogram latency;
+#endif
+
+    void run() {
+        TAVOLO_PROFILE_SCOPE(latency); // Names a member that does not exist in this build
+        runs++;
+    }
+};
+
+}
+
+TEST(disabled_profiling_adds_no_probe_or_storage) {
+    static_assert(TAVOLO_PROFILING == 0, "the header must not override the build switch");
+    static_assert(sizeof(Instrumented) == sizeof(uint32_t), "no histogram storage when disabled");
+
+    VirtualClock::reset();
+    LatencyHistogram histogram;
+    Instrumented instrumented;
+    {
+        TAVOLO_PROFILE_SCOPE(histogram);
+        instrumented.run();
+        delayMicroseconds(300);
+    }
+    CHECK_EQ(instrumented.runs, 1u);
+    CHECK_EQ(histogram.getCount(), 0u);
+}
@@ -0,0 +1,186 @@
+// Telemetry that cannot be published goes to the offline queue and is forwarded later
+#include "TestHarness.h"
+#include "EdgeLink.h"
+#include <WiFi.h>
+#include <dirent.h>
+#include <float.h>
+
+namespace {
+
+EdgeCommunication::WeightData sample(unsigned long timestamp, float weight) {
+    EdgeCommunication::WeightData data;
+    data.timestamp = timestamp;
+    data.weight = weight;
+    return data;
+}
+
+void enableBatching(EdgeLink& link) {
+    EdgeCommunication::BatchConfig config;
+    config.enabled = true;
+    config.maxSamples = 20;
+    config.maxAgeMs = 60000;
+    config.maxBytes = 512;
+    link.edge().setBatchConfig(config);
+}
+
+void queueSamples(EdgeLink& link, unsigned long firstTimestamp, uint8_t count) {
+    for (uint8_t i = 0; i < count; i++) {
+        link.edge().queueWeightData(sample(firstTimestamp + i * 100, 10.0f + i));
+    }
+}
+
+// Backlog messages forwarded by the queue drain, concatenated
+bool backlogContains(EdgeLink& link, const char* entry) {
+    for (size_t i = 0; i < link.broker().logSize(); i++) {
+        const char* payload = (const char*)link.broker().logEntry(i).payload;
+        if (strstr(payload, "\"weight_backlog\"") && strstr(payload, entry)) return true;
+    }
+    return false;
+}
+
+// Flips a bit in the value of every record on flash, so none passes its checksum
+void corruptQueueSegments() {
+    DIR* directory = opendir(TAVOLO_OFFLINE_QUEUE_PATH);
+    REQUIRE(directory != nullptr);
+    struct dirent* entry;
+    while ((entry = readdir(directory)) != nullptr) {
+        if (entry->d_name[0] == '.') continue;
+        char path[300];
+        snprintf(path, sizeof(path), "%s/%s", TAVOLO_OFFLINE_QUEUE_PATH, entry->d_name);
+        FILE* file = fopen(path, "r+b");
+        REQUIRE(file != nullptr);
+        for (long offset = 8; fseek(file, offset, SEEK_SET) == 0; offset += sizeof(OfflineQueue::Record)) {
+            int byte = fgetc(file);
+            if (byte == EOF) break;
+            fseek(file, offset, SEEK_SET);
+            fputc(byte ^ 0x01, file);
+        }
+        fclose(file);
+    }
+    closedir(directory);
+}
+
+}
+
+TEST(batch_flushed_while_offline_is_queued) {
+    EdgeLink link;
+    REQUIRE(link.waitOnline());
+    enableBatching(link);
+    queueSamples(link, 5000, 3);
+
+    link.broker().dropConnection();
+    CHECK(!link.edge().flushWeightBatch());
+    CHECK_EQ(link.edge().getBatchedSampleCount(), 0);
+    CHECK_EQ(link.queue().size(), 3u);
+
+    REQUIRE(link.waitOnline(10000));
+    REQUIRE(link.runUntil([&]() { return link.queue().isEmpty(); }, 5000));
+    link.runFor(50);
+    CHECK(backlogContains(link, "[5000,10.00]"));
+    CHECK(backlogContains(link, "[5100,11.00]"));
+    CHECK(backlogContains(link, "[5200,12.00]"));
+}
+
+TEST(failed_publish_while_connected_is_queued) {
+    EdgeLink link;
+    REQUIRE(link.waitOnline());
+    link.broker().clearLog();
+
+    WiFi.setSendFault(true);
+    CHECK(link.edge().isConnected());
+    CHECK(!link.edge().sendWeightData(sample(7000, 42.0f)));
+    CHECK_EQ(link.queue().size(), 1u);
+
+    enableBatching(link);
+    queueSamples(link, 8000, 2);
+    CHECK(!link.edge().flushWeightBatch());
+    CHECK_EQ(link.queue().size(), 3u);
+    WiFi.setSendFault(false);
+
+    REQUIRE(link.runUntil([&]() { return link.queue().isEmpty(); }, 5000));
+    link.runFor(50);
+    CHECK(backlogContains(link, "[7000,42.00]"));
+    CHECK(backlogContains(link, "[8000,10.00]"));
+    CHECK(backlogContains(link, "[8100,11.00]"));
+    CHECK_EQ(link.broker().countOn("/weight", "\"weight_data\""), 0u);
+}
+
+TEST(open_batch_is_queued_when_the_connection_drops) {
+    EdgeLink link;
+    REQUIRE(link.waitOnline());
+    enableBatching(link);
+    queueSamples(link, 9000, 4);
+
+    link.broker().dropConnection();
+    REQUIRE(link.runUntil([&]() { return !link.edge().isConnected(); }, 1000));
+    link.step();
+    CHECK_EQ(link.edge().getBatchedSampleCount(), 0);
+    CHECK_EQ(link.queue().size(), 4u);
+
+    REQUIRE(link.waitOnline(10000));
+    REQUIRE(link.runUntil([&]() { return link.queue().isEmpty(); }, 5000));
+    link.runFor(50);
+    CHECK(backlogContains(link, "[9000,10.00]"));
+    CHECK(backlogContains(link, "[9300,13.00]"));
+    CHECK_EQ(link.queue().getDroppedCount(), 0u);
+}
+
+TEST(spilled_batch_keeps_the_samples_as_queued) {
+    EdgeLink link;
+    REQUIRE(link.waitOnline());
+    enableBatching(link);
+    // The batch text rounds to 2 decimals; the spilled records must not
+    const float weights[] = { 12.3456f, -0.004f, 1234.5678f };
+    for (uint8_t i = 0; i < 3; i++) {
+        link.edge().queueWeightData(sample(4000000000UL + i * 12345, weights[i]));
+    }
+
+    link.broker().dropConnection();
+    CHECK(!link.edge().flushWeightBatch());
+    OfflineQueue::Record records[4];
+    REQUIRE_EQ(link.queue().peek(records, 4), 3u);
+    for (uint8_t i = 0; i < 3; i++) {
+        CHECK_EQ(records[i].kind, OfflineQueue::WEIGHT_SAMPLE);
+        CHECK_EQ(records[i].timestamp, 4000000000UL + i * 12345);
+        CHECK(records[i].value == weights[i]);
+    }
+}
+
+TEST(extreme_load_event_drains_intact) {
+    EdgeLink link;
+    link.broker().dropConnection();
+    REQUIRE(link.runUntil([&]() { return !link.edge().isConnected(); }, 1000));
+
+    EdgeCommunication::WeightEvent event;
+    event.event = "LOAD_PLACED";
+    event.eventCode = 1;
+    event.weight = FLT_MAX;
+    event.delta = -FLT_MAX;
+    event.settleTime = 0xFFFFFFFFUL;
+    event.timestamp = 0xFFFFFFFFUL;
+    CHECK(!link.edge().sendWeightEvent(event));
+    REQUIRE_EQ(link.queue().size(), 1u);
+
+    REQUIRE(link.waitOnline(10000));
+    REQUIRE(link.runUntil([&]() { return link.queue().isEmpty(); }, 5000));
+    link.runFor(50);
+    CHECK(backlogContains(link, "[4294967295,340282346638528859811704183484516925440.00,1,"
+                                "-340282346638528859811704183484516925440.00,4294967295]]}"));
+}
+
+TEST(unreadable_backlog_is_discarded_without_empty_messages) {
+    EdgeLink link;
+    link.broker().dropConnection();
+    REQUIRE(link.runUntil([&]() { return !link.edge().isConnected(); }, 1000));
+    for (uint8_t i = 0; i < 5; i++) {
+        link.edge().sendWeightData(sample(1000 + i, 5.0f));
+    }
+    REQUIRE(link.queue().flush());
+    corruptQueueSegments();
+
+    REQUIRE(link.waitOnline(10000));
+    REQUIRE(link.runUntil([&]() { return link.queue().isEmpty(); }, 5000));
+    link.runFor(1000);
+    CHECK_EQ(link.broker().countOn("/weight", "\"weight_backlog\""), 0u);
+    CHECK_EQ(link.queue().getForwardedCount(), 5u);
+}
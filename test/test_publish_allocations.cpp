@@ -0,0 +1,154 @@
+// Publish path: no heap allocation per message, counted at operator new and at malloc
+#include "TestHarness.h"
+#include "EdgeLink.h"
+#include <AllocationAudit.h>
+#include <stdlib.h>
+
+/*
+ * AllocationAudit only sees operator new; String and stdio call malloc directly. On glibc
+ * this executable interposes malloc and friends to count those too, forwarding to the
+ * allocator behind them, so a String built anywhere on the path shows up here.
+ */
+#ifdef __GLIBC__
+extern "C" {
+void* __libc_malloc(size_t size);
+void* __libc_calloc(size_t count, size_t size);
+void* __libc_realloc(void* pointer, size_t size);
+void __libc_free(void* pointer);
+}
+
+namespace {
+volatile bool countingMalloc = false;
+volatile uint32_t mallocCalls = 0;
+}
+
+extern "C" void* malloc(size_t size) {
+    if (countingMalloc) mallocCalls = mallocCalls + 1;
+    return __libc_malloc(size);
+}
+
+extern "C" void* calloc(size_t count, size_t size) {
+    if (countingMalloc) mallocCalls = mallocCalls + 1;
+    return __libc_calloc(count, size);
+}
+
+extern "C" void* realloc(void* pointer, size_t size) {
+    if (countingMalloc) mallocCalls = mallocCalls + 1;
+    return __libc_realloc(pointer, size);
+}
+
+extern "C" void free(void* pointer) {
+    __libc_free(pointer);
+}
+#endif
+
+namespace {
+
+// Allocations of every kind made while body runs
+template <typename Body>
+uint32_t allocationsDuring(Body body) {
+    uint32_t newBefore = AllocationAudit::getPostBootAllocations();
+#ifdef __GLIBC__
+    uint32_t mallocBefore = mallocCalls;
+    countingMalloc = true;
+#endif
+    body();
+#ifdef __GLIBC__
+    countingMalloc = false;
+    uint32_t viaMalloc = mallocCalls - mallocBefore;
+#else
+    uint32_t viaMalloc = 0;
+#endif
+    return AllocationAudit::getPostBootAllocations() - newBefore + viaMalloc;
+}
+
+EdgeCommunication::WeightEvent placedEvent() {
+    EdgeCommunication::WeightEvent event;
+    event.event = "LOAD_PLACED";
+    event.eventCode = 1;
+    event.weight = 250.0f;
+    event.delta = 250.0f;
+    event.settleTime = 420;
+    event.timestamp = millis();
+    return event;
+}
+
+WindowAggregator::Summary summary() {
+    WindowAggregator::Summary summary = {};
+    summary.windowMs = 60000;
+    summary.hopMs = 60000;
+    summary.timestamp = millis();
+    summary.count = 600;
+    summary.min = 10.0f;
+    summary.max = 260.0f;
+    summary.mean = 120.5f;
+    summary.variance = 30.25f;
+    summary.aboveMs = 12000;
+    return summary;
+}
+
+// Every kind of outbound message once, then a minute of heartbeats and keep-alives
+void publishEverything(EdgeLink& link) {
+    EdgeCommunication& edge = link.edge();
+    EdgeCommunication::WeightData data;
+    for (int i = 0; i < 20; i++) {
+        data.weight = 100.0f + i * 0.5f;
+        data.timestamp = millis();
+        CHECK(edge.sendWeightData(data));
+        edge.queueWeightData(data);
+        link.step();
+    }
+    edge.flushWeightBatch();
+    CHECK(edge.sendWeightEvent(placedEvent()));
+    CHECK(edge.sendWeightSummary(summary()));
+    CHECK(edge.sendStatusUpdate("MEASURING"));
+    const uint8_t chunk[] = { 0x54, 0x43, 0x01, 0x00, 0x02, 0x7F, 0x10, 0x20 };
+    CHECK(edge.sendTraceChunk(chunk, sizeof(chunk)));
+    link.runFor(61000);
+}
+
+// Connected, then one untimed pass of everything so one-time setup is out of the way
+void warmUp(EdgeLink& link, EdgeCommunication::PayloadFormat format) {
+    REQUIRE(link.waitOnline());
+    link.edge().setPayloadFormat(format);
+    publishEverything(link);
+    AllocationAudit::markBootComplete();
+    link.broker().clearLog();
+}
+
+}
+
+TEST(json_publishes_allocate_nothing) {
+    EdgeLink link;
+    warmUp(link, EdgeCommunication::PayloadFormat::JSON);
+    uint32_t before = link.broker().getPublishCount();
+
+    CHECK_EQ(allocationsDuring([&]() { publishEverything(link); }), 0u);
+    CHECK_GE(link.broker().getPublishCount() - before, 20u + 5u + 2u); // The path really ran
+    CHECK_EQ(link.edge().getPublishFailureCount(), 0u);
+}
+
+TEST(binary_publishes_allocate_nothing) {
+    EdgeLink link;
+    warmUp(link, EdgeCommunication::PayloadFormat::BINARY);
+    uint32_t before = link.broker().getPublishCount();
+
+    CHECK_EQ(allocationsDuring([&]() { publishEverything(link); }), 0u);
+    CHECK_GE(link.broker().getPublishCount() - before, 20u + 5u + 2u);
+    CHECK_EQ(link.edge().getPublishFailureCount(), 0u);
+}
+
+TEST(counter_sees_string_and_new) {
+    // The check above is only worth something if it would notice an allocation
+    CHECK_EQ(allocationsDuring([]() {}), 0u);
+    AllocationAudit::markBootComplete();
+    CHECK_GE(allocationsDuring([]() {
+        String payload = "{\"weight\":";
+        payload += 12.5f;
+        payload += "}";
+    }), 1u);
+    CHECK_GE(allocationsDuring([]() {
+        int* volatile value = new int(1); // volatile: the pair may not be optimised away
+        delete value;
+    }), 1u);
+}
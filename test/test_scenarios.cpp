@@ -0,0 +1,301 @@
+// End-to-end scenarios: load waveforms in, LED, LCD and MQTT traffic out
+#include "TestHarness.h"
+#include "Simulation.h"
+#include <math.h>
+#include <stdlib.h>
+
+typedef TavoloSystem::SystemState State;
+typedef LedActuator::BlinkPattern Pattern;
+
+namespace {
+
+// Boot, calibrate on an empty table and settle in IDLE
+void settleIdle(Simulation& sim) {
+    sim.setWeight(0);
+    REQUIRE(sim.runUntil([&]() { return sim.system().getSystemState() == State::IDLE; }, 10000));
+}
+
+const char* lastPayload(Simulation& sim, const char* topicSuffix) {
+    const FakeBroker::Message* message = sim.broker().lastOn(topicSuffix);
+    return message ? (const char*)message->payload : nullptr;
+}
+
+// Value of a top-level numeric field in a JSON payload, NAN when absent
+float jsonNumber(const char* payload, const char* key) {
+    char pattern[32];
+    snprintf(pattern, sizeof(pattern), "\"%s\":", key);
+    const char* found = payload ? strstr(payload, pattern) : nullptr;
+    return found ? strtof(found + strlen(pattern), nullptr) : NAN;
+}
+
+}
+
+TEST(boot_calibrates_then_idles_with_the_led_off) {
+    Simulation sim;
+    sim.setWeight(0);
+
+    CHECK(sim.system().getSystemState() == State::CALIBRATING);
+    CHECK(sim.ledPattern(1000) == Pattern::PULSE);
+
+    REQUIRE(sim.runUntil([&]() { return sim.system().getSystemState() == State::IDLE; }, 10000));
+    sim.runFor(3500); // "Tare Complete" message times out
+    CHECK(sim.ledPattern(2000) == Pattern::OFF);
+    CHECK(sim.lcdShows("TAVOLO WEIGHT"));
+    CHECK(sim.lcdShows("0.0 g"));
+    CHECK(sim.lcdShows("Status: NORMAL"));
+}
+
+TEST(connects_subscribes_and_announces_itself) {
+    Simulation sim;
+    settleIdle(sim);
+
+    REQUIRE(sim.waitForBrokerSession());
+    CHECK_EQ(sim.broker().getConnectCount(), 1);
+    CHECK_EQ(sim.broker().getSubscriptionCount(), 1);
+    CHECK_CONTAINS(lastPayload(sim, "/status"), "\"type\":\"status_update\"");
+
+    // Heartbeats keep coming while the table is idle
+    sim.broker().clearLog();
+    sim.runFor(65000);
+    CHECK_GE(sim.broker().countOn("/status", "\"heartbeat\""), 2);
+}
+
+TEST(placed_load_is_measured_shown_and_reported_once) {
+    Simulation sim;
+    settleIdle(sim);
+    REQUIRE(sim.waitForBrokerSession());
+    sim.broker().clearLog();
+
+    sim.play(Waveform().set(0).hold(500).rampTo(50, 300).hold(9000).rampTo(0, 300).hold(60000));
+    REQUIRE(sim.runUntil([&]() { return sim.system().getSystemState() == State::MEASURING; }, 5000));
+    sim.runFor(8000);
+
+    CHECK_NEAR(sim.lcdWeight(), 50.0f, 2.5f); // One count is 2.4 g
+    CHECK(sim.lcdShows("Status: NORMAL"));
+    CHECK_EQ(sim.broker().countOn("/weight", "LOAD_PLACED"), 1);
+    CHECK_EQ(sim.broker().countOn("/weight", "\"weight_event\""), 1); // No LOAD_STABLE echo
+    const char* event = nullptr;
+    for (size_t i = 0; i < sim.broker().logSize(); i++) {
+        const FakeBroker::Message& message = sim.broker().logEntry(i);
+        if (strstr((const char*)message.payload, "LOAD_PLACED")) event = (const char*)message.payload;
+    }
+    REQUIRE(event != nullptr);
+    CHECK_NEAR(jsonNumber(event, "delta"), 50.0f, 2.5f);
+    CHECK_GE(sim.broker().countOn("/weight", "\"weight_batch\""), 1);
+
+    // Taking it off is one LOAD_REMOVED with the negative delta, again without an echo
+    sim.broker().clearLog();
+    sim.runFor(8000);
+    CHECK_EQ(sim.broker().countOn("/weight", "\"weight_event\""), 1);
+    const FakeBroker::Message* removed = nullptr;
+    for (size_t i = 0; i < sim.broker().logSize(); i++) {
+        const FakeBroker::Message& message = sim.broker().logEntry(i);
+        if (strstr((const char*)message.payload, "\"weight_event\"")) removed = &message;
+    }
+    REQUIRE(removed != nullptr);
+    CHECK_CONTAINS((const char*)removed->payload, "\"event\":\"LOAD_REMOVED\"");
+    CHECK_NEAR(jsonNumber((const char*)removed->payload, "delta"), -50.0f, 5.0f); // Settles on the filter tail
+}
+
+TEST(threshold_turns_the_led_on_and_the_lcd_to_over_limit) {
+    Simulation sim;
+    settleIdle(sim);
+
+    sim.play(Waveform().set(0).hold(200).rampTo(180, 200).hold(15000).rampTo(0, 200).hold(600000));
+    REQUIRE(sim.runUntil([&]() { return sim.system().getSystemState() == State::THRESHOLD_EXCEEDED; }, 5000));
+    sim.runFor(1000);
+    CHECK(sim.ledPattern(2000) == Pattern::ON);
+    CHECK(sim.lcdShows("OVER LIMIT"));
+
+    // Load taken off: back to measuring, then idle once the table has been empty for the timeout
+    REQUIRE(sim.runUntil([&]() { return sim.system().getSystemState() == State::MEASURING; }, 20000));
+    sim.runFor(1000);
+    CHECK(sim.lcdShows("Status: NORMAL"));
+    REQUIRE(sim.runUntil([&]() { return sim.system().getSystemState() == State::IDLE; }, 40000));
+    CHECK(sim.ledPattern(2000) == Pattern::OFF);
+}
+
+TEST(edge_command_changes_the_threshold) {
+    Simulation sim;
+    settleIdle(sim);
+    REQUIRE(sim.waitForBrokerSession());
+
+    char topic[64];
+    snprintf(topic, sizeof(topic), "tavolo/%s/command", sim.system().getDeviceId().c_str());
+    REQUIRE(sim.broker().injectPublish(topic, "{\"command\":\"SET_THRESHOLD\",\"value\":50}"));
+    sim.runFor(500);
+
+    sim.play(Waveform().set(0).hold(200).rampTo(80, 200).hold(60000));
+    REQUIRE(sim.runUntil([&]() { return sim.system().getSystemState() == State::THRESHOLD_EXCEEDED; }, 5000));
+    sim.runFor(500);
+    CHECK(sim.ledPattern(1000) == Pattern::ON);
+}
+
+TEST(idle_rules_follow_the_set_idle_command) {
+    Simulation sim;
+    settleIdle(sim);
+    REQUIRE(sim.waitForBrokerSession());
+
+    char topic[64];
+    snprintf(topic, sizeof(topic), "tavolo/%s/command", sim.system().getDeviceId().c_str());
+    REQUIRE(sim.broker().injectPublish(topic, "{\"command\":\"SET_IDLE\",\"value\":\"timeout=3000,load=50\"}"));
+    sim.runFor(500);
+
+    // Moving wakes it, but a settled 20 g is now an empty table: back to IDLE after 3 s
+    sim.play(Waveform().set(0).hold(200).rampTo(20, 200).hold(600000));
+    REQUIRE(sim.runUntil([&]() { return sim.system().getSystemState() == State::MEASURING; }, 5000));
+    REQUIRE(sim.runUntil([&]() { return sim.system().getSystemState() == State::IDLE; }, 15000));
+    sim.runFor(10000);
+    CHECK(sim.system().getSystemState() == State::IDLE);
+
+    // 80 g is a load and keeps it measuring
+    sim.play(Waveform().set(20).hold(200).rampTo(80, 200).hold(600000));
+    REQUIRE(sim.runUntil([&]() { return sim.system().getSystemState() == State::MEASURING; }, 10000));
+    sim.runFor(30000);
+    CHECK(sim.system().getSystemState() == State::MEASURING);
+
+    // With the timeout disabled an emptied table stays in MEASURING
+    REQUIRE(sim.broker().injectPublish(topic, "{\"command\":\"SET_IDLE\",\"value\":\"timeout=0\"}"));
+    sim.play(Waveform().set(80).hold(200).rampTo(0, 200).hold(600000));
+    sim.runFor(120000);
+    CHECK(sim.system().getSystemState() == State::MEASURING);
+
+    REQUIRE(sim.broker().injectPublish(topic, "{\"command\":\"SET_IDLE\",\"value\":\"timeout=2000\"}"));
+    REQUIRE(sim.runUntil([&]() { return sim.system().getSystemState() == State::IDLE; }, 5000));
+}
+
+TEST(set_sampling_changes_the_sample_period_and_refuses_bad_values) {
+    Simulation::Options options;
+    options.ratePin = true;
+    Simulation sim(options);
+    settleIdle(sim);
+    REQUIRE(sim.waitForBrokerSession());
+    const WeightSensor& sensor = sim.system().getWeightSensor();
+    typedef WeightSensor::SamplingMode Mode;
+
+    // Without duty cycling the IDLE period is the measurement interval
+    char topic[64];
+    snprintf(topic, sizeof(topic), "tavolo/%s/command", sim.system().getDeviceId().c_str());
+    REQUIRE(sim.broker().injectPublish(topic, "{\"command\":\"SET_POWER\",\"value\":\"PERFORMANCE\"}"));
+    REQUIRE(sim.broker().injectPublish(topic,
+        "{\"command\":\"SET_SAMPLING\",\"value\":\"rate=10,avg=2,idle_after=2000,interval=500\"}"));
+    sim.runFor(500);
+    REQUIRE(sim.runUntil([&]() { return sensor.getSamplingMode() == Mode::IDLE; }, 5000));
+    CHECK_EQ(sensor.getSamplingPolicy().activeRate, WeightSensor::SLOW_RATE);
+    CHECK_EQ(sensor.getSamplingPolicy().activeAveraging, 2);
+    CHECK_EQ(sensor.getSamplePeriod(), 500ul);
+
+    // A moving load switches to ACTIVE: 2 conversions at 10 SPS
+    uint32_t switches = sensor.getModeSwitchCount();
+    sim.play(Waveform().set(0).hold(200).rampTo(60, 400).hold(600000));
+    REQUIRE(sim.runUntil([&]() { return sensor.getSamplingMode() == Mode::ACTIVE; }, 2000));
+    CHECK_EQ(sensor.getConversionRate(), WeightSensor::SLOW_RATE);
+    CHECK_EQ(sensor.getSamplePeriod(), 200ul);
+
+    // Settled for idle_after, back to IDLE
+    uint64_t movingUntil = sim.nowMs() + 400;
+    REQUIRE(sim.runUntil([&]() { return sensor.getSamplingMode() == Mode::IDLE; }, 8000));
+    CHECK_GE(sim.nowMs() - movingUntil, 2000u);
+    CHECK_EQ(sensor.getModeSwitchCount(), switches + 2);
+
+    // Out-of-range or malformed values leave the policy as it was
+    const char* const bad[] = { "rate=40", "rate=70000", "avg=0", "avg=300", "interval=0", "rate=80,speed=1",
+                                "rate=fast" };
+    Serial.clearCapturedOutput();
+    for (const char* value : bad) {
+        char payload[96];
+        snprintf(payload, sizeof(payload), "{\"command\":\"SET_SAMPLING\",\"value\":\"%s\"}", value);
+        REQUIRE(sim.broker().injectPublish(topic, payload));
+        sim.runFor(200);
+        CHECK_EQ(sensor.getSamplingPolicy().activeRate, WeightSensor::SLOW_RATE);
+        CHECK_EQ(sensor.getSamplingPolicy().activeAveraging, 2);
+        CHECK_EQ(sensor.getSamplingPolicy().idleInterval, 500ul);
+    }
+    DeferredLog::drain(Serial);
+    CHECK_CONTAINS(Serial.capturedOutput(), "Invalid sampling policy: rate 40, avg 2");
+    CHECK_EQ(sensor.getSamplePeriod(), 500ul);
+
+    // 80 SPS with 4 conversions a sample once the load moves again
+    REQUIRE(sim.broker().injectPublish(topic, "{\"command\":\"SET_SAMPLING\",\"value\":\"rate=80,avg=4\"}"));
+    sim.runFor(200);
+    sim.play(Waveform().set(60).hold(200).rampTo(120, 400).hold(600000));
+    REQUIRE(sim.runUntil([&]() { return sensor.getSamplingMode() == Mode::ACTIVE; }, 2000));
+    CHECK_EQ(sensor.getConversionRate(), WeightSensor::FAST_RATE);
+    CHECK_EQ(sensor.getSamplePeriod(), 50ul);
+}
+
+TEST(filter_command_logs_through_the_deferred_log) {
+    Simulation sim;
+    settleIdle(sim);
+    REQUIRE(sim.waitForBrokerSession());
+
+    char topic[64];
+    snprintf(topic, sizeof(topic), "tavolo/%s/command", sim.system().getDeviceId().c_str());
+    Serial.clearCapturedOutput();
+    REQUIRE(sim.broker().injectPublish(topic, "{\"command\":\"SET_FILTER\",\"value\":\"ema.alpha=0.2\"}"));
+    REQUIRE(sim.broker().injectPublish(topic, "{\"command\":\"SET_FILTER\",\"value\":\"ema.beta=1\"}"));
+    sim.runFor(500);
+    DeferredLog::drain(Serial);
+
+    // The key lives in the handler's stack buffer; the log must not point at it
+    char rejected[96];
+    snprintf(rejected, sizeof(rejected), " W] Filter parameter rejected: key hash %08x (8 chars)",
+             (unsigned)commandHash("ema.beta"));
+    CHECK_CONTAINS(Serial.capturedOutput(), " I] Filter parameter ema.alpha set to 0.2000");
+    CHECK_CONTAINS(Serial.capturedOutput(), rejected);
+}
+
+TEST(status_reads_network_counters_from_the_published_status) {
+    Simulation sim;
+    settleIdle(sim);
+    REQUIRE(sim.waitForBrokerSession());
+    sim.runFor(500);
+
+    Serial.clearCapturedOutput();
+    sim.system().showSystemStatus();
+    CHECK_CONTAINS(Serial.capturedOutput(), "MQTT Phase: ONLINE");
+    CHECK_CONTAINS(Serial.capturedOutput(), "Offline Queue: 0 pending");
+    CHECK(strstr(Serial.capturedOutput(), "MQTT Published: 0,") == nullptr); // Announced itself already
+    CHECK(strstr(Serial.capturedOutput(), "Display compositions: 0 of 0") == nullptr);
+}
+
+TEST(lost_broker_blinks_fast_and_recovers) {
+    Simulation sim;
+    settleIdle(sim);
+    REQUIRE(sim.waitForBrokerSession());
+
+    sim.broker().setConnAck(FakeBroker::ConnAckMode::SILENT);
+    sim.broker().dropConnection();
+    REQUIRE(sim.runUntil([&]() { return sim.system().getSystemState() == State::COMMUNICATION_ERROR; }, 10000));
+    sim.runFor(200);
+    CHECK(sim.ledPattern(2000) == Pattern::FAST_BLINK);
+    CHECK(sim.lcdShows("Comm Error"));
+
+    sim.broker().setConnAck(FakeBroker::ConnAckMode::ACCEPT);
+    REQUIRE(sim.runUntil([&]() { return sim.system().getSystemState() == State::IDLE; }, 120000));
+    CHECK_GE(sim.broker().getConnectCount(), 2);
+    CHECK(sim.ledPattern(2000) == Pattern::OFF);
+}
+
+TEST(hours_of_operation_run_in_seconds) {
+    Simulation sim;
+    settleIdle(sim);
+    REQUIRE(sim.waitForBrokerSession());
+
+    // A load comes and goes every ten minutes for six hours, ending on an empty table
+    Waveform day;
+    day.set(0);
+    for (int i = 0; i < 18; i++) {
+        day.rampTo(400, 500).hold(299500).rampTo(0, 500).hold(299500);
+    }
+    sim.broker().clearLog();
+    sim.play(day);
+    uint64_t start = sim.nowMs();
+    sim.runFor(6UL * 3600 * 1000);
+
+    CHECK_GE(sim.nowMs() - start, 6ULL * 3600 * 1000);
+    CHECK_EQ(sim.broker().getConnectCount(), 1); // Never dropped
+    CHECK_GE(sim.broker().getPublishCount(), 6 * 60); // Heartbeats alone
+    CHECK(sim.system().getSystemState() == State::IDLE);
+    CHECK_NEAR(sim.lcdWeight(), 0.0f, 2.5f);
+}
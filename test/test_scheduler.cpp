@@ -0,0 +1,210 @@
+// Scheduler deadlines on a virtual clock, across the 32-bit microsecond wrap
+#include "TestHarness.h"
+#include <Scheduler.h>
+#include "VirtualClock.h"
+
+namespace {
+
+const uint32_t NEAR_WRAP = 0xFFFFFFFFu - 15000; // 15 ms before micros() wraps
+
+/**
+ * Clock the test owns: sleep() jumps straight to the deadline, unless an "interrupt"
+ * was planned inside the sleep, in which case time stops there and the hook runs.
+ */
+class TestClock : public SchedulerClock {
+public:
+    uint32_t time;
+    uint32_t interruptAt = 0;
+    bool interruptPending = false;
+    std::function<void()> interrupt;
+    bool woken = false;
+
+    explicit TestClock(uint32_t start = 0) : time(start) {}
+
+    uint32_t now() override { return time; }
+
+    void sleep(uint32_t durationUs) override {
+        if (interruptPending && (uint32_t)(interruptAt - time) < durationUs) {
+            time = interruptAt;
+            interruptPending = false;
+            woken = false;
+            interrupt();
+            if (woken) return;
+        }
+        time += durationUs;
+    }
+
+    void wake() override { woken = true; }
+
+    void advance(uint32_t us) { time += us; }
+};
+
+// Runs the loop up to and including end, without sleeping past it
+void runUntil(Scheduler& scheduler, TestClock& clock, uint32_t end) {
+    while (true) {
+        scheduler.runDue();
+        int32_t left = (int32_t)(end - clock.now());
+        if (left <= 0) return;
+        if (scheduler.timeUntilNext() > (uint32_t)left) {
+            clock.advance(left);
+            scheduler.runDue();
+            return;
+        }
+        scheduler.waitForNext();
+    }
+}
+
+}
+
+TEST(periodic_tasks_run_exactly_on_their_deadlines) {
+    TestClock clock(1000);
+    Scheduler scheduler(clock);
+    uint32_t fastRuns[200];
+    uint32_t fastCount = 0;
+    uint32_t slowCount = 0;
+    scheduler.addPeriodic("fast", 10, [&]() { if (fastCount < 200) fastRuns[fastCount++] = clock.now(); });
+    scheduler.addPeriodic("slow", 25, [&]() { slowCount++; }, 25);
+
+    runUntil(scheduler, clock, 1000 + 1000000);
+    CHECK_EQ(fastCount, 101u); // t = 0, 10, ... 1000 ms
+    CHECK_EQ(slowCount, 40u);
+    for (uint32_t i = 0; i < fastCount; i++) {
+        CHECK_EQ(fastRuns[i], 1000u + i * 10000u);
+    }
+    CHECK_EQ(scheduler.getStatistics().maxLatencyUs, 0u);
+    // Slept between runs instead of spinning
+    CHECK_LE(scheduler.getStatistics().wakeups, 141u);
+}
+
+TEST(one_shot_runs_once_and_can_be_rearmed_or_cancelled) {
+    TestClock clock;
+    Scheduler scheduler(clock);
+    uint32_t runs = 0;
+    Scheduler::TaskId id = scheduler.addOneShot("once", 50, [&]() { runs++; });
+
+    runUntil(scheduler, clock, 49999);
+    CHECK_EQ(runs, 0u);
+    runUntil(scheduler, clock, 200000);
+    CHECK_EQ(runs, 1u);
+    CHECK(!scheduler.isScheduled(id));
+
+    scheduler.schedule(id, 20);
+    scheduler.schedule(id, 40); // Re-arming replaces the earlier deadline
+    runUntil(scheduler, clock, 230000);
+    CHECK_EQ(runs, 1u);
+    runUntil(scheduler, clock, 240000);
+    CHECK_EQ(runs, 2u);
+
+    scheduler.schedule(id, 10);
+    scheduler.cancel(id);
+    runUntil(scheduler, clock, 400000);
+    CHECK_EQ(runs, 2u);
+}
+
+TEST(deadlines_hold_across_the_microsecond_wrap) {
+    TestClock clock(NEAR_WRAP);
+    Scheduler scheduler(clock);
+    uint32_t periodicRuns = 0;
+    uint32_t lastRun = 0;
+    bool early = false;
+    scheduler.addPeriodic("tick", 10, [&]() {
+        if (periodicRuns > 0 && clock.now() - lastRun != 10000) early = true;
+        lastRun = clock.now();
+        periodicRuns++;
+    });
+
+    // Deadline past the wrap is numerically smaller than now: must not fire at once
+    uint32_t oneShotAt = 0;
+    scheduler.addOneShot("after wrap", 40, [&]() { oneShotAt = clock.now(); });
+    scheduler.runDue();
+    CHECK_EQ(oneShotAt, 0u);
+    CHECK_EQ(scheduler.timeUntilNext(), 10000u);
+
+    runUntil(scheduler, clock, NEAR_WRAP + 100000);
+    CHECK_EQ(oneShotAt, NEAR_WRAP + 40000); // Wrapped value, on time
+    CHECK(oneShotAt < NEAR_WRAP);
+    CHECK_EQ(periodicRuns, 11u);
+    CHECK(!early);
+    CHECK_EQ(scheduler.getStatistics().maxLatencyUs, 0u);
+}
+
+TEST(many_tasks_fire_in_deadline_order_across_the_wrap) {
+    TestClock clock(NEAR_WRAP);
+    Scheduler scheduler(clock);
+    uint8_t order[Scheduler::MAX_TASKS];
+    uint8_t fired = 0;
+
+    // Delays 5..80 ms registered in scrambled order, so half land after the wrap
+    for (uint8_t i = 0; i < Scheduler::MAX_TASKS; i++) {
+        uint8_t rank = (i * 7) % Scheduler::MAX_TASKS;
+        scheduler.addOneShot("task", 5 + rank * 5, [&order, &fired, rank]() { order[fired++] = rank; });
+    }
+    CHECK_EQ(scheduler.addOneShot("extra", 1, []() {}), Scheduler::INVALID_TASK);
+
+    runUntil(scheduler, clock, NEAR_WRAP + 100000);
+    REQUIRE_EQ(fired, Scheduler::MAX_TASKS);
+    for (uint8_t i = 0; i < Scheduler::MAX_TASKS; i++) {
+        CHECK_EQ(order[i], i);
+    }
+}
+
+TEST(late_periodic_task_skips_missed_runs) {
+    TestClock clock;
+    Scheduler scheduler(clock);
+    uint32_t runs = 0;
+    uint32_t runTimes[8];
+    scheduler.addPeriodic("slow work", 10, [&]() {
+        if (runs < 8) runTimes[runs] = clock.now();
+        if (runs++ == 1) clock.advance(35000); // One run overstays by three periods
+    });
+
+    runUntil(scheduler, clock, 100000);
+    REQUIRE(runs >= 4);
+    CHECK_EQ(runTimes[0], 0u);
+    CHECK_EQ(runTimes[1], 10000u);
+    CHECK_EQ(runTimes[2], 45000u); // One late run instead of 20, 30 and 40 in a burst
+    CHECK_EQ(runTimes[3], 55000u); // Then the period restarts from there
+    CHECK_EQ(runs, 8u);
+}
+
+TEST(signal_cuts_the_sleep_short) {
+    TestClock clock;
+    Scheduler scheduler(clock);
+    uint32_t eventRuns = 0;
+    uint32_t eventAt = 0;
+    Scheduler::TaskId event = scheduler.addEvent("event", [&]() { eventRuns++; eventAt = clock.now(); });
+    scheduler.addPeriodic("idle", 500, []() {}, 500);
+
+    clock.interruptAt = 120000;
+    clock.interruptPending = true;
+    clock.interrupt = [&]() { scheduler.signal(event); };
+
+    scheduler.runDue();
+    scheduler.waitForNext();
+    CHECK_EQ(clock.now(), 120000u);
+    CHECK_EQ(scheduler.getStatistics().earlyWakeups, 1u);
+    scheduler.runDue();
+    CHECK_EQ(eventRuns, 1u);
+    CHECK_EQ(eventAt, 120000u);
+
+    // Nothing pending: the next wait goes to the periodic deadline
+    scheduler.waitForNext();
+    CHECK_EQ(clock.now(), 500000u);
+}
+
+TEST(system_clock_follows_the_virtual_clock_through_the_wrap) {
+    VirtualClock::reset(NEAR_WRAP);
+    Scheduler scheduler; // SystemClock: micros() and delayMicroseconds()
+    uint32_t runs = 0;
+    scheduler.addPeriodic("tick", 1, [&]() { runs++; });
+
+    uint64_t end = VirtualClock::now() + 50000;
+    while (VirtualClock::now() < end) {
+        scheduler.runDue();
+        scheduler.waitForNext();
+    }
+    CHECK_EQ(runs, 50u);
+    CHECK_EQ(scheduler.getStatistics().maxLatencyUs, 0u);
+    CHECK_EQ(VirtualClock::now(), (uint64_t)NEAR_WRAP + 50000);
+    VirtualClock::reset();
+}
@@ -0,0 +1,193 @@
+// StateMachine: guard order, internal transitions, bounded steps, counters and per-row stats
+#ifndef NDEBUG
+#define NDEBUG // The overflow cases check what setTable() returns, which assert() would stop first
+#endif
+#include "TestHarness.h"
+#include <StateMachine.h>
+#include "VirtualClock.h"
+
+namespace {
+
+enum class State : uint8_t { A, B, C };
+enum class Event : uint8_t { GO, BACK, POKE, CHAIN, NOISE };
+const uint8_t STATES = 3;
+const uint8_t EVENTS = 5;
+
+struct Panel;
+typedef StateMachine<State, Event, Panel, STATES, EVENTS, 8, 4, 2> Machine;
+typedef Machine::Transition Row;
+
+struct Panel {
+    Machine* machine = nullptr;
+    bool open = true;
+    uint32_t actions = 0;
+    uint32_t hooks = 0;
+    State lastFrom = State::A;
+    State lastTo = State::A;
+};
+
+void hook(Panel& panel, State from, State to) {
+    panel.hooks++;
+    panel.lastFrom = from;
+    panel.lastTo = to;
+}
+
+bool isOpen(const Panel& panel) { return panel.open; }
+void act(Panel& panel) { panel.actions++; }
+void slowAct(Panel& panel) {
+    panel.actions++;
+    delayMicroseconds(250);
+}
+void postBack(Panel& panel) { panel.machine->post(Event::BACK); }
+
+// Rows 0 and 1 are ANY_STATE but listed first: state-specific rows must still win
+const Row TABLE[] = {
+    Row(ANY_STATE, Event::GO,    State::C),                   // 0
+    Row(ANY_STATE, Event::BACK,  State::A),                   // 1
+    Row(State::A,  Event::GO,    State::B, isOpen),           // 2
+    Row(State::B,  Event::POKE,  State::B, nullptr, slowAct), // 3, internal
+    Row(State::B,  Event::CHAIN, State::C, nullptr, postBack), // 4
+    Row(State::C,  Event::POKE,  State::C, isOpen, act),      // 5, internal and guarded
+};
+const uint8_t ROWS = sizeof(TABLE) / sizeof(TABLE[0]);
+
+struct Rig {
+    Panel panel;
+    Machine machine;
+
+    Rig() : machine(State::A, hook) {
+        VirtualClock::reset();
+        panel.machine = &machine;
+        REQUIRE(machine.setTable(TABLE, ROWS));
+    }
+
+    size_t send(Event event) {
+        machine.post(event);
+        return machine.step(panel);
+    }
+};
+
+}
+
+TEST(state_rows_win_over_any_state_rows_and_guards_fall_through) {
+    Rig rig;
+    rig.send(Event::GO);
+    CHECK(rig.machine.getState() == State::B); // Row 2, although row 0 comes first
+    CHECK_EQ(rig.machine.getRowStats(2).count, 1u);
+    CHECK_EQ(rig.machine.getRowStats(0).count, 0u);
+
+    // A failing guard falls through to the ANY_STATE row
+    rig.send(Event::BACK);
+    REQUIRE(rig.machine.getState() == State::A);
+    rig.panel.open = false;
+    rig.send(Event::GO);
+    CHECK(rig.machine.getState() == State::C);
+    CHECK_EQ(rig.machine.getRowStats(0).count, 1u);
+    CHECK_EQ(rig.panel.hooks, 3u);
+    CHECK(rig.panel.lastFrom == State::A);
+    CHECK(rig.panel.lastTo == State::C);
+}
+
+TEST(internal_transitions_run_the_action_without_the_hook) {
+    Rig rig;
+    rig.send(Event::GO);
+    uint32_t hooks = rig.panel.hooks;
+    rig.send(Event::POKE);
+    rig.send(Event::POKE);
+    CHECK(rig.machine.getState() == State::B);
+    CHECK_EQ(rig.panel.actions, 2u);
+    CHECK_EQ(rig.panel.hooks, hooks);
+}
+
+TEST(unhandled_events_and_failed_guards_are_counted_as_ignored) {
+    Rig rig;
+    rig.send(Event::NOISE);   // No row at all
+    rig.send(Event::POKE);    // No row in A
+    CHECK_EQ(rig.machine.getIgnoredCount(), 2u);
+
+    rig.panel.open = false;
+    rig.send(Event::GO);      // To C through row 0
+    rig.send(Event::POKE);    // Row 5's guard fails, nothing else applies
+    CHECK(rig.machine.getState() == State::C);
+    CHECK_EQ(rig.panel.actions, 0u);
+    CHECK_EQ(rig.machine.getIgnoredCount(), 3u);
+}
+
+TEST(step_handles_only_the_events_queued_before_it) {
+    Rig rig;
+    rig.send(Event::GO);
+    REQUIRE(rig.machine.getState() == State::B);
+
+    // CHAIN's action posts BACK: it waits for the next step
+    CHECK_EQ(rig.send(Event::CHAIN), 1u);
+    CHECK(rig.machine.getState() == State::C);
+    CHECK_EQ(rig.machine.pending(), 1u);
+    CHECK_EQ(rig.machine.step(rig.panel), 1u);
+    CHECK(rig.machine.getState() == State::A);
+    CHECK_EQ(rig.machine.step(rig.panel), 0u);
+}
+
+TEST(full_queue_drops_and_counts) {
+    Rig rig;
+    for (uint8_t i = 0; i < 4; i++) {
+        CHECK(rig.machine.post(Event::NOISE));
+    }
+    CHECK(!rig.machine.post(Event::GO));
+    CHECK(!rig.machine.post(Event::GO));
+    CHECK_EQ(rig.machine.getDroppedCount(), 2u);
+    CHECK_EQ(rig.machine.step(rig.panel), 4u);
+    CHECK(rig.machine.getState() == State::A); // The dropped GO never ran
+    CHECK(rig.machine.post(Event::GO));
+}
+
+TEST(rows_keep_their_own_count_and_time) {
+    Rig rig;
+    rig.send(Event::GO);
+    for (uint8_t i = 0; i < 3; i++) rig.send(Event::POKE);
+
+    const Machine::RowStats& poke = rig.machine.getRowStats(3);
+    CHECK_EQ(poke.count, 3u);
+    CHECK_GE(poke.maxUs, 250u);
+    CHECK_GE(poke.totalUs, 750u);
+    CHECK_EQ(rig.machine.getRowStats(2).count, 1u);
+    CHECK_LT(rig.machine.getRowStats(2).maxUs, 250u);
+    CHECK_EQ(rig.machine.getRowStats(5).count, 0u);
+
+    Serial.clearCapturedOutput();
+    rig.machine.printStats(Serial, [](State state) { return state == State::A ? "A" : state == State::B ? "B" : "C"; },
+                           [](Event) { return "E"; });
+    CHECK_CONTAINS(Serial.capturedOutput(), "ignored 0, dropped 0");
+    CHECK_CONTAINS(Serial.capturedOutput(), "B --E--> B: 3 x");
+}
+
+TEST(oversized_tables_are_reported) {
+    // Nine rows for eight slots: the ninth is never indexed
+    const Row tooMany[] = {
+        Row(State::A, Event::NOISE, State::A), Row(State::A, Event::NOISE, State::A),
+        Row(State::B, Event::NOISE, State::B), Row(State::B, Event::NOISE, State::B),
+        Row(State::C, Event::NOISE, State::C), Row(State::C, Event::NOISE, State::C),
+        Row(State::A, Event::POKE, State::A),  Row(State::B, Event::POKE, State::B),
+        Row(State::A, Event::GO, State::B),
+    };
+    Panel panel;
+    Machine machine(State::A, hook);
+    CHECK(!machine.setTable(tooMany, sizeof(tooMany) / sizeof(tooMany[0])));
+    machine.post(Event::GO);
+    machine.step(panel);
+    CHECK(machine.getState() == State::A);
+    CHECK_EQ(machine.getIgnoredCount(), 1u);
+
+    // Three candidates for (A, GO) with room for two: the ANY_STATE row, last in order, is left out
+    const Row crowded[] = {
+        Row(ANY_STATE, Event::GO, State::C),
+        Row(State::A, Event::GO, State::B, isOpen),
+        Row(State::A, Event::GO, State::C, isOpen),
+    };
+    CHECK(!machine.setTable(crowded, 3));
+    panel.open = false;
+    machine.post(Event::GO);
+    machine.step(panel);
+    CHECK(machine.getState() == State::A);
+
+    CHECK(machine.setTable(TABLE, ROWS));
+}
@@ -0,0 +1,226 @@
+// TraceCodec: bit-exact round trips on the awkward inputs, chunk limits and bad headers
+#include "TestHarness.h"
+#include <TraceCodec.h>
+#include <float.h>
+#include <stdint.h>
+
+namespace {
+
+const size_t MAX_SAMPLES = 4096;
+const uint32_t PERIOD_US = 12500; // 80 SPS
+
+uint32_t timestamps[MAX_SAMPLES];
+float values[MAX_SAMPLES];
+uint8_t chunk[8192];
+
+float fromBits(uint32_t bits) {
+    return TraceCodec::bitsFloat(bits);
+}
+
+// Encodes the first count samples into one chunk and checks every one comes back bit for bit
+size_t roundTrip(size_t count, size_t capacity = sizeof(chunk)) {
+    TraceEncoder encoder;
+    REQUIRE(encoder.begin(chunk, capacity));
+    for (size_t i = 0; i < count; i++) {
+        if (!encoder.append(timestamps[i], values[i])) {
+            TEST_FAIL_("sample did not fit the chunk", true);
+        }
+    }
+    size_t length = encoder.finish();
+    CHECK_EQ(length, TraceCodec::HEADER_SIZE + (encoder.getBitCount() + 7) / 8);
+
+    TraceDecoder decoder;
+    REQUIRE(decoder.begin(chunk, length));
+    REQUIRE_EQ(decoder.getCount(), count);
+    for (size_t i = 0; i < count; i++) {
+        uint32_t timestamp;
+        float value;
+        if (!decoder.next(timestamp, value)) {
+            char text[64];
+            snprintf(text, sizeof(text), "decoding stopped at sample %u of %u", (unsigned)i, (unsigned)count);
+            TEST_FAIL_(text, true);
+        }
+        if (timestamp != timestamps[i] || TraceCodec::floatBits(value) != TraceCodec::floatBits(values[i])) {
+            char text[128];
+            snprintf(text, sizeof(text), "sample %u: got %08X/%08X, wrote %08X/%08X", (unsigned)i,
+                     (unsigned)timestamp, (unsigned)TraceCodec::floatBits(value),
+                     (unsigned)timestamps[i], (unsigned)TraceCodec::floatBits(values[i]));
+            TEST_FAIL_(text, true);
+        }
+    }
+    uint32_t timestamp;
+    float value;
+    CHECK(!decoder.next(timestamp, value));
+    CHECK(!decoder.isTruncated());
+    CHECK_EQ(decoder.getConsumedBytes(), length);
+    return length;
+}
+
+// xorshift32, so the "random" cases are the same on every run
+uint32_t nextRandom(uint32_t& state) {
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return state;
+}
+
+}
+
+TEST(nan_and_special_values_keep_their_bits) {
+    const uint32_t specials[] = {
+        0x7FC00000u, 0x7FC01234u, 0xFFC00000u, 0x7F800001u, 0xFFFFFFFFu, // Quiet, payload, negative, signalling
+        0x7F800000u, 0xFF800000u, 0x00000000u, 0x80000000u,              // Infinities and zeros
+        0x00000001u, 0x007FFFFFu, 0x7F7FFFFFu,                           // Denormals, FLT_MAX
+    };
+    const size_t specialCount = sizeof(specials) / sizeof(specials[0]);
+
+    // Each special between ordinary weights, then all of them back to back, then NaN repeated
+    size_t n = 0;
+    for (size_t i = 0; i < specialCount; i++) {
+        values[n++] = 250.5f;
+        values[n++] = fromBits(specials[i]);
+        values[n++] = 250.75f;
+    }
+    for (size_t i = 0; i < specialCount; i++) values[n++] = fromBits(specials[i]);
+    for (size_t i = 0; i < 20; i++) values[n++] = fromBits(0x7FC01234u);
+    for (size_t i = 0; i < n; i++) timestamps[i] = 1000 + i * PERIOD_US;
+    roundTrip(n);
+
+    // A chunk that starts on NaN keeps it in the header
+    values[0] = fromBits(0x7FC01234u);
+    values[1] = 12.0f;
+    roundTrip(2);
+}
+
+TEST(identical_values_cost_two_bits_a_sample) {
+    const size_t count = 2000;
+    for (size_t i = 0; i < count; i++) {
+        timestamps[i] = 5000000 + i * PERIOD_US;
+        values[i] = 731.25f;
+    }
+    size_t length = roundTrip(count);
+    // After the second sample both the delta and the value repeat: one bit each
+    CHECK_LE(length, TraceCodec::HEADER_SIZE + (TraceCodec::MAX_SAMPLE_BITS + 2 * (count - 2) + 7) / 8);
+
+    // The same, with every timestamp equal too (delta zero throughout)
+    for (size_t i = 0; i < count; i++) timestamps[i] = 42;
+    length = roundTrip(count);
+    CHECK_EQ(length, TraceCodec::HEADER_SIZE + (2 * (count - 1) + 7) / 8);
+
+    // A single sample is the header alone
+    CHECK_EQ(roundTrip(1), TraceCodec::HEADER_SIZE);
+}
+
+TEST(timestamps_wrap_around_32_bits) {
+    // micros() wraps every 71.6 minutes; a steady trace must cross it at no extra cost
+    const size_t count = 400;
+    uint32_t start = 0xFFFFFFFFu - 200 * PERIOD_US + 1;
+    for (size_t i = 0; i < count; i++) {
+        timestamps[i] = start + (uint32_t)i * PERIOD_US;
+        values[i] = 100.0f;
+    }
+    CHECK(timestamps[count - 1] < timestamps[0]);
+    size_t wrapped = roundTrip(count);
+
+    for (size_t i = 0; i < count; i++) timestamps[i] = 1000 + (uint32_t)i * PERIOD_US;
+    CHECK_EQ(roundTrip(count), wrapped);
+
+    // Wrapping with ISR jitter, and exactly onto zero
+    uint32_t state = 0x1234567u;
+    for (size_t i = 0; i < count; i++) {
+        timestamps[i] = start + (uint32_t)i * PERIOD_US + nextRandom(state) % 16;
+    }
+    timestamps[200] = 0;
+    roundTrip(count);
+}
+
+TEST(extreme_timestamp_steps_round_trip) {
+    // Deltas whose delta-of-delta overflows int32: the zigzag varint must take all 8 nibbles
+    const uint32_t sequence[] = { 0, 0xFFFFFFFFu, 0, 0x80000000u, 0x7FFFFFFFu, 0x80000000u,
+                                  0, 0, 1, 0xFFFFFFFEu, 0x80000001u, 12500, 12500, 25000 };
+    size_t n = sizeof(sequence) / sizeof(sequence[0]);
+    for (size_t i = 0; i < n; i++) {
+        timestamps[i] = sequence[i];
+        values[i] = (float)i;
+    }
+    roundTrip(n);
+}
+
+TEST(random_samples_round_trip) {
+    uint32_t state = 0xC0FFEEu;
+    const size_t count = 1000;
+    uint32_t timestamp = nextRandom(state);
+    for (size_t i = 0; i < count; i++) {
+        timestamp += nextRandom(state) >> (nextRandom(state) % 32);
+        timestamps[i] = timestamp;
+        values[i] = fromBits(nextRandom(state));
+    }
+    roundTrip(count);
+
+    // Noisy weight around a load: small XORs that move the window often
+    for (size_t i = 0; i < count; i++) {
+        timestamps[i] = i * PERIOD_US + nextRandom(state) % 8;
+        values[i] = 250.0f + (float)(int32_t)(nextRandom(state) % 200 - 100) / 64.0f;
+    }
+    roundTrip(count);
+}
+
+TEST(full_chunk_refuses_the_sample_and_stays_decodable) {
+    const size_t count = MAX_SAMPLES;
+    uint32_t state = 99;
+    for (size_t i = 0; i < count; i++) {
+        timestamps[i] = nextRandom(state);
+        values[i] = fromBits(nextRandom(state));
+    }
+
+    const size_t capacity = 512;
+    TraceEncoder encoder;
+    REQUIRE(encoder.begin(chunk, capacity));
+    size_t accepted = 0;
+    while (accepted < count && encoder.append(timestamps[accepted], values[accepted])) accepted++;
+    REQUIRE(accepted < count);
+    size_t bitsBefore = encoder.getBitCount();
+    CHECK(!encoder.append(timestamps[accepted], values[accepted])); // Still refused, nothing written
+    CHECK_EQ(encoder.getBitCount(), bitsBefore);
+    size_t length = encoder.finish();
+    CHECK_LE(length, capacity);
+
+    TraceDecoder decoder;
+    REQUIRE(decoder.begin(chunk, length));
+    CHECK_EQ(decoder.getCount(), accepted);
+    uint32_t timestamp;
+    float value;
+    size_t decoded = 0;
+    while (decoder.next(timestamp, value)) {
+        CHECK_EQ(timestamp, timestamps[decoded]);
+        decoded++;
+    }
+    CHECK_EQ(decoded, accepted);
+    CHECK(!decoder.isTruncated());
+
+    CHECK(!encoder.begin(chunk, TraceCodec::HEADER_SIZE - 1));
+}
+
+TEST(truncated_chunks_and_bad_headers_are_reported) {
+    for (size_t i = 0; i < 100; i++) {
+        timestamps[i] = i * PERIOD_US + (i % 3);
+        values[i] = 10.0f + i * 0.37f;
+    }
+    size_t length = roundTrip(100);
+
+    TraceDecoder decoder;
+    uint32_t timestamp;
+    float value;
+    REQUIRE(decoder.begin(chunk, length - 3));
+    size_t decoded = 0;
+    while (decoder.next(timestamp, value)) decoded++;
+    CHECK(decoded < 100u);
+    CHECK(decoder.isTruncated());
+
+    CHECK(!decoder.begin(chunk, TraceCodec::HEADER_SIZE - 1));
+    chunk[2] = TraceCodec::VERSION + 1;
+    CHECK(!decoder.begin(chunk, length));
+    chunk[2] = TraceCodec::VERSION;
+    chunk[0] = '{';
+    CHECK(!decoder.begin(chunk, length));
+}
@@ -0,0 +1,96 @@
+// Weight batching: sample encoding bounds and the byte budget
+#include "TestHarness.h"
+#include "EdgeLink.h"
+#include <math.h>
+
+namespace {
+
+EdgeCommunication::WeightData sample(unsigned long timestamp, float weight) {
+    EdgeCommunication::WeightData data;
+    data.timestamp = timestamp;
+    data.weight = weight;
+    return data;
+}
+
+const char* payloadOn(EdgeLink& link, const char* topicSuffix) {
+    const FakeBroker::Message* message = link.broker().lastOn(topicSuffix);
+    return message ? (const char*)message->payload : nullptr;
+}
+
+void enableBatching(EdgeLink& link, uint16_t maxSamples, uint16_t maxBytes) {
+    EdgeCommunication::BatchConfig config;
+    config.enabled = true;
+    config.maxSamples = maxSamples;
+    config.maxAgeMs = 60000;
+    config.maxBytes = maxBytes;
+    link.edge().setBatchConfig(config);
+}
+
+}
+
+TEST(non_finite_weights_are_rejected) {
+    EdgeLink link;
+    REQUIRE(link.waitOnline());
+    enableBatching(link, 20, 512);
+    link.broker().clearLog();
+
+    CHECK(link.edge().queueWeightData(sample(1000, 12.5f)));
+    CHECK(!link.edge().queueWeightData(sample(1010, NAN)));
+    CHECK(!link.edge().queueWeightData(sample(1020, INFINITY)));
+    CHECK(!link.edge().queueWeightData(sample(1030, -INFINITY)));
+    CHECK_EQ(link.edge().getBatchedSampleCount(), 1);
+
+    CHECK(link.edge().flushWeightBatch());
+    link.runFor(50);
+    REQUIRE_EQ(link.broker().countOn("/weight"), 1u);
+    CHECK_STR(payloadOn(link, "/weight"),
+              "{\"deviceId\":\"TAVOLO_TEST\",\"type\":\"weight_batch\",\"baseTimestamp\":1000,\"samples\":[[0,12.50]]}");
+}
+
+TEST(sample_too_long_for_an_entry_is_sent_alone) {
+    EdgeLink link;
+    REQUIRE(link.waitOnline());
+    enableBatching(link, 20, 512);
+    link.broker().clearLog();
+
+    CHECK(link.edge().queueWeightData(sample(1000, 1.0f)));
+    CHECK(link.edge().queueWeightData(sample(1010, 3.0e30f))); // "%.2f" needs 34 characters
+    CHECK(link.edge().queueWeightData(sample(1020, 2.0f)));
+    CHECK_EQ(link.edge().getBatchedSampleCount(), 2);
+
+    link.runFor(50);
+    REQUIRE_EQ(link.broker().countOn("/weight"), 1u);
+    CHECK_CONTAINS(payloadOn(link, "/weight"), "\"type\":\"weight_data\"");
+
+    CHECK(link.edge().flushWeightBatch());
+    link.runFor(50);
+    REQUIRE_EQ(link.broker().countOn("/weight"), 2u);
+    CHECK_CONTAINS(payloadOn(link, "/weight"), "\"samples\":[[0,1.00],[20,2.00]]}");
+}
+
+TEST(batches_stay_within_the_byte_budget) {
+    EdgeLink link;
+    REQUIRE(link.waitOnline());
+    enableBatching(link, 1000, 128);
+    link.broker().clearLog();
+
+    for (unsigned long i = 0; i < 200; i++) {
+        link.edge().queueWeightData(sample(1000 + i * 100, -99999.99f));
+        link.step();
+    }
+    link.edge().flushWeightBatch();
+    link.runFor(50);
+
+    size_t samples = 0;
+    REQUIRE(link.broker().countOn("/weight") > 1);
+    for (size_t i = 0; i < link.broker().logSize(); i++) {
+        const FakeBroker::Message& message = link.broker().logEntry(i);
+        if (strstr(message.topic, "/weight") == nullptr) continue;
+        CHECK_LE(message.length, 128u);
+        CHECK(message.length >= 2 && memcmp(message.payload + message.length - 2, "]}", 2) == 0);
+        for (const char* cursor = (const char*)message.payload; (cursor = strstr(cursor, "-99999.99")) != nullptr; cursor++) {
+            samples++;
+        }
+    }
+    CHECK_EQ(samples, 200u);
+}
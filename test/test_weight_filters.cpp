@@ -0,0 +1,105 @@
+// Filter stages: the running median against a brute-force one, and the chain plumbing
+#include "TestHarness.h"
+#include <WeightFilters.h>
+#include <algorithm>
+
+namespace {
+
+// Median of the last n values of history[0..length), computed the slow way
+float bruteMedian(const float* history, size_t length, size_t n) {
+    size_t first = length > n ? length - n : 0;
+    float sorted[256];
+    size_t count = 0;
+    for (size_t i = first; i < length; i++) sorted[count++] = history[i];
+    std::sort(sorted, sorted + count);
+    return (count & 1) ? sorted[count / 2] : (sorted[count / 2 - 1] + sorted[count / 2]) * 0.5f;
+}
+
+uint32_t lcg(uint32_t& state) {
+    state = state * 1664525u + 1013904223u;
+    return state >> 8;
+}
+
+template <uint8_t N>
+void checkAgainstBruteForce(uint32_t seed, uint32_t valueRange) {
+    RunningMedianFilter<N> filter;
+    static float history[4000];
+    uint32_t state = seed;
+    for (size_t i = 0; i < 4000; i++) {
+        history[i] = (float)(lcg(state) % valueRange);
+        float got = filter.process(history[i]);
+        float want = bruteMedian(history, i + 1, N);
+        if (got != want) {
+            char message[128];
+            snprintf(message, sizeof(message), "N=%u sample %u: median %g, expected %g",
+                     (unsigned)N, (unsigned)i, got, want);
+            TEST_FAIL_(message, true);
+        }
+    }
+}
+
+}
+
+TEST(median_matches_brute_force_for_every_window_size) {
+    checkAgainstBruteForce<1>(1, 1000);
+    checkAgainstBruteForce<2>(2, 1000);
+    checkAgainstBruteForce<3>(3, 1000);
+    checkAgainstBruteForce<5>(5, 1000);
+    checkAgainstBruteForce<8>(8, 1000);
+    checkAgainstBruteForce<31>(31, 1000);
+    checkAgainstBruteForce<101>(101, 1000);
+    checkAgainstBruteForce<255>(255, 1000);
+}
+
+TEST(median_handles_many_duplicates) {
+    // Few distinct values: most comparisons are ties
+    checkAgainstBruteForce<5>(7, 3);
+    checkAgainstBruteForce<16>(9, 2);
+    checkAgainstBruteForce<31>(11, 4);
+}
+
+TEST(median_follows_monotonic_runs_and_steps) {
+    RunningMedianFilter<5> filter;
+    for (int i = 0; i < 20; i++) filter.process((float)i); // Rising: median lags by two
+    CHECK_EQ(filter.process(20.0f), 18.0f);
+    for (int i = 19; i >= 0; i--) filter.process((float)i); // Falling
+    CHECK_EQ(filter.process(-1.0f), 1.0f);
+
+    // A single spike never reaches the output; a step does after three samples
+    filter.reset();
+    for (int i = 0; i < 5; i++) filter.process(100.0f);
+    CHECK_EQ(filter.process(5000.0f), 100.0f);
+    CHECK_EQ(filter.process(100.0f), 100.0f);
+    filter.process(250.0f);
+    filter.process(250.0f);
+    CHECK_EQ(filter.process(250.0f), 250.0f);
+}
+
+TEST(median_reset_starts_a_fresh_window) {
+    RunningMedianFilter<5> filter;
+    for (int i = 0; i < 5; i++) filter.process(1000.0f);
+    filter.reset();
+    CHECK_EQ(filter.process(3.0f), 3.0f);
+    CHECK_EQ(filter.process(5.0f), 4.0f);
+    CHECK_EQ(filter.process(4.0f), 4.0f);
+}
+
+TEST(chain_routes_parameters_to_the_owning_stage) {
+    FilterChain<SpikeRejectFilter, RunningMedianFilter<5>, EmaFilter> chain;
+    CHECK(chain.setParameter("ema.alpha", 1.0f));
+    CHECK(chain.setParameter("spike.delta", 50.0f));
+    CHECK(!chain.setParameter("ema.alpha", 2.0f)); // Out of range
+    CHECK(!chain.setParameter("median.size", 3.0f));
+
+    // The name handed back is the stage's own, so it outlives the caller's key buffer
+    char key[16] = "spike.confirm";
+    const char* name = chain.setParameter(key, 2.0f);
+    REQUIRE(name != nullptr);
+    CHECK(name != key);
+    memset(key, 0, sizeof(key));
+    CHECK_STR(name, "spike.confirm");
+
+    // alpha 1 makes the EMA transparent, so the output is the median of the spike stage
+    for (int i = 0; i < 5; i++) chain.process(10.0f);
+    CHECK_EQ(chain.process(400.0f), 10.0f);
+}
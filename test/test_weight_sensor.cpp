@@ -0,0 +1,178 @@
+// WeightSensor on one simulated HX711: what wakes the IDLE sampling mode, and duty cycling
+#include "TestHarness.h"
+#include <WeightSensor.h>
+#include <PowerManager.h>
+#include <InPlace.h>
+#include "SimHx711.h"
+
+namespace {
+
+const uint8_t DATA_PIN = 2;
+const uint8_t CLOCK_PIN = 4;
+const uint8_t RATE_PIN = 15;
+const float COUNTS_PER_GRAM = 420.0f;
+const uint32_t IDLE_PERIOD_US = 100000; // 10 SPS
+
+InPlace<SimHx711> cellStorage;
+InPlace<WeightSensor> sensorStorage;
+
+struct Conversions {
+    float weights[256];
+    uint16_t count = 0;
+    uint32_t lastTimestamp = 0;
+
+    // Conversions at or above grams since the last clear
+    uint16_t above(float grams) const {
+        uint16_t hits = 0;
+        for (uint16_t i = 0; i < count; i++) {
+            if (weights[i] >= grams) hits++;
+        }
+        return hits;
+    }
+};
+
+void record(void* context, uint32_t timestampMicros, float weight) {
+    Conversions& into = *static_cast<Conversions*>(context);
+    into.lastTimestamp = timestampMicros;
+    if (into.count < 256) into.weights[into.count++] = weight;
+}
+
+struct Rig {
+    SimHx711* cell;
+    WeightSensor* sensor;
+    Conversions conversions;
+
+    Rig() {
+        VirtualClock::reset();
+        HostGpio::reset();
+        cell = cellStorage.construct(DATA_PIN, CLOCK_PIN, RATE_PIN);
+        cell->setCountsPerGram(COUNTS_PER_GRAM);
+        cell->begin();
+        sensor = sensorStorage.construct(DATA_PIN, CLOCK_PIN, COUNTS_PER_GRAM);
+        sensor->setRatePin(RATE_PIN);
+        sensor->begin();
+        sensor->setConversionHandler(record, &conversions);
+    }
+
+    ~Rig() {
+        sensorStorage.destroy();
+        cellStorage.destroy();
+        VirtualClock::reset();
+        HostGpio::reset();
+    }
+
+    void runFor(uint32_t ms) {
+        uint64_t end = VirtualClock::now() + (uint64_t)ms * 1000;
+        while (VirtualClock::now() < end) {
+            sensor->update();
+            delay(1);
+        }
+    }
+
+    template <typename Predicate>
+    bool runUntil(Predicate done, uint32_t timeoutMs) {
+        uint64_t end = VirtualClock::now() + (uint64_t)timeoutMs * 1000;
+        while (!done()) {
+            if (VirtualClock::now() >= end) return false;
+            sensor->update();
+            delay(1);
+        }
+        return true;
+    }
+
+    void settleIdle() {
+        REQUIRE(runUntil([&]() { return sensor->getSamplingMode() == WeightSensor::SamplingMode::IDLE; }, 10000));
+        runFor(500); // Past the conversions dropped after the RATE change
+        REQUIRE(conversions.count > 0);
+        conversions.count = 0;
+    }
+
+    // ms from now until the conversion ahead (1 = the next one) completes
+    uint32_t msUntilConversion(uint8_t ahead) const {
+        uint32_t next = conversions.lastTimestamp + ahead * IDLE_PERIOD_US;
+        return (next - (uint32_t)VirtualClock::now()) / 1000;
+    }
+};
+
+}
+
+TEST(one_moved_conversion_does_not_wake_idle) {
+    Rig rig;
+    rig.settleIdle();
+    uint32_t switches = rig.sensor->getModeSwitchCount();
+
+    // 50 g for 60 ms around the next conversion: a knock on the table
+    uint32_t at = rig.msUntilConversion(1);
+    rig.cell->play(Waveform().set(0).hold(at - 30).set(50).hold(60).set(0).hold(10000));
+    rig.runFor(1000);
+
+    CHECK_EQ(rig.conversions.above(25.0f), 1u); // The knock really was converted
+    CHECK(rig.sensor->getSamplingMode() == WeightSensor::SamplingMode::IDLE);
+    CHECK_EQ(rig.sensor->getModeSwitchCount(), switches);
+}
+
+TEST(moved_conversions_must_be_consecutive) {
+    Rig rig;
+    rig.settleIdle();
+    uint32_t switches = rig.sensor->getModeSwitchCount();
+
+    // Two knocks with a quiet conversion between them
+    uint32_t first = rig.msUntilConversion(1);
+    uint32_t third = rig.msUntilConversion(3);
+    rig.cell->play(Waveform().set(0).hold(first - 30).set(50).hold(60).set(0)
+                       .hold(third - first - 60).set(50).hold(60).set(0).hold(10000));
+    rig.runFor(1000);
+
+    CHECK_EQ(rig.conversions.above(25.0f), 2u);
+    CHECK(rig.sensor->getSamplingMode() == WeightSensor::SamplingMode::IDLE);
+    CHECK_EQ(rig.sensor->getModeSwitchCount(), switches);
+}
+
+TEST(a_load_wakes_idle_on_its_second_conversion) {
+    Rig rig;
+    rig.settleIdle();
+
+    uint32_t at = rig.msUntilConversion(1);
+    rig.cell->play(Waveform().set(0).hold(at - 30).set(50).hold(60000));
+    REQUIRE(rig.runUntil([&]() { return rig.conversions.above(25.0f) == 1; }, 1000));
+    rig.runFor(50);
+    CHECK(rig.sensor->getSamplingMode() == WeightSensor::SamplingMode::IDLE);
+
+    REQUIRE(rig.runUntil([&]() { return rig.conversions.above(25.0f) == 2; }, 1000));
+    CHECK(rig.sensor->getSamplingMode() == WeightSensor::SamplingMode::ACTIVE);
+}
+
+TEST(light_sleep_is_held_off_while_the_converter_is_powered) {
+    Rig rig;
+    rig.settleIdle();
+    PowerManager power(*rig.sensor);
+    power.begin();
+    CHECK(power.isLightSleepBlocked());
+
+    power.apply(PowerManager::Profile::ECO);
+    REQUIRE(rig.runUntil([&]() { return rig.sensor->isPoweredDown(); }, 5000));
+    CHECK(!power.isLightSleepBlocked());
+
+    // Through two sleep/wake cycles, no conversion completes while sleep is allowed
+    uint32_t cycles = 0;
+    bool wasDown = true;
+    uint64_t end = VirtualClock::now() + 5000000;
+    while (VirtualClock::now() < end && cycles < 2) {
+        uint16_t before = rig.conversions.count;
+        bool sleepAllowed = !power.isLightSleepBlocked();
+        rig.sensor->update();
+        delay(1);
+        if (sleepAllowed) {
+            CHECK_EQ(rig.conversions.count, before);
+        }
+        CHECK_EQ(power.isLightSleepBlocked(), !rig.sensor->isPoweredDown());
+        if (wasDown && !rig.sensor->isPoweredDown()) cycles++;
+        wasDown = rig.sensor->isPoweredDown();
+    }
+    CHECK_EQ(cycles, 2u);
+    CHECK_GE(rig.sensor->getWakeCount(), 1u);
+
+    power.apply(PowerManager::Profile::PERFORMANCE);
+    CHECK(!rig.sensor->isPoweredDown());
+    CHECK(power.isLightSleepBlocked());
+}
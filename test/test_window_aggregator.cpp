@@ -0,0 +1,125 @@
+// Window summaries: pane timing, millis() wrap, long gaps and the published message
+#include "TestHarness.h"
+#include "EdgeLink.h"
+#include <WindowAggregator.h>
+#include <float.h>
+
+namespace {
+
+// Feeds value every periodMs from start (inclusive) to end (exclusive); returns the summaries seen
+uint32_t feed(WindowAggregator& aggregator, float value, uint32_t start, uint32_t end, uint32_t periodMs,
+              WindowAggregator::Summary* last = nullptr) {
+    uint32_t summaries = 0;
+    WindowAggregator::Summary summary;
+    for (uint32_t t = start; t != end; t += periodMs) {
+        if (aggregator.add(value, t, summary)) {
+            summaries++;
+            if (last) *last = summary;
+        }
+    }
+    return summaries;
+}
+
+}
+
+TEST(summary_is_stamped_with_the_pane_end) {
+    WindowAggregator aggregator;
+    REQUIRE(aggregator.configure(60000));
+
+    WindowAggregator::Summary summary;
+    CHECK_EQ(feed(aggregator, 10.0f, 1000, 61000, 1000), 0u);
+    // The next sample arrives late, after a gap; the window still ended at 61000
+    REQUIRE(aggregator.add(10.0f, 64500, summary));
+    CHECK_EQ(summary.timestamp, 61000ul);
+    CHECK_EQ(summary.count, 60u);
+    CHECK_EQ(summary.windowMs, 60000ul);
+    CHECK_EQ(summary.hopMs, 60000ul);
+}
+
+TEST(time_above_threshold_is_exact) {
+    WindowAggregator aggregator;
+    REQUIRE(aggregator.configure(10000));
+    aggregator.setThreshold(100.0f);
+
+    // 2.5 s above the threshold, split across samples 100 ms apart
+    WindowAggregator::Summary summary;
+    feed(aggregator, 0.0f, 0, 3000, 100);
+    feed(aggregator, 150.0f, 3000, 5500, 100);
+    feed(aggregator, 0.0f, 5500, 10000, 100);
+    REQUIRE(aggregator.add(0.0f, 10000, summary));
+    CHECK_EQ(summary.aboveMs, 2500ul);
+    CHECK_EQ(summary.count, 100u);
+    CHECK_NEAR(summary.min, 0.0f, 0.0f);
+    CHECK_NEAR(summary.max, 150.0f, 0.0f);
+    CHECK_NEAR(summary.mean, 37.5f, 0.001f);
+}
+
+TEST(windows_span_the_millis_wrap) {
+    WindowAggregator aggregator;
+    REQUIRE(aggregator.configure(60000));
+    aggregator.setThreshold(5.0f);
+
+    // Starts 30 s before millis() wraps
+    uint32_t start = 0xFFFFFFFFu - 29999u;
+    WindowAggregator::Summary summary;
+    CHECK_EQ(feed(aggregator, 10.0f, start, start + 60000u, 500), 0u);
+    REQUIRE(aggregator.add(10.0f, start + 60000u, summary));
+    CHECK_EQ(summary.timestamp, (unsigned long)(uint32_t)(start + 60000u));
+    CHECK_EQ(summary.count, 120u);
+    CHECK_EQ(summary.aboveMs, 60000ul);
+}
+
+TEST(long_panes_and_gaps_beyond_71_minutes) {
+    // A 90-minute pane overflowed the old microsecond counters
+    WindowAggregator tumbling;
+    REQUIRE(tumbling.configure(90UL * 60000));
+    tumbling.setThreshold(5.0f);
+    WindowAggregator::Summary summary;
+    CHECK_EQ(feed(tumbling, 10.0f, 0, 90UL * 60000, 1000, &summary), 0u);
+    REQUIRE(tumbling.add(10.0f, 90UL * 60000, summary));
+    CHECK_EQ(summary.count, 5400u);
+    CHECK_EQ(summary.aboveMs, 90UL * 60000);
+
+    // Sliding 5 x 10 min; the sensor goes quiet for 80 min while loaded
+    WindowAggregator sliding;
+    REQUIRE(sliding.configure(50UL * 60000, 5));
+    sliding.setThreshold(5.0f);
+    CHECK_EQ(feed(sliding, 10.0f, 0, 50UL * 60000, 1000, &summary), 0u);
+    REQUIRE(sliding.add(10.0f, 50UL * 60000, summary));
+    CHECK_EQ(summary.timestamp, 50UL * 60000);
+
+    // The first sample after the gap closes the pane it started in; the panes skipped
+    // by the gap keep the last level, so the next window is entirely above threshold
+    REQUIRE(sliding.add(10.0f, 130UL * 60000, summary));
+    CHECK_EQ(summary.timestamp, 60UL * 60000);
+    CHECK_EQ(feed(sliding, 10.0f, 130UL * 60000 + 1000, 140UL * 60000, 1000), 0u);
+    REQUIRE(sliding.add(10.0f, 140UL * 60000, summary));
+    CHECK_EQ(summary.timestamp, 140UL * 60000);
+    CHECK_EQ(summary.aboveMs, 50UL * 60000);
+}
+
+TEST(widest_summary_is_published_whole) {
+    EdgeLink link;
+    REQUIRE(link.waitOnline());
+    link.broker().clearLog();
+
+    WindowAggregator::Summary summary;
+    summary.windowMs = 4294967295UL;
+    summary.hopMs = 429496729UL;
+    summary.timestamp = 4294967295UL;
+    summary.count = 4294967295UL;
+    summary.min = -FLT_MAX;
+    summary.max = -1.17549435e-38f;
+    summary.mean = -1.23456789e-30f;
+    summary.variance = FLT_MAX;
+    summary.aboveMs = 4294967295UL;
+    REQUIRE(link.edge().sendWeightSummary(summary));
+    link.runFor(50);
+
+    const FakeBroker::Message* message = link.broker().lastOn("/weight");
+    REQUIRE(message != nullptr);
+    CHECK_GT(message->length, 256u); // More than the previous message buffer held
+    CHECK_CONTAINS((const char*)message->payload, "\"type\":\"weight_summary\"");
+    CHECK_CONTAINS((const char*)message->payload, "\"timestamp\":4294967295}");
+    CHECK_EQ(link.edge().getPublishFailureCount(), 0u);
+}
@@ -0,0 +1,111 @@
+// Decodes flight recorder chunks, as published on tavolo/<id>/flightlog, to text
+//
+// Input is one or more FlightLog chunks back to back, e.g. the raw payloads saved with
+// `mosquitto_sub -t 'tavolo/+/flightlog' -N > flightlog.bin`; with no file, or "-", stdin.
+// Prints "<boot>:<sequence> <FlightLog::describe() line>" per record, and a note where
+// the sequence skips records the ring overwrote between uploads.
+// Built from FlightLog.cpp alone: no Arduino shims, no firmware library.
+// Usage: flightlog_decode [file...]
+#include <FlightLog.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+namespace {
+
+const size_t MAX_CHUNK_RECORDS = 255; // ChunkHeader::count is one byte
+
+struct Position {
+    bool any = false;
+    uint16_t bootCount = 0;
+    uint32_t nextSequence = 0;
+    uint32_t records = 0;
+};
+
+// Reads a whole stream; the ring is 256 records, a few kilobytes per upload
+uint8_t* readAll(FILE* in, size_t& length) {
+    size_t capacity = 16 * 1024;
+    uint8_t* data = (uint8_t*)malloc(capacity);
+    length = 0;
+    while (data != nullptr) {
+        if (length == capacity) {
+            capacity *= 2;
+            uint8_t* grown = (uint8_t*)realloc(data, capacity);
+            if (grown == nullptr) {
+                free(data);
+                return nullptr;
+            }
+            data = grown;
+        }
+        size_t got = fread(data + length, 1, capacity - length, in);
+        length += got;
+        if (got == 0) break;
+    }
+    return data;
+}
+
+// Returns false on a chunk that does not decode; what came before it is still printed
+bool decodeStream(const char* name, const uint8_t* data, size_t length, Position& position) {
+    FlightLog::Record records[MAX_CHUNK_RECORDS];
+    size_t offset = 0;
+    while (offset < length) {
+        FlightLog::ChunkHeader header;
+        if (!FlightLog::decodeChunk(data + offset, length - offset, header, records, MAX_CHUNK_RECORDS)) {
+            fprintf(stderr, "%s: no flight log chunk at byte %zu\n", name, offset);
+            return false;
+        }
+
+        if (!position.any || header.bootCount != position.bootCount) {
+            printf("=== boot %u ===\n", (unsigned)header.bootCount);
+        } else if (header.firstSequence > position.nextSequence) {
+            printf("... %lu records overwritten\n", (unsigned long)(header.firstSequence - position.nextSequence));
+        }
+
+        char line[64];
+        for (uint8_t i = 0; i < header.count; i++) {
+            FlightLog::describe(records[i], line, sizeof(line));
+            printf("%u:%lu %s\n", (unsigned)header.bootCount, (unsigned long)(header.firstSequence + i), line);
+        }
+
+        position.any = true;
+        position.bootCount = header.bootCount;
+        position.nextSequence = header.firstSequence + header.count;
+        position.records += header.count;
+        offset += FlightLog::CHUNK_HEADER_SIZE + (size_t)header.count * FlightLog::RECORD_SIZE;
+    }
+    return true;
+}
+
+bool decodeFile(const char* path, Position& position) {
+    bool useStdin = strcmp(path, "-") == 0;
+    FILE* in = useStdin ? stdin : fopen(path, "rb");
+    if (in == nullptr) {
+        fprintf(stderr, "%s: cannot open\n", path);
+        return false;
+    }
+    size_t length;
+    uint8_t* data = readAll(in, length);
+    if (!useStdin) fclose(in);
+    if (data == nullptr) {
+        fprintf(stderr, "%s: out of memory\n", path);
+        return false;
+    }
+    bool ok = decodeStream(useStdin ? "stdin" : path, data, length, position);
+    free(data);
+    return ok;
+}
+
+}
+
+int main(int argc, char** argv) {
+    Position position;
+    bool ok = true;
+    if (argc < 2) {
+        ok = decodeFile("-", position);
+    }
+    for (int i = 1; i < argc; i++) {
+        ok = decodeFile(argv[i], position) && ok;
+    }
+    fprintf(stderr, "%lu records\n", (unsigned long)position.records);
+    return ok ? 0 : 1;
+}
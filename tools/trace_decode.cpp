@@ -0,0 +1,136 @@
+// Decodes weight trace chunks, as published on tavolo/<id>/trace, to CSV
+//
+// Input is one or more TraceCodec chunks back to back, e.g. the raw payloads saved with
+// `mosquitto_sub -t 'tavolo/+/trace' -N > trace.bin`; with no file, or "-", stdin.
+// Prints "chunk,timestamp_us,weight_g" per sample, or with -s only the totals.
+// Built from TraceCodec.cpp alone: no Arduino shims, no firmware library.
+// Usage: trace_decode [-s] [file...]
+#include <TraceCodec.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+namespace {
+
+struct Totals {
+    uint32_t chunks = 0;
+    uint64_t samples = 0;
+    uint64_t bytes = 0;
+    bool any = false;
+    uint32_t lastTimestamp = 0;
+    uint64_t spanMicros = 0; // Summed per step, so it survives the micros() wrap
+};
+
+// Reads a whole stream; traces are minutes long, a few hundred kilobytes at most
+uint8_t* readAll(FILE* in, size_t& length) {
+    size_t capacity = 64 * 1024;
+    uint8_t* data = (uint8_t*)malloc(capacity);
+    length = 0;
+    while (data != nullptr) {
+        if (length == capacity) {
+            capacity *= 2;
+            uint8_t* grown = (uint8_t*)realloc(data, capacity);
+            if (grown == nullptr) {
+                free(data);
+                return nullptr;
+            }
+            data = grown;
+        }
+        size_t got = fread(data + length, 1, capacity - length, in);
+        length += got;
+        if (got == 0) break;
+    }
+    return data;
+}
+
+// Returns false on a chunk that does not decode; what came before it is still printed
+bool decodeStream(const char* name, const uint8_t* data, size_t length, bool print, Totals& totals) {
+    size_t offset = 0;
+    while (offset < length) {
+        TraceDecoder decoder;
+        if (!decoder.begin(data + offset, length - offset)) {
+            fprintf(stderr, "%s: no trace chunk at byte %zu\n", name, offset);
+            return false;
+        }
+        uint32_t timestamp;
+        float weight;
+        uint32_t samples = 0;
+        uint32_t first = 0;
+        uint32_t last = 0;
+        while (decoder.next(timestamp, weight)) {
+            if (print) printf("%u,%u,%.4f\n", (unsigned)totals.chunks, (unsigned)timestamp, weight);
+            if (samples++ == 0) first = timestamp;
+            last = timestamp;
+        }
+        if (decoder.isTruncated()) {
+            fprintf(stderr, "%s: chunk at byte %zu truncated or corrupt\n", name, offset);
+            return false;
+        }
+        offset += decoder.getConsumedBytes();
+
+        // Totals cover whole chunks only
+        if (samples > 0) {
+            if (totals.any) totals.spanMicros += (uint32_t)(first - totals.lastTimestamp);
+            totals.spanMicros += (uint32_t)(last - first);
+            totals.lastTimestamp = last;
+            totals.any = true;
+        }
+        totals.samples += samples;
+        totals.bytes += decoder.getConsumedBytes();
+        totals.chunks++;
+    }
+    return true;
+}
+
+bool decodeFile(const char* path, bool print, Totals& totals) {
+    bool useStdin = strcmp(path, "-") == 0;
+    FILE* in = useStdin ? stdin : fopen(path, "rb");
+    if (in == nullptr) {
+        fprintf(stderr, "%s: cannot open\n", path);
+        return false;
+    }
+    size_t length;
+    uint8_t* data = readAll(in, length);
+    if (!useStdin) fclose(in);
+    if (data == nullptr) {
+        fprintf(stderr, "%s: out of memory\n", path);
+        return false;
+    }
+    bool ok = decodeStream(useStdin ? "stdin" : path, data, length, print, totals);
+    free(data);
+    return ok;
+}
+
+}
+
+int main(int argc, char** argv) {
+    bool summaryOnly = false;
+    int first = 1;
+    if (argc > 1 && strcmp(argv[1], "-s") == 0) {
+        summaryOnly = true;
+        first = 2;
+    }
+
+    Totals totals;
+    bool ok = true;
+    if (!summaryOnly) printf("chunk,timestamp_us,weight_g\n");
+    if (first >= argc) {
+        ok = decodeFile("-", !summaryOnly, totals);
+    }
+    for (int i = first; i < argc; i++) {
+        ok = decodeFile(argv[i], !summaryOnly, totals) && ok;
+    }
+
+    FILE* out = summaryOnly ? stdout : stderr;
+    fprintf(out, "%u chunks, %llu samples, %llu bytes", (unsigned)totals.chunks,
+            (unsigned long long)totals.samples, (unsigned long long)totals.bytes);
+    if (totals.samples > 0) {
+        fprintf(out, ", %.2f bits/sample", totals.bytes * 8.0 / totals.samples);
+    }
+    if (totals.samples > 1) {
+        fprintf(out, ", %.1f s at %.1f SPS", totals.spanMicros / 1e6,
+                (totals.samples - 1) * 1e6 / (totals.spanMicros > 0 ? totals.spanMicros : 1));
+    }
+    fprintf(out, "\n");
+    return ok ? 0 : 1;
+}